@@ -434,6 +434,12 @@ struct cl_object_header {
 	 * Size of cl_page + page slices
 	 */
 	unsigned short		 coh_page_bufsize;
+	/**
+	 * Slab cache cl_pages of this object are allocated from, shared by
+	 * all objects with the same coh_page_bufsize. Set by the first
+	 * cl_page_alloc().
+	 */
+	cfs_mem_cache_t		*coh_page_kmem;
 	/**
 	 * Number of objects above this one: 0 for a top-object, 1 for its
 	 * sub-object, etc.
@@ -2390,7 +2396,13 @@ struct cl_io {
 	 * Right now, only two opertaions need to verify layout: glimpse
 	 * and setattr.
 	 */
-			     ci_verify_layout:1;
+			     ci_verify_layout:1,
+	/**
+	 * O_DIRECT read or write: do not split the io at stripe boundaries,
+	 * so that one iteration submits the transfers to all the stripes it
+	 * covers at once and waits for them together.
+	 */
+			     ci_parallel_dio:1;
         /**
          * Number of pages owned by this IO. For invariant checking.
          */
@@ -52,6 +52,8 @@
 #include <linux/version.h>
 #include <linux/smp.h>
 #include <linux/rwsem.h>
+#include <linux/mm.h>
+#include <linux/vmalloc.h>
 #include <libcfs/libcfs.h>
 #include <linux/statfs.h>
 
@@ -207,9 +207,49 @@ struct lprocfs_stats {
 
 	/* has ls_num of counter headers */
 	struct lprocfs_counter_header	*ls_cnt_header;
+	/* entry in the binary stats export, set by lprocfs_register_stats */
+	struct lprocfs_export_entry	*ls_export;
 	struct lprocfs_percpu		*ls_percpu[0];
 };
 
+/*
+ * Latency histograms.
+ *
+ * Every counter is a log2 histogram split into LPROCFS_LAT_SUB_BUCKETS
+ * linear sub-buckets per power of two (in the style of HdrHistogram), so
+ * a value is known to within 1/LPROCFS_LAT_SUB_BUCKETS of its magnitude.
+ * Values below LPROCFS_LAT_SUB_BUCKETS are counted exactly and anything
+ * above 2^32 is clamped into the last bucket.
+ *
+ * Histograms are kept per CPU and are only allocated the first time a
+ * counter is updated on that CPU, so sparse counter sets (e.g. one slot
+ * per RPC opcode) only pay for the opcodes actually seen. Updates are done
+ * with preemption disabled on the local CPU copy without any locking.
+ */
+#define LPROCFS_LAT_SUB_BITS	2
+#define LPROCFS_LAT_SUB_BUCKETS	(1 << LPROCFS_LAT_SUB_BITS)
+#define LPROCFS_LAT_BUCKETS	((32 - LPROCFS_LAT_SUB_BITS + 1) * \
+				 LPROCFS_LAT_SUB_BUCKETS)
+
+struct lprocfs_lat_counter {
+	__u64	llc_max;
+	__u32	llc_buckets[LPROCFS_LAT_BUCKETS];
+};
+
+struct lprocfs_lat_stats {
+	/* # of counters */
+	unsigned int			 lls_num;
+	/* # of per-cpu slots, i.e. cfs_num_possible_cpus() */
+	unsigned int			 lls_num_cpu;
+	/* has lls_num of counter headers */
+	struct lprocfs_counter_header	*lls_cnt_header;
+	/* lls_num_cpu * lls_num histograms, allocated on first update */
+	struct lprocfs_lat_counter	**lls_cntr;
+	/* entry in the binary stats export, set by
+	 * lprocfs_register_lat_stats */
+	struct lprocfs_export_entry	*lls_export;
+};
+
 #define OPC_RANGE(seg) (seg ## _LAST_OPC - seg ## _FIRST_OPC)
 
 /* Pack all opcodes down into a single monotonically increasing index */
@@ -335,6 +375,12 @@ enum {
 
 #define PTLRPC_FIRST_CNTR PTLRPC_REQWAIT_CNTR
 
+/* latency histograms kept in front of the per-opcode ones */
+enum {
+	PTLRPC_LAT_REQWAIT = 0,
+	PTLRPC_LAT_LAST
+};
+
 enum {
         LDLM_GLIMPSE_ENQUEUE = 0,
         LDLM_PLAIN_ENQUEUE,
@@ -380,6 +426,17 @@ static inline void s2dhms(struct dhms *ts, time_t secs)
 #define JOBSTATS_DISABLE		"disable"
 #define JOBSTATS_PROCNAME_UID		"procname_uid"
 
+/* per-job latency breakdown of the requests handled for a job */
+enum {
+	JOBSTATS_LAT_QUEUE = 0,		/* arrival until handling, incl. NRS */
+	JOBSTATS_LAT_HANDLE,		/* request handling, excluding bulk */
+	JOBSTATS_LAT_BULK,		/* waiting for bulk transfers */
+	JOBSTATS_LAT_LAST
+};
+
+/* log2 usec buckets, the last one counts everything from ~4s up */
+#define JOBSTATS_LAT_BUCKETS		24
+
 typedef void (*cntr_init_callback)(struct lprocfs_stats *stats);
 
 struct obd_job_stats {
@@ -551,6 +608,52 @@ static inline __u64 lprocfs_stats_collector(struct lprocfs_stats *stats,
 	return ret;
 }
 
+/* map a value to its latency histogram bucket */
+static inline unsigned int lprocfs_lat_bucket(__u64 value)
+{
+	unsigned int shift;
+	__u32	     val;
+
+	if (value < LPROCFS_LAT_SUB_BUCKETS)
+		return value;
+
+	val = value > ~0U ? ~0U : value;
+	/* index of the most significant bit, >= LPROCFS_LAT_SUB_BITS */
+	shift = fls(val) - 1 - LPROCFS_LAT_SUB_BITS;
+
+	return (shift + 1) * LPROCFS_LAT_SUB_BUCKETS +
+	       ((val >> shift) & (LPROCFS_LAT_SUB_BUCKETS - 1));
+}
+
+/* highest value which is counted into latency histogram bucket \a idx */
+static inline __u64 lprocfs_lat_bucket_max(unsigned int idx)
+{
+	unsigned int shift;
+
+	if (idx < LPROCFS_LAT_SUB_BUCKETS)
+		return idx;
+
+	shift = idx / LPROCFS_LAT_SUB_BUCKETS - 1;
+	return ((__u64)(LPROCFS_LAT_SUB_BUCKETS +
+			idx % LPROCFS_LAT_SUB_BUCKETS + 1) << shift) - 1;
+}
+
+extern struct lprocfs_lat_stats *lprocfs_alloc_lat_stats(unsigned int num);
+extern void lprocfs_free_lat_stats(struct lprocfs_lat_stats **stats);
+extern void lprocfs_clear_lat_stats(struct lprocfs_lat_stats *stats);
+extern void lprocfs_lat_counter_init(struct lprocfs_lat_stats *stats,
+				     int index, const char *name,
+				     const char *units);
+extern void lprocfs_lat_counter_add(struct lprocfs_lat_stats *stats, int idx,
+				    __u64 value);
+extern __u64 lprocfs_lat_collect(struct lprocfs_lat_stats *stats, int idx,
+				 struct lprocfs_lat_counter *cnt);
+extern __u64 lprocfs_lat_percentile(struct lprocfs_lat_counter *cnt,
+				    __u64 count, unsigned int permille);
+extern int lprocfs_register_lat_stats(cfs_proc_dir_entry_t *root,
+				      const char *name,
+				      struct lprocfs_lat_stats *stats);
+
 extern struct lprocfs_stats *
 lprocfs_alloc_stats(unsigned int num, enum lprocfs_stats_flags flags);
 extern void lprocfs_clear_stats(struct lprocfs_stats *stats);
@@ -708,6 +811,10 @@ void lprocfs_oh_tally(struct obd_histogram *oh, unsigned int value);
 void lprocfs_oh_tally_log2(struct obd_histogram *oh, unsigned int value);
 void lprocfs_oh_clear(struct obd_histogram *oh);
 unsigned long lprocfs_oh_sum(struct obd_histogram *oh);
+int lprocfs_oh_export(cfs_proc_dir_entry_t *root, const char *name,
+		      struct obd_histogram *oh, int count);
+void lprocfs_oh_unexport(struct obd_histogram *oh);
+extern struct file_operations lprocfs_stats_export_fops;
 
 void lprocfs_stats_collect(struct lprocfs_stats *stats, int idx,
                            struct lprocfs_counter *cnt);
@@ -774,6 +881,7 @@ struct file_operations name##_fops = {                                     \
 /* lprocfs_jobstats.c */
 int lprocfs_job_stats_log(struct obd_device *obd, char *jobid,
 			  int event, long amount);
+void lprocfs_job_stats_lat(struct obd_device *obd, char *jobid, long *lat);
 void lprocfs_job_stats_fini(struct obd_device *obd);
 int lprocfs_job_stats_init(struct obd_device *obd, int cntr_num,
 			   cntr_init_callback fn);
@@ -904,6 +1012,24 @@ static inline int lprocfs_register_stats(cfs_proc_dir_entry_t *root,
                                          const char *name,
                                          struct lprocfs_stats *stats)
 { return 0; }
+static inline struct lprocfs_lat_stats *
+lprocfs_alloc_lat_stats(unsigned int num)
+{ return NULL; }
+static inline void lprocfs_free_lat_stats(struct lprocfs_lat_stats **stats)
+{ return; }
+static inline void lprocfs_clear_lat_stats(struct lprocfs_lat_stats *stats)
+{ return; }
+static inline void lprocfs_lat_counter_init(struct lprocfs_lat_stats *stats,
+					    int index, const char *name,
+					    const char *units)
+{ return; }
+static inline void lprocfs_lat_counter_add(struct lprocfs_lat_stats *stats,
+					   int idx, __u64 value)
+{ return; }
+static inline int lprocfs_register_lat_stats(cfs_proc_dir_entry_t *root,
+					     const char *name,
+					     struct lprocfs_lat_stats *stats)
+{ return 0; }
 static inline void lprocfs_init_ops_stats(int num_private_stats,
                                           struct lprocfs_stats *stats)
 { return; }
@@ -1075,6 +1201,13 @@ static inline
 unsigned long lprocfs_oh_sum(struct obd_histogram *oh)
 { return 0; }
 static inline
+int lprocfs_oh_export(cfs_proc_dir_entry_t *root, const char *name,
+		      struct obd_histogram *oh, int count)
+{ return 0; }
+static inline
+void lprocfs_oh_unexport(struct obd_histogram *oh)
+{ return; }
+static inline
 void lprocfs_stats_collect(struct lprocfs_stats *stats, int idx,
                            struct lprocfs_counter *cnt)
 { return; }
@@ -1092,6 +1225,9 @@ int lprocfs_job_stats_log(struct obd_device *obd, char *jobid, int event,
 			  long amount)
 { return 0; }
 static inline
+void lprocfs_job_stats_lat(struct obd_device *obd, char *jobid, long *lat)
+{ return; }
+static inline
 void lprocfs_job_stats_fini(struct obd_device *obd)
 { return; }
 static inline
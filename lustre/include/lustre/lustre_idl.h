@@ -1309,6 +1309,13 @@ extern void lustre_swab_ptlrpc_body(struct ptlrpc_body *pb);
 #define OBD_CONNECT_SHORTIO     0x2000000000000ULL/* short io */
 #define OBD_CONNECT_PINGLESS	0x4000000000000ULL/* pings not required */
 #define OBD_CONNECT_DISP_STRIPE 0x10000000000000ULL/* create stripe disposition*/
+#define OBD_CONNECT_BL_BATCH	0x80000000000000ULL/* multi-lock blocking AST */
+#define OBD_CONNECT_FLAGS2	0x8000000000000000ULL/* ocd_connect_flags2 used */
+
+/* Flags in obd_connect_data::ocd_connect_flags2, only valid if
+ * OBD_CONNECT_FLAGS2 is set. Other branches allocate them from the lowest
+ * bit up, so this branch takes them from the top down. */
+#define OBD_CONNECT2_MD_BATCH	0x4000000000000000ULL/* REINT_BATCH requests */
 
 /* XXX README XXX:
  * Please DO NOT add flag values here before first ensuring that this same
@@ -1352,7 +1359,10 @@ extern void lustre_swab_ptlrpc_body(struct ptlrpc_body *pb);
 				OBD_CONNECT_LIGHTWEIGHT | OBD_CONNECT_UMASK | \
 				OBD_CONNECT_LVB_TYPE | OBD_CONNECT_LAYOUTLOCK |\
 				OBD_CONNECT_PINGLESS | \
-				OBD_CONNECT_DISP_STRIPE)
+				OBD_CONNECT_DISP_STRIPE | OBD_CONNECT_BL_BATCH |\
+				OBD_CONNECT_FLAGS2)
+
+#define MDT_CONNECT_SUPPORTED2	OBD_CONNECT2_MD_BATCH
 
 #define OST_CONNECT_SUPPORTED  (OBD_CONNECT_SRVLOCK | OBD_CONNECT_GRANT | \
                                 OBD_CONNECT_REQPORTAL | OBD_CONNECT_VERSION | \
@@ -1370,7 +1380,7 @@ extern void lustre_swab_ptlrpc_body(struct ptlrpc_body *pb);
 				OBD_CONNECT_JOBSTATS | \
 				OBD_CONNECT_LIGHTWEIGHT | OBD_CONNECT_LVB_TYPE|\
 				OBD_CONNECT_LAYOUTLOCK | OBD_CONNECT_FID | \
-				OBD_CONNECT_PINGLESS)
+				OBD_CONNECT_PINGLESS | OBD_CONNECT_BL_BATCH)
 #define ECHO_CONNECT_SUPPORTED (0)
 #define MGS_CONNECT_SUPPORTED  (OBD_CONNECT_VERSION | OBD_CONNECT_AT | \
 				OBD_CONNECT_FULL20 | OBD_CONNECT_IMP_RECOV | \
@@ -1431,7 +1441,7 @@ struct obd_connect_data {
          * if the corresponding flag in ocd_connect_flags is set. Accessing
          * any field after ocd_maxbytes on the receiver without a valid flag
          * may result in out-of-bound memory access and kernel oops. */
-        __u64 padding1;          /* added 2.1.0. also fix lustre_swab_connect */
+	__u64 ocd_connect_flags2; /* OBD_CONNECT2_* per above */
         __u64 padding2;          /* added 2.1.0. also fix lustre_swab_connect */
         __u64 padding3;          /* added 2.1.0. also fix lustre_swab_connect */
         __u64 padding4;          /* added 2.1.0. also fix lustre_swab_connect */
@@ -1933,12 +1943,17 @@ struct quota_body {
 /* qb_usage is the current qunit (in kbytes/inodes) when quota_body is used in
  * quota reply */
 #define qb_qunit	qb_usage
+/* In QUOTA_DQACQ_BATCH replies, qb_padding holds the result of each entry */
+#define qb_rc		qb_padding
 
 #define QUOTA_DQACQ_FL_ACQ	0x1  /* acquire quota */
 #define QUOTA_DQACQ_FL_PREACQ	0x2  /* pre-acquire */
 #define QUOTA_DQACQ_FL_REL	0x4  /* release quota */
 #define QUOTA_DQACQ_FL_REPORT	0x8  /* report usage */
 
+/* maximum number of quota_body in a QUOTA_DQACQ_BATCH request */
+#define QUOTA_DQACQ_BATCH_MAX	64
+
 extern void lustre_swab_quota_body(struct quota_body *b);
 
 /* Quota types currently supported */
@@ -2028,6 +2043,7 @@ extern void lustre_swab_lquota_lvb(struct lquota_lvb *lvb);
 typedef enum {
 	QUOTA_DQACQ	= 601,
 	QUOTA_DQREL	= 602,
+	QUOTA_DQACQ_BATCH = 603,
 	QUOTA_LAST_OPC
 } quota_cmd_t;
 #define QUOTA_FIRST_OPC	QUOTA_DQACQ
@@ -2095,9 +2111,20 @@ typedef enum {
 	REINT_SETXATTR = 7,
 	REINT_RMENTRY  = 8,
 //      REINT_WRITE    = 9,
+	REINT_BATCH    = 10,
         REINT_MAX
 } mds_reint_t, mdt_reint_t;
 
+/*
+ * A REINT_BATCH request carries an array of mdt_rec_reint records in
+ * RMF_BATCH_RECS, each one a REINT_SETATTR, REINT_CREATE or REINT_UNLINK
+ * record, and the names of the create and unlink records in RMF_BATCH_NAMES,
+ * NUL terminated and in record order. The reply returns the result of every
+ * record in RMF_RCS. Only clients connected with OBD_CONNECT2_MD_BATCH may
+ * send it.
+ */
+#define MDS_BATCH_MAX_OPS	256
+
 extern void lustre_swab_generic_32s (__u32 *val);
 
 /* the disposition of the intent outlines what was executed */
@@ -255,6 +255,17 @@ struct ost_id {
 #define LL_IOC_LMV_SETSTRIPE	    _IOWR('f', 240, struct lmv_user_md)
 #define LL_IOC_LMV_GETSTRIPE	    _IOWR('f', 241, struct lmv_user_md)
 #define LL_IOC_REMOVE_ENTRY	    _IOWR('f', 242, __u64)
+#define LL_IOC_BULK_UNLINK	    _IOWR('f', 243, struct ll_bulk_unlink)
+
+/* argument of LL_IOC_BULK_UNLINK on a directory */
+#define LL_BULK_UNLINK_MAX	1024	/* names per ioctl */
+#define LL_BULK_UNLINK_BUFLEN	(256 * 1024)
+struct ll_bulk_unlink {
+	__u32	lbu_count;	/* number of names */
+	__u32	lbu_buflen;	/* size of lbu_buf */
+	/* lbu_count __s32 results (out), then the NUL-terminated names */
+	char	lbu_buf[0];
+};
 
 #define LL_STATFS_LMV           1
 #define LL_STATFS_LOV           2
@@ -818,11 +829,20 @@ static inline char *changelog_rec_sname(struct changelog_ext_rec *rec)
 	return rec->cr_name + strlen(rec->cr_name) + 1;
 }
 
+/* icc_flags bit, next to the CHANGELOG_FLAG_* of lustreapi.h: the caller
+ * passes icc_type_mask and icc_fid, older binaries pass a struct ending at
+ * icc_flags */
+#define CHANGELOG_FLAG_FILTER	0x04
+
 struct ioc_changelog {
         __u64 icc_recno;
         __u32 icc_mdtindex;
         __u32 icc_id;
         __u32 icc_flags;
+	/* only valid with CHANGELOG_FLAG_FILTER */
+	__u32 icc_type_mask;	/* 1 << CL_* types to report, 0 for all */
+	struct lu_fid icc_fid;	/* only report records about this FID or
+				 * its entries, if set */
 };
 
 enum changelog_message_type {
@@ -1152,6 +1172,81 @@ struct hsm_copy {
 	struct hsm_action_item	hc_hai;
 };
 
+/*
+ * Binary statistics export, /proc/fs/lustre/stats_export.
+ *
+ * Each open of the file takes a snapshot of every exported lprocfs_stats
+ * and obd_histogram, which can then be read() or mmap()ed in one go.
+ * The snapshot is a header followed by leh_count records; each record is
+ * a lstats_export_record followed by ler_count lstats_export_counter
+ * entries (LSTATS_EXPORT_STATS), ler_count arrays of leh_hist_max __u64
+ * buckets (LSTATS_EXPORT_HIST), or ler_count lstats_export_lat entries each
+ * followed by lel_buckets __u64 buckets (LSTATS_EXPORT_LAT).  Latency
+ * bucket i < 2^lel_sub_bits counts the value i; above that, bucket i counts
+ * values up to ((S + i % S + 1) << (i / S - 1)) - 1 with S = 2^lel_sub_bits.
+ * Records are 8-byte aligned and
+ * ler_size gives the offset to the next one, so decoders must use the
+ * sizes recorded in the snapshot rather than sizeof().  All values are
+ * in host byte order.
+ */
+#define LSTATS_EXPORT_MAGIC	0x4c535458	/* "LSTX" */
+#define LSTATS_EXPORT_VERSION	1
+
+#define LSTATS_PATH_LEN		128
+#define LSTATS_NAME_LEN		48
+#define LSTATS_UNITS_LEN	16
+
+/* lec_config bits, same values as LPROCFS_CNTR_* */
+#define LSTATS_CNTR_AVGMINMAX	0x0002
+#define LSTATS_CNTR_STDDEV	0x0004
+
+struct lstats_export_header {
+	__u32	leh_magic;
+	__u16	leh_version;
+	__u16	leh_hdr_size;		/* sizeof(lstats_export_header) */
+	__u16	leh_rec_size;		/* sizeof(lstats_export_record) */
+	__u16	leh_cntr_size;		/* sizeof(lstats_export_counter) */
+	__u32	leh_count;		/* number of records */
+	__u64	leh_size;		/* total snapshot size in bytes */
+	__u64	leh_snapshot_sec;
+	__u32	leh_snapshot_usec;
+	__u32	leh_hist_max;		/* buckets per histogram */
+};
+
+enum lstats_export_type {
+	LSTATS_EXPORT_STATS	= 1,
+	LSTATS_EXPORT_HIST	= 2,
+	LSTATS_EXPORT_LAT	= 3,
+};
+
+struct lstats_export_record {
+	__u32	ler_type;		/* enum lstats_export_type */
+	__u32	ler_count;		/* counters or histograms */
+	__u64	ler_size;		/* record and payload size */
+	char	ler_path[LSTATS_PATH_LEN]; /* relative to /proc/fs/lustre */
+};
+
+struct lstats_export_counter {
+	__u64	lec_count;
+	__u64	lec_min;
+	__u64	lec_max;
+	__u64	lec_sum;
+	__u64	lec_sumsquare;
+	__u32	lec_config;		/* LSTATS_CNTR_* */
+	__u32	lec_padding;
+	char	lec_name[LSTATS_NAME_LEN];
+	char	lec_units[LSTATS_UNITS_LEN];
+};
+
+struct lstats_export_lat {
+	__u64	lel_count;		/* samples in the buckets */
+	__u64	lel_max;		/* largest sample */
+	__u32	lel_buckets;		/* buckets following this entry */
+	__u32	lel_sub_bits;		/* log2 of linear sub-buckets */
+	char	lel_name[LSTATS_NAME_LEN];
+	char	lel_units[LSTATS_UNITS_LEN];
+};
+
 /** @} lustreuser */
 
 #endif /* _LUSTRE_USER_H */
@@ -228,6 +228,8 @@ extern int llapi_quotactl(char *mnt, struct if_quotactl *qctl);
 extern int llapi_target_iterate(int type_num, char **obd_type, void *args,
 				llapi_cb_t cb);
 extern int llapi_get_connect_flags(const char *mnt, __u64 *flags);
+extern int llapi_bulk_unlink(const char *dir, char **names, int count,
+			     int *rcs);
 extern int llapi_lsetfacl(int argc, char *argv[]);
 extern int llapi_lgetfacl(int argc, char *argv[]);
 extern int llapi_rsetfacl(int argc, char *argv[]);
@@ -271,6 +273,9 @@ extern int llapi_swap_layouts(const char *path1, const char *path2,
 
 extern int llapi_changelog_start(void **priv, int flags, const char *mdtname,
                                  long long startrec);
+extern int llapi_changelog_start_filter(void **priv, int flags,
+					const char *mdtname, long long startrec,
+					__u32 type_mask, const lustre_fid *fid);
 extern int llapi_changelog_fini(void **priv);
 extern int llapi_changelog_recv(void *priv, struct changelog_ext_rec **rech);
 extern int llapi_changelog_free(struct changelog_ext_rec **rech);
@@ -299,6 +304,65 @@ extern int llapi_hsm_import(const char *dst, int archive, struct stat *st,
 			    int stripe_count, int stripe_pattern,
 			    char *pool_name, lustre_fid *newfid);
 
+/* HSM copytool engine.
+ * Receives the HSM actions of a copytool and runs them in a pool of worker
+ * threads, each action calling the mover callback for its type between
+ * llapi_hsm_copy_start() and llapi_hsm_copy_end(). Progress is reported to
+ * the coordinator by the engine while data is being copied.
+ */
+struct hsm_ct_engine;
+struct hsm_ct_action;
+
+struct hsm_ct_mover {
+	/* return 0 or a negative errno, reported with the copy end */
+	int	(*ctm_archive)(struct hsm_ct_action *act, void *data);
+	int	(*ctm_restore)(struct hsm_ct_action *act, void *data);
+	int	(*ctm_remove)(struct hsm_ct_action *act, void *data);
+	void	 *ctm_data;
+};
+
+#define HSM_CT_MAX_ARCHIVE	32
+
+struct hsm_ct_engine_param {
+	int			cep_threads;	/* concurrent actions */
+	int			cep_stripes;	/* streams per file copy */
+	unsigned int		cep_chunk_size;	/* I/O size, page aligned */
+	int			cep_direct_io;	/* O_DIRECT on Lustre files */
+	int			cep_progress_interval; /* seconds */
+	/* bytes/s allowed for each archive id, 0 for no limit */
+	unsigned long long	cep_bandwidth[HSM_CT_MAX_ARCHIVE];
+};
+
+struct hsm_ct_stats {
+	unsigned long long	cts_archived;
+	unsigned long long	cts_restored;
+	unsigned long long	cts_removed;
+	unsigned long long	cts_failed;
+	unsigned long long	cts_running;
+	unsigned long long	cts_bytes;	/* copied by all actions */
+	unsigned long long	cts_copy_usec;	/* time spent copying */
+	unsigned long long	cts_throttle_usec; /* delayed by bandwidth */
+};
+
+extern void llapi_hsm_ct_engine_param_init(struct hsm_ct_engine_param *param);
+extern int llapi_hsm_ct_engine_init(struct hsm_ct_engine **engine,
+				    const char *mnt, int archive_count,
+				    int *archives,
+				    const struct hsm_ct_engine_param *param,
+				    const struct hsm_ct_mover *mover);
+extern int llapi_hsm_ct_engine_run(struct hsm_ct_engine *engine);
+extern void llapi_hsm_ct_engine_stop(struct hsm_ct_engine *engine);
+extern int llapi_hsm_ct_engine_fini(struct hsm_ct_engine **engine);
+extern void llapi_hsm_ct_engine_stats(struct hsm_ct_engine *engine,
+				      struct hsm_ct_stats *stats);
+extern const struct hsm_action_item *
+llapi_hsm_ct_action_item(const struct hsm_ct_action *act);
+extern int llapi_hsm_ct_action_archive(const struct hsm_ct_action *act);
+extern int llapi_hsm_ct_action_open(struct hsm_ct_action *act, int flags);
+extern int llapi_hsm_ct_action_copy(struct hsm_ct_action *act, int src_fd,
+				    int dst_fd, unsigned long long offset,
+				    unsigned long long length);
+
 /* HSM user interface */
 extern struct hsm_user_request *llapi_hsm_user_request_alloc(int itemcount,
 							     int data_len);
@@ -342,7 +342,7 @@ static inline int lockmode_compat(ldlm_mode_t exist_mode, ldlm_mode_t new_mode)
  * lr_lock
  *
  * lr_lock
- *     waiting_locks_spinlock
+ *     ldlm_waiting_locks::wl_lock
  *
  * lr_lock
  *     led_lock
@@ -1017,10 +1017,10 @@ struct ldlm_lock {
 	/**
 	 * List item for locks waiting for cancellation from clients.
 	 * The lists this could be linked into are:
-	 * waiting_locks_list (protected by waiting_locks_spinlock),
-	 * then if the lock timed out, it is moved to
-	 * expired_lock_thread.elt_expired_locks for further processing.
-	 * Protected by elt_lock.
+	 * a slot of ldlm_waiting_locks::wl_wheel, then if the lock timed out,
+	 * it is moved to ldlm_waiting_locks::wl_expired for further
+	 * processing. Protected by ldlm_waiting_locks::wl_lock of the
+	 * partition the lock handle maps to.
 	 */
 	cfs_list_t		l_pending_chain;
 
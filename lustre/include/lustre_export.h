@@ -81,6 +81,12 @@ struct mdt_export_data {
 	__u64			med_ibits_known;
 	struct mutex		med_idmap_mutex;
 	struct lustre_idmap_table *med_idmap;
+	/** Per-record results of the last REINT_BATCH, to reconstruct its
+	 * reply if it is resent, protected by exp_lock */
+	__u64			med_batch_xid;
+	__u64			med_batch_transno;
+	__u32		       *med_batch_rcs;
+	int			med_batch_count;
 };
 
 struct ec_export_data { /* echo client */
@@ -343,6 +349,23 @@ static inline int exp_connect_umask(struct obd_export *exp)
 	return !!(exp_connect_flags(exp) & OBD_CONNECT_UMASK);
 }
 
+static inline bool exp_connect_bl_batch(struct obd_export *exp)
+{
+	return !!(exp_connect_flags(exp) & OBD_CONNECT_BL_BATCH);
+}
+
+static inline __u64 exp_connect_flags2(struct obd_export *exp)
+{
+	if (exp_connect_flags(exp) & OBD_CONNECT_FLAGS2)
+		return exp->exp_connect_data.ocd_connect_flags2;
+	return 0;
+}
+
+static inline bool exp_connect_md_batch(struct obd_export *exp)
+{
+	return !!(exp_connect_flags2(exp) & OBD_CONNECT2_MD_BATCH);
+}
+
 static inline int imp_connect_lru_resize(struct obd_import *imp)
 {
         struct obd_connect_data *ocd;
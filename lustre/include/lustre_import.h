@@ -59,6 +59,26 @@
 #define D_ADAPTTO D_OTHER
 #define AT_BINS 4                  /* "bin" means "N seconds of history" */
 #define AT_FLG_NOHIST 0x1          /* use last reported value only */
+#define AT_FLG_QUANTILE 0x2        /* use the at_percentile of at_qhist */
+
+/*
+ * Distribution of the values measured by an adaptive timeout, in log-linear
+ * buckets: values below 4 have a bucket each, then every power of 2 is split
+ * in 4 buckets, up to 4095 secs. A new value weighs AT_QWEIGHT and all the
+ * weights are halved every time the bins of at_hist move over, so that a
+ * value is forgotten after about at_history secs, like in at_hist. Weights
+ * are also halved if a bucket would overflow, so with many values per second
+ * the distribution is the one of the most recent values.
+ */
+#define AT_QBUCKETS	44
+#define AT_QWEIGHT	(1 << AT_BINS)
+/* a percentile is not used until this weight of values is measured */
+#define AT_QMIN_COUNT	(8 * AT_QWEIGHT)
+
+struct at_qhist {
+	unsigned int	atq_count;                  /* sum of atq_buckets */
+	__u16		atq_buckets[AT_QBUCKETS];
+};
 
 struct adaptive_timeout {
 	time_t		at_binstart;         /* bin start time */
@@ -67,6 +87,7 @@ struct adaptive_timeout {
 	unsigned int	at_current;          /* current timeout value */
 	unsigned int	at_worst_ever;       /* worst-ever timeout value */
 	time_t		at_worst_time;       /* worst-ever timeout timestamp */
+	struct at_qhist	*at_qhist;           /* distribution, if tracked */
 	spinlock_t	at_lock;
 };
 
@@ -79,10 +100,17 @@ struct ptlrpc_at_array {
 };
 
 #define IMP_AT_MAX_PORTALS 8
+#define IMP_AT_MAX_OPCODES 16
 struct imp_at {
         int                     iat_portal[IMP_AT_MAX_PORTALS];
         struct adaptive_timeout iat_net_latency;
         struct adaptive_timeout iat_service_estimate[IMP_AT_MAX_PORTALS];
+	/* service times measured for the first opcodes sent */
+	int			iat_opc[IMP_AT_MAX_OPCODES];
+	struct adaptive_timeout	iat_opc_estimate[IMP_AT_MAX_OPCODES];
+	struct at_qhist		iat_net_latency_qhist;
+	struct at_qhist		iat_service_qhist[IMP_AT_MAX_PORTALS];
+	struct at_qhist		iat_opc_qhist[IMP_AT_MAX_OPCODES];
 };
 
 
@@ -190,6 +218,10 @@ struct obd_import {
 	cfs_list_t		  imp_committed_list;
 	cfs_list_t		 *imp_replay_cursor;
 	/** @} */
+	/** number of requests on imp_replay_list and imp_committed_list,
+	 * protected by imp_lock */
+	unsigned int		  imp_replay_count;
+	unsigned int		  imp_committed_count;
 
         /** obd device for this import */
         struct obd_device        *imp_obd;
@@ -299,6 +331,7 @@ struct obd_import {
         __u32                     imp_connect_op;
         struct obd_connect_data   imp_connect_data;
         __u64                     imp_connect_flags_orig;
+	__u64			  imp_connect_flags2_orig;
         int                       imp_connect_error;
 
         __u32                     imp_msg_magic;
@@ -357,12 +390,65 @@ static inline void at_init(struct adaptive_timeout *at, int val, int flags) {
 	at->at_flags = flags;
 	at_reset(at, val);
 }
+/* keep the distribution of the values measured by \a at in \a qhist */
+static inline void at_init_qhist(struct adaptive_timeout *at, int val,
+				 int flags, struct at_qhist *qhist)
+{
+	at_init(at, val, flags);
+	memset(qhist, 0, sizeof(*qhist));
+	at->at_qhist = qhist;
+}
 extern unsigned int at_min;
 static inline int at_get(struct adaptive_timeout *at) {
         return (at->at_current > at_min) ? at->at_current : at_min;
 }
+
+/* largest value counted in bucket \a i of a struct at_qhist */
+static inline unsigned int at_qhist_bucket_max(int i)
+{
+	int bits;
+
+	if (i < 4)
+		return i;
+	bits = (i - 4) / 4;
+	return ((4 + (i - 4) % 4) << bits) + (1 << bits) - 1;
+}
+
+/**
+ * Value below which \a pct percent of the values of \a qhist are, rounded
+ * up to the bucket boundary. Returns 0 if no value was measured.
+ * Must be called under at_lock of the adaptive timeout of \a qhist.
+ */
+static inline unsigned int at_qhist_percentile(struct at_qhist *qhist,
+					       unsigned int pct)
+{
+	unsigned int target = (qhist->atq_count * pct + 99) / 100;
+	unsigned int sum = 0;
+	int i;
+
+	if (qhist->atq_count == 0)
+		return 0;
+
+	for (i = 0; i < AT_QBUCKETS; i++) {
+		sum += qhist->atq_buckets[i];
+		if (sum > 0 && sum >= target)
+			break;
+	}
+	return at_qhist_bucket_max(min(i, AT_QBUCKETS - 1));
+}
+
+/* enough values were measured recently to trust the percentile of \a at */
+static inline int at_qhist_ready(struct adaptive_timeout *at)
+{
+	return at->at_qhist != NULL &&
+	       at->at_qhist->atq_count >= AT_QMIN_COUNT;
+}
+
 int at_measured(struct adaptive_timeout *at, unsigned int val);
+void at_bump(struct adaptive_timeout *at, unsigned int val);
 int import_at_get_index(struct obd_import *imp, int portal);
+int import_at_get_opc_index(struct obd_import *imp, int opc);
+extern unsigned int at_percentile;
 extern unsigned int at_max;
 #define AT_OFF (at_max == 0)
 
@@ -90,6 +90,12 @@ struct cat_handle_data {
         cfs_list_t              chd_head;
         struct llog_handle     *chd_current_log; /* currently open log */
 	struct llog_handle	*chd_next_log; /* llog to be used next */
+	/* append statistics, protected by the catalog lgh_hdr_lock */
+	__u64			 chd_rec_count;	/* records appended */
+	__u64			 chd_rec_bytes;	/* bytes appended */
+	__u64			 chd_append_usec; /* total append time */
+	__u64			 chd_append_max;  /* slowest append */
+	__u64			 chd_log_switch;  /* append hit a full llog */
 };
 
 static inline void logid_to_fid(struct llog_logid *id, struct lu_fid *fid)
@@ -202,6 +208,7 @@ int llog_cat_reverse_process(const struct lu_env *env,
 			     void *data);
 int llog_cat_init_and_process(const struct lu_env *env,
 			      struct llog_handle *llh);
+int llog_cat_rd_stats(struct llog_handle *cathandle, char *page, int count);
 
 /* llog_obd.c */
 int llog_setup(const struct lu_env *env, struct obd_device *obd,
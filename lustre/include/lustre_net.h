@@ -111,7 +111,9 @@
 #define PTLRPC_MAX_BRW_PAGES	(PTLRPC_MAX_BRW_SIZE >> CFS_PAGE_SHIFT)
 
 #define ONE_MB_BRW_SIZE		(1 << LNET_MTU_BITS)
-#define MD_MAX_BRW_SIZE		(1 << LNET_MTU_BITS)
+/* Readdir is sent as multiple LNET_MTU bulks like BRW, so that a large
+ * directory can be listed with a few multi-megabyte MDS_READPAGE RPCs. */
+#define MD_MAX_BRW_SIZE		PTLRPC_MAX_BRW_SIZE
 #define MD_MAX_BRW_PAGES	(MD_MAX_BRW_SIZE >> CFS_PAGE_SHIFT)
 #define DT_MAX_BRW_SIZE		PTLRPC_MAX_BRW_SIZE
 #define DT_MAX_BRW_PAGES	(DT_MAX_BRW_SIZE >> CFS_PAGE_SHIFT)
@@ -375,6 +377,13 @@
 				       MDS_LOV_MAXREQSIZE) + 1023) >> 10) << 10)
 #define MDS_REG_MAXREPSIZE	MDS_REG_MAXREQSIZE
 
+/**
+ * Space for the records and names of one REINT_BATCH request, which is sent
+ * to the regular MDS_REQUEST_PORTAL; the rest of MDS_REG_MAXREQSIZE is left
+ * for lustre_msg, ptlrpc_body, the header record and early lock cancels.
+ */
+#define MDS_BATCH_MAXREQSIZE	(MDS_REG_MAXREQSIZE - 4096)
+
 /**
  * The update request includes all of updates from the create, which might
  * include linkea (4K maxim), together with other updates, we set it to 9K:
@@ -642,6 +651,15 @@ struct ptlrpc_cb_id {
 #define RS_MAX_LOCKS 8
 #define RS_DEBUG     0
 
+/**
+ * Reply states of the null security flavor are recycled by the service
+ * partition which allocated them, in size classes of 512 bytes to 16KB.
+ * Up to PTLRPC_RS_POOL_BYTES of reply states are cached per class.
+ */
+#define PTLRPC_RS_POOL_CLASSES		6
+#define PTLRPC_RS_POOL_MIN_SHIFT	9
+#define PTLRPC_RS_POOL_BYTES		(64 << 10)
+
 /**
  * Structure to define reply state on the server
  * Reply state holds various reply message information. Also for "difficult"
@@ -675,6 +693,7 @@ struct ptlrpc_reply_state {
         unsigned long          rs_committed:1;/* the transaction was committed
                                                  and the rs was dispatched
                                                  by ptlrpc_commit_replies */
+	unsigned long	       rs_pooled:1;   /* rs from the svcpt rs pool */
         /** Size of the state */
         int                    rs_size;
         /** opcode */
@@ -1850,7 +1869,12 @@ struct ptlrpc_request {
 		 * status */
 		rq_allow_replay:1,
 		/* bulk request, sent to server, but uncommitted */
-		rq_unstable:1;
+		rq_unstable:1,
+		/* server-side, being replayed by target recovery */
+		rq_recovery_replay:1,
+		/* client-side, on imp_committed_list rather than
+		 * imp_replay_list, changed under imp_lock */
+		rq_replay_committed:1;
 
 	unsigned int rq_nr_resend;
 
@@ -1963,6 +1987,8 @@ struct ptlrpc_request {
         /* server-side... */
         /** request arrival time */
         struct timeval       rq_arrival_time;
+	/** usecs spent in target_bulk_io() for this request */
+	long			rq_bulk_usec;
         /** separated reply state */
         struct ptlrpc_reply_state *rq_reply_state;
         /** incoming request buffer */
@@ -2431,6 +2457,14 @@ struct ptlrpc_request_buffer_desc {
         int                    rqbd_refcount;
         /** The buffer itself */
         char                  *rqbd_buffer;
+	/** Size of the buffer */
+	int		       rqbd_size;
+	/**
+	 * The buffer only holds a request copied out of a request buffer it
+	 * pinned, see ptlrpc_server_copy_straggler(); it is freed instead of
+	 * being reposted once the request is released.
+	 */
+	unsigned int	       rqbd_copy:1;
         struct ptlrpc_cb_id    rqbd_cbid;
         /**
          * This "embedded" request structure is only used for the
@@ -2506,6 +2540,8 @@ struct ptlrpc_service {
         cfs_proc_dir_entry_t           *srv_procroot;
         /** Pointer to statistic data for this service */
         struct lprocfs_stats           *srv_stats;
+	/** queue wait and per-opcode handling time histograms */
+	struct lprocfs_lat_stats	*srv_lat_stats;
         /** # hp per lp reqs to handle */
         int                             srv_hpreq_ratio;
         /** biggest request to receive */
@@ -2602,6 +2638,23 @@ struct ptlrpc_service_part {
 	cfs_list_t			scp_req_incoming;
 	/** timeout before re-posting reqs, in tick */
 	cfs_duration_t			scp_rqbd_timeout;
+	/** # request buffers to keep posted, adapted to the request rate */
+	int				scp_nrqbds_target;
+	/** size of new request buffers, adapted to the request sizes */
+	int				scp_rqbd_size;
+	/** moving average of the size of incoming requests */
+	int				scp_req_size_avg;
+	/** last time scp_nrqbds_target was changed, in seconds */
+	time_t				scp_rqbd_adjust_time;
+	/** # times a request arrived with no more request buffers posted */
+	__u64				scp_rqbd_starved;
+	/** scp_rqbd_starved when scp_nrqbds_target was last changed */
+	__u64				scp_rqbd_starved_seen;
+	/** bytes filled and offered by the request buffers unlinked so far */
+	__u64				scp_rqbd_used_bytes;
+	__u64				scp_rqbd_unlinked_bytes;
+	/** # requests copied out of the request buffers they pinned */
+	__u64				scp_rqbd_copied;
 	/**
 	 * all threads sleep on this. This wait-queue is signalled when new
 	 * incoming request arrives and when difficult reply has to be handled.
@@ -2647,6 +2700,8 @@ struct ptlrpc_service_part {
 	spinlock_t			scp_at_lock __cfs_cacheline_aligned;
 	/** estimated rpc service time */
 	struct adaptive_timeout		scp_at_estimate;
+	/** distribution of the service times, for lprocfs only */
+	struct at_qhist			scp_at_qhist;
 	/** reqs waiting for replies */
 	struct ptlrpc_at_array		scp_at_array;
 	/** early reply timer */
@@ -2674,6 +2729,17 @@ struct ptlrpc_service_part {
 	cfs_waitq_t			scp_rep_waitq;
 	/** # 'difficult' replies */
 	cfs_atomic_t			scp_nreps_difficult;
+
+	/**
+	 * reply states freed and cached for reuse, by size class, see
+	 * ptlrpc_rs_pool_get()
+	 */
+	spinlock_t			scp_rs_pool_lock;
+	cfs_list_t			scp_rs_pool[PTLRPC_RS_POOL_CLASSES];
+	int				scp_rs_pool_count[PTLRPC_RS_POOL_CLASSES];
+	/** reply states taken from / allocated for the pool */
+	__u64				scp_rs_pool_hits;
+	__u64				scp_rs_pool_misses;
 };
 
 #define ptlrpc_service_for_each_part(part, i, svc)			\
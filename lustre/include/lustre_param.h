@@ -91,6 +91,7 @@ int do_lcfg(char *cfgname, lnet_nid_t nid, int cmd,
 #define PARAM_AT_EXTRA             "at_extra="         /* global */
 #define PARAM_AT_EARLY_MARGIN      "at_early_margin="  /* global */
 #define PARAM_AT_HISTORY           "at_history="       /* global */
+#define PARAM_AT_PERCENTILE        "at_percentile="    /* global */
 #define PARAM_JOBID_VAR		   "jobid_var="	       /* global */
 #define PARAM_MGSNODE              "mgsnode="          /* only at mounttime */
 #define PARAM_FAILNODE             "failover.node="    /* add failover nid */
@@ -96,6 +96,10 @@ struct qmt_handlers {
 	int (*qmth_dqacq)(const struct lu_env *, struct lu_device *,
 			  struct ptlrpc_request *);
 
+	/* Handle batched dqacq/dqrel request from slave. */
+	int (*qmth_dqacq_batch)(const struct lu_env *, struct lu_device *,
+				struct ptlrpc_request *);
+
 	/* LDLM intent policy associated with quota locks */
 	int (*qmth_intent_policy)(const struct lu_env *, struct lu_device *,
 				  struct ptlrpc_request *, struct ldlm_lock **,
@@ -416,6 +416,7 @@ enum {
 #define OBD_MAX_DEFAULT_COOKIE_SIZE	LU_PAGE_SIZE
 
 struct mdc_rpc_lock;
+struct mdc_changelog_index;
 struct obd_import;
 struct client_obd {
 	struct rw_semaphore  cl_sem;
@@ -520,6 +521,8 @@ struct client_obd {
         struct obd_histogram     cl_write_page_hist;
         struct obd_histogram     cl_read_offset_hist;
         struct obd_histogram     cl_write_offset_hist;
+	/* operations per REINT_BATCH RPC */
+	struct obd_histogram	 cl_batch_ops_hist;
 
 	/* lru for osc caching pages */
 	struct cl_client_cache	*cl_cache;
@@ -538,6 +541,8 @@ struct client_obd {
 
         struct mdc_rpc_lock     *cl_rpc_lock;
         struct mdc_rpc_lock     *cl_close_lock;
+	/* where changelog readers can start, see mdc_changelog_startcat() */
+	struct mdc_changelog_index *cl_changelog_index;
 
         /* mgc datastruct */
 	struct semaphore	 cl_mgc_sem;
@@ -976,6 +981,31 @@ struct target_recovery_data {
 	pid_t			trd_processing_task;
 	struct completion	trd_starting;
 	struct completion	trd_finishing;
+
+	/* parallel request replay, protected by trd_replay_lock */
+	spinlock_t		trd_replay_lock;
+	cfs_waitq_t		trd_replay_waitq;
+	/* requests being replayed, either by the recovery thread or by a
+	 * replay worker */
+	cfs_list_t		trd_replay_inflight;
+	/* requests handed to replay workers and not picked up yet */
+	cfs_list_t		trd_replay_ready;
+	int			trd_replay_inflight_count;
+	/* dispatched requests whose transaction may not be committed yet, in
+	 * transno order, see target_replay_committed() */
+	cfs_list_t		trd_replay_uncommitted;
+	int			trd_replay_uncommitted_count;
+	/* highest transno committed along with all replays before it */
+	__u64			trd_replay_committed;
+	int			trd_replay_threads;	/* running workers */
+	unsigned int		trd_replay_stop:1;
+	/* statistics reported in recovery_status */
+	time_t			trd_replay_start;	/* seconds */
+	time_t			trd_replay_end;		/* seconds */
+	int			trd_replay_parallel;	/* replayed by workers */
+	int			trd_replay_waits;	/* dispatch delayed by a
+							 * dependency */
+	int			trd_replay_barriers;	/* replayed alone */
 };
 
 struct obd_llog_group {
@@ -1108,6 +1138,7 @@ struct obd_device {
         cfs_proc_dir_entry_t  *obd_proc_exports_entry;
         cfs_proc_dir_entry_t  *obd_svc_procroot;
         struct lprocfs_stats  *obd_svc_stats;
+	struct lprocfs_lat_stats *obd_svc_lat_stats;
         cfs_atomic_t           obd_evict_inprogress;
         cfs_waitq_t            obd_evict_inprogress_waitq;
         cfs_list_t             obd_evict_list; /* protected with pet_lock */
@@ -1268,6 +1299,13 @@ enum op_cli_flags {
 	CLI_RM_ENTRY	= 1 << 1,
 };
 
+/* one operation of md_batch() */
+struct md_batch_op {
+	__u32			 mbo_opc;	/* REINT_{SETATTR,CREATE,UNLINK} */
+	int			 mbo_rc;	/* result, set by md_batch() */
+	struct md_op_data	*mbo_data;
+};
+
 struct md_enqueue_info;
 /* metadata stat-ahead */
 typedef int (* md_enqueue_cb_t)(struct ptlrpc_request *req,
@@ -1596,6 +1634,8 @@ struct md_ops {
         int (*m_revalidate_lock)(struct obd_export *, struct lookup_intent *,
                                  struct lu_fid *, __u64 *bits);
 
+	int (*m_batch)(struct obd_export *, struct md_batch_op *, int);
+
         /*
          * NOTE: If adding ops, add another LPROCFS_MD_OP_INIT() line to
          * lprocfs_alloc_md_stats() in obdclass/lprocfs_status.c. Also, add a
@@ -113,7 +113,8 @@ char *obd_export_nid2str(struct obd_export *exp);
 
 int obd_export_evict_by_nid(struct obd_device *obd, const char *nid);
 int obd_export_evict_by_uuid(struct obd_device *obd, const char *uuid);
-int obd_connect_flags2str(char *page, int count, __u64 flags, char *sep);
+int obd_connect_flags2str(char *page, int count, __u64 flags, __u64 flags2,
+			  char *sep);
 
 int obd_zombie_impexp_init(void);
 void obd_zombie_impexp_stop(void);
@@ -2232,6 +2233,22 @@ static inline int md_revalidate_lock(struct obd_export *exp,
         RETURN(rc);
 }
 
+/**
+ * Send \a count setattr, create and unlink operations to the MDT in as few
+ * RPCs as possible; the result of each one is left in its mbo_rc.
+ * Returns -EOPNOTSUPP if the target cannot do batches at all.
+ */
+static inline int md_batch(struct obd_export *exp, struct md_batch_op *ops,
+			   int count)
+{
+	int rc;
+	ENTRY;
+	EXP_CHECK_MD_OP(exp, batch);
+	EXP_MD_COUNTER_INCREMENT(exp, batch);
+	rc = MDP(exp->exp_obd, batch)(exp, ops, count);
+	RETURN(rc);
+}
+
 
 /* OBD Metadata Support */
 
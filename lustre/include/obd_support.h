@@ -73,6 +73,7 @@ extern unsigned int at_max;
 extern unsigned int at_history;
 extern int at_early_margin;
 extern int at_extra;
+extern unsigned int at_percentile;
 extern unsigned int obd_sync_filter;
 extern unsigned int obd_max_dirty_pages;
 extern cfs_atomic_t obd_unstable_pages;
@@ -111,7 +112,7 @@ int obd_alloc_fail(const void *ptr, const char *name, const char *type,
 #define HASH_CL_ENV_BITS        10
 #define HASH_JOB_STATS_BKT_BITS 5
 #define HASH_JOB_STATS_CUR_BITS 7
-#define HASH_JOB_STATS_MAX_BITS 12
+#define HASH_JOB_STATS_MAX_BITS 16
 
 /* Timeout definitions */
 #define OBD_TIMEOUT_DEFAULT             100
@@ -430,6 +431,7 @@ int obd_alloc_fail(const void *ptr, const char *name, const char *type,
 #define OBD_FAIL_QUOTA_EDQUOT            0xA02
 #define OBD_FAIL_QUOTA_DELAY_REINT       0xA03
 #define OBD_FAIL_QUOTA_RECOVERABLE_ERR   0xA04
+#define OBD_FAIL_QUOTA_DQACQ_BATCH_NET   0xA05
 
 #define OBD_FAIL_LPROC_REMOVE            0xB00
 
@@ -95,8 +95,14 @@ struct ldlm_cb_set_arg {
 	cfs_atomic_t			 restart;
 	cfs_list_t			*list;
 	union ldlm_gl_desc		*gl_desc; /* glimpse AST descriptor */
+	struct ldlm_lock		**batch; /* LDLM_BL_BATCH_MAX locks */
 };
 
+/* Upper limit of lock handles in one blocking AST RPC, which keeps the
+ * request well below LDLM_MAXREQSIZE. */
+#define LDLM_BL_BATCH_MAX	256
+extern unsigned int ldlm_bl_batch_max;
+
 typedef enum {
 	LDLM_WORK_BL_AST,
 	LDLM_WORK_CP_AST,
@@ -146,6 +152,11 @@ int ldlm_bl_to_thread_list(struct ldlm_namespace *ns,
 
 void ldlm_handle_bl_callback(struct ldlm_namespace *ns,
                              struct ldlm_lock_desc *ld, struct ldlm_lock *lock);
+#ifdef HAVE_SERVER_SUPPORT
+int ldlm_server_blocking_ast_batch(struct ldlm_lock **locks, int count,
+				   struct ldlm_lock_desc *desc,
+				   struct ldlm_cb_set_arg *arg);
+#endif
 
 #ifdef HAVE_SERVER_SUPPORT
 /* ldlm_plain.c */
@@ -182,12 +193,32 @@ void l_check_no_ns_lock(struct ldlm_namespace *ns);
 extern cfs_proc_dir_entry_t *ldlm_svc_proc_dir;
 extern cfs_proc_dir_entry_t *ldlm_type_proc_dir;
 
+#if defined(HAVE_SERVER_SUPPORT) && defined(__KERNEL__) && defined(LPROCFS)
+/* ldlm_lockd.c */
+int ldlm_rd_waiting_locks(char *page, char **start, off_t off, int count,
+			  int *eof, void *data);
+#endif
+#if defined(__KERNEL__) && defined(LPROCFS)
+/* ldlm_lockd.c */
+int ldlm_rd_bl_pools(char *page, char **start, off_t off, int count,
+		     int *eof, void *data);
+#endif
+#ifdef LPROCFS
+/* ldlm_lockd.c */
+int ldlm_rd_bl_batch_stats(char *page, char **start, off_t off, int count,
+			   int *eof, void *data);
+int ldlm_wr_bl_batch_stats(struct file *file, const char *buffer,
+			   unsigned long count, void *data);
+#endif
+
 struct ldlm_state {
         struct ptlrpc_service *ldlm_cb_service;
         struct ptlrpc_service *ldlm_cancel_service;
         struct ptlrpc_client *ldlm_client;
         struct ptlrpc_connection *ldlm_server_conn;
-        struct ldlm_bl_pool *ldlm_bl_pool;
+	/* blocking callback thread pools, one per CPU partition */
+	struct ldlm_bl_pool **ldlm_bl_pools;
+	int ldlm_bl_pools_nr;
 };
 
 /* interval tree, for LDLM_EXTENT. */
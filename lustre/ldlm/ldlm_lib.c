@@ -362,6 +362,7 @@ int client_obd_setup(struct obd_device *obddev, struct lustre_cfg *lcfg)
 	spin_lock_init(&cli->cl_write_page_hist.oh_lock);
 	spin_lock_init(&cli->cl_read_offset_hist.oh_lock);
 	spin_lock_init(&cli->cl_write_offset_hist.oh_lock);
+	spin_lock_init(&cli->cl_batch_ops_hist.oh_lock);
 
 	/* lru for osc. */
 	CFS_INIT_LIST_HEAD(&cli->cl_lru_osc);
@@ -521,6 +522,7 @@ int client_connect_import(const struct lu_env *env,
         if (data) {
                 *ocd = *data;
                 imp->imp_connect_flags_orig = data->ocd_connect_flags;
+		imp->imp_connect_flags2_orig = data->ocd_connect_flags2;
         }
 
         rc = ptlrpc_connect_import(imp);
@@ -535,6 +537,7 @@ int client_connect_import(const struct lu_env *env,
                          ocd->ocd_connect_flags, "old "LPX64", new "LPX64"\n",
                          data->ocd_connect_flags, ocd->ocd_connect_flags);
                 data->ocd_connect_flags = ocd->ocd_connect_flags;
+		data->ocd_connect_flags2 = ocd->ocd_connect_flags2;
         }
 
         ptlrpc_pinger_add_import(imp);
@@ -1465,12 +1468,18 @@ static void abort_lock_replay_queue(struct obd_device *obd)
    Because the obd_stopping flag is set, no new requests should be received.
 
 */
+static void target_replay_cleanup(struct obd_device *obd);
+
 void target_cleanup_recovery(struct obd_device *obd)
 {
         struct ptlrpc_request *req, *n;
         cfs_list_t clean_list;
         ENTRY;
 
+	/* recovery may be over already, but replays whose commit was never
+	 * seen can still be pending */
+	target_replay_cleanup(obd);
+
         CFS_INIT_LIST_HEAD(&clean_list);
 	spin_lock(&obd->obd_dev_lock);
 	if (!obd->obd_recovering) {
@@ -1912,7 +1921,9 @@ static int handle_recovery_req(struct ptlrpc_thread *thread,
 
         /* thread context */
         lu_context_enter(&thread->t_env->le_ctx);
+	req->rq_recovery_replay = 1;
         (void)handler(req);
+	req->rq_recovery_replay = 0;
         lu_context_exit(&thread->t_env->le_ctx);
 
         lu_context_exit(&req->rq_recov_session);
@@ -1949,6 +1960,548 @@ reqcopy_put:
         RETURN(rc);
 }
 
+/**
+ * Allocate the ptlrpc_thread and lu_env used to run the recovery handler
+ * outside of a ptlrpc service thread.
+ */
+static int target_recovery_thread_init(struct ptlrpc_thread **threadp)
+{
+	struct ptlrpc_thread	*thread;
+	struct lu_env		*env;
+	unsigned long		 flags;
+	int			 rc;
+
+	SIGNAL_MASK_LOCK(current, flags);
+	sigfillset(&current->blocked);
+	RECALC_SIGPENDING;
+	SIGNAL_MASK_UNLOCK(current, flags);
+
+	OBD_ALLOC_PTR(thread);
+	if (thread == NULL)
+		return -ENOMEM;
+
+	OBD_ALLOC_PTR(env);
+	if (env == NULL) {
+		OBD_FREE_PTR(thread);
+		return -ENOMEM;
+	}
+
+	rc = lu_context_init(&env->le_ctx, LCT_MD_THREAD | LCT_DT_THREAD);
+	if (rc) {
+		OBD_FREE_PTR(thread);
+		OBD_FREE_PTR(env);
+		return rc;
+	}
+
+	thread->t_env = env;
+	thread->t_id = -1; /* force filter_iobuf_get/put to use local buffers */
+	env->le_ctx.lc_thread = thread;
+	thread->t_data = NULL;
+	thread->t_watchdog = NULL;
+
+	*threadp = thread;
+	return 0;
+}
+
+static void target_recovery_thread_fini(struct ptlrpc_thread *thread)
+{
+	struct lu_env *env = thread->t_env;
+
+	lu_context_fini(&env->le_ctx);
+	OBD_FREE_PTR(thread);
+	OBD_FREE_PTR(env);
+}
+
+static int tgt_recovery_threads = 4;
+CFS_MODULE_PARM(tgt_recovery_threads, "i", int, 0644,
+		"number of threads replaying independent requests during "
+		"target recovery");
+
+/*
+ * Parallel request replay.
+ *
+ * Requests are still pulled from obd_req_replay_queue in transno order by
+ * the recovery thread, which hands them over to a pool of replay workers as
+ * long as they don't depend on a request still being replayed. Two requests
+ * depend on each other if they come from the same client or modify a common
+ * object. Requests whose objects can't be found out from the request itself
+ * are replayed alone by the recovery thread, once everything dispatched
+ * before them is done.
+ */
+struct target_replay_item {
+	cfs_list_t		 tri_inflight;	/* trd_replay_inflight */
+	cfs_list_t		 tri_ready;	/* trd_replay_ready */
+	cfs_list_t		 tri_commit;	/* trd_replay_uncommitted */
+	struct ptlrpc_request	*tri_req;
+	__u64			 tri_transno;
+	int			 tri_nfids;
+	struct lu_fid		 tri_fids[2];
+	unsigned int		 tri_barrier:1,
+				 tri_done:1,	/* replayed, tri_req is gone */
+				 tri_committed:1;
+};
+
+/**
+ * Find out which objects are modified by a replayed request. Only metadata
+ * reint records are understood: their first FID is the object (or parent
+ * directory) and the second one, if any, the child or target directory.
+ * Rename is left out since it may remove an object only known by name, and
+ * so is any request missing one of its FIDs, e.g. an unlink whose client
+ * had no FID cached for the child.
+ */
+static void target_replay_deps(struct target_replay_item *tri)
+{
+	struct ptlrpc_request	*req = tri->tri_req;
+	struct mdt_rec_reint	*rec;
+	__u32			 opcode;
+	int			 i;
+
+	tri->tri_barrier = 1;
+	tri->tri_nfids = 0;
+
+	if (lustre_msg_get_opc(req->rq_reqmsg) != MDS_REINT)
+		return;
+
+	/* the reint record hasn't been swabbed yet */
+	rec = lustre_msg_buf(req->rq_reqmsg, REQ_REC_OFF, sizeof(*rec));
+	if (rec == NULL)
+		return;
+
+	opcode = rec->rr_opcode;
+	if (ptlrpc_req_need_swab(req))
+		__swab32s(&opcode);
+
+	switch (opcode) {
+	case REINT_SETATTR:
+	case REINT_SETXATTR:
+		tri->tri_nfids = 1;
+		break;
+	case REINT_CREATE:
+	case REINT_LINK:
+	case REINT_UNLINK:
+		tri->tri_nfids = 2;
+		break;
+	default:
+		return;
+	}
+
+	tri->tri_fids[0] = rec->rr_fid1;
+	tri->tri_fids[1] = rec->rr_fid2;
+	for (i = 0; i < tri->tri_nfids; i++) {
+		if (ptlrpc_req_need_swab(req))
+			lustre_swab_lu_fid(&tri->tri_fids[i]);
+		if (fid_is_zero(&tri->tri_fids[i]))
+			return;
+	}
+	tri->tri_barrier = 0;
+}
+
+/* true if \a tri must wait for \a busy to be replayed first */
+static bool target_replay_depends(struct target_replay_item *tri,
+				  struct target_replay_item *busy)
+{
+	int i, j;
+
+	if (tri->tri_barrier || busy->tri_barrier)
+		return true;
+
+	if (tri->tri_req->rq_export == busy->tri_req->rq_export)
+		return true;
+
+	for (i = 0; i < tri->tri_nfids; i++)
+		for (j = 0; j < busy->tri_nfids; j++)
+			if (lu_fid_eq(&tri->tri_fids[i], &busy->tri_fids[j]))
+				return true;
+	return false;
+}
+
+/* check whether \a tri can be replayed now, called with trd_replay_lock */
+static bool target_replay_can_dispatch(struct target_recovery_data *trd,
+				       struct target_replay_item *tri)
+{
+	struct target_replay_item *busy;
+
+	if (tri->tri_barrier)
+		return trd->trd_replay_inflight_count == 0;
+
+	if (trd->trd_replay_inflight_count >= trd->trd_replay_threads)
+		return false;
+
+	cfs_list_for_each_entry(busy, &trd->trd_replay_inflight, tri_inflight)
+		if (target_replay_depends(tri, busy))
+			return false;
+	return true;
+}
+
+static bool target_replay_idle(struct target_recovery_data *trd)
+{
+	bool idle;
+
+	spin_lock(&trd->trd_replay_lock);
+	idle = trd->trd_replay_inflight_count == 0;
+	spin_unlock(&trd->trd_replay_lock);
+	return idle;
+}
+
+/**
+ * Replay one request of the first recovery stage and release it.
+ *
+ * \retval true if the reply carries a transno, i.e. the replay may have a
+ *	   transaction still to be committed
+ */
+static bool target_replay_one(struct ptlrpc_thread *thread,
+			      struct obd_device *obd,
+			      struct ptlrpc_request *req)
+{
+	struct target_recovery_data *trd = &obd->obd_recovery_data;
+	bool			     transno;
+
+	DEBUG_REQ(D_HA, req, "processing t"LPD64" from %s",
+		  lustre_msg_get_transno(req->rq_reqmsg),
+		  libcfs_nid2str(req->rq_peer.nid));
+	handle_recovery_req(thread, req, trd->trd_recovery_handler);
+	transno = req->rq_repmsg != NULL &&
+		  lustre_msg_get_transno(req->rq_repmsg) != 0;
+	target_exp_dequeue_req_replay(req);
+	target_request_copy_put(req);
+
+	spin_lock(&obd->obd_recovery_task_lock);
+	obd->obd_replayed_requests++;
+	spin_unlock(&obd->obd_recovery_task_lock);
+
+	return transno;
+}
+
+/*
+ * Replays handed to different workers are committed in the order their
+ * transactions happen to land in the journal, not in transno order, so
+ * last_committed could otherwise move past a replay which is not committed
+ * yet. Clients would drop that request and a second failure would lose it.
+ * Every dispatched replay is kept on trd_replay_uncommitted until its commit
+ * callback runs, and last_committed never goes past the first one there.
+ */
+
+/* free \a tri once it is replayed and committed, called with
+ * trd_replay_lock */
+static void target_replay_item_put(struct target_replay_item *tri)
+{
+	if (tri->tri_done && cfs_list_empty(&tri->tri_commit))
+		OBD_FREE_PTR(tri);
+}
+
+/* drop the committed replays from the head of the uncommitted list, called
+ * with trd_replay_lock */
+static void target_replay_commit_advance(struct target_recovery_data *trd)
+{
+	struct target_replay_item *tri;
+
+	while (!cfs_list_empty(&trd->trd_replay_uncommitted)) {
+		tri = cfs_list_entry(trd->trd_replay_uncommitted.next,
+				     struct target_replay_item, tri_commit);
+		if (!tri->tri_committed)
+			break;
+
+		if (tri->tri_transno > trd->trd_replay_committed)
+			trd->trd_replay_committed = tri->tri_transno;
+		cfs_list_del_init(&tri->tri_commit);
+		trd->trd_replay_uncommitted_count--;
+		target_replay_item_put(tri);
+	}
+}
+
+/**
+ * Called from the commit callback of the transaction with \a transno.
+ *
+ * \retval the highest transno known to be committed together with every
+ *	   replayed transno below it, to be used as last_committed
+ */
+__u64 target_replay_committed(struct obd_device *obd, __u64 transno)
+{
+	struct target_recovery_data *trd = &obd->obd_recovery_data;
+	struct target_replay_item   *tri;
+
+	/* only parallel replay ever adds to the list, nothing can be added
+	 * behind a transno being committed */
+	if (trd->trd_replay_uncommitted_count == 0)
+		return transno;
+
+	spin_lock(&trd->trd_replay_lock);
+	cfs_list_for_each_entry(tri, &trd->trd_replay_uncommitted,
+				tri_commit) {
+		if (tri->tri_transno == transno) {
+			tri->tri_committed = 1;
+			break;
+		}
+	}
+	target_replay_commit_advance(trd);
+
+	if (trd->trd_replay_committed > transno)
+		transno = trd->trd_replay_committed;
+	if (!cfs_list_empty(&trd->trd_replay_uncommitted)) {
+		tri = cfs_list_entry(trd->trd_replay_uncommitted.next,
+				     struct target_replay_item, tri_commit);
+		if (transno >= tri->tri_transno)
+			transno = tri->tri_transno - 1;
+	}
+	spin_unlock(&trd->trd_replay_lock);
+
+	return transno;
+}
+EXPORT_SYMBOL(target_replay_committed);
+
+/**
+ * Flush the replayed transactions to disk once all replays are done and
+ * forget those whose commit callback was not seen, e.g. because the
+ * replay found its transaction committed already.
+ */
+static void target_replay_commit_flush(struct ptlrpc_thread *thread,
+				       struct lu_target *lut)
+{
+	struct target_recovery_data *trd = &lut->lut_obd->obd_recovery_data;
+	struct target_replay_item   *tri;
+	int			     rc;
+
+	if (trd->trd_replay_uncommitted_count == 0)
+		return;
+
+	lu_context_enter(&thread->t_env->le_ctx);
+	rc = dt_sync(thread->t_env, lut->lut_bottom);
+	lu_context_exit(&thread->t_env->le_ctx);
+	if (rc != 0) {
+		/* keep last_committed back until the commit callbacks run */
+		CWARN("%s: cannot sync replayed transactions: rc = %d\n",
+		      lut->lut_obd->obd_name, rc);
+		return;
+	}
+
+	spin_lock(&trd->trd_replay_lock);
+	cfs_list_for_each_entry(tri, &trd->trd_replay_uncommitted, tri_commit)
+		tri->tri_committed = 1;
+	target_replay_commit_advance(trd);
+	spin_unlock(&trd->trd_replay_lock);
+}
+
+/* forget the replays still waiting for their commit, replays in progress
+ * are freed by target_replay_done() */
+static void target_replay_cleanup(struct obd_device *obd)
+{
+	struct target_recovery_data *trd = &obd->obd_recovery_data;
+	struct target_replay_item   *tri, *n;
+
+	/* the list is only set up once recovery has started */
+	if (trd->trd_replay_uncommitted_count == 0)
+		return;
+
+	spin_lock(&trd->trd_replay_lock);
+	cfs_list_for_each_entry_safe(tri, n, &trd->trd_replay_uncommitted,
+				     tri_commit) {
+		cfs_list_del_init(&tri->tri_commit);
+		target_replay_item_put(tri);
+	}
+	trd->trd_replay_uncommitted_count = 0;
+	spin_unlock(&trd->trd_replay_lock);
+}
+
+static void target_replay_done(struct target_recovery_data *trd,
+			       struct target_replay_item *tri, bool transno)
+{
+	spin_lock(&trd->trd_replay_lock);
+	cfs_list_del_init(&tri->tri_inflight);
+	trd->trd_replay_inflight_count--;
+	tri->tri_done = 1;
+	if (!transno) {
+		/* nothing to commit, this may free \a tri */
+		tri->tri_committed = 1;
+		target_replay_commit_advance(trd);
+	} else {
+		target_replay_item_put(tri);
+	}
+	spin_unlock(&trd->trd_replay_lock);
+	cfs_waitq_broadcast(&trd->trd_replay_waitq);
+}
+
+static bool target_replay_worker_wakeup(struct target_recovery_data *trd)
+{
+	bool wakeup;
+
+	spin_lock(&trd->trd_replay_lock);
+	wakeup = !cfs_list_empty(&trd->trd_replay_ready) ||
+		 trd->trd_replay_stop;
+	spin_unlock(&trd->trd_replay_lock);
+	return wakeup;
+}
+
+static int target_replay_worker(void *arg)
+{
+	struct obd_device		*obd = arg;
+	struct target_recovery_data	*trd = &obd->obd_recovery_data;
+	struct target_replay_item	*tri;
+	struct ptlrpc_thread		*thread;
+	int				 rc;
+	ENTRY;
+
+	cfs_daemonize_ctxt("tgt_replay");
+
+	rc = target_recovery_thread_init(&thread);
+
+	spin_lock(&trd->trd_replay_lock);
+	if (rc == 0)
+		trd->trd_replay_threads++;
+	spin_unlock(&trd->trd_replay_lock);
+	complete(&trd->trd_starting);
+	if (rc)
+		RETURN(rc);
+
+	while (1) {
+		cfs_wait_event(trd->trd_replay_waitq,
+			       target_replay_worker_wakeup(trd));
+
+		spin_lock(&trd->trd_replay_lock);
+		if (cfs_list_empty(&trd->trd_replay_ready)) {
+			spin_unlock(&trd->trd_replay_lock);
+			/* stop only once all handed over requests are done */
+			break;
+		}
+		tri = cfs_list_entry(trd->trd_replay_ready.next,
+				     struct target_replay_item, tri_ready);
+		cfs_list_del_init(&tri->tri_ready);
+		spin_unlock(&trd->trd_replay_lock);
+
+		target_replay_done(trd, tri,
+				   target_replay_one(thread, obd,
+						     tri->tri_req));
+	}
+
+	target_recovery_thread_fini(thread);
+
+	spin_lock(&trd->trd_replay_lock);
+	trd->trd_replay_threads--;
+	spin_unlock(&trd->trd_replay_lock);
+	cfs_waitq_broadcast(&trd->trd_replay_waitq);
+	RETURN(0);
+}
+
+/**
+ * Start up to tgt_recovery_threads replay workers, returns how many are
+ * running. The recovery thread replays everything itself if none could be
+ * started.
+ */
+static int target_replay_workers_start(struct obd_device *obd)
+{
+	struct target_recovery_data *trd = &obd->obd_recovery_data;
+	int i;
+
+	for (i = 0; i < tgt_recovery_threads && tgt_recovery_threads > 1;
+	     i++) {
+		init_completion(&trd->trd_starting);
+		if (cfs_create_thread(target_replay_worker, obd, 0) <= 0)
+			break;
+		wait_for_completion(&trd->trd_starting);
+	}
+
+	CDEBUG(D_HA, "%s: %d replay threads started\n", obd->obd_name,
+	       trd->trd_replay_threads);
+	return trd->trd_replay_threads;
+}
+
+static bool target_replay_workers_stopped(struct target_recovery_data *trd)
+{
+	bool stopped;
+
+	spin_lock(&trd->trd_replay_lock);
+	stopped = trd->trd_replay_threads == 0;
+	spin_unlock(&trd->trd_replay_lock);
+	return stopped;
+}
+
+static void target_replay_workers_stop(struct obd_device *obd)
+{
+	struct target_recovery_data *trd = &obd->obd_recovery_data;
+
+	spin_lock(&trd->trd_replay_lock);
+	trd->trd_replay_stop = 1;
+	spin_unlock(&trd->trd_replay_lock);
+	cfs_waitq_broadcast(&trd->trd_replay_waitq);
+	cfs_wait_event(trd->trd_replay_waitq,
+		       target_replay_workers_stopped(trd));
+}
+
+static bool target_replay_wait_dispatch(struct target_recovery_data *trd,
+					struct target_replay_item *tri)
+{
+	bool ready;
+
+	spin_lock(&trd->trd_replay_lock);
+	ready = target_replay_can_dispatch(trd, tri);
+	spin_unlock(&trd->trd_replay_lock);
+	return ready;
+}
+
+/**
+ * Hand the next replayed request over to the replay workers, or replay it
+ * in the recovery thread if it has to be replayed alone. Returns once the
+ * request has been dispatched.
+ */
+static void target_replay_dispatch(struct ptlrpc_thread *thread,
+				   struct obd_device *obd,
+				   struct ptlrpc_request *req)
+{
+	struct target_recovery_data	*trd = &obd->obd_recovery_data;
+	struct target_replay_item	*tri;
+
+	OBD_ALLOC_PTR(tri);
+	if (tri == NULL) {
+		/* replay it alone */
+		cfs_wait_event(trd->trd_replay_waitq, target_replay_idle(trd));
+		target_replay_one(thread, obd, req);
+		spin_lock(&obd->obd_recovery_task_lock);
+		obd->obd_next_recovery_transno++;
+		spin_unlock(&obd->obd_recovery_task_lock);
+		return;
+	}
+	CFS_INIT_LIST_HEAD(&tri->tri_inflight);
+	CFS_INIT_LIST_HEAD(&tri->tri_ready);
+	CFS_INIT_LIST_HEAD(&tri->tri_commit);
+	tri->tri_req = req;
+	tri->tri_transno = lustre_msg_get_transno(req->rq_reqmsg);
+	target_replay_deps(tri);
+
+	spin_lock(&trd->trd_replay_lock);
+	if (!target_replay_can_dispatch(trd, tri)) {
+		trd->trd_replay_waits++;
+		spin_unlock(&trd->trd_replay_lock);
+		cfs_wait_event(trd->trd_replay_waitq,
+			       target_replay_wait_dispatch(trd, tri));
+		spin_lock(&trd->trd_replay_lock);
+	}
+	cfs_list_add_tail(&tri->tri_inflight, &trd->trd_replay_inflight);
+	trd->trd_replay_inflight_count++;
+	/* transnos are dispatched in increasing order */
+	cfs_list_add_tail(&tri->tri_commit, &trd->trd_replay_uncommitted);
+	trd->trd_replay_uncommitted_count++;
+	if (!tri->tri_barrier) {
+		cfs_list_add_tail(&tri->tri_ready, &trd->trd_replay_ready);
+		trd->trd_replay_parallel++;
+	} else {
+		trd->trd_replay_barriers++;
+	}
+	spin_unlock(&trd->trd_replay_lock);
+
+	/* the next transno can be waited for as soon as this one is
+	 * dispatched, see bz18031 for why this must happen before the request
+	 * is released */
+	spin_lock(&obd->obd_recovery_task_lock);
+	obd->obd_next_recovery_transno++;
+	spin_unlock(&obd->obd_recovery_task_lock);
+
+	if (!tri->tri_barrier) {
+		cfs_waitq_broadcast(&trd->trd_replay_waitq);
+		return;
+	}
+
+	target_replay_done(trd, tri, target_replay_one(thread, obd, req));
+}
+
 static int target_recovery_thread(void *arg)
 {
         struct lu_target *lut = arg;
@@ -1956,41 +2509,16 @@ static int target_recovery_thread(void *arg)
         struct ptlrpc_request *req;
         struct target_recovery_data *trd = &obd->obd_recovery_data;
         unsigned long delta;
-        unsigned long flags;
-        struct lu_env *env;
         struct ptlrpc_thread *thread = NULL;
+        int workers;
         int rc = 0;
         ENTRY;
 
         cfs_daemonize_ctxt("tgt_recov");
 
-        SIGNAL_MASK_LOCK(current, flags);
-        sigfillset(&current->blocked);
-        RECALC_SIGPENDING;
-        SIGNAL_MASK_UNLOCK(current, flags);
-
-        OBD_ALLOC_PTR(thread);
-        if (thread == NULL)
-                RETURN(-ENOMEM);
-
-        OBD_ALLOC_PTR(env);
-        if (env == NULL) {
-                OBD_FREE_PTR(thread);
-                RETURN(-ENOMEM);
-        }
-
-        rc = lu_context_init(&env->le_ctx, LCT_MD_THREAD | LCT_DT_THREAD);
-        if (rc) {
-                OBD_FREE_PTR(thread);
-                OBD_FREE_PTR(env);
-                RETURN(rc);
-        }
-
-        thread->t_env = env;
-        thread->t_id = -1; /* force filter_iobuf_get/put to use local buffers */
-        env->le_ctx.lc_thread = thread;
-        thread->t_data = NULL;
-        thread->t_watchdog = NULL;
+	rc = target_recovery_thread_init(&thread);
+	if (rc)
+		RETURN(rc);
 
         CDEBUG(D_HA, "%s: started recovery thread pid %d\n", obd->obd_name,
                cfs_curproc_pid());
@@ -2013,8 +2541,14 @@ static int target_recovery_thread(void *arg)
         CDEBUG(D_INFO, "1: request replay stage - %d clients from t"LPU64"\n",
                cfs_atomic_read(&obd->obd_req_replay_clients),
                obd->obd_next_recovery_transno);
+	trd->trd_replay_start = cfs_time_current_sec();
+	workers = target_replay_workers_start(obd);
         while ((req = target_next_replay_req(obd))) {
                 LASSERT(trd->trd_processing_task == cfs_curproc_pid());
+		if (workers > 0) {
+			target_replay_dispatch(thread, obd, req);
+			continue;
+		}
                 DEBUG_REQ(D_HA, req, "processing t"LPD64" from %s",
                           lustre_msg_get_transno(req->rq_reqmsg),
                           libcfs_nid2str(req->rq_peer.nid));
@@ -2031,6 +2565,12 @@ static int target_recovery_thread(void *arg)
                 target_request_copy_put(req);
                 obd->obd_replayed_requests++;
         }
+	/* wait for the workers to complete the requests handed over */
+	if (workers > 0) {
+		target_replay_workers_stop(obd);
+		target_replay_commit_flush(thread, lut);
+	}
+	trd->trd_replay_end = cfs_time_current_sec();
 
         /**
          * The second stage: replay locks
@@ -2085,12 +2625,10 @@ static int target_recovery_thread(void *arg)
                 libcfs_debug_dumplog();
         }
 
-        lu_context_fini(&env->le_ctx);
+        target_recovery_thread_fini(thread);
         trd->trd_processing_task = 0;
 	complete(&trd->trd_finishing);
 
-        OBD_FREE_PTR(thread);
-        OBD_FREE_PTR(env);
         RETURN(rc);
 }
 
@@ -2104,6 +2642,11 @@ static int target_start_recovery_thread(struct lu_target *lut,
         memset(trd, 0, sizeof(*trd));
 	init_completion(&trd->trd_starting);
 	init_completion(&trd->trd_finishing);
+	spin_lock_init(&trd->trd_replay_lock);
+	cfs_waitq_init(&trd->trd_replay_waitq);
+	CFS_INIT_LIST_HEAD(&trd->trd_replay_inflight);
+	CFS_INIT_LIST_HEAD(&trd->trd_replay_ready);
+	CFS_INIT_LIST_HEAD(&trd->trd_replay_uncommitted);
         trd->trd_recovery_handler = handler;
 
         if (cfs_create_thread(target_recovery_thread, lut, 0) > 0) {
@@ -2220,10 +2763,11 @@ int target_queue_recovery_request(struct ptlrpc_request *req,
         __u64 transno = lustre_msg_get_transno(req->rq_reqmsg);
         ENTRY;
 
-        if (obd->obd_recovery_data.trd_processing_task == cfs_curproc_pid()) {
-                /* Processing the queue right now, don't re-add. */
-                RETURN(1);
-        }
+	if (obd->obd_recovery_data.trd_processing_task == cfs_curproc_pid() ||
+	    req->rq_recovery_replay) {
+		/* Processing the queue right now, don't re-add. */
+		RETURN(1);
+	}
 
         target_process_req_flags(obd, req);
 
@@ -2638,10 +3182,14 @@ int target_bulk_io(struct obd_export *exp, struct ptlrpc_bulk_desc *desc,
 {
 	struct ptlrpc_request	*req = desc->bd_req;
 	time_t			 start = cfs_time_current_sec();
+	struct timeval		 bulk_start;
+	struct timeval		 bulk_end;
 	int			 rc = 0;
 
 	ENTRY;
 
+	cfs_gettimeofday(&bulk_start);
+
 	/* If there is eviction in progress, wait for it to finish. */
 	if (unlikely(cfs_atomic_read(&exp->exp_obd->obd_evict_inprogress))) {
 		*lwi = LWI_INTR(NULL, NULL);
@@ -2720,6 +3268,10 @@ int target_bulk_io(struct obd_export *exp, struct ptlrpc_bulk_desc *desc,
 		rc = sptlrpc_svc_unwrap_bulk(req, desc);
 	}
 
+	/* accounted to the job of the request in job_stats */
+	cfs_gettimeofday(&bulk_end);
+	req->rq_bulk_usec += cfs_timeval_sub(&bulk_end, &bulk_start, NULL);
+
 	RETURN(rc);
 }
 EXPORT_SYMBOL(target_bulk_io);
@@ -1808,6 +1808,72 @@ int ldlm_reprocess_queue(struct ldlm_resource *res, cfs_list_t *queue,
 }
 #endif
 
+/**
+ * Maximum number of locks sent to a client in one blocking AST RPC, values
+ * below 2 disable batching.
+ */
+unsigned int ldlm_bl_batch_max = LDLM_BL_BATCH_MAX;
+
+#ifdef HAVE_SERVER_SUPPORT
+/**
+ * Move locks which can share a blocking AST RPC with \a lock from the
+ * ast_work list to \a arg->batch: they belong to the same export, conflict
+ * with the same lock and carry the same AST flags.  Only the head of the list
+ * is scanned, so that long lists of locks from many clients are not walked
+ * over and over again.
+ *
+ * \retval number of locks in \a arg->batch, \a lock included
+ */
+static int ldlm_bl_ast_batch(struct ldlm_cb_set_arg *arg,
+			     struct ldlm_lock *lock)
+{
+	struct ldlm_lock *tmp;
+	struct ldlm_lock *next;
+	unsigned int      max;
+	int               scan;
+	int               count = 1;
+
+	max = min_t(unsigned int, ldlm_bl_batch_max, LDLM_BL_BATCH_MAX);
+	if (max < 2 || lock->l_blocking_ast != ldlm_server_blocking_ast ||
+	    lock->l_export == NULL || !exp_connect_bl_batch(lock->l_export) ||
+	    lock->l_flags & LDLM_FL_CANCEL_ON_BLOCK)
+		return 1;
+
+	if (arg->batch == NULL) {
+		OBD_ALLOC(arg->batch, LDLM_BL_BATCH_MAX * sizeof(*arg->batch));
+		if (arg->batch == NULL)
+			return 1;
+	}
+	arg->batch[0] = lock;
+
+	scan = 4 * max;
+	cfs_list_for_each_entry_safe(tmp, next, arg->list, l_bl_ast) {
+		if (count == max || scan-- == 0)
+			break;
+		if (tmp->l_export != lock->l_export ||
+		    tmp->l_blocking_lock != lock->l_blocking_lock ||
+		    tmp->l_blocking_ast != lock->l_blocking_ast)
+			continue;
+
+		lock_res_and_lock(tmp);
+		if ((tmp->l_flags ^ lock->l_flags) &
+		    (LDLM_AST_FLAGS | LDLM_FL_CANCEL_ON_BLOCK)) {
+			unlock_res_and_lock(tmp);
+			continue;
+		}
+		cfs_list_del_init(&tmp->l_bl_ast);
+		LASSERT(tmp->l_flags & LDLM_FL_AST_SENT);
+		LASSERT(tmp->l_bl_ast_run == 0);
+		tmp->l_bl_ast_run++;
+		unlock_res_and_lock(tmp);
+
+		arg->batch[count++] = tmp;
+	}
+
+	return count;
+}
+#endif
+
 /**
  * Process a call to blocking AST callback for a lock in ast_work list
  */
@@ -1818,6 +1884,10 @@ ldlm_work_bl_ast_lock(struct ptlrpc_request_set *rqset, void *opaq)
 	struct ldlm_lock_desc   d;
 	int                     rc;
 	struct ldlm_lock       *lock;
+#ifdef HAVE_SERVER_SUPPORT
+	int                     count;
+	int                     i;
+#endif
 	ENTRY;
 
 	if (cfs_list_empty(arg->list))
@@ -1837,6 +1907,20 @@ ldlm_work_bl_ast_lock(struct ptlrpc_request_set *rqset, void *opaq)
 
 	ldlm_lock2desc(lock->l_blocking_lock, &d);
 
+#ifdef HAVE_SERVER_SUPPORT
+	count = ldlm_bl_ast_batch(arg, lock);
+	if (count > 1) {
+		rc = ldlm_server_blocking_ast_batch(arg->batch, count, &d, arg);
+		for (i = 0; i < count; i++) {
+			lock = arg->batch[i];
+			LDLM_LOCK_RELEASE(lock->l_blocking_lock);
+			lock->l_blocking_lock = NULL;
+			LDLM_LOCK_RELEASE(lock);
+		}
+		RETURN(rc);
+	}
+#endif
+
 	rc = lock->l_blocking_ast(lock, &d, (void *)arg, LDLM_CB_BLOCKING);
 	LDLM_LOCK_RELEASE(lock->l_blocking_lock);
 	lock->l_blocking_lock = NULL;
@@ -2013,6 +2097,8 @@ int ldlm_run_ast_work(struct ldlm_namespace *ns, cfs_list_t *rpc_list,
 	rc = cfs_atomic_read(&arg->restart) ? -ERESTART : 0;
 	GOTO(out, rc);
 out:
+	if (arg->batch != NULL)
+		OBD_FREE(arg->batch, LDLM_BL_BATCH_MAX * sizeof(*arg->batch));
 	OBD_FREE_PTR(arg);
 	return rc;
 }
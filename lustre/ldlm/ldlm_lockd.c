@@ -68,8 +68,60 @@ static int ldlm_refcount;
 struct ldlm_cb_async_args {
         struct ldlm_cb_set_arg *ca_set_arg;
         struct ldlm_lock       *ca_lock;
+	/* locks of a multi-lock blocking AST, ca_lock is the first one and
+	 * the array of ca_count slots is NULL terminated if not full */
+	struct ldlm_lock      **ca_locks;
+	int                     ca_count;
 };
 
+/* locks per blocking AST RPC sent by the server and received by the client */
+static struct obd_histogram ldlm_bl_batch_sent;
+static struct obd_histogram ldlm_bl_batch_rcvd;
+
+#ifdef LPROCFS
+#define pct(a, b) (b ? a * 100 / b : 0)
+
+int ldlm_rd_bl_batch_stats(char *page, char **start, off_t off, int count,
+			   int *eof, void *data)
+{
+	unsigned long sent_tot = lprocfs_oh_sum(&ldlm_bl_batch_sent);
+	unsigned long rcvd_tot = lprocfs_oh_sum(&ldlm_bl_batch_rcvd);
+	unsigned long sent_cum = 0;
+	unsigned long rcvd_cum = 0;
+	int           rc;
+	int           i;
+
+	*eof = 1;
+	rc = snprintf(page, count, "\t\t\tsent\t\t\treceived\n"
+		      "locks per rpc         rpcs   %% cum %% |"
+		      "       rpcs   %% cum %%\n");
+	for (i = 0; i < OBD_HIST_MAX; i++) {
+		unsigned long s = ldlm_bl_batch_sent.oh_buckets[i];
+		unsigned long r = ldlm_bl_batch_rcvd.oh_buckets[i];
+
+		sent_cum += s;
+		rcvd_cum += r;
+		rc += snprintf(page + rc, count - rc,
+			       "%d:\t\t%10lu %3lu %3lu   | %10lu %3lu %3lu\n",
+			       1 << i, s, pct(s, sent_tot),
+			       pct(sent_cum, sent_tot), r, pct(r, rcvd_tot),
+			       pct(rcvd_cum, rcvd_tot));
+		if (sent_cum == sent_tot && rcvd_cum == rcvd_tot)
+			break;
+	}
+	return rc;
+}
+
+int ldlm_wr_bl_batch_stats(struct file *file, const char *buffer,
+			   unsigned long count, void *data)
+{
+	lprocfs_oh_clear(&ldlm_bl_batch_sent);
+	lprocfs_oh_clear(&ldlm_bl_batch_rcvd);
+	return count;
+}
+#undef pct
+#endif
+
 /* LDLM state */
 
 static struct ldlm_state *ldlm_state;
@@ -114,6 +166,17 @@ struct ldlm_bl_pool {
         cfs_atomic_t            blp_busy_threads;
         int                     blp_min_threads;
         int                     blp_max_threads;
+	/* CPU partition the threads of this pool are bound to */
+	int			blp_cpt;
+	/* blp_list requests handled since the last blp_prio_list one */
+	int			blp_num_bl;
+	/* statistics below are protected by blp_lock */
+	/* requests currently queued on both lists */
+	unsigned int		blp_queued;
+	unsigned int		blp_max_queued;
+	__u64			blp_total;
+	/* requests taken by the threads of other pools */
+	__u64			blp_stolen;
 };
 
 struct ldlm_bl_work_item {
@@ -131,39 +194,78 @@ struct ldlm_bl_work_item {
 #if defined(HAVE_SERVER_SUPPORT) && defined(__KERNEL__)
 
 /**
- * Protects both waiting_locks_list and expired_lock_thread.
+ * Number of one-second slots in the timer wheel of a waiting-locks partition.
+ * A lock whose callback timeout is further away than that stays in its slot
+ * for more than one turn of the wheel.
  */
-static spinlock_t waiting_locks_spinlock;   /* BH lock (timer) */
+#define LDLM_WAIT_SLOTS		128
+#define LDLM_WAIT_SLOT_MASK	(LDLM_WAIT_SLOTS - 1)
 
 /**
- * List for contended locks.
+ * Contended locks.
  *
- * As soon as a lock is contended, it gets placed on this list and
- * expected time to get a response is filled in the lock. A special
- * thread walks the list looking for locks that should be released and
- * schedules client evictions for those that have not been released in
- * time.
+ * As soon as a lock is contended, it gets placed on the timer wheel of one of
+ * these partitions, in the slot of the second its callback times out, and the
+ * expected time to get a response is filled in the lock. While the wheel is
+ * not empty, the timer of the partition ticks every second and looks at the
+ * slots of the seconds passed since the previous tick only. Locks which were
+ * not released in time are moved to the expired list, and the ldlm_elt thread
+ * of the partition evicts the clients holding them.
  *
- * All access to it should be under waiting_locks_spinlock.
+ * There is one partition per CPU partition of cfs_cpt_table and locks are
+ * spread over them by handle, so that adding, refreshing, removing and timing
+ * out many locks at once do not serialize on a single spinlock or thread.
  */
-static cfs_list_t waiting_locks_list;
-static cfs_timer_t waiting_locks_timer;
+struct ldlm_waiting_locks {
+	/** BH lock (timer), protects all the fields below */
+	spinlock_t		wl_lock;
+	cfs_list_t		wl_wheel[LDLM_WAIT_SLOTS];
+	cfs_timer_t		wl_timer;
+	/** last second whose slot was checked */
+	unsigned long		wl_tick;
+	/** locks on the wheel or on wl_expired */
+	unsigned int		wl_nr_pending;
+	/** locks which timed out since startup */
+	__u64			wl_nr_timeouts;
+	int			wl_cpt;
+	/* expired lock thread */
+	cfs_waitq_t		wl_waitq;
+	int			wl_state;
+	int			wl_dump;
+	cfs_list_t		wl_expired;
+};
+
+static struct ldlm_waiting_locks	**ldlm_waiting_locks;
+static int				  ldlm_waiting_locks_nr;
+
+static inline struct ldlm_waiting_locks *ldlm_lock_wl(struct ldlm_lock *lock)
+{
+	return ldlm_waiting_locks[(unsigned long)lock->l_handle.h_cookie %
+				  ldlm_waiting_locks_nr];
+}
+
+static inline unsigned long ldlm_wait_sec(cfs_time_t time)
+{
+	return cfs_duration_sec(cfs_time_sub(time, 0));
+}
+
+static inline cfs_list_t *ldlm_wait_slot(struct ldlm_waiting_locks *wl,
+					 struct ldlm_lock *lock)
+{
+	unsigned long sec;
 
-static struct expired_lock_thread {
-	cfs_waitq_t		elt_waitq;
-	int			elt_state;
-	int			elt_dump;
-	cfs_list_t		elt_expired_locks;
-} expired_lock_thread;
+	sec = ldlm_wait_sec(round_timeout(lock->l_callback_timeout));
+	return &wl->wl_wheel[sec & LDLM_WAIT_SLOT_MASK];
+}
 
-static inline int have_expired_locks(void)
+static inline int have_expired_locks(struct ldlm_waiting_locks *wl)
 {
 	int need_to_run;
 
 	ENTRY;
-	spin_lock_bh(&waiting_locks_spinlock);
-	need_to_run = !cfs_list_empty(&expired_lock_thread.elt_expired_locks);
-	spin_unlock_bh(&waiting_locks_spinlock);
+	spin_lock_bh(&wl->wl_lock);
+	need_to_run = !cfs_list_empty(&wl->wl_expired);
+	spin_unlock_bh(&wl->wl_lock);
 
 	RETURN(need_to_run);
 }
@@ -173,36 +275,41 @@ static inline int have_expired_locks(void)
  */
 static int expired_lock_main(void *arg)
 {
-        cfs_list_t *expired = &expired_lock_thread.elt_expired_locks;
+	struct ldlm_waiting_locks *wl = arg;
+	cfs_list_t *expired = &wl->wl_expired;
         struct l_wait_info lwi = { 0 };
+	char name[CFS_CURPROC_COMM_MAX];
         int do_dump;
 
         ENTRY;
-        cfs_daemonize("ldlm_elt");
+	snprintf(name, sizeof(name), "ldlm_elt_%02d", wl->wl_cpt);
+	cfs_daemonize(name);
+	if (cfs_cpt_bind(cfs_cpt_table, wl->wl_cpt) != 0)
+		CWARN("%s: failed to bind to CPT %d\n", name, wl->wl_cpt);
 
-        expired_lock_thread.elt_state = ELT_READY;
-        cfs_waitq_signal(&expired_lock_thread.elt_waitq);
+	wl->wl_state = ELT_READY;
+	cfs_waitq_signal(&wl->wl_waitq);
 
         while (1) {
-                l_wait_event(expired_lock_thread.elt_waitq,
-                             have_expired_locks() ||
-                             expired_lock_thread.elt_state == ELT_TERMINATE,
+		l_wait_event(wl->wl_waitq,
+			     have_expired_locks(wl) ||
+			     wl->wl_state == ELT_TERMINATE,
                              &lwi);
 
-		spin_lock_bh(&waiting_locks_spinlock);
-		if (expired_lock_thread.elt_dump) {
+		spin_lock_bh(&wl->wl_lock);
+		if (wl->wl_dump) {
 			struct libcfs_debug_msg_data msgdata = {
 				.msg_file = __FILE__,
 				.msg_fn = "waiting_locks_callback",
-				.msg_line = expired_lock_thread.elt_dump };
-			spin_unlock_bh(&waiting_locks_spinlock);
+				.msg_line = wl->wl_dump };
+			spin_unlock_bh(&wl->wl_lock);
 
 			/* from waiting_locks_callback, but not in timer */
 			libcfs_debug_dumplog();
 			libcfs_run_lbug_upcall(&msgdata);
 
-			spin_lock_bh(&waiting_locks_spinlock);
-                        expired_lock_thread.elt_dump = 0;
+			spin_lock_bh(&wl->wl_lock);
+			wl->wl_dump = 0;
                 }
 
                 do_dump = 0;
@@ -212,14 +319,15 @@ static int expired_lock_main(void *arg)
                         struct ldlm_lock *lock;
 
                         lock = cfs_list_entry(expired->next, struct ldlm_lock,
-                                          l_pending_chain);
+					      l_pending_chain);
                         if ((void *)lock < LP_POISON + CFS_PAGE_SIZE &&
                             (void *)lock >= LP_POISON) {
-				spin_unlock_bh(&waiting_locks_spinlock);
+				spin_unlock_bh(&wl->wl_lock);
                                 CERROR("free lock on elt list %p\n", lock);
                                 LBUG();
                         }
                         cfs_list_del_init(&lock->l_pending_chain);
+			wl->wl_nr_pending--;
                         if ((void *)lock->l_export < LP_POISON + CFS_PAGE_SIZE &&
                             (void *)lock->l_export >= LP_POISON) {
                                 CERROR("lock with free export on elt list %p\n",
@@ -240,7 +348,7 @@ static int expired_lock_main(void *arg)
 				continue;
 			}
 			export = class_export_lock_get(lock->l_export, lock);
-			spin_unlock_bh(&waiting_locks_spinlock);
+			spin_unlock_bh(&wl->wl_lock);
 
 			do_dump++;
 			class_fail_export(export);
@@ -250,26 +358,29 @@ static int expired_lock_main(void *arg)
 			 * or ldlm_failed_ast() */
 			LDLM_LOCK_RELEASE(lock);
 
-			spin_lock_bh(&waiting_locks_spinlock);
+			spin_lock_bh(&wl->wl_lock);
 		}
-		spin_unlock_bh(&waiting_locks_spinlock);
+		spin_unlock_bh(&wl->wl_lock);
 
                 if (do_dump && obd_dump_on_eviction) {
                         CERROR("dump the log upon eviction\n");
                         libcfs_debug_dumplog();
                 }
 
-                if (expired_lock_thread.elt_state == ELT_TERMINATE)
+		if (wl->wl_state == ELT_TERMINATE)
                         break;
         }
 
-        expired_lock_thread.elt_state = ELT_STOPPED;
-        cfs_waitq_signal(&expired_lock_thread.elt_waitq);
+	wl->wl_state = ELT_STOPPED;
+	cfs_waitq_signal(&wl->wl_waitq);
         RETURN(0);
 }
 
 static int ldlm_add_waiting_lock(struct ldlm_lock *lock);
-static int __ldlm_add_waiting_lock(struct ldlm_lock *lock, int seconds);
+static int __ldlm_add_waiting_lock(struct ldlm_waiting_locks *wl,
+				   struct ldlm_lock *lock, int seconds);
+static int __ldlm_del_waiting_lock(struct ldlm_waiting_locks *wl,
+				   struct ldlm_lock *lock);
 
 /**
  * Check if there is a request in the export request list
@@ -297,29 +408,53 @@ static int ldlm_lock_busy(struct ldlm_lock *lock)
 	RETURN(match);
 }
 
+/**
+ * Put a lock whose timeout was suspended back on the wheel, or hand it to
+ * the expired lock thread to drop the reference if it was destroyed.
+ */
+static void ldlm_requeue_waiting_lock(struct ldlm_waiting_locks *wl,
+				      struct ldlm_lock *lock)
+{
+	if (lock->l_destroyed) {
+		/* relay the lock refcount decrease to expired lock thread */
+		cfs_list_move(&lock->l_pending_chain, &wl->wl_expired);
+	} else {
+		__ldlm_del_waiting_lock(wl, lock);
+		__ldlm_add_waiting_lock(wl, lock, ldlm_get_enq_timeout(lock));
+	}
+}
+
 /* This is called from within a timer interrupt and cannot schedule */
-static void waiting_locks_callback(unsigned long unused)
+static void waiting_locks_callback(unsigned long data)
 {
-	struct ldlm_lock	*lock;
-	int			need_dump = 0;
-	int			processed = 0;
+	struct ldlm_waiting_locks	*wl = (struct ldlm_waiting_locks *)data;
+	struct ldlm_lock		*lock;
+	CFS_LIST_HEAD			(expiring);
+	unsigned long			 now;
+	int				 need_dump = 0;
+
+	spin_lock_bh(&wl->wl_lock);
+	/* collect the slots of the seconds passed since the previous tick;
+	 * after a long delay (or a jiffies wrap) every slot is checked once */
+	now = ldlm_wait_sec(cfs_time_current());
+	if (now - wl->wl_tick > LDLM_WAIT_SLOTS)
+		wl->wl_tick = now - LDLM_WAIT_SLOTS;
+	while (wl->wl_tick != now) {
+		wl->wl_tick++;
+		cfs_list_splice_init(&wl->wl_wheel[wl->wl_tick &
+						   LDLM_WAIT_SLOT_MASK],
+				     expiring.prev);
+	}
 
-	spin_lock_bh(&waiting_locks_spinlock);
-        while (!cfs_list_empty(&waiting_locks_list)) {
-		processed++;
-                lock = cfs_list_entry(waiting_locks_list.next, struct ldlm_lock,
+	while (!cfs_list_empty(&expiring)) {
+		lock = cfs_list_entry(expiring.next, struct ldlm_lock,
                                       l_pending_chain);
                 if (cfs_time_after(lock->l_callback_timeout,
 				   cfs_time_current())) {
-			int timeout = cfs_duration_sec(cfs_time_sub(lock->l_callback_timeout,
-						       cfs_time_current()));
-			if ((processed == 1) && (timeout > 65))
-					LDLM_ERROR(lock, "Long-waiting lock %d sec\n",
-						   timeout);
-
-			/* Should we move this towards the end of the list
-			 * instead? */
-			break;
+			/* due on a later turn of the wheel */
+			cfs_list_move_tail(&lock->l_pending_chain,
+					   ldlm_wait_slot(wl, lock));
+			continue;
 		}
 
                 if (ptlrpc_check_suspend()) {
@@ -333,16 +468,7 @@ static void waiting_locks_callback(unsigned long unused)
                                    lock->l_export->exp_connection->c_remote_uuid.uuid,
                                    libcfs_nid2str(lock->l_export->exp_connection->c_peer.nid));
 
-                        cfs_list_del_init(&lock->l_pending_chain);
-			if (lock->l_destroyed) {
-				/* relay the lock refcount decrease to
-				 * expired lock thread */
-				cfs_list_add(&lock->l_pending_chain,
-					&expired_lock_thread.elt_expired_locks);
-			} else {
-				__ldlm_add_waiting_lock(lock,
-						ldlm_get_enq_timeout(lock));
-			}
+			ldlm_requeue_waiting_lock(wl, lock);
 			continue;
                 }
 
@@ -356,97 +482,71 @@ static void waiting_locks_callback(unsigned long unused)
                                    lock->l_export->exp_connection->c_remote_uuid.uuid,
                                    libcfs_nid2str(lock->l_export->exp_connection->c_peer.nid));
 
-                        cfs_list_del_init(&lock->l_pending_chain);
-			if (lock->l_destroyed) {
-				/* relay the lock refcount decrease to
-				 * expired lock thread */
-				cfs_list_add(&lock->l_pending_chain,
-					&expired_lock_thread.elt_expired_locks);
-			} else {
-				__ldlm_add_waiting_lock(lock,
-						ldlm_get_enq_timeout(lock));
-			}
+			ldlm_requeue_waiting_lock(wl, lock);
 			continue;
                 }
 
                 /* Check if we need to prolong timeout */
                 if (!OBD_FAIL_CHECK(OBD_FAIL_PTLRPC_HPREQ_TIMEOUT) &&
 		    (ldlm_lock_busy(lock) || (lock->l_req_mode == LCK_GROUP))) {
-                        int cont = 1;
-
-                        if (lock->l_pending_chain.next == &waiting_locks_list)
-                                cont = 0;
-
                         LDLM_LOCK_GET(lock);
 
-			spin_unlock_bh(&waiting_locks_spinlock);
+			spin_unlock_bh(&wl->wl_lock);
 			LDLM_DEBUG(lock, "prolong the busy lock");
 			lock->l_last_used++;
+			/* moves the lock from expiring back onto the wheel */
 			ldlm_refresh_waiting_lock(lock,
 						  ldlm_get_enq_timeout(lock));
-			spin_lock_bh(&waiting_locks_spinlock);
-
-                        if (!cont) {
-                                LDLM_LOCK_RELEASE(lock);
-                                break;
-                        }
+			spin_lock_bh(&wl->wl_lock);
 
                         LDLM_LOCK_RELEASE(lock);
                         continue;
                 }
                 ldlm_lock_to_ns(lock)->ns_timeouts++;
+		wl->wl_nr_timeouts++;
                 LDLM_ERROR(lock, "lock callback timer expired after %lds: "
                            "evicting client at %s ",
                            cfs_time_current_sec()- lock->l_last_activity,
                            libcfs_nid2str(
                                    lock->l_export->exp_connection->c_peer.nid));
 
-                /* no needs to take an extra ref on the lock since it was in
-                 * the waiting_locks_list and ldlm_add_waiting_lock()
-                 * already grabbed a ref */
-                cfs_list_del(&lock->l_pending_chain);
-                cfs_list_add(&lock->l_pending_chain,
-                             &expired_lock_thread.elt_expired_locks);
+		/* no needs to take an extra ref on the lock since it was on
+		 * the wheel and ldlm_add_waiting_lock() already grabbed a
+		 * ref */
+		cfs_list_move(&lock->l_pending_chain, &wl->wl_expired);
 		need_dump = 1;
 	}
 
-	if (!cfs_list_empty(&expired_lock_thread.elt_expired_locks)) {
+	if (!cfs_list_empty(&wl->wl_expired)) {
 		if (obd_dump_on_timeout && need_dump)
-			expired_lock_thread.elt_dump = __LINE__;
+			wl->wl_dump = __LINE__;
 
-		cfs_waitq_signal(&expired_lock_thread.elt_waitq);
+		cfs_waitq_signal(&wl->wl_waitq);
 	}
 
-        /*
-         * Make sure the timer will fire again if we have any locks
-         * left.
-         */
-        if (!cfs_list_empty(&waiting_locks_list)) {
-                cfs_time_t timeout_rounded;
-                lock = cfs_list_entry(waiting_locks_list.next, struct ldlm_lock,
-                                      l_pending_chain);
-                timeout_rounded = (cfs_time_t)round_timeout(lock->l_callback_timeout);
-                cfs_timer_arm(&waiting_locks_timer, timeout_rounded);
-        }
-	spin_unlock_bh(&waiting_locks_spinlock);
+	/* keep ticking while there are locks left */
+	if (wl->wl_nr_pending > 0)
+		cfs_timer_arm(&wl->wl_timer, cfs_time_seconds(now + 1));
+	spin_unlock_bh(&wl->wl_lock);
 }
 
 /**
- * Add lock to the list of contended locks.
+ * Add lock to the wheel of contended locks.
  *
  * Indicate that we're waiting for a client to call us back cancelling a given
- * lock.  We add it to the pending-callback chain, and schedule the lock-timeout
- * timer to fire appropriately.  (We round up to the next second, to avoid
- * floods of timer firings during periods of high lock contention and traffic).
+ * lock.  We add it to the wheel slot of the second its callback times out,
+ * and start the timer of the partition if it was idle.  (We round up to the
+ * next second, to avoid floods of timer firings during periods of high lock
+ * contention and traffic).
  * As done by ldlm_add_waiting_lock(), the caller must grab a lock reference
  * if it has been added to the waiting list (1 is returned).
  *
  * Called with the namespace lock held.
  */
-static int __ldlm_add_waiting_lock(struct ldlm_lock *lock, int seconds)
+static int __ldlm_add_waiting_lock(struct ldlm_waiting_locks *wl,
+				   struct ldlm_lock *lock, int seconds)
 {
         cfs_time_t timeout;
-        cfs_time_t timeout_rounded;
 
         if (!cfs_list_empty(&lock->l_pending_chain))
                 return 0;
@@ -463,33 +563,19 @@ static int __ldlm_add_waiting_lock(struct ldlm_lock *lock, int seconds)
         if (likely(cfs_time_after(timeout, lock->l_callback_timeout)))
                 lock->l_callback_timeout = timeout;
 
-        timeout_rounded = round_timeout(lock->l_callback_timeout);
-
-        if (cfs_time_before(timeout_rounded,
-                            cfs_timer_deadline(&waiting_locks_timer)) ||
-            !cfs_timer_is_armed(&waiting_locks_timer)) {
-                cfs_timer_arm(&waiting_locks_timer, timeout_rounded);
-        }
-        /* if the new lock has a shorter timeout than something earlier on
-           the list, we'll wait the longer amount of time; no big deal. */
-	/* Or is it? */
-	if (!list_empty(&waiting_locks_list)) {
-		struct ldlm_lock *tmp = cfs_list_entry(waiting_locks_list.next,
-						       struct ldlm_lock,
-						       l_pending_chain);
-		int t = cfs_duration_sec(cfs_time_sub(tmp->l_callback_timeout,
-				     cfs_time_current()));
-		if (t > at_max + 65 /* Safety margin */ )
-			LDLM_ERROR(tmp, "Adding a lock, but the front position "
-				    "is scheduled in %d seconds\n", t);
+	cfs_list_add_tail(&lock->l_pending_chain, ldlm_wait_slot(wl, lock));
+	if (wl->wl_nr_pending++ == 0) {
+		/* the wheel was idle, nothing before now is due */
+		wl->wl_tick = ldlm_wait_sec(cfs_time_current());
+		cfs_timer_arm(&wl->wl_timer,
+			      cfs_time_seconds(wl->wl_tick + 1));
 	}
-        /* FIFO */
-        cfs_list_add_tail(&lock->l_pending_chain, &waiting_locks_list);
         return 1;
 }
 
 static int ldlm_add_waiting_lock(struct ldlm_lock *lock)
 {
+	struct ldlm_waiting_locks *wl = ldlm_lock_wl(lock);
 	int ret;
 	int timeout = ldlm_get_enq_timeout(lock);
 
@@ -499,10 +585,10 @@ static int ldlm_add_waiting_lock(struct ldlm_lock *lock)
 
 	LASSERT(!(lock->l_flags & LDLM_FL_CANCEL_ON_BLOCK));
 
-	spin_lock_bh(&waiting_locks_spinlock);
+	spin_lock_bh(&wl->wl_lock);
 	if (lock->l_destroyed) {
 		static cfs_time_t next;
-		spin_unlock_bh(&waiting_locks_spinlock);
+		spin_unlock_bh(&wl->wl_lock);
                 LDLM_ERROR(lock, "not waiting on destroyed lock (bug 5653)");
                 if (cfs_time_after(cfs_time_current(), next)) {
                         next = cfs_time_shift(14400);
@@ -511,13 +597,13 @@ static int ldlm_add_waiting_lock(struct ldlm_lock *lock)
                 return 0;
         }
 
-        ret = __ldlm_add_waiting_lock(lock, timeout);
+	ret = __ldlm_add_waiting_lock(wl, lock, timeout);
         if (ret) {
                 /* grab ref on the lock if it has been added to the
                  * waiting list */
                 LDLM_LOCK_GET(lock);
         }
-	spin_unlock_bh(&waiting_locks_spinlock);
+	spin_unlock_bh(&wl->wl_lock);
 
 	if (ret) {
 		spin_lock_bh(&lock->l_export->exp_bl_list_lock);
@@ -534,42 +620,31 @@ static int ldlm_add_waiting_lock(struct ldlm_lock *lock)
 }
 
 /**
- * Remove a lock from the pending list, likely because it had its cancellation
- * callback arrive without incident.  This adjusts the lock-timeout timer if
- * needed.  Returns 0 if the lock wasn't pending after all, 1 if it was.
+ * Remove a lock from the wheel or the expired list, likely because it had its
+ * cancellation callback arrive without incident.  The timer of the partition
+ * stops by itself once no lock is left.  Returns 0 if the lock wasn't pending
+ * after all, 1 if it was.
  * As done by ldlm_del_waiting_lock(), the caller must release the lock
  * reference when the lock is removed from any list (1 is returned).
  *
  * Called with namespace lock held.
  */
-static int __ldlm_del_waiting_lock(struct ldlm_lock *lock)
+static int __ldlm_del_waiting_lock(struct ldlm_waiting_locks *wl,
+				   struct ldlm_lock *lock)
 {
-        cfs_list_t *list_next;
-
         if (cfs_list_empty(&lock->l_pending_chain))
                 return 0;
 
-        list_next = lock->l_pending_chain.next;
-        if (lock->l_pending_chain.prev == &waiting_locks_list) {
-                /* Removing the head of the list, adjust timer. */
-                if (list_next == &waiting_locks_list) {
-                        /* No more, just cancel. */
-                        cfs_timer_disarm(&waiting_locks_timer);
-                } else {
-                        struct ldlm_lock *next;
-                        next = cfs_list_entry(list_next, struct ldlm_lock,
-                                              l_pending_chain);
-                        cfs_timer_arm(&waiting_locks_timer,
-                                      round_timeout(next->l_callback_timeout));
-                }
-        }
         cfs_list_del_init(&lock->l_pending_chain);
+	LASSERT(wl->wl_nr_pending > 0);
+	wl->wl_nr_pending--;
 
         return 1;
 }
 
 int ldlm_del_waiting_lock(struct ldlm_lock *lock)
 {
+	struct ldlm_waiting_locks *wl;
         int ret;
 
         if (lock->l_export == NULL) {
@@ -578,9 +653,10 @@ int ldlm_del_waiting_lock(struct ldlm_lock *lock)
                 return 0;
         }
 
-	spin_lock_bh(&waiting_locks_spinlock);
-	ret = __ldlm_del_waiting_lock(lock);
-	spin_unlock_bh(&waiting_locks_spinlock);
+	wl = ldlm_lock_wl(lock);
+	spin_lock_bh(&wl->wl_lock);
+	ret = __ldlm_del_waiting_lock(wl, lock);
+	spin_unlock_bh(&wl->wl_lock);
 
 	/* remove the lock out of export blocking list */
 	spin_lock_bh(&lock->l_export->exp_bl_list_lock);
@@ -605,31 +681,137 @@ EXPORT_SYMBOL(ldlm_del_waiting_lock);
  */
 int ldlm_refresh_waiting_lock(struct ldlm_lock *lock, int timeout)
 {
+	struct ldlm_waiting_locks *wl;
+
 	if (lock->l_export == NULL) {
 		/* We don't have a "waiting locks list" on clients. */
 		LDLM_DEBUG(lock, "client lock: no-op");
 		return 0;
 	}
 
-	spin_lock_bh(&waiting_locks_spinlock);
+	wl = ldlm_lock_wl(lock);
+	spin_lock_bh(&wl->wl_lock);
 
 	if (cfs_list_empty(&lock->l_pending_chain)) {
-		spin_unlock_bh(&waiting_locks_spinlock);
+		spin_unlock_bh(&wl->wl_lock);
 		LDLM_DEBUG(lock, "wasn't waiting");
 		return 0;
 	}
 
 	/* we remove/add the lock to the waiting list, so no needs to
 	 * release/take a lock reference */
-	__ldlm_del_waiting_lock(lock);
-	__ldlm_add_waiting_lock(lock, timeout);
-	spin_unlock_bh(&waiting_locks_spinlock);
+	__ldlm_del_waiting_lock(wl, lock);
+	__ldlm_add_waiting_lock(wl, lock, timeout);
+	spin_unlock_bh(&wl->wl_lock);
 
 	LDLM_DEBUG(lock, "refreshed");
 	return 1;
 }
 EXPORT_SYMBOL(ldlm_refresh_waiting_lock);
 
+#ifdef LPROCFS
+int ldlm_rd_waiting_locks(char *page, char **start, off_t off, int count,
+			  int *eof, void *data)
+{
+	int rc = 0;
+	int i;
+
+	*eof = 1;
+	for (i = 0; ldlm_waiting_locks != NULL &&
+		    i < ldlm_waiting_locks_nr; i++) {
+		struct ldlm_waiting_locks	*wl = ldlm_waiting_locks[i];
+		unsigned int			 pending;
+		__u64				 timeouts;
+
+		if (wl == NULL)
+			break;
+
+		spin_lock_bh(&wl->wl_lock);
+		pending = wl->wl_nr_pending;
+		timeouts = wl->wl_nr_timeouts;
+		spin_unlock_bh(&wl->wl_lock);
+
+		rc += snprintf(page + rc, count - rc,
+			       "cpt %d: pending %u timeouts "LPU64"\n",
+			       wl->wl_cpt, pending, timeouts);
+	}
+	return rc;
+}
+#endif
+
+static void ldlm_waiting_locks_fini(void)
+{
+	int i;
+
+	if (ldlm_waiting_locks == NULL)
+		return;
+
+	for (i = 0; i < ldlm_waiting_locks_nr; i++) {
+		struct ldlm_waiting_locks *wl = ldlm_waiting_locks[i];
+
+		if (wl == NULL)
+			continue;
+
+		if (wl->wl_state != ELT_STOPPED) {
+			wl->wl_state = ELT_TERMINATE;
+			cfs_waitq_signal(&wl->wl_waitq);
+			cfs_wait_event(wl->wl_waitq,
+				       wl->wl_state == ELT_STOPPED);
+		}
+		LASSERT(wl->wl_nr_pending == 0);
+		cfs_timer_disarm(&wl->wl_timer);
+		/* wait for a timer callback still running */
+		spin_lock_bh(&wl->wl_lock);
+		spin_unlock_bh(&wl->wl_lock);
+		OBD_FREE_PTR(wl);
+	}
+	OBD_FREE(ldlm_waiting_locks,
+		 ldlm_waiting_locks_nr * sizeof(ldlm_waiting_locks[0]));
+	ldlm_waiting_locks = NULL;
+}
+
+static int ldlm_waiting_locks_init(void)
+{
+	int rc;
+	int i;
+	int j;
+
+	ldlm_waiting_locks_nr = cfs_cpt_number(cfs_cpt_table);
+	OBD_ALLOC(ldlm_waiting_locks,
+		  ldlm_waiting_locks_nr * sizeof(ldlm_waiting_locks[0]));
+	if (ldlm_waiting_locks == NULL)
+		return -ENOMEM;
+
+	for (i = 0; i < ldlm_waiting_locks_nr; i++) {
+		struct ldlm_waiting_locks *wl;
+
+		OBD_CPT_ALLOC_PTR(wl, cfs_cpt_table, i);
+		if (wl == NULL)
+			return -ENOMEM;
+		ldlm_waiting_locks[i] = wl;
+
+		spin_lock_init(&wl->wl_lock);
+		for (j = 0; j < LDLM_WAIT_SLOTS; j++)
+			CFS_INIT_LIST_HEAD(&wl->wl_wheel[j]);
+		cfs_timer_init(&wl->wl_timer, waiting_locks_callback, wl);
+		wl->wl_cpt = i;
+		CFS_INIT_LIST_HEAD(&wl->wl_expired);
+		wl->wl_state = ELT_STOPPED;
+		cfs_waitq_init(&wl->wl_waitq);
+
+		rc = cfs_create_thread(expired_lock_main, wl,
+				       CFS_DAEMON_FLAGS);
+		if (rc < 0) {
+			CERROR("Cannot start ldlm expired-lock thread: %d\n",
+			       rc);
+			return rc;
+		}
+
+		cfs_wait_event(wl->wl_waitq, wl->wl_state == ELT_READY);
+	}
+	return 0;
+}
+
 #else /* !HAVE_SERVER_SUPPORT ||  !__KERNEL__ */
 
 int ldlm_del_waiting_lock(struct ldlm_lock *lock)
@@ -661,6 +843,10 @@ static int ldlm_add_waiting_lock(struct ldlm_lock *lock)
 static void ldlm_failed_ast(struct ldlm_lock *lock, int rc,
                             const char *ast_type)
 {
+#ifdef __KERNEL__
+	struct ldlm_waiting_locks *wl = ldlm_lock_wl(lock);
+#endif
+
         LCONSOLE_ERROR_MSG(0x138, "%s: A client on nid %s was evicted due "
                            "to a lock %s callback time out: rc %d\n",
                            lock->l_export->exp_obd->obd_name,
@@ -669,15 +855,15 @@ static void ldlm_failed_ast(struct ldlm_lock *lock, int rc,
         if (obd_dump_on_timeout)
                 libcfs_debug_dumplog();
 #ifdef __KERNEL__
-	spin_lock_bh(&waiting_locks_spinlock);
-	if (__ldlm_del_waiting_lock(lock) == 0)
+	spin_lock_bh(&wl->wl_lock);
+	if (__ldlm_del_waiting_lock(wl, lock) == 0)
 		/* the lock was not in any list, grab an extra ref before adding
 		 * the lock to the expired list */
 		LDLM_LOCK_GET(lock);
-	cfs_list_add(&lock->l_pending_chain,
-		     &expired_lock_thread.elt_expired_locks);
-	cfs_waitq_signal(&expired_lock_thread.elt_waitq);
-	spin_unlock_bh(&waiting_locks_spinlock);
+	cfs_list_add(&lock->l_pending_chain, &wl->wl_expired);
+	wl->wl_nr_pending++;
+	cfs_waitq_signal(&wl->wl_waitq);
+	spin_unlock_bh(&wl->wl_lock);
 #else
 	class_fail_export(lock->l_export);
 #endif
@@ -743,6 +929,56 @@ static int ldlm_handle_ast_error(struct ldlm_lock *lock,
         return rc;
 }
 
+/**
+ * Handle the reply to a multi-lock blocking AST.  An error applies to every
+ * lock in the RPC, while the handles returned in the reply are locks the
+ * client no longer has, which are handled as an -EINVAL reply to a single
+ * lock blocking AST would be.
+ */
+static int ldlm_cb_batch_interpret(struct ptlrpc_request *req,
+				   struct ldlm_cb_async_args *ca, int rc)
+{
+	struct ldlm_request *rep = NULL;
+	int                  i;
+	int                  j;
+	ENTRY;
+
+	if (rc == 0 && req_capsule_field_present(&req->rq_pill, &RMF_DLM_REQ,
+						 RCL_SERVER)) {
+		rep = req_capsule_server_get(&req->rq_pill, &RMF_DLM_REQ);
+		if (rep != NULL &&
+		    req_capsule_get_size(&req->rq_pill, &RMF_DLM_REQ,
+					 RCL_SERVER) <
+		    ldlm_request_bufsize(rep->lock_count, LDLM_BL_CALLBACK)) {
+			DEBUG_REQ(D_ERROR, req, "bad lock count %u in reply",
+				  rep->lock_count);
+			rep = NULL;
+		}
+	}
+
+	for (i = 0; i < ca->ca_count && ca->ca_locks[i] != NULL; i++) {
+		struct ldlm_lock *lock = ca->ca_locks[i];
+		int               lrc = rc;
+
+		for (j = 0; rep != NULL && lrc == 0 && j < rep->lock_count; j++)
+			if (rep->lock_handle[j].cookie ==
+			    lock->l_remote_handle.cookie)
+				lrc = -EINVAL;
+
+		if (lrc != 0 &&
+		    ldlm_handle_ast_error(lock, req, lrc, "blocking") ==
+		    -ERESTART)
+			cfs_atomic_inc(&ca->ca_set_arg->restart);
+
+		/* release extra reference taken in
+		 * ldlm_server_blocking_ast_batch() */
+		LDLM_LOCK_RELEASE(lock);
+	}
+
+	OBD_FREE(ca->ca_locks, ca->ca_count * sizeof(*ca->ca_locks));
+	RETURN(0);
+}
+
 static int ldlm_cb_interpret(const struct lu_env *env,
                              struct ptlrpc_request *req, void *data, int rc)
 {
@@ -751,6 +987,9 @@ static int ldlm_cb_interpret(const struct lu_env *env,
         struct ldlm_cb_set_arg    *arg  = ca->ca_set_arg;
         ENTRY;
 
+	if (ca->ca_locks != NULL)
+		RETURN(ldlm_cb_batch_interpret(req, ca, rc));
+
         LASSERT(lock != NULL);
 
 	switch (arg->type) {
@@ -949,6 +1188,118 @@ int ldlm_server_blocking_ast(struct ldlm_lock *lock,
 }
 EXPORT_SYMBOL(ldlm_server_blocking_ast);
 
+/**
+ * Sends one blocking AST RPC for \a count server locks, which belong to the
+ * same export and conflict with the same lock described by \a desc, to a
+ * client which connected with OBD_CONNECT_BL_BATCH.
+ *
+ * Locks which do not need a blocking AST any more are skipped as in
+ * ldlm_server_blocking_ast(); every other lock gets its waiting timer armed.
+ */
+int ldlm_server_blocking_ast_batch(struct ldlm_lock **locks, int count,
+				   struct ldlm_lock_desc *desc,
+				   struct ldlm_cb_set_arg *arg)
+{
+	struct obd_export         *exp = locks[0]->l_export;
+	struct ldlm_cb_async_args *ca;
+	struct ldlm_request       *body;
+	struct ptlrpc_request     *req;
+	struct ldlm_lock         **batch;
+	int                        nr = 0;
+	int                        rc;
+	int                        i;
+	ENTRY;
+
+	LASSERT(count > 1 && count <= LDLM_BL_BATCH_MAX);
+	if (exp->exp_obd->obd_recovering != 0)
+		LDLM_ERROR(locks[0], "BUG 6063: lock collide during recovery");
+
+	OBD_ALLOC(batch, count * sizeof(*batch));
+	if (batch == NULL)
+		RETURN(-ENOMEM);
+
+	req = ptlrpc_request_alloc(exp->exp_imp_reverse,
+				   &RQF_LDLM_BL_CALLBACK_BATCH);
+	if (req == NULL)
+		GOTO(out_free, rc = -ENOMEM);
+
+	req_capsule_set_size(&req->rq_pill, &RMF_DLM_REQ, RCL_CLIENT,
+			     ldlm_request_bufsize(count, LDLM_BL_CALLBACK));
+	rc = ptlrpc_request_pack(req, LUSTRE_DLM_VERSION, LDLM_BL_CALLBACK);
+	if (rc) {
+		ptlrpc_request_free(req);
+		GOTO(out_free, rc);
+	}
+
+	body = req_capsule_client_get(&req->rq_pill, &RMF_DLM_REQ);
+	body->lock_desc = *desc;
+	body->lock_flags |= ldlm_flags_to_wire(locks[0]->l_flags &
+					       LDLM_AST_FLAGS);
+
+	for (i = 0; i < count; i++) {
+		struct ldlm_lock *lock = locks[i];
+
+		ldlm_lock_reorder_req(lock);
+
+		lock_res_and_lock(lock);
+		if (lock->l_granted_mode != lock->l_req_mode ||
+		    lock->l_destroyed) {
+			unlock_res_and_lock(lock);
+			LDLM_DEBUG(lock, "not sending blocking AST");
+			continue;
+		}
+
+		body->lock_handle[nr] = lock->l_remote_handle;
+		LDLM_DEBUG(lock, "server preparing blocking AST, %d locks",
+			   count);
+		ldlm_add_waiting_lock(lock);
+		unlock_res_and_lock(lock);
+
+		lock->l_last_activity = cfs_time_current_sec();
+		batch[nr++] = LDLM_LOCK_GET(lock);
+	}
+
+	if (nr == 0) {
+		ptlrpc_req_finished(req);
+		GOTO(out_free, rc = 0);
+	}
+
+	body->lock_count = nr;
+	req_capsule_shrink(&req->rq_pill, &RMF_DLM_REQ,
+			   ldlm_request_bufsize(nr, LDLM_BL_CALLBACK),
+			   RCL_CLIENT);
+	/* room for the handles of locks the client has cancelled already */
+	req_capsule_set_size(&req->rq_pill, &RMF_DLM_REQ, RCL_SERVER,
+			     ldlm_request_bufsize(nr, LDLM_BL_CALLBACK));
+	ptlrpc_request_set_replen(req);
+
+	CLASSERT(sizeof(*ca) <= sizeof(req->rq_async_args));
+	ca = ptlrpc_req_async_args(req);
+	ca->ca_set_arg = arg;
+	ca->ca_lock = batch[0];
+	ca->ca_locks = batch;
+	ca->ca_count = count;
+
+	req->rq_interpret_reply = ldlm_cb_interpret;
+	req->rq_no_resend = 1;
+	req->rq_send_state = LUSTRE_IMP_FULL;
+	/* ptlrpc_request_pack already set timeout */
+	if (AT_OFF)
+		req->rq_timeout = ldlm_get_rq_timeout();
+
+	if (exp->exp_nid_stats && exp->exp_nid_stats->nid_ldlm_stats)
+		lprocfs_counter_incr(exp->exp_nid_stats->nid_ldlm_stats,
+				     LDLM_BL_CALLBACK - LDLM_FIRST_OPC);
+	lprocfs_oh_tally_log2(&ldlm_bl_batch_sent, nr);
+
+	ptlrpc_set_add_req(arg->set, req);
+	RETURN(0);
+
+out_free:
+	OBD_FREE(batch, count * sizeof(*batch));
+	return rc;
+}
+
 /**
  * ->l_completion_ast callback for a remote lock in server namespace.
  *
@@ -1963,10 +2314,59 @@ static int ldlm_callback_reply(struct ptlrpc_request *req, int rc)
 }
 
 #ifdef __KERNEL__
+/**
+ * Pick the blocking callback pool for \a blwi.
+ *
+ * All the callbacks on one resource go to the same CPU partition, so the
+ * resource and its locks stay in the caches of the CPUs of that partition.
+ * A list of locks from the LRU is placed by its first lock.
+ */
+static struct ldlm_bl_pool *ldlm_bl_pool_select(struct ldlm_bl_work_item *blwi)
+{
+	struct ldlm_lock    *lock = blwi->blwi_lock;
+	struct ldlm_res_id  *name;
+	unsigned long	     hash = 0;
+	int		     i;
+
+	if (ldlm_state->ldlm_bl_pools_nr == 1)
+		return ldlm_state->ldlm_bl_pools[0];
+
+	if (lock == NULL)
+		lock = cfs_list_entry(blwi->blwi_head.next, struct ldlm_lock,
+				      l_bl_ast);
+	name = &lock->l_resource->lr_name;
+	for (i = 0; i < RES_NAME_SIZE; i++)
+		hash += name->name[i];
+
+	return ldlm_state->ldlm_bl_pools[cfs_hash_long(hash, 16) %
+					 ldlm_state->ldlm_bl_pools_nr];
+}
+
+/**
+ * All the threads of \a blp are busy, wake up an idle thread of another
+ * pool so that it steals the request just queued (see ldlm_bl_get_work()).
+ */
+static void ldlm_bl_pool_kick(struct ldlm_bl_pool *blp)
+{
+	int nr = ldlm_state->ldlm_bl_pools_nr;
+	int i;
+
+	for (i = 1; i < nr; i++) {
+		struct ldlm_bl_pool *other;
+
+		other = ldlm_state->ldlm_bl_pools[(blp->blp_cpt + i) % nr];
+		if (cfs_atomic_read(&other->blp_busy_threads) <
+		    cfs_atomic_read(&other->blp_num_threads)) {
+			cfs_waitq_signal(&other->blp_waitq);
+			break;
+		}
+	}
+}
+
 static int __ldlm_bl_to_thread(struct ldlm_bl_work_item *blwi,
 			       ldlm_cancel_flags_t cancel_flags)
 {
-	struct ldlm_bl_pool *blp = ldlm_state->ldlm_bl_pool;
+	struct ldlm_bl_pool *blp = ldlm_bl_pool_select(blwi);
 	ENTRY;
 
 	spin_lock(&blp->blp_lock);
@@ -1978,9 +2378,15 @@ static int __ldlm_bl_to_thread(struct ldlm_bl_work_item *blwi,
 		/* other blocking callbacks are added to the regular list */
 		cfs_list_add_tail(&blwi->blwi_entry, &blp->blp_list);
 	}
+	if (++blp->blp_queued > blp->blp_max_queued)
+		blp->blp_max_queued = blp->blp_queued;
+	blp->blp_total++;
 	spin_unlock(&blp->blp_lock);
 
 	cfs_waitq_signal(&blp->blp_waitq);
+	if (cfs_atomic_read(&blp->blp_busy_threads) >=
+	    cfs_atomic_read(&blp->blp_num_threads))
+		ldlm_bl_pool_kick(blp);
 
 	/* can not check blwi->blwi_flags as blwi could be already freed in
 	   LCF_ASYNC mode */
@@ -2153,6 +2559,124 @@ static int ldlm_handle_qc_callback(struct ptlrpc_request *req)
 	return 0;
 }
 
+/**
+ * Callback handler for blocking ASTs carrying several lock handles.
+ *
+ * This only can happen on client side.  Handles of locks which are gone
+ * already are returned in the reply.  Unused locks are then cancelled in one
+ * batch by a blocking thread, while locks still in use are handled one by one
+ * as for a single-lock blocking AST.
+ */
+static void ldlm_handle_bl_callback_batch(struct ptlrpc_request *req,
+					  struct ldlm_namespace *ns,
+					  struct ldlm_request *dlm_req)
+{
+	CFS_LIST_HEAD(cancels);
+	struct ldlm_request *rep;
+	struct ldlm_lock   **locks;
+	struct ldlm_lock    *lock;
+	__u32                count = dlm_req->lock_count;
+	int                  stale = 0;
+	int                  nr = 0;
+	int                  rc;
+	int                  i;
+	ENTRY;
+
+	if (count > LDLM_BL_BATCH_MAX ||
+	    req_capsule_get_size(&req->rq_pill, &RMF_DLM_REQ, RCL_CLIENT) <
+	    ldlm_request_bufsize(count, LDLM_BL_CALLBACK)) {
+		rc = ldlm_callback_reply(req, -EPROTO);
+		ldlm_callback_errmsg(req, "Operate with bad lock count", rc,
+				     NULL);
+		RETURN_EXIT;
+	}
+
+	OBD_ALLOC(locks, count * sizeof(*locks));
+	if (locks == NULL) {
+		rc = ldlm_callback_reply(req, -ENOMEM);
+		ldlm_callback_errmsg(req, "Operate without memory", rc, NULL);
+		RETURN_EXIT;
+	}
+
+	lprocfs_oh_tally_log2(&ldlm_bl_batch_rcvd, count);
+
+	for (i = 0; i < count; i++) {
+		lock = ldlm_handle2lock_long(&dlm_req->lock_handle[i], 0);
+		if (lock == NULL) {
+			CDEBUG(D_DLMTRACE, "callback on lock "LPX64" - lock "
+			       "disappeared\n", dlm_req->lock_handle[i].cookie);
+			stale++;
+			continue;
+		}
+
+		/* Copy hints/flags (e.g. LDLM_FL_DISCARD_DATA) from AST. */
+		lock_res_and_lock(lock);
+		lock->l_flags |= ldlm_flags_from_wire(dlm_req->lock_flags &
+						      LDLM_AST_FLAGS);
+		/* see ldlm_callback_handler() */
+		if (((lock->l_flags & LDLM_FL_CANCELING) &&
+		     (lock->l_flags & LDLM_FL_BL_DONE)) ||
+		    (lock->l_flags & LDLM_FL_FAILED)) {
+			LDLM_DEBUG(lock, "callback on lock "LPX64" - lock "
+				   "disappeared", dlm_req->lock_handle[i].cookie);
+			unlock_res_and_lock(lock);
+			LDLM_LOCK_RELEASE(lock);
+			stale++;
+			continue;
+		}
+		ldlm_lock_remove_from_lru(lock);
+		lock->l_flags |= LDLM_FL_BL_AST;
+		unlock_res_and_lock(lock);
+		locks[i] = lock;
+	}
+
+	req_capsule_extend(&req->rq_pill, &RQF_LDLM_BL_CALLBACK_BATCH);
+	req_capsule_set_size(&req->rq_pill, &RMF_DLM_REQ, RCL_SERVER,
+			     ldlm_request_bufsize(stale, LDLM_BL_CALLBACK));
+	rc = req_capsule_server_pack(&req->rq_pill);
+	if (rc == 0) {
+		rep = req_capsule_server_get(&req->rq_pill, &RMF_DLM_REQ);
+		for (i = 0; i < count; i++)
+			if (locks[i] == NULL)
+				rep->lock_handle[rep->lock_count++] =
+					dlm_req->lock_handle[i];
+	}
+	rc = ldlm_callback_reply(req, rc);
+	if (req->rq_no_reply || rc)
+		ldlm_callback_errmsg(req, "Normal process", rc, NULL);
+
+	for (i = 0; i < count; i++) {
+		lock = locks[i];
+		if (lock == NULL)
+			continue;
+
+		lock_res_and_lock(lock);
+		if (lock->l_readers || lock->l_writers ||
+		    (lock->l_flags & LDLM_FL_CANCELING)) {
+			unlock_res_and_lock(lock);
+			if (ldlm_bl_to_thread_lock(ns, &dlm_req->lock_desc,
+						   lock))
+				ldlm_handle_bl_callback(ns, &dlm_req->lock_desc,
+							lock);
+			continue;
+		}
+		/* See CBPENDING comment in ldlm_cancel_lru */
+		lock->l_flags |= LDLM_FL_CBPENDING | LDLM_FL_CANCELING;
+		LASSERT(cfs_list_empty(&lock->l_bl_ast));
+		cfs_list_add(&lock->l_bl_ast, &cancels);
+		unlock_res_and_lock(lock);
+		nr++;
+	}
+	OBD_FREE(locks, count * sizeof(*locks));
+
+	if (nr > 0 && ldlm_bl_to_thread_list(ns, &dlm_req->lock_desc,
+					     &cancels, nr, LCF_ASYNC) != 0) {
+		nr = ldlm_cli_cancel_list_local(&cancels, nr, LCF_BL_AST);
+		ldlm_cli_cancel_list(&cancels, nr, NULL, 0);
+	}
+	EXIT;
+}
+
 /* TODO: handle requests in a similar way as MDT: see mdt_handle_common() */
 static int ldlm_callback_handler(struct ptlrpc_request *req)
 {
@@ -2266,6 +2790,13 @@ static int ldlm_callback_handler(struct ptlrpc_request *req)
                 RETURN(0);
         }
 
+	/* lock_count is only set by servers sending several locks at once */
+	if (lustre_msg_get_opc(req->rq_reqmsg) == LDLM_BL_CALLBACK &&
+	    dlm_req->lock_count > 0) {
+		ldlm_handle_bl_callback_batch(req, ns, dlm_req);
+		RETURN(0);
+	}
+
         /* Force a known safe race, send a cancel to the server for a lock
          * which the server has already started a blocking callback on. */
         if (OBD_FAIL_CHECK(OBD_FAIL_LDLM_CANCEL_BL_CB_RACE) &&
@@ -2579,33 +3110,106 @@ EXPORT_SYMBOL(ldlm_revoke_export_locks);
 #endif /* HAVE_SERVER_SUPPORT */
 
 #ifdef __KERNEL__
-static struct ldlm_bl_work_item *ldlm_bl_get_work(struct ldlm_bl_pool *blp)
+static struct ldlm_bl_work_item *__ldlm_bl_get_work(struct ldlm_bl_pool *blp,
+						    int steal)
 {
 	struct ldlm_bl_work_item *blwi = NULL;
-	static unsigned int num_bl = 0;
 
 	spin_lock(&blp->blp_lock);
         /* process a request from the blp_list at least every blp_num_threads */
         if (!cfs_list_empty(&blp->blp_list) &&
-            (cfs_list_empty(&blp->blp_prio_list) || num_bl == 0))
+	    (cfs_list_empty(&blp->blp_prio_list) || blp->blp_num_bl == 0))
                 blwi = cfs_list_entry(blp->blp_list.next,
                                       struct ldlm_bl_work_item, blwi_entry);
-        else
-                if (!cfs_list_empty(&blp->blp_prio_list))
-                        blwi = cfs_list_entry(blp->blp_prio_list.next,
-                                              struct ldlm_bl_work_item,
-                                              blwi_entry);
+	else if (!cfs_list_empty(&blp->blp_prio_list))
+		blwi = cfs_list_entry(blp->blp_prio_list.next,
+				      struct ldlm_bl_work_item, blwi_entry);
+
+	/* the requests stopping the threads of a pool are not for others */
+	if (blwi != NULL && steal && blwi->blwi_ns == NULL)
+		blwi = NULL;
 
         if (blwi) {
-                if (++num_bl >= cfs_atomic_read(&blp->blp_num_threads))
-                        num_bl = 0;
+		if (++blp->blp_num_bl >=
+		    cfs_atomic_read(&blp->blp_num_threads))
+			blp->blp_num_bl = 0;
                 cfs_list_del(&blwi->blwi_entry);
+		blp->blp_queued--;
+		if (steal)
+			blp->blp_stolen++;
         }
 	spin_unlock(&blp->blp_lock);
 
 	return blwi;
 }
 
+/**
+ * Get the next request for a thread of \a blp.
+ *
+ * When its own pool is empty, the thread helps the other pools whose
+ * threads are all busy, so that a burst of callbacks on the resources
+ * hashed to one partition does not wait while the others are idle.
+ */
+static struct ldlm_bl_work_item *ldlm_bl_get_work(struct ldlm_bl_pool *blp)
+{
+	struct ldlm_bl_work_item *blwi;
+	int			  nr = ldlm_state->ldlm_bl_pools_nr;
+	int			  i;
+
+	blwi = __ldlm_bl_get_work(blp, 0);
+	for (i = 1; blwi == NULL && i < nr; i++) {
+		struct ldlm_bl_pool *other;
+
+		other = ldlm_state->ldlm_bl_pools[(blp->blp_cpt + i) % nr];
+		if (other->blp_queued == 0 ||
+		    cfs_atomic_read(&other->blp_busy_threads) <
+		    cfs_atomic_read(&other->blp_num_threads))
+			continue;
+
+		blwi = __ldlm_bl_get_work(other, 1);
+	}
+
+	return blwi;
+}
+
+#ifdef LPROCFS
+int ldlm_rd_bl_pools(char *page, char **start, off_t off, int count,
+		     int *eof, void *data)
+{
+	int rc = 0;
+	int i;
+
+	*eof = 1;
+	for (i = 0; ldlm_state != NULL && ldlm_state->ldlm_bl_pools != NULL &&
+		    i < ldlm_state->ldlm_bl_pools_nr; i++) {
+		struct ldlm_bl_pool	*blp = ldlm_state->ldlm_bl_pools[i];
+		unsigned int		 queued;
+		unsigned int		 max_queued;
+		__u64			 total;
+		__u64			 stolen;
+
+		if (blp == NULL)
+			break;
+
+		spin_lock(&blp->blp_lock);
+		queued = blp->blp_queued;
+		max_queued = blp->blp_max_queued;
+		total = blp->blp_total;
+		stolen = blp->blp_stolen;
+		spin_unlock(&blp->blp_lock);
+
+		rc += snprintf(page + rc, count - rc,
+			       "cpt %d: threads %d busy %d queued %u "
+			       "max_queued %u total "LPU64" stolen "LPU64"\n",
+			       blp->blp_cpt,
+			       cfs_atomic_read(&blp->blp_num_threads),
+			       cfs_atomic_read(&blp->blp_busy_threads),
+			       queued, max_queued, total, stolen);
+	}
+	return rc;
+}
+#endif
+
 /* This only contains temporary data until the thread starts */
 struct ldlm_bl_thread_data {
 	char			bltd_name[CFS_CURPROC_COMM_MAX];
@@ -2624,8 +3228,9 @@ static int ldlm_bl_thread_start(struct ldlm_bl_pool *blp)
 	init_completion(&bltd.bltd_comp);
 	rc = cfs_create_thread(ldlm_bl_thread_main, &bltd, 0);
 	if (rc < 0) {
-		CERROR("cannot start LDLM thread ldlm_bl_%02d: rc %d\n",
-		       cfs_atomic_read(&blp->blp_num_threads), rc);
+		CERROR("cannot start LDLM thread ldlm_bl_%02d_%02d: rc %d\n",
+		       blp->blp_cpt, cfs_atomic_read(&blp->blp_num_threads),
+		       rc);
 		return rc;
 	}
 	wait_for_completion(&bltd.bltd_comp);
@@ -2655,8 +3260,11 @@ static int ldlm_bl_thread_main(void *arg)
                 cfs_atomic_inc(&blp->blp_busy_threads);
 
                 snprintf(bltd->bltd_name, sizeof(bltd->bltd_name) - 1,
-                        "ldlm_bl_%02d", bltd->bltd_num);
+			 "ldlm_bl_%02d_%02d", blp->blp_cpt, bltd->bltd_num);
                 cfs_daemonize(bltd->bltd_name);
+		if (cfs_cpt_bind(cfs_cpt_table, blp->blp_cpt) != 0)
+			CWARN("%s: failed to bind to CPT %d\n",
+			      bltd->bltd_name, blp->blp_cpt);
 
 		complete(&bltd->bltd_comp);
                 /* cannot use bltd after this, it is only on caller's stack */
@@ -2874,10 +3482,14 @@ EXPORT_SYMBOL(ldlm_destroy_export);
 static int ldlm_setup(void)
 {
 	static struct ptlrpc_service_conf	conf;
-	struct ldlm_bl_pool			*blp = NULL;
         int rc = 0;
 #ifdef __KERNEL__
-        int i;
+	struct ldlm_bl_pool			*blp;
+	int					 min;
+	int					 max;
+	int					 nr;
+	int					 i;
+	int					 j;
 #endif
         ENTRY;
 
@@ -2976,51 +3588,58 @@ static int ldlm_setup(void)
 	}
 #endif
 
-	OBD_ALLOC(blp, sizeof(*blp));
-	if (blp == NULL)
+#ifdef __KERNEL__
+	nr = cfs_cpt_number(cfs_cpt_table);
+	OBD_ALLOC(ldlm_state->ldlm_bl_pools,
+		  nr * sizeof(ldlm_state->ldlm_bl_pools[0]));
+	if (ldlm_state->ldlm_bl_pools == NULL)
 		GOTO(out, rc = -ENOMEM);
-	ldlm_state->ldlm_bl_pool = blp;
-
-	spin_lock_init(&blp->blp_lock);
-        CFS_INIT_LIST_HEAD(&blp->blp_list);
-        CFS_INIT_LIST_HEAD(&blp->blp_prio_list);
-        cfs_waitq_init(&blp->blp_waitq);
-        cfs_atomic_set(&blp->blp_num_threads, 0);
-        cfs_atomic_set(&blp->blp_busy_threads, 0);
+	ldlm_state->ldlm_bl_pools_nr = nr;
+
+	for (i = 0; i < nr; i++) {
+		OBD_CPT_ALLOC_PTR(blp, cfs_cpt_table, i);
+		if (blp == NULL)
+			GOTO(out, rc = -ENOMEM);
+		ldlm_state->ldlm_bl_pools[i] = blp;
+
+		spin_lock_init(&blp->blp_lock);
+		CFS_INIT_LIST_HEAD(&blp->blp_list);
+		CFS_INIT_LIST_HEAD(&blp->blp_prio_list);
+		cfs_waitq_init(&blp->blp_waitq);
+		cfs_atomic_set(&blp->blp_num_threads, 0);
+		cfs_atomic_set(&blp->blp_busy_threads, 0);
+		blp->blp_cpt = i;
+	}
 
-#ifdef __KERNEL__
 	if (ldlm_num_threads == 0) {
-		blp->blp_min_threads = LDLM_NTHRS_INIT;
-		blp->blp_max_threads = LDLM_NTHRS_MAX;
+		min = LDLM_NTHRS_INIT;
+		max = LDLM_NTHRS_MAX;
 	} else {
-		blp->blp_min_threads = blp->blp_max_threads = \
-			min_t(int, LDLM_NTHRS_MAX, max_t(int, LDLM_NTHRS_INIT,
-							 ldlm_num_threads));
+		min = max = min_t(int, LDLM_NTHRS_MAX,
+				  max_t(int, LDLM_NTHRS_INIT,
+					ldlm_num_threads));
 	}
-
-	for (i = 0; i < blp->blp_min_threads; i++) {
-		rc = ldlm_bl_thread_start(blp);
-		if (rc < 0)
-			GOTO(out, rc);
+	/* spread the threads over the partitions, at least one in each */
+	min = max_t(int, 1, min / nr);
+	max = max_t(int, min, max / nr);
+
+	/* all the pools are set up before any thread may steal from them */
+	for (i = 0; i < nr; i++) {
+		blp = ldlm_state->ldlm_bl_pools[i];
+		blp->blp_min_threads = min;
+		blp->blp_max_threads = max;
+
+		for (j = 0; j < blp->blp_min_threads; j++) {
+			rc = ldlm_bl_thread_start(blp);
+			if (rc < 0)
+				GOTO(out, rc);
+		}
 	}
 
 # ifdef HAVE_SERVER_SUPPORT
-        CFS_INIT_LIST_HEAD(&expired_lock_thread.elt_expired_locks);
-        expired_lock_thread.elt_state = ELT_STOPPED;
-        cfs_waitq_init(&expired_lock_thread.elt_waitq);
-
-        CFS_INIT_LIST_HEAD(&waiting_locks_list);
-	spin_lock_init(&waiting_locks_spinlock);
-        cfs_timer_init(&waiting_locks_timer, waiting_locks_callback, 0);
-
-        rc = cfs_create_thread(expired_lock_main, NULL, CFS_DAEMON_FLAGS);
-	if (rc < 0) {
-		CERROR("Cannot start ldlm expired-lock thread: %d\n", rc);
+	rc = ldlm_waiting_locks_init();
+	if (rc < 0)
 		GOTO(out, rc);
-	}
-
-        cfs_wait_event(expired_lock_thread.elt_waitq,
-                       expired_lock_thread.elt_state == ELT_READY);
 # endif /* HAVE_SERVER_SUPPORT */
 
 	rc = ldlm_pools_init();
@@ -3051,23 +3670,41 @@ static int ldlm_cleanup(void)
 #ifdef __KERNEL__
         ldlm_pools_fini();
 
-	if (ldlm_state->ldlm_bl_pool != NULL) {
-		struct ldlm_bl_pool *blp = ldlm_state->ldlm_bl_pool;
+	if (ldlm_state->ldlm_bl_pools != NULL) {
+		struct ldlm_bl_pool *blp;
+		int i;
 
-		while (cfs_atomic_read(&blp->blp_num_threads) > 0) {
-			struct ldlm_bl_work_item blwi = { .blwi_ns = NULL };
+		for (i = 0; i < ldlm_state->ldlm_bl_pools_nr; i++) {
+			blp = ldlm_state->ldlm_bl_pools[i];
+			if (blp == NULL)
+				continue;
 
-			init_completion(&blp->blp_comp);
+			while (cfs_atomic_read(&blp->blp_num_threads) > 0) {
+				struct ldlm_bl_work_item blwi = {
+					.blwi_ns = NULL };
 
-			spin_lock(&blp->blp_lock);
-			cfs_list_add_tail(&blwi.blwi_entry, &blp->blp_list);
-			cfs_waitq_signal(&blp->blp_waitq);
-			spin_unlock(&blp->blp_lock);
+				init_completion(&blp->blp_comp);
 
-			wait_for_completion(&blp->blp_comp);
+				spin_lock(&blp->blp_lock);
+				cfs_list_add_tail(&blwi.blwi_entry,
+						  &blp->blp_list);
+				blp->blp_queued++;
+				cfs_waitq_signal(&blp->blp_waitq);
+				spin_unlock(&blp->blp_lock);
+
+				wait_for_completion(&blp->blp_comp);
+			}
 		}
 
-		OBD_FREE(blp, sizeof(*blp));
+		/* threads of one pool may steal from the others until all
+		 * of them are stopped */
+		for (i = 0; i < ldlm_state->ldlm_bl_pools_nr; i++)
+			if (ldlm_state->ldlm_bl_pools[i] != NULL)
+				OBD_FREE_PTR(ldlm_state->ldlm_bl_pools[i]);
+		OBD_FREE(ldlm_state->ldlm_bl_pools,
+			 ldlm_state->ldlm_bl_pools_nr *
+			 sizeof(ldlm_state->ldlm_bl_pools[0]));
+		ldlm_state->ldlm_bl_pools = NULL;
 	}
 #endif /* __KERNEL__ */
 
@@ -3082,12 +3719,7 @@ static int ldlm_cleanup(void)
 	ldlm_proc_cleanup();
 
 # ifdef HAVE_SERVER_SUPPORT
-	if (expired_lock_thread.elt_state != ELT_STOPPED) {
-		expired_lock_thread.elt_state = ELT_TERMINATE;
-		cfs_waitq_signal(&expired_lock_thread.elt_waitq);
-		cfs_wait_event(expired_lock_thread.elt_waitq,
-			       expired_lock_thread.elt_state == ELT_STOPPED);
-	}
+	ldlm_waiting_locks_fini();
 # endif
 #endif /* __KERNEL__ */
 
@@ -3100,6 +3732,8 @@ static int ldlm_cleanup(void)
 int ldlm_init(void)
 {
 	mutex_init(&ldlm_ref_mutex);
+	spin_lock_init(&ldlm_bl_batch_sent.oh_lock);
+	spin_lock_init(&ldlm_bl_batch_rcvd.oh_lock);
 	mutex_init(ldlm_namespace_lock(LDLM_NAMESPACE_SERVER));
 	mutex_init(ldlm_namespace_lock(LDLM_NAMESPACE_CLIENT));
         ldlm_resource_slab = cfs_mem_cache_create("ldlm_resources",
@@ -91,6 +91,17 @@ int ldlm_proc_setup(void)
                 { "cancel_unused_locks_before_replay",
                   lprocfs_rd_uint, lprocfs_wr_uint,
                   &ldlm_cancel_unused_locks_before_replay, NULL },
+                { "bl_batch_max",
+                  lprocfs_rd_uint, lprocfs_wr_uint,
+                  &ldlm_bl_batch_max, NULL },
+		{ "bl_batch_stats", ldlm_rd_bl_batch_stats,
+		  ldlm_wr_bl_batch_stats, NULL },
+#if defined(HAVE_SERVER_SUPPORT) && defined(__KERNEL__)
+		{ "waiting_locks", ldlm_rd_waiting_locks, NULL, NULL },
+#endif
+#ifdef __KERNEL__
+		{ "bl_pools", ldlm_rd_bl_pools, NULL, NULL },
+#endif
                 { NULL }};
         ENTRY;
         LASSERT(ldlm_ns_proc_dir == NULL);
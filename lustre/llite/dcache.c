@@ -501,6 +501,9 @@ int ll_revalidate_it(struct dentry *de, int lookup_flags,
         }
 
 do_lock:
+	if (it->it_op & IT_OPEN)
+		ll_open_cache_intent(parent, it);
+
         op_data = ll_prep_md_op_data(NULL, parent, de->d_inode,
                                      de->d_name.name, de->d_name.len,
                                      0, LUSTRE_OPC_ANY, NULL);
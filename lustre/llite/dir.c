@@ -144,6 +144,7 @@
 static int ll_dir_filler(void *_hash, struct page *page0)
 {
         struct inode *inode = page0->mapping->host;
+	struct ll_inode_info *lli = ll_i2info(inode);
         int hash64 = ll_i2sbi(inode)->ll_flags & LL_SBI_64BIT_HASH;
         struct obd_export *exp = ll_i2sbi(inode)->ll_md_exp;
         struct ptlrpc_request *request;
@@ -156,6 +157,8 @@ static int ll_dir_filler(void *_hash, struct page *page0)
         struct pagevec lru_pvec;
 #endif
         struct lu_dirpage *dp;
+	__u64 start = 0;
+	__u64 end = MDS_DIR_END_OFF;
         int max_pages = ll_i2sbi(inode)->ll_md_brw_size >> CFS_PAGE_SHIFT;
         int nrdpgs = 0; /* number of pages read actually */
         int npages;
@@ -199,8 +202,12 @@ static int ll_dir_filler(void *_hash, struct page *page0)
                 nrdpgs = (request->rq_bulk->bd_nob_transferred+CFS_PAGE_SIZE-1)
                          >> CFS_PAGE_SHIFT;
                 SetPageUptodate(page0);
+
+		dp = cfs_kmap(page0);
+		start = le64_to_cpu(dp->ldp_hash_start);
+		end = le64_to_cpu(dp->ldp_hash_end);
+		cfs_kunmap(page0);
         }
-        unlock_page(page0);
         ptlrpc_req_finished(request);
 
         CDEBUG(D_VFSTRACE, "read %d/%d pages\n", nrdpgs, npages);
@@ -221,6 +228,7 @@ static int ll_dir_filler(void *_hash, struct page *page0)
 
                 dp = cfs_kmap(page);
                 hash = le64_to_cpu(dp->ldp_hash_start);
+		end = le64_to_cpu(dp->ldp_hash_end);
                 cfs_kunmap(page);
 
                 offset = hash_x_index(hash, hash64);
@@ -240,6 +248,16 @@ static int ll_dir_filler(void *_hash, struct page *page0)
         }
         ll_pagevec_lru_add_file(&lru_pvec);
 
+	/* Keep page0 locked until the whole batch is in the page cache, so
+	 * that a reader waiting on it finds the following pages as well. */
+	if (rc == 0) {
+		spin_lock(&lli->lli_lock);
+		lli->lli_dir_ra_start = start;
+		lli->lli_dir_ra_end = end;
+		spin_unlock(&lli->lli_lock);
+	}
+	unlock_page(page0);
+
         if (page_pool != &page0)
                 OBD_FREE(page_pool, sizeof(struct page *) * max_pages);
         EXIT;
@@ -294,8 +312,8 @@ static struct page *ll_dir_page_locate(struct inode *dir, __u64 *hash,
                  * page cannot be truncated (while DLM lock is held) and,
                  * hence, can avoid restart.
                  *
-                 * In fact, page cannot be locked here at all, because
-		 * ll_dir_filler() does synchronous io.
+		 * The page is only locked here while ll_dir_filler() is
+		 * reading it, possibly on behalf of readdir-ahead.
                  */
                 wait_on_page(page);
                 if (PageUptodate(page)) {
@@ -327,8 +345,15 @@ static struct page *ll_dir_page_locate(struct inode *dir, __u64 *hash,
                                 page = NULL;
                         }
                 } else {
-                        page_cache_release(page);
-                        page = ERR_PTR(-EIO);
+			/* The read that added this page failed, e.g. an
+			 * interrupted readahead. Drop it so that the caller
+			 * fetches it again. */
+			lock_page(page);
+			if (likely(page->mapping != NULL))
+				truncate_complete_page(page->mapping, page);
+			unlock_page(page);
+			page_cache_release(page);
+			page = NULL;
                 }
 
         } else {
@@ -338,6 +363,116 @@ static struct page *ll_dir_page_locate(struct inode *dir, __u64 *hash,
         return page;
 }
 
+struct ll_dir_ra_args {
+	struct inode	*dra_inode;
+	__u64		 dra_hash;
+};
+
+static int ll_dir_readahead_thread(void *arg)
+{
+	struct ll_dir_ra_args	*args = arg;
+	struct inode		*dir = args->dra_inode;
+	struct ll_inode_info	*lli = ll_i2info(dir);
+	struct ll_sb_info	*sbi = ll_i2sbi(dir);
+	ldlm_policy_data_t	 policy = {
+				.l_inodebits = {MDS_INODELOCK_UPDATE} };
+	struct lustre_handle	 lockh;
+	struct page		*page;
+	ldlm_mode_t		 mode;
+	__u64			 hash = args->dra_hash;
+	int			 hash64 = sbi->ll_flags & LL_SBI_64BIT_HASH;
+	ENTRY;
+
+	cfs_daemonize("ll_dir_ra");
+
+	/* Dir pages may only be cached under the UPDATE lock. It is not
+	 * enqueued here: if the lock is already gone, so is the reader. */
+	mode = md_lock_match(sbi->ll_md_exp, LDLM_FL_BLOCK_GRANTED,
+			     ll_inode2fid(dir), LDLM_IBITS, &policy, LCK_PR,
+			     &lockh);
+	if (mode != 0) {
+		page = read_cache_page(dir->i_mapping,
+				       hash_x_index(hash, hash64),
+				       ll_dir_filler, &hash);
+		if (IS_ERR(page))
+			CDEBUG(D_READA, "readahead "DFID" at "LPX64": rc %ld\n",
+			       PFID(ll_inode2fid(dir)), hash, PTR_ERR(page));
+		else
+			page_cache_release(page);
+		ldlm_lock_decref(&lockh, mode);
+	}
+
+	spin_lock(&lli->lli_lock);
+	lli->lli_dir_ra_pending = 0;
+	spin_unlock(&lli->lli_lock);
+
+	iput(dir);
+	OBD_FREE_PTR(args);
+	if (cfs_atomic_dec_and_test(&sbi->ll_dir_ra_running))
+		cfs_waitq_broadcast(&sbi->ll_dir_ra_waitq);
+	RETURN(0);
+}
+
+/*
+ * Once the reader reaches the first page of the last batch read from the MDS,
+ * start reading the next batch in the background so that it is in the page
+ * cache by the time the reader gets there.
+ */
+static void ll_dir_readahead(struct inode *dir, struct lu_dirpage *dp)
+{
+	struct ll_inode_info	*lli = ll_i2info(dir);
+	struct ll_sb_info	*sbi = ll_i2sbi(dir);
+	int			 hash64 = sbi->ll_flags & LL_SBI_64BIT_HASH;
+	struct ll_dir_ra_args	*args;
+	struct page		*page;
+	__u64			 hash;
+	int			 rc;
+
+	if (!(sbi->ll_flags & LL_SBI_DIR_RA) || sbi->ll_umounting)
+		return;
+
+	spin_lock(&lli->lli_lock);
+	hash = lli->lli_dir_ra_end;
+	if (lli->lli_dir_ra_pending || hash == MDS_DIR_END_OFF ||
+	    le64_to_cpu(dp->ldp_hash_start) != lli->lli_dir_ra_start) {
+		spin_unlock(&lli->lli_lock);
+		return;
+	}
+	lli->lli_dir_ra_pending = 1;
+	spin_unlock(&lli->lli_lock);
+
+	/* repeated listing, the next batch is still cached */
+	page = find_get_page(dir->i_mapping, hash_x_index(hash, hash64));
+	if (page != NULL) {
+		page_cache_release(page);
+		GOTO(out, rc = 0);
+	}
+
+	OBD_ALLOC_PTR(args);
+	if (args == NULL)
+		GOTO(out, rc = -ENOMEM);
+
+	args->dra_inode = igrab(dir);
+	args->dra_hash = hash;
+	cfs_atomic_inc(&sbi->ll_dir_ra_running);
+	rc = cfs_create_thread(ll_dir_readahead_thread, args, 0);
+	if (rc < 0) {
+		CDEBUG(D_READA, "cannot start readahead for "DFID": rc %d\n",
+		       PFID(ll_inode2fid(dir)), rc);
+		cfs_atomic_dec(&sbi->ll_dir_ra_running);
+		iput(dir);
+		OBD_FREE_PTR(args);
+		GOTO(out, rc);
+	}
+
+	atomic_inc(&sbi->ll_dir_ra_total);
+	return;
+out:
+	spin_lock(&lli->lli_lock);
+	lli->lli_dir_ra_pending = 0;
+	spin_unlock(&lli->lli_lock);
+}
+
 struct page *ll_get_dir_page(struct inode *dir, __u64 hash,
                              struct ll_dir_chain *chain)
 {
@@ -474,6 +609,7 @@ hash_collision:
                  */
                 goto fail;
         }
+	ll_dir_readahead(dir, dp);
 out_unlock:
 	mutex_unlock(&lli->lli_readdir_mutex);
         ldlm_lock_decref(&lockh, mode);
@@ -1468,6 +1604,56 @@ out_rmdir:
                         ll_putname(filename);
 		RETURN(rc);
 	}
+	case LL_IOC_BULK_UNLINK: {
+		struct ll_bulk_unlink	 lbu;
+		struct ll_bulk_unlink	*buf;
+		__s32			*rcs;
+		char			*name, *end;
+		int			 totalsize, len, i, rc;
+
+		if (cfs_copy_from_user(&lbu, (void *)arg, sizeof(lbu)))
+			RETURN(-EFAULT);
+
+		if (lbu.lbu_count == 0 ||
+		    lbu.lbu_count > LL_BULK_UNLINK_MAX ||
+		    lbu.lbu_buflen > LL_BULK_UNLINK_BUFLEN ||
+		    lbu.lbu_buflen <= lbu.lbu_count * sizeof(*rcs))
+			RETURN(-EINVAL);
+
+		totalsize = sizeof(lbu) + lbu.lbu_buflen;
+		OBD_ALLOC_LARGE(buf, totalsize);
+		if (buf == NULL)
+			RETURN(-ENOMEM);
+
+		if (cfs_copy_from_user(buf, (void *)arg, totalsize))
+			GOTO(out_bulk, rc = -EFAULT);
+
+		/* every name has to be there and be a plain entry name */
+		rcs = (__s32 *)buf->lbu_buf;
+		name = buf->lbu_buf + lbu.lbu_count * sizeof(*rcs);
+		end = buf->lbu_buf + lbu.lbu_buflen;
+		for (i = 0; i < lbu.lbu_count; i++) {
+			len = strnlen(name, end - name);
+			if (len == 0 || len == end - name ||
+			    len > ll_i2sbi(inode)->ll_namelen ||
+			    memchr(name, '/', len) != NULL ||
+			    (name[0] == '.' && (len == 1 ||
+						(len == 2 && name[1] == '.'))))
+				GOTO(out_bulk, rc = -EINVAL);
+			name += len + 1;
+		}
+
+		rc = ll_bulk_unlink(inode, buf->lbu_buf + lbu.lbu_count *
+				    sizeof(*rcs), lbu.lbu_count, rcs);
+
+		if (cfs_copy_to_user(((struct ll_bulk_unlink *)arg)->lbu_buf,
+				     rcs, lbu.lbu_count * sizeof(*rcs)) &&
+		    rc == 0)
+			rc = -EFAULT;
+out_bulk:
+		OBD_FREE_LARGE(buf, totalsize);
+		RETURN(rc);
+	}
 	case LL_IOC_LOV_SWAP_LAYOUTS:
 		RETURN(-EPERM);
         case LL_IOC_OBD_STATFS:
@@ -1806,11 +1992,21 @@ out_rmdir:
         case LL_IOC_GET_CONNECT_FLAGS: {
                 RETURN(obd_iocontrol(cmd, sbi->ll_md_exp, 0, NULL, (void*)arg));
         }
-        case OBD_IOC_CHANGELOG_SEND:
-        case OBD_IOC_CHANGELOG_CLEAR:
-                rc = copy_and_ioctl(cmd, sbi->ll_md_exp, (void *)arg,
-                                    sizeof(struct ioc_changelog));
-                RETURN(rc);
+	case OBD_IOC_CHANGELOG_SEND:
+	case OBD_IOC_CHANGELOG_CLEAR: {
+		struct ioc_changelog	icc;
+		int			len;
+
+		/* the filter fields are only there if the caller says so */
+		len = offsetof(struct ioc_changelog, icc_type_mask);
+		if (cfs_copy_from_user(&icc, (void *)arg, len))
+			RETURN(-EFAULT);
+		if (icc.icc_flags & CHANGELOG_FLAG_FILTER)
+			len = sizeof(icc);
+
+		rc = copy_and_ioctl(cmd, sbi->ll_md_exp, (void *)arg, len);
+		RETURN(rc);
+	}
         case OBD_IOC_FID2PATH:
 		RETURN(ll_fid2path(inode, (void *)arg));
 	case LL_IOC_HSM_REQUEST: {
@@ -228,6 +228,8 @@ int ll_md_real_close(struct inode *inode, int flags)
         }
         och=*och_p;
         *och_p = NULL;
+	if (lli->lli_mds_read_och == NULL)
+		ll_open_cache_del(inode);
 	mutex_unlock(&lli->lli_och_mutex);
 
         if (och) { /* There might be a race and somebody have freed this och
@@ -255,6 +257,7 @@ int ll_md_close(struct obd_export *md_exp, struct inode *inode,
            we can skip talking to MDS */
         if (file->f_dentry->d_inode) { /* Can this ever be false? */
                 int lockmode;
+		int idle = 0;
 		__u64 flags = LDLM_FL_BLOCK_GRANTED | LDLM_FL_TEST_LOCK;
                 struct lustre_handle lockh;
                 struct inode *inode = file->f_dentry->d_inode;
@@ -273,6 +276,7 @@ int ll_md_close(struct obd_export *md_exp, struct inode *inode,
                         lockmode = LCK_CR;
                         LASSERT(lli->lli_open_fd_read_count);
                         lli->lli_open_fd_read_count--;
+			idle = lli->lli_open_fd_read_count == 0;
                 }
 		mutex_unlock(&lli->lli_och_mutex);
 
@@ -281,6 +285,10 @@ int ll_md_close(struct obd_export *md_exp, struct inode *inode,
                                    &lockh)) {
                         rc = ll_md_real_close(file->f_dentry->d_inode,
                                               fd->fd_omode);
+		} else if (idle) {
+			/* the handle is kept under the OPEN lock, let it
+			 * age out unless it is opened again */
+			ll_open_cache_add(inode);
                 }
         } else {
                 CERROR("Releasing a file %p with negative dentry %p. Name %s",
@@ -584,6 +592,11 @@ restart:
 
 	mutex_lock(&lli->lli_och_mutex);
         if (*och_p) { /* Open handle is present */
+		if (!(it->it_flags & (FMODE_WRITE | FMODE_EXEC)) &&
+		    ll_open_cache_del(inode) &&
+		    !it_disposition(it, DISP_OPEN_OPEN))
+			cfs_atomic_inc(&ll_i2sbi(inode)->ll_open_cache.loc_hits);
+
                 if (it_disposition(it, DISP_OPEN_OPEN)) {
                         /* Well, there's extra open request that we do not need,
                            let's close it somehow. This will decref request. */
@@ -624,6 +637,10 @@ restart:
                 if (!*och_p)
                         GOTO(out_och_free, rc = -ENOMEM);
 
+		if (ll_i2sbi(inode)->ll_open_cache.loc_age > 0 &&
+		    !(it->it_flags & (FMODE_WRITE | FMODE_EXEC)))
+			cfs_atomic_inc(&ll_i2sbi(inode)->ll_open_cache.loc_misses);
+
                 (*och_usecount)++;
 
                 /* md_intent_lock() didn't get a request ref if there was an
@@ -840,6 +857,8 @@ void ll_io_init(struct cl_io *io, const struct file *file, int write)
 	}
         io->ci_obj     = ll_i2info(inode)->lli_clob;
         io->ci_lockreq = CILR_MAYBE;
+	io->ci_parallel_dio = !!(file->f_flags & O_DIRECT) &&
+			      !!(ll_i2sbi(inode)->ll_flags & LL_SBI_PARALLEL_DIO);
         if (ll_file_nolock(file)) {
                 io->ci_lockreq = CILR_NEVER;
                 io->ci_no_srvlock = 1;
@@ -937,7 +956,7 @@ out:
                         ll_stats_ops_tally(ll_i2sbi(file->f_dentry->d_inode),
                                            LPROC_LL_WRITE_BYTES, result);
 			fd->fd_write_failed = false;
-		} else if (result != -ERESTARTSYS) {
+		} else if (result != -ERESTARTSYS && result != -EIOCBQUEUED) {
 			fd->fd_write_failed = true;
 		}
 	}
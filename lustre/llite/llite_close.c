@@ -344,9 +344,146 @@ static struct ll_inode_info *ll_close_next_lli(struct ll_close_queue *lcq)
 	return lli;
 }
 
+void ll_open_cache_init(struct ll_open_cache *loc)
+{
+	spin_lock_init(&loc->loc_lock);
+	CFS_INIT_LIST_HEAD(&loc->loc_head);
+	loc->loc_age = LL_OC_AGE_DEF;
+	loc->loc_max = LL_OC_MAX_DEF;
+	loc->loc_count = 0;
+	cfs_atomic_set(&loc->loc_hits, 0);
+	cfs_atomic_set(&loc->loc_misses, 0);
+	cfs_atomic_set(&loc->loc_expired, 0);
+}
+
+/* Ask for an OPEN lock with an open whose handle can be kept after close;
+ * handles for writing are not, they carry the I/O epoch. Neither are exec
+ * handles: the MDS refuses writers with -ETXTBSY while one is open, and a
+ * write open does not revoke the OPEN lock that keeps it. */
+void ll_open_cache_intent(struct inode *inode, struct lookup_intent *it)
+{
+	if (ll_i2sbi(inode)->ll_open_cache.loc_age == 0)
+		return;
+
+	if (it->it_op == IT_OPEN &&
+	    !(it->it_flags & (FMODE_WRITE | FMODE_EXEC | O_TRUNC)))
+		it->it_flags |= MDS_OPEN_LOCK;
+}
+
+/* The last user of the read open handle of @inode closed it and
+ * the handle is kept under its OPEN lock, start aging it. */
+void ll_open_cache_add(struct inode *inode)
+{
+	struct ll_sb_info    *sbi = ll_i2sbi(inode);
+	struct ll_open_cache *loc = &sbi->ll_open_cache;
+	struct ll_inode_info *lli = ll_i2info(inode);
+	int                   wake;
+
+	spin_lock(&loc->loc_lock);
+	if (loc->loc_age == 0) {
+		spin_unlock(&loc->loc_lock);
+		return;
+	}
+	if (cfs_list_empty(&lli->lli_oc_list))
+		loc->loc_count++;
+	else
+		cfs_list_del(&lli->lli_oc_list);
+	lli->lli_oc_deadline = cfs_time_shift(loc->loc_age);
+	cfs_list_add_tail(&lli->lli_oc_list, &loc->loc_head);
+	/* the close thread waits without a timeout while the cache is
+	 * empty, it has to start looking at the first handle */
+	wake = loc->loc_count == 1 || loc->loc_count > loc->loc_max;
+	spin_unlock(&loc->loc_lock);
+
+	if (wake && sbi->ll_lcq != NULL)
+		cfs_waitq_signal(&sbi->ll_lcq->lcq_waitq);
+}
+
+/* Take @inode out of the open cache, because its handle is used again or
+ * closed. Returns true if it was there. */
+bool ll_open_cache_del(struct inode *inode)
+{
+	struct ll_open_cache *loc = &ll_i2sbi(inode)->ll_open_cache;
+	struct ll_inode_info *lli = ll_i2info(inode);
+	bool                  cached = false;
+
+	if (cfs_list_empty(&lli->lli_oc_list))
+		return false;
+
+	spin_lock(&loc->loc_lock);
+	if (!cfs_list_empty(&lli->lli_oc_list)) {
+		cfs_list_del_init(&lli->lli_oc_list);
+		loc->loc_count--;
+		cached = true;
+	}
+	spin_unlock(&loc->loc_lock);
+
+	return cached;
+}
+
+/* Take the oldest inode off the open cache if its handles are due to be
+ * released. The inode cannot be freed while it is in the cache, closing its
+ * handles in ll_clear_inode() takes it out. */
+static struct inode *ll_open_cache_next(struct ll_open_cache *loc)
+{
+	struct ll_inode_info *lli;
+	struct inode         *inode = NULL;
+
+	spin_lock(&loc->loc_lock);
+	while (inode == NULL && !cfs_list_empty(&loc->loc_head)) {
+		lli = cfs_list_entry(loc->loc_head.next, struct ll_inode_info,
+				     lli_oc_list);
+		if (loc->loc_age != 0 && loc->loc_count <= loc->loc_max &&
+		    cfs_time_before(cfs_time_current(), lli->lli_oc_deadline))
+			break;
+
+		cfs_list_del_init(&lli->lli_oc_list);
+		loc->loc_count--;
+		inode = igrab(ll_info2i(lli));
+	}
+	spin_unlock(&loc->loc_lock);
+
+	return inode;
+}
+
+/* Cancel the OPEN lock of the idle read handle of @inode, the handle is
+ * closed by ll_md_blocking_ast() as the lock goes. */
+static void ll_open_cache_release(struct inode *inode)
+{
+	struct ll_inode_info *lli = ll_i2info(inode);
+	ldlm_policy_data_t    policy = {
+		.l_inodebits = { MDS_INODELOCK_OPEN } };
+	bool                  read;
+
+	mutex_lock(&lli->lli_och_mutex);
+	read = lli->lli_mds_read_och != NULL &&
+	       lli->lli_open_fd_read_count == 0;
+	mutex_unlock(&lli->lli_och_mutex);
+
+	CDEBUG(D_INODE, "release open handle of "DFID": read %d\n",
+	       PFID(ll_inode2fid(inode)), read);
+
+	if (read) {
+		md_cancel_unused(ll_i2mdexp(inode), ll_inode2fid(inode),
+				 &policy, LCK_CR, LCF_ASYNC, NULL);
+		cfs_atomic_inc(&ll_i2sbi(inode)->ll_open_cache.loc_expired);
+	}
+}
+
+static void ll_open_cache_expire(struct ll_open_cache *loc)
+{
+	struct inode *inode;
+
+	while ((inode = ll_open_cache_next(loc)) != NULL) {
+		ll_open_cache_release(inode);
+		iput(inode);
+	}
+}
+
 static int ll_close_thread(void *arg)
 {
         struct ll_close_queue *lcq = arg;
+	struct ll_open_cache  *loc = lcq->lcq_oc;
         ENTRY;
 
         {
@@ -361,12 +498,27 @@ static int ll_close_thread(void *arg)
                 struct l_wait_info lwi = { 0 };
                 struct ll_inode_info *lli;
                 struct inode *inode;
+		int timed;
+
+		/* look at the open cache every second while it has handles,
+		 * the first handle added or the cache being disabled ends a
+		 * wait without timeout */
+		timed = loc->loc_count > 0;
+		if (timed)
+			lwi = LWI_TIMEOUT(cfs_time_seconds(1), NULL, NULL);
 
                 l_wait_event_exclusive(lcq->lcq_waitq,
-                                       (lli = ll_close_next_lli(lcq)) != NULL,
+                                       (lli = ll_close_next_lli(lcq)) != NULL ||
+				       loc->loc_count > loc->loc_max ||
+				       (loc->loc_count > 0 &&
+					(!timed || loc->loc_age == 0)),
                                        &lwi);
-                if (IS_ERR(lli))
-                        break;
+		if (IS_ERR(lli))
+			break;
+
+		ll_open_cache_expire(loc);
+		if (lli == NULL)
+			continue;
 
                 inode = ll_info2i(lli);
                 CDEBUG(D_INFO, "done_writting for inode %lu/%u\n",
@@ -380,7 +532,8 @@ static int ll_close_thread(void *arg)
 	RETURN(0);
 }
 
-int ll_close_thread_start(struct ll_close_queue **lcq_ret)
+int ll_close_thread_start(struct ll_close_queue **lcq_ret,
+			  struct ll_open_cache *loc)
 {
         struct ll_close_queue *lcq;
         pid_t pid;
@@ -396,6 +549,7 @@ int ll_close_thread_start(struct ll_close_queue **lcq_ret)
 	CFS_INIT_LIST_HEAD(&lcq->lcq_head);
 	cfs_waitq_init(&lcq->lcq_waitq);
 	init_completion(&lcq->lcq_comp);
+	lcq->lcq_oc = loc;
 
 	pid = cfs_create_thread(ll_close_thread, lcq, 0);
 	if (pid < 0) {
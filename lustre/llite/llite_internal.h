@@ -193,6 +193,13 @@ struct ll_inode_info {
 			/* "opendir_pid" is the token when lookup/revalid
 			 * -- I am the owner of dir statahead. */
 			pid_t                           d_opendir_pid;
+			/* readdir-ahead: hash range of the last batch of
+			 * dir pages read from the MDS, protected by
+			 * lli_lock. Reaching the page at d_ra_start starts
+			 * the read of the batch beginning at d_ra_end. */
+			__u64				d_ra_start;
+			__u64				d_ra_end;
+			unsigned int			d_ra_pending:1;
 		} d;
 
 #define lli_readdir_mutex       u.d.d_readdir_mutex
@@ -201,6 +208,9 @@ struct ll_inode_info {
 #define lli_def_acl             u.d.d_def_acl
 #define lli_sa_lock             u.d.d_sa_lock
 #define lli_opendir_pid         u.d.d_opendir_pid
+#define lli_dir_ra_start	u.d.d_ra_start
+#define lli_dir_ra_end		u.d.d_ra_end
+#define lli_dir_ra_pending	u.d.d_ra_pending
 
 		/* for non-directory */
 		struct {
@@ -275,6 +285,12 @@ struct ll_inode_info {
 	struct mutex			lli_layout_mutex;
 	/* valid only inside LAYOUT ibits lock, protected by lli_layout_mutex */
 	__u32				lli_layout_gen;
+
+	/* on ll_open_cache::loc_head while the read open handle is
+	 * kept with nobody using it, protected by loc_lock */
+	cfs_list_t			lli_oc_list;
+	/* when the kept handle is released, in jiffies */
+	cfs_time_t			lli_oc_deadline;
 };
 
 /*
@@ -398,6 +414,8 @@ enum stats_track_type {
 #define LL_SBI_VERBOSE        0x10000 /* verbose mount/umount */
 #define LL_SBI_LAYOUT_LOCK    0x20000 /* layout lock support */
 #define LL_SBI_USER_FID2PATH  0x40000 /* allow fid2path by unprivileged users */
+#define LL_SBI_DIR_RA         0x80000 /* read next dir pages in background */
+#define LL_SBI_PARALLEL_DIO  0x100000 /* DIO to all stripes in one iteration */
 
 #define LL_SBI_FLAGS { 	\
 	"nolck",	\
@@ -417,7 +435,9 @@ enum stats_track_type {
 	"agl",		\
 	"verbose",	\
 	"layout",	\
-	"user_fid2path" }
+	"user_fid2path",\
+	"dir_ra",	\
+	"parallel_dio" }
 
 /* default value for ll_sb_info->contention_time */
 #define SBI_DEFAULT_CONTENTION_SECONDS     60
@@ -451,6 +471,52 @@ struct eacl_table {
 	cfs_list_t	et_entries[EE_HASHES];
 };
 
+/**
+ * Open handles for reading which nobody uses any more are kept for loc_age
+ * seconds after the last close, for as long as the OPEN lock granted with
+ * them is, so that opening the file again needs no RPC. Once
+ * more than loc_max are kept the oldest ones are released early; the lock
+ * LRU and its shrinker release them under memory pressure. loc_age == 0
+ * disables the cache.
+ */
+struct ll_open_cache {
+	spinlock_t		loc_lock;
+	cfs_list_t		loc_head;	/* least recently closed first */
+	unsigned int		loc_age;
+	unsigned int		loc_max;
+	unsigned int		loc_count;
+	cfs_atomic_t		loc_hits;	/* opens without an RPC */
+	cfs_atomic_t		loc_misses;	/* opens which sent one */
+	cfs_atomic_t		loc_expired;	/* released by the close thread */
+};
+
+#define LL_OC_AGE_DEF		0
+#define LL_OC_AGE_MAX		3600
+#define LL_OC_MAX_DEF		1024
+#define LL_OC_MAX_MAX		(1 << 20)
+
+#define LL_DIO_AIO_THREADS_DEF	32
+#define LL_DIO_AIO_THREADS_MAX	512
+
+/**
+ * Asynchronous direct I/O requests are queued here and carried out by a
+ * pool of "ll_dio_aio_NN" threads, created on demand up to
+ * ldq_max_threads, so that as many requests as there are threads are in
+ * flight at once. ldq_max_threads == 0 makes all direct I/O synchronous.
+ */
+struct ll_dio_queue {
+	spinlock_t		ldq_lock;
+	cfs_list_t		ldq_head;
+	cfs_waitq_t		ldq_waitq;
+	unsigned int		ldq_max_threads;
+	unsigned int		ldq_nr_threads;
+	unsigned int		ldq_nr_idle;
+	unsigned int		ldq_nr_waiting;	/* not picked up yet */
+	unsigned int		ldq_stopping:1;
+	cfs_atomic_t		ldq_nr_queued;	/* requests not completed */
+	cfs_atomic_t		ldq_total;	/* requests since mount */
+};
+
 struct ll_sb_info {
 	cfs_list_t		  ll_list;
 	/* this protects pglist and ra_info.  It isn't safe to
@@ -471,6 +537,8 @@ struct ll_sb_info {
 
         cfs_list_t                ll_orphan_dentry_list; /*please don't ask -p*/
         struct ll_close_queue    *ll_lcq;
+	struct ll_dio_queue	  ll_dio_queue;	/* async direct I/O workers */
+	struct ll_open_cache	  ll_open_cache; /* idle open handles */
 
         struct lprocfs_stats     *ll_stats; /* lprocfs stats counter */
 
@@ -511,6 +579,11 @@ struct ll_sb_info {
         atomic_t                  ll_sa_wrong;   /* statahead thread stopped for
                                                   * low hit ratio */
         atomic_t                  ll_agl_total;  /* AGL thread started count */
+	atomic_t		  ll_dir_ra_total; /* dir readahead started
+						    * count */
+	atomic_t		  ll_dir_ra_running; /* dir readahead threads
+						      * in flight */
+	cfs_waitq_t		  ll_dir_ra_waitq; /* wait for them at umount */
 
         dev_t                     ll_sdev_orig; /* save s_dev before assign for
                                                  * clustred nfs */
@@ -708,6 +781,8 @@ struct lookup_intent *ll_convert_intent(struct open_intent *oit,
 #endif
 struct dentry *ll_splice_alias(struct inode *inode, struct dentry *de);
 int ll_rmdir_entry(struct inode *dir, char *name, int namelen);
+int ll_bulk_unlink(struct inode *dir, const char *names, int count,
+		   __s32 *rcs);
 
 /* llite/rw.c */
 int ll_prepare_write(struct file *, struct page *, unsigned from, unsigned to);
@@ -905,6 +980,7 @@ struct ll_close_queue {
 	cfs_waitq_t		lcq_waitq;
 	struct completion	lcq_comp;
 	cfs_atomic_t		lcq_stop;
+	struct ll_open_cache	*lcq_oc;	/* expired by the close thread */
 };
 
 struct ccc_object *cl_inode2ccc(struct inode *inode);
@@ -1075,7 +1151,12 @@ static inline struct vvp_io *vvp_env_io(const struct lu_env *env)
 
 void ll_queue_done_writing(struct inode *inode, unsigned long flags);
 void ll_close_thread_shutdown(struct ll_close_queue *lcq);
-int ll_close_thread_start(struct ll_close_queue **lcq_ret);
+int ll_close_thread_start(struct ll_close_queue **lcq_ret,
+			  struct ll_open_cache *loc);
+void ll_open_cache_init(struct ll_open_cache *loc);
+void ll_open_cache_intent(struct inode *inode, struct lookup_intent *it);
+void ll_open_cache_add(struct inode *inode);
+bool ll_open_cache_del(struct inode *inode);
 
 /* llite/llite_mmap.c */
 typedef struct rb_root  rb_root_t;
@@ -1501,6 +1582,8 @@ static inline void cl_stats_tally(struct cl_device *dev, enum cl_req_type crt,
 extern ssize_t ll_direct_rw_pages(const struct lu_env *env, struct cl_io *io,
                                   int rw, struct inode *inode,
                                   struct ll_dio_pages *pv);
+void ll_dio_queue_init(struct ll_dio_queue *ldq);
+void ll_dio_queue_fini(struct ll_dio_queue *ldq);
 
 static inline int ll_file_nolock(const struct file *file)
 {
@@ -148,6 +148,17 @@ static struct ll_sb_info *ll_init_sbi(void)
         cfs_atomic_set(&sbi->ll_agl_total, 0);
         sbi->ll_flags |= LL_SBI_AGL_ENABLED;
 
+	ll_dio_queue_init(&sbi->ll_dio_queue);
+	ll_open_cache_init(&sbi->ll_open_cache);
+
+	/* readdir-ahead is enabled by default */
+	cfs_atomic_set(&sbi->ll_dir_ra_total, 0);
+	cfs_atomic_set(&sbi->ll_dir_ra_running, 0);
+	cfs_waitq_init(&sbi->ll_dir_ra_waitq);
+	sbi->ll_flags |= LL_SBI_DIR_RA;
+
+	sbi->ll_flags |= LL_SBI_PARALLEL_DIO;
+
         RETURN(sbi);
 }
 
@@ -222,7 +233,9 @@ static int client_common_fill_super(struct super_block *sb, char *md, char *dt,
 				  OBD_CONNECT_EINPROGRESS |
 				  OBD_CONNECT_JOBSTATS | OBD_CONNECT_LVB_TYPE |
 				  OBD_CONNECT_LAYOUTLOCK | OBD_CONNECT_PINGLESS |
-				  OBD_CONNECT_DISP_STRIPE;
+				  OBD_CONNECT_DISP_STRIPE | OBD_CONNECT_BL_BATCH |
+				  OBD_CONNECT_FLAGS2;
+	data->ocd_connect_flags2 = OBD_CONNECT2_MD_BATCH;
 
         if (sbi->ll_flags & LL_SBI_SOM_PREVIEW)
                 data->ocd_connect_flags |= OBD_CONNECT_SOM;
@@ -315,7 +328,7 @@ static int client_common_fill_super(struct super_block *sb, char *md, char *dt,
 
 		OBD_ALLOC_WAIT(buf, CFS_PAGE_SIZE);
 		obd_connect_flags2str(buf, CFS_PAGE_SIZE,
-				      valid ^ CLIENT_CONNECT_MDT_REQD, ",");
+				      valid ^ CLIENT_CONNECT_MDT_REQD, 0, ",");
 		LCONSOLE_ERROR_MSG(0x170, "Server %s does not support "
 				   "feature(s) needed for correct operation "
 				   "of this client (%s). Please upgrade "
@@ -414,7 +427,8 @@ static int client_common_fill_super(struct super_block *sb, char *md, char *dt,
                                   OBD_CONNECT_MAXBYTES |
 				  OBD_CONNECT_EINPROGRESS |
 				  OBD_CONNECT_JOBSTATS | OBD_CONNECT_LVB_TYPE |
-				  OBD_CONNECT_LAYOUTLOCK | OBD_CONNECT_PINGLESS;
+				  OBD_CONNECT_LAYOUTLOCK | OBD_CONNECT_PINGLESS |
+				  OBD_CONNECT_BL_BATCH;
 
         if (sbi->ll_flags & LL_SBI_SOM_PREVIEW)
                 data->ocd_connect_flags |= OBD_CONNECT_SOM;
@@ -554,7 +568,7 @@ static int client_common_fill_super(struct super_block *sb, char *md, char *dt,
                 GOTO(out_root, err);
         }
 
-        err = ll_close_thread_start(&sbi->ll_lcq);
+        err = ll_close_thread_start(&sbi->ll_lcq, &sbi->ll_open_cache);
         if (err) {
                 CERROR("cannot start close thread: rc %d\n", err);
                 GOTO(out_root, err);
@@ -742,6 +756,7 @@ void client_common_put_super(struct super_block *sb)
 #endif
 
         ll_close_thread_shutdown(sbi->ll_lcq);
+	ll_dio_queue_fini(&sbi->ll_dio_queue);
 
         cl_sb_fini(sb);
 
@@ -783,8 +798,16 @@ void ll_kill_super(struct super_block *sb)
          * because new kernels have cached s_dev and change sb->s_dev in
          * put_super not affected real removing devices */
 	if (sbi) {
+		struct l_wait_info lwi = { 0 };
+
 		sb->s_dev = sbi->ll_sdev_orig;
 		sbi->ll_umounting = 1;
+
+		/* The dir readahead threads hold directory inodes, they must
+		 * be gone before the VFS evicts the inodes. */
+		l_wait_event(sbi->ll_dir_ra_waitq,
+			     cfs_atomic_read(&sbi->ll_dir_ra_running) == 0,
+			     &lwi);
 	}
 	EXIT;
 }
@@ -993,6 +1016,7 @@ void ll_lli_init(struct ll_inode_info *lli)
 	lli->lli_has_smd = false;
 	lli->lli_layout_gen = LL_LAYOUT_GEN_NONE;
 	lli->lli_clob = NULL;
+	CFS_INIT_LIST_HEAD(&lli->lli_oc_list);
 
 	LASSERT(lli->lli_vfs_inode.i_mode != 0);
 	if (S_ISDIR(lli->lli_vfs_inode.i_mode)) {
@@ -1002,6 +1026,9 @@ void ll_lli_init(struct ll_inode_info *lli)
 		lli->lli_def_acl = NULL;
 		spin_lock_init(&lli->lli_sa_lock);
 		lli->lli_opendir_pid = 0;
+		lli->lli_dir_ra_start = MDS_DIR_END_OFF;
+		lli->lli_dir_ra_end = MDS_DIR_END_OFF;
+		lli->lli_dir_ra_pending = 0;
 	} else {
 		sema_init(&lli->lli_size_sem, 1);
 		lli->lli_size_sem_owner = NULL;
@@ -1288,6 +1315,7 @@ void ll_clear_inode(struct inode *inode)
                 ll_md_real_close(inode, FMODE_EXEC);
         if (lli->lli_mds_read_och)
                 ll_md_real_close(inode, FMODE_READ);
+	ll_open_cache_del(inode);
 
         if (S_ISLNK(inode->i_mode) && lli->lli_symlink_name) {
                 OBD_FREE(lli->lli_symlink_name,
@@ -664,10 +664,208 @@ static int ll_rd_statahead_stats(char *page, char **start, off_t off,
         return snprintf(page, count,
                         "statahead total: %u\n"
                         "statahead wrong: %u\n"
-                        "agl total: %u\n",
+                        "agl total: %u\n"
+			"dir readahead total: %u\n",
                         atomic_read(&sbi->ll_sa_total),
                         atomic_read(&sbi->ll_sa_wrong),
-                        atomic_read(&sbi->ll_agl_total));
+                        atomic_read(&sbi->ll_agl_total),
+			atomic_read(&sbi->ll_dir_ra_total));
+}
+
+static int ll_rd_dir_readahead(char *page, char **start, off_t off,
+			       int count, int *eof, void *data)
+{
+	struct super_block *sb = data;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+
+	return snprintf(page, count, "%u\n",
+			sbi->ll_flags & LL_SBI_DIR_RA ? 1 : 0);
+}
+
+static int ll_wr_dir_readahead(struct file *file, const char *buffer,
+			       unsigned long count, void *data)
+{
+	struct super_block *sb = data;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+	int val, rc;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val)
+		sbi->ll_flags |= LL_SBI_DIR_RA;
+	else
+		sbi->ll_flags &= ~LL_SBI_DIR_RA;
+
+	return count;
+}
+
+static int ll_rd_parallel_dio(char *page, char **start, off_t off,
+			      int count, int *eof, void *data)
+{
+	struct super_block *sb = data;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+
+	return snprintf(page, count, "%u\n",
+			sbi->ll_flags & LL_SBI_PARALLEL_DIO ? 1 : 0);
+}
+
+static int ll_wr_parallel_dio(struct file *file, const char *buffer,
+			      unsigned long count, void *data)
+{
+	struct super_block *sb = data;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+	int val, rc;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val)
+		sbi->ll_flags |= LL_SBI_PARALLEL_DIO;
+	else
+		sbi->ll_flags &= ~LL_SBI_PARALLEL_DIO;
+
+	return count;
+}
+
+static int ll_rd_dio_aio_max_threads(char *page, char **start, off_t off,
+				     int count, int *eof, void *data)
+{
+	struct super_block *sb = data;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+
+	return snprintf(page, count, "%u\n",
+			sbi->ll_dio_queue.ldq_max_threads);
+}
+
+static int ll_wr_dio_aio_max_threads(struct file *file, const char *buffer,
+				     unsigned long count, void *data)
+{
+	struct super_block *sb = data;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+	struct ll_dio_queue *ldq = &sbi->ll_dio_queue;
+	int val, rc;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val < 0 || val > LL_DIO_AIO_THREADS_MAX)
+		return -ERANGE;
+
+	/* running threads beyond the new limit stay until umount */
+	spin_lock(&ldq->ldq_lock);
+	ldq->ldq_max_threads = val;
+	spin_unlock(&ldq->ldq_lock);
+
+	return count;
+}
+
+static int ll_rd_dio_aio_stats(char *page, char **start, off_t off,
+			       int count, int *eof, void *data)
+{
+	struct super_block *sb = data;
+	struct ll_dio_queue *ldq = &ll_s2sbi(sb)->ll_dio_queue;
+	unsigned int threads;
+	unsigned int idle;
+
+	spin_lock(&ldq->ldq_lock);
+	threads = ldq->ldq_nr_threads;
+	idle = ldq->ldq_nr_idle;
+	spin_unlock(&ldq->ldq_lock);
+
+	return snprintf(page, count,
+			"threads: %u\n"
+			"idle: %u\n"
+			"in flight: %d\n"
+			"total: %d\n",
+			threads, idle, cfs_atomic_read(&ldq->ldq_nr_queued),
+			cfs_atomic_read(&ldq->ldq_total));
+}
+
+static int ll_rd_open_cache_age(char *page, char **start, off_t off,
+				int count, int *eof, void *data)
+{
+	struct super_block *sb = data;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+
+	return snprintf(page, count, "%u\n", sbi->ll_open_cache.loc_age);
+}
+
+static int ll_wr_open_cache_age(struct file *file, const char *buffer,
+				unsigned long count, void *data)
+{
+	struct super_block *sb = data;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+	int val, rc;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val < 0 || val > LL_OC_AGE_MAX)
+		return -ERANGE;
+
+	/* handles kept already keep their deadline, or are all released by
+	 * the close thread if the cache is disabled */
+	sbi->ll_open_cache.loc_age = val;
+	if (sbi->ll_lcq != NULL)
+		cfs_waitq_signal(&sbi->ll_lcq->lcq_waitq);
+
+	return count;
+}
+
+static int ll_rd_open_cache_max(char *page, char **start, off_t off,
+				int count, int *eof, void *data)
+{
+	struct super_block *sb = data;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+
+	return snprintf(page, count, "%u\n", sbi->ll_open_cache.loc_max);
+}
+
+static int ll_wr_open_cache_max(struct file *file, const char *buffer,
+				unsigned long count, void *data)
+{
+	struct super_block *sb = data;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+	int val, rc;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val < 1 || val > LL_OC_MAX_MAX)
+		return -ERANGE;
+
+	sbi->ll_open_cache.loc_max = val;
+	if (sbi->ll_lcq != NULL)
+		cfs_waitq_signal(&sbi->ll_lcq->lcq_waitq);
+
+	return count;
+}
+
+static int ll_rd_open_cache_stats(char *page, char **start, off_t off,
+				  int count, int *eof, void *data)
+{
+	struct super_block *sb = data;
+	struct ll_open_cache *loc = &ll_s2sbi(sb)->ll_open_cache;
+	unsigned int cached;
+
+	spin_lock(&loc->loc_lock);
+	cached = loc->loc_count;
+	spin_unlock(&loc->loc_lock);
+
+	return snprintf(page, count,
+			"cached: %u\n"
+			"hits: %d\n"
+			"misses: %d\n"
+			"expired: %d\n",
+			cached, cfs_atomic_read(&loc->loc_hits),
+			cfs_atomic_read(&loc->loc_misses),
+			cfs_atomic_read(&loc->loc_expired));
 }
 
 static int ll_rd_lazystatfs(char *page, char **start, off_t off,
@@ -830,6 +1028,14 @@ static struct lprocfs_vars lprocfs_llite_obd_vars[] = {
         { "statahead_max",    ll_rd_statahead_max, ll_wr_statahead_max, 0 },
         { "statahead_agl",    ll_rd_statahead_agl, ll_wr_statahead_agl, 0 },
         { "statahead_stats",  ll_rd_statahead_stats, 0, 0 },
+	{ "dir_readahead",    ll_rd_dir_readahead, ll_wr_dir_readahead, 0 },
+	{ "dio_aio_max_threads", ll_rd_dio_aio_max_threads,
+				 ll_wr_dio_aio_max_threads, 0 },
+	{ "dio_aio_stats",    ll_rd_dio_aio_stats, 0, 0 },
+	{ "parallel_dio",     ll_rd_parallel_dio, ll_wr_parallel_dio, 0 },
+	{ "open_cache_age",   ll_rd_open_cache_age, ll_wr_open_cache_age, 0 },
+	{ "open_cache_max",   ll_rd_open_cache_max, ll_wr_open_cache_max, 0 },
+	{ "open_cache_stats", ll_rd_open_cache_stats, 0, 0 },
         { "lazystatfs",       ll_rd_lazystatfs, ll_wr_lazystatfs, 0 },
         { "max_easize",       ll_rd_maxea_size, 0, 0 },
 	{ "default_easize",   ll_rd_defaultea_size, 0, 0 },
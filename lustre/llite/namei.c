@@ -541,6 +541,7 @@ static struct dentry *ll_lookup_it(struct inode *parent, struct dentry *dentry,
         if (!IS_POSIXACL(parent) || !exp_connect_umask(ll_i2mdexp(parent)))
                 it->it_create_mode &= ~cfs_curproc_umask();
 
+	ll_open_cache_intent(parent, it);
         rc = md_intent_lock(ll_i2mdexp(parent), op_data, NULL, 0, it,
                             lookup_flags, &req, ll_md_blocking_ast, 0);
         ll_finish_md_op_data(op_data);
@@ -1248,10 +1249,26 @@ out:
  * Instead, ll_ddelete() and ll_d_iput() will update it based upon if there
  * is any lock existing. They will recycle dentries and inodes based upon locks
  * too. b=20433 */
+/* send an unlink prepared in \a op_data and account for it */
+static int ll_md_unlink(struct inode *dir, struct md_op_data *op_data)
+{
+	struct ptlrpc_request *request = NULL;
+	int rc;
+
+	rc = md_unlink(ll_i2sbi(dir)->ll_md_exp, op_data, &request);
+	if (rc == 0) {
+		ll_update_times(request, dir);
+		ll_stats_ops_tally(ll_i2sbi(dir), LPROC_LL_UNLINK, 1);
+
+		rc = ll_objects_destroy(request, dir);
+	}
+	ptlrpc_req_finished(request);
+	return rc;
+}
+
 static int ll_unlink_generic(struct inode *dir, struct dentry *dparent,
                              struct dentry *dchild, struct qstr *name)
 {
-        struct ptlrpc_request *request = NULL;
         struct md_op_data *op_data;
         int rc;
         ENTRY;
@@ -1272,18 +1289,76 @@ static int ll_unlink_generic(struct inode *dir, struct dentry *dparent,
 
 	ll_get_child_fid(dir, name, &op_data->op_fid3);
 	op_data->op_fid2 = op_data->op_fid3;
-	rc = md_unlink(ll_i2sbi(dir)->ll_md_exp, op_data, &request);
+	rc = ll_md_unlink(dir, op_data);
 	ll_finish_md_op_data(op_data);
-	if (rc)
-		GOTO(out, rc);
+	RETURN(rc);
+}
 
-        ll_update_times(request, dir);
-        ll_stats_ops_tally(ll_i2sbi(dir), LPROC_LL_UNLINK, 1);
+/**
+ * Unlink \a count entries of \a dir given as NUL-terminated names packed
+ * back to back in \a names, storing the result for each in \a rcs.
+ *
+ * The unlinks go to the MDT in REINT_BATCH requests; if the MDT cannot do
+ * batches, or an entry turns out to be on another MDT, it is unlinked on its
+ * own. Like ll_rmdir_entry() this works below the VFS, the dentries of the
+ * unlinked entries go away with their LOOKUP locks.
+ */
+int ll_bulk_unlink(struct inode *dir, const char *names, int count,
+		   __s32 *rcs)
+{
+	struct ll_sb_info   *sbi = ll_i2sbi(dir);
+	struct md_batch_op  *ops;
+	struct md_op_data   *op_data;
+	struct qstr          qstr;
+	int                  done = 0, rc = 0, i;
+	ENTRY;
 
-        rc = ll_objects_destroy(request, dir);
- out:
-        ptlrpc_req_finished(request);
-        RETURN(rc);
+	CDEBUG(D_VFSTRACE, "VFS Op:%d names,dir=%lu/%u(%p)\n",
+	       count, dir->i_ino, dir->i_generation, dir);
+
+	OBD_ALLOC_LARGE(ops, count * sizeof(*ops));
+	if (ops == NULL)
+		RETURN(-ENOMEM);
+
+	for (i = 0; i < count; i++) {
+		qstr.name = (const unsigned char *)names;
+		qstr.len = strlen(names);
+		qstr.hash = full_name_hash(qstr.name, qstr.len);
+
+		op_data = ll_prep_md_op_data(NULL, dir, NULL, names, qstr.len,
+					     0, LUSTRE_OPC_ANY, NULL);
+		names += qstr.len + 1;
+		if (IS_ERR(op_data))
+			GOTO(out, rc = PTR_ERR(op_data));
+
+		ll_get_child_fid(dir, &qstr, &op_data->op_fid3);
+		op_data->op_fid2 = op_data->op_fid3;
+		ops[i].mbo_opc = REINT_UNLINK;
+		ops[i].mbo_rc = -EIO;
+		ops[i].mbo_data = op_data;
+	}
+
+	rc = md_batch(sbi->ll_md_exp, ops, count);
+	for (i = 0; i < count; i++) {
+		if (rc == -EOPNOTSUPP || ops[i].mbo_rc == -EREMOTE)
+			ops[i].mbo_rc = ll_md_unlink(dir, ops[i].mbo_data);
+		else if (rc == 0 && ops[i].mbo_rc == 0)
+			done++;
+		rcs[i] = ops[i].mbo_rc;
+	}
+	if (rc == -EOPNOTSUPP)
+		rc = 0;
+
+	/* the batch reply has no times for the directory, they are fetched
+	 * again once the UPDATE lock cancelled by the batch is taken back */
+	if (done > 0)
+		ll_stats_ops_tally(sbi, LPROC_LL_UNLINK, done);
+	EXIT;
+out:
+	for (i = 0; i < count && ops[i].mbo_data != NULL; i++)
+		ll_finish_md_op_data(ops[i].mbo_data);
+	OBD_FREE_LARGE(ops, count * sizeof(*ops));
+	return rc;
 }
 
 static int ll_rename_generic(struct inode *src, struct dentry *src_dparent,
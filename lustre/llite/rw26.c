@@ -59,6 +59,7 @@
 #include <asm/uaccess.h>
 #include <linux/mm.h>
 #include <linux/pagemap.h>
+#include <linux/aio.h>
 
 #define DEBUG_SUBSYSTEM S_LLITE
 
@@ -237,15 +238,18 @@ static void ll_free_user_pages(struct page **pages, int npages, int do_dirty)
         OBD_FREE_LARGE(pages, npages * sizeof(*pages));
 }
 
-ssize_t ll_direct_rw_pages(const struct lu_env *env, struct cl_io *io,
-                           int rw, struct inode *inode,
-                           struct ll_dio_pages *pv)
+/**
+ * Set up the transient pages for \a pv in io->ci_queue, the caller holds
+ * the inode mutex. Returns the number of pages to transfer, or an error.
+ */
+static int ll_dio_pages_prep(const struct lu_env *env, struct cl_io *io,
+			     int rw, struct ll_dio_pages *pv)
 {
         struct cl_page    *clp;
         struct cl_2queue  *queue;
         struct cl_object  *obj = io->ci_obj;
         int i;
-        ssize_t rc = 0;
+        int rc = 0;
         loff_t file_offset  = pv->ldp_start_offset;
         long size           = pv->ldp_size;
         int page_count      = pv->ldp_nr;
@@ -327,19 +331,36 @@ ssize_t ll_direct_rw_pages(const struct lu_env *env, struct cl_io *io,
                 size -= page_size;
                 file_offset += page_size;
         }
+	RETURN(rc ? : io_pages);
+}
 
-        if (rc == 0 && io_pages) {
-                rc = cl_io_submit_sync(env, io,
-                                       rw == READ ? CRT_READ : CRT_WRITE,
-				       queue, 0);
-        }
-        if (rc == 0)
-                rc = pv->ldp_size;
+/* Release the transient pages, the caller holds the inode mutex. */
+static void ll_dio_pages_fini(const struct lu_env *env, struct cl_io *io)
+{
+	struct cl_2queue *queue = &io->ci_queue;
 
-        cl_2queue_discard(env, io, queue);
-        cl_2queue_disown(env, io, queue);
-        cl_2queue_fini(env, queue);
-        RETURN(rc);
+	cl_2queue_discard(env, io, queue);
+	cl_2queue_disown(env, io, queue);
+	cl_2queue_fini(env, queue);
+}
+
+ssize_t ll_direct_rw_pages(const struct lu_env *env, struct cl_io *io,
+                           int rw, struct inode *inode,
+                           struct ll_dio_pages *pv)
+{
+	ssize_t rc;
+	ENTRY;
+
+	rc = ll_dio_pages_prep(env, io, rw, pv);
+	if (rc > 0)
+		rc = cl_io_submit_sync(env, io,
+				       rw == READ ? CRT_READ : CRT_WRITE,
+				       &io->ci_queue, 0);
+	if (rc == 0)
+		rc = pv->ldp_size;
+
+	ll_dio_pages_fini(env, io);
+	RETURN(rc);
 }
 EXPORT_SYMBOL(ll_direct_rw_pages);
 
@@ -372,6 +393,320 @@ static ssize_t ll_direct_IO_26_seg(const struct lu_env *env, struct cl_io *io,
  * up to 22MB for 128kB kmalloc and up to 682MB for 4MB kmalloc. */
 #define MAX_DIO_SIZE ((MAX_MALLOC / sizeof(struct brw_page) * CFS_PAGE_SIZE) & \
 		      ~(DT_MAX_BRW_SIZE - 1))
+
+/**
+ * An asynchronous direct I/O request: user pages are pinned by the caller of
+ * io_submit(), the transfer is done by an ll_dio_aio thread, which completes
+ * the kiocb.
+ */
+struct ll_dio_aio {
+	cfs_list_t	  lda_linkage;
+	struct kiocb	 *lda_iocb;
+	struct inode	 *lda_inode;
+	int		  lda_rw;
+	loff_t		  lda_offset;
+	size_t		  lda_size;
+	struct page	**lda_pages;
+	int		  lda_nr_pages;
+	int		  lda_max_pages;
+};
+
+#define LL_DIO_AIO_SCOPE "dio_aio"
+
+static void ll_dio_aio_do(struct ll_dio_aio *aio)
+{
+	struct inode		*inode = aio->lda_inode;
+	struct cl_object	*obj = ll_i2info(inode)->lli_clob;
+	struct ll_dio_pages	 pvec = { .ldp_pages	    = aio->lda_pages,
+					  .ldp_nr	    = aio->lda_nr_pages,
+					  .ldp_size	    = aio->lda_size,
+					  .ldp_offsets	    = NULL,
+					  .ldp_start_offset = aio->lda_offset };
+	struct cl_lock_descr	*descr;
+	struct cl_lock		*lock;
+	struct lu_env		*env;
+	struct cl_io		*io;
+	ssize_t			 result;
+	int			 refcheck;
+	ENTRY;
+
+	env = cl_env_get(&refcheck);
+	if (IS_ERR(env))
+		GOTO(out, result = PTR_ERR(env));
+
+	io = ccc_env_thread_io(env);
+	io->ci_obj = obj;
+	result = cl_io_init(env, io, CIT_MISC, obj);
+	if (result != 0)
+		GOTO(out_io, result = result < 0 ? result : -EIO);
+
+	/* the same extent lock a synchronous read or write of this range
+	 * would take in vvp_io_rw_lock() */
+	descr = &ccc_env_info(env)->cti_descr;
+	descr->cld_obj = obj;
+	descr->cld_start = cl_index(obj, aio->lda_offset);
+	descr->cld_end = cl_index(obj, aio->lda_offset + aio->lda_size - 1);
+	descr->cld_mode = aio->lda_rw == WRITE ? CLM_WRITE : CLM_READ;
+	descr->cld_gid = 0;
+	descr->cld_enq_flags = 0;
+	lock = cl_lock_request(env, io, descr, LL_DIO_AIO_SCOPE, cfs_current());
+	if (IS_ERR(lock))
+		GOTO(out_io, result = PTR_ERR(lock));
+
+	/* Inode mutex is needed to operate transient pages, but not for the
+	 * transfer itself: the extent lock serializes it against other I/O
+	 * to the range, and transient pages are not in the page tree. */
+	mutex_lock(&inode->i_mutex);
+	result = ll_dio_pages_prep(env, io, aio->lda_rw, &pvec);
+	mutex_unlock(&inode->i_mutex);
+	if (result > 0)
+		result = cl_io_submit_sync(env, io, aio->lda_rw == READ ?
+					   CRT_READ : CRT_WRITE,
+					   &io->ci_queue, 0);
+	if (result == 0)
+		result = aio->lda_size;
+
+	mutex_lock(&inode->i_mutex);
+	ll_dio_pages_fini(env, io);
+	if (result > 0 && aio->lda_rw == WRITE) {
+		struct lov_stripe_md	*lsm;
+		loff_t			 end = aio->lda_offset + result;
+
+		if (end > i_size_read(inode))
+			cl_isize_write(inode, end);
+
+		lsm = ccc_inode_lsm_get(inode);
+		LASSERT(lsm != NULL);
+		lov_stripe_lock(lsm);
+		obd_adjust_kms(ll_i2dtexp(inode), lsm, end, 0);
+		lov_stripe_unlock(lsm);
+		ccc_inode_lsm_put(inode, lsm);
+	}
+	mutex_unlock(&inode->i_mutex);
+
+	cl_unuse(env, lock);
+	cl_lock_release(env, lock, LL_DIO_AIO_SCOPE, cfs_current());
+out_io:
+	cl_io_fini(env, io);
+	cl_env_put(env, &refcheck);
+out:
+	CDEBUG(D_VFSTRACE, "async %s "DFID" [%lld, %lld): rc = %zd\n",
+	       aio->lda_rw == WRITE ? "write" : "read",
+	       PFID(ll_inode2fid(inode)), aio->lda_offset,
+	       aio->lda_offset + (loff_t)aio->lda_size, result);
+
+	ll_free_user_pages(aio->lda_pages, aio->lda_max_pages,
+			   aio->lda_rw == READ);
+	/* once the iocb completes, the file may be closed and unmounted */
+	iput(inode);
+	aio_complete(aio->lda_iocb, result, 0);
+	OBD_FREE_PTR(aio);
+	EXIT;
+}
+
+static struct ll_dio_aio *ll_dio_aio_next(struct ll_dio_queue *ldq)
+{
+	struct ll_dio_aio *aio = NULL;
+
+	spin_lock(&ldq->ldq_lock);
+	if (!cfs_list_empty(&ldq->ldq_head)) {
+		aio = cfs_list_entry(ldq->ldq_head.next, struct ll_dio_aio,
+				     lda_linkage);
+		cfs_list_del_init(&aio->lda_linkage);
+		ldq->ldq_nr_waiting--;
+		ldq->ldq_nr_idle--;
+	} else if (ldq->ldq_stopping) {
+		aio = ERR_PTR(-ESHUTDOWN);
+	}
+	spin_unlock(&ldq->ldq_lock);
+	return aio;
+}
+
+static int ll_dio_aio_thread(void *arg)
+{
+	struct ll_dio_queue	*ldq = arg;
+	struct ll_dio_aio	*aio;
+	struct l_wait_info	 lwi = { 0 };
+	ENTRY;
+
+	{
+		char name[CFS_CURPROC_COMM_MAX];
+
+		spin_lock(&ldq->ldq_lock);
+		snprintf(name, sizeof(name), "ll_dio_aio_%02u",
+			 ldq->ldq_nr_threads - 1);
+		spin_unlock(&ldq->ldq_lock);
+		cfs_daemonize(name);
+	}
+
+	while (1) {
+		l_wait_event_exclusive(ldq->ldq_waitq,
+				       (aio = ll_dio_aio_next(ldq)) != NULL,
+				       &lwi);
+		if (IS_ERR(aio))
+			break;
+
+		ll_dio_aio_do(aio);
+		cfs_atomic_dec(&ldq->ldq_nr_queued);
+
+		spin_lock(&ldq->ldq_lock);
+		ldq->ldq_nr_idle++;
+		spin_unlock(&ldq->ldq_lock);
+	}
+
+	spin_lock(&ldq->ldq_lock);
+	ldq->ldq_nr_idle--;
+	ldq->ldq_nr_threads--;
+	spin_unlock(&ldq->ldq_lock);
+	/* ll_dio_queue_fini() waits on the same queue */
+	cfs_waitq_broadcast(&ldq->ldq_waitq);
+	RETURN(0);
+}
+
+void ll_dio_queue_init(struct ll_dio_queue *ldq)
+{
+	spin_lock_init(&ldq->ldq_lock);
+	CFS_INIT_LIST_HEAD(&ldq->ldq_head);
+	cfs_waitq_init(&ldq->ldq_waitq);
+	ldq->ldq_max_threads = LL_DIO_AIO_THREADS_DEF;
+	ldq->ldq_nr_threads = 0;
+	ldq->ldq_nr_idle = 0;
+	ldq->ldq_nr_waiting = 0;
+	ldq->ldq_stopping = 0;
+	cfs_atomic_set(&ldq->ldq_nr_queued, 0);
+	cfs_atomic_set(&ldq->ldq_total, 0);
+}
+
+void ll_dio_queue_fini(struct ll_dio_queue *ldq)
+{
+	struct l_wait_info lwi = { 0 };
+
+	spin_lock(&ldq->ldq_lock);
+	ldq->ldq_stopping = 1;
+	spin_unlock(&ldq->ldq_lock);
+	cfs_waitq_broadcast(&ldq->ldq_waitq);
+
+	l_wait_event(ldq->ldq_waitq, ldq->ldq_nr_threads == 0, &lwi);
+	LASSERT(cfs_list_empty(&ldq->ldq_head));
+}
+
+/**
+ * Hand \a aio to a worker, starting a new one if all are busy and the
+ * limit allows. Fails only if there is no worker at all to run it.
+ */
+static int ll_dio_aio_queue(struct ll_dio_queue *ldq, struct ll_dio_aio *aio)
+{
+	int start = 0;
+	int rc;
+
+	spin_lock(&ldq->ldq_lock);
+	if (ldq->ldq_stopping) {
+		spin_unlock(&ldq->ldq_lock);
+		return -ESHUTDOWN;
+	}
+	/* idle threads which have not picked up a request yet are taken */
+	if (ldq->ldq_nr_waiting >= ldq->ldq_nr_idle &&
+	    ldq->ldq_nr_threads < ldq->ldq_max_threads) {
+		ldq->ldq_nr_threads++;
+		ldq->ldq_nr_idle++;
+		start = 1;
+	}
+	if (ldq->ldq_nr_threads == 0) {
+		spin_unlock(&ldq->ldq_lock);
+		return -EAGAIN;
+	}
+	cfs_list_add_tail(&aio->lda_linkage, &ldq->ldq_head);
+	ldq->ldq_nr_waiting++;
+	cfs_atomic_inc(&ldq->ldq_nr_queued);
+	cfs_atomic_inc(&ldq->ldq_total);
+	spin_unlock(&ldq->ldq_lock);
+
+	if (start) {
+		rc = cfs_create_thread(ll_dio_aio_thread, ldq, 0);
+		if (rc < 0) {
+			CERROR("cannot start ll_dio_aio thread: rc = %d\n", rc);
+			spin_lock(&ldq->ldq_lock);
+			ldq->ldq_nr_threads--;
+			ldq->ldq_nr_idle--;
+			if (ldq->ldq_nr_threads == 0) {
+				/* nobody to run it, take it back */
+				cfs_list_del_init(&aio->lda_linkage);
+				ldq->ldq_nr_waiting--;
+				cfs_atomic_dec(&ldq->ldq_nr_queued);
+				spin_unlock(&ldq->ldq_lock);
+				return rc;
+			}
+			spin_unlock(&ldq->ldq_lock);
+		}
+	}
+	cfs_waitq_signal(&ldq->ldq_waitq);
+	return 0;
+}
+
+/**
+ * Start an asynchronous direct I/O for \a iocb and return -EIOCBQUEUED, or
+ * return -EAGAIN if the request has to be done synchronously: vectored
+ * requests, requests larger than MAX_DIO_SIZE, user buffers which cannot be
+ * pinned at once, or when no worker can be started.
+ */
+static ssize_t ll_direct_IO_26_async(int rw, struct kiocb *iocb,
+				     const struct iovec *iov,
+				     unsigned long nr_segs, loff_t file_offset,
+				     long count)
+{
+	struct inode		*inode = iocb->ki_filp->f_mapping->host;
+	struct ll_dio_queue	*ldq = &ll_i2sbi(inode)->ll_dio_queue;
+	struct ll_dio_aio	*aio;
+	int			 rc;
+	ENTRY;
+
+	if (nr_segs != 1 || count > MAX_DIO_SIZE || ldq->ldq_max_threads == 0)
+		RETURN(-EAGAIN);
+
+	if (rw == READ) {
+		loff_t size = i_size_read(inode);
+
+		if (file_offset >= size)
+			RETURN(0);
+		if (file_offset + count > size)
+			count = size - file_offset;
+	}
+
+	OBD_ALLOC_PTR(aio);
+	if (aio == NULL)
+		RETURN(-EAGAIN);
+
+	rc = ll_get_user_pages(rw, (unsigned long)iov->iov_base, count,
+			       &aio->lda_pages, &aio->lda_max_pages);
+	if (rc == 0)
+		GOTO(out, rc = -EFAULT);
+	if (rc < 0)
+		GOTO(out, rc = -EAGAIN);
+	if (rc < aio->lda_max_pages) {
+		ll_free_user_pages(aio->lda_pages, aio->lda_max_pages, 0);
+		GOTO(out, rc = -EAGAIN);
+	}
+
+	CFS_INIT_LIST_HEAD(&aio->lda_linkage);
+	aio->lda_iocb = iocb;
+	aio->lda_inode = igrab(inode);
+	aio->lda_rw = rw;
+	aio->lda_offset = file_offset;
+	aio->lda_size = count;
+	aio->lda_nr_pages = rc;
+
+	rc = ll_dio_aio_queue(ldq, aio);
+	if (rc < 0) {
+		ll_free_user_pages(aio->lda_pages, aio->lda_max_pages, 0);
+		iput(inode);
+		GOTO(out, rc = -EAGAIN);
+	}
+	RETURN(-EIOCBQUEUED);
+out:
+	OBD_FREE_PTR(aio);
+	RETURN(rc);
+}
+
 static ssize_t ll_direct_IO_26(int rw, struct kiocb *iocb,
                                const struct iovec *iov, loff_t file_offset,
                                unsigned long nr_segs)
@@ -380,7 +715,6 @@ static ssize_t ll_direct_IO_26(int rw, struct kiocb *iocb,
         struct cl_io *io;
         struct file *file = iocb->ki_filp;
         struct inode *inode = file->f_mapping->host;
-        struct ccc_object *obj = cl_inode2ccc(inode);
         long count = iov_length(iov, nr_segs);
         long tot_bytes = 0, result = 0;
         struct ll_inode_info *lli = ll_i2info(inode);
@@ -414,6 +748,24 @@ static ssize_t ll_direct_IO_26(int rw, struct kiocb *iocb,
         io = ccc_env_io(env)->cui_cl.cis_io;
         LASSERT(io != NULL);
 
+	/* The iocb of an asynchronous request completes with the bytes of
+	 * this call only, so it has to be the whole I/O: not the case when
+	 * the I/O is split at stripe boundaries, e.g. for O_APPEND or
+	 * without parallel_dio. The worker takes a plain extent lock of its
+	 * own, which a lockless I/O would not take at all, and which would
+	 * wait for the group lock of this very file descriptor. */
+	if (!is_sync_kiocb(iocb) && io->ci_nob == 0 && !io->ci_continue &&
+	    io->ci_lockreq != CILR_NEVER &&
+	    !(LUSTRE_FPRIVATE(file)->fd_flags & LL_FILE_GROUP_LOCKED)) {
+		result = ll_direct_IO_26_async(rw, iocb, iov, nr_segs,
+					       file_offset, count);
+		if (result != -EAGAIN) {
+			cl_env_put(env, &refcheck);
+			RETURN(result);
+		}
+		result = 0;
+	}
+
 	/* 0. Need locking between buffered and direct access. and race with
 	 *    size changing by concurrent truncates and writes.
 	 * 1. Need inode mutex to operate transient pages.
@@ -421,7 +773,6 @@ static ssize_t ll_direct_IO_26(int rw, struct kiocb *iocb,
 	if (rw == READ)
 		mutex_lock(&inode->i_mutex);
 
-        LASSERT(obj->cob_transient_pages == 0);
         for (seg = 0; seg < nr_segs; seg++) {
                 long iov_left = iov[seg].iov_len;
                 unsigned long user_addr = (unsigned long)iov[seg].iov_base;
@@ -481,7 +832,6 @@ static ssize_t ll_direct_IO_26(int rw, struct kiocb *iocb,
                 }
         }
 out:
-	LASSERT(obj->cob_transient_pages == 0);
 	if (rw == READ)
 		mutex_unlock(&inode->i_mutex);
 
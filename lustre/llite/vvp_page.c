@@ -484,6 +484,12 @@ static int vvp_transient_page_is_vmlocked(const struct lu_env *env,
 	struct inode    *inode = ccc_object_inode(slice->cpl_obj);
 	int	locked;
 
+	/* Transient pages are not in the page tree, only the direct I/O
+	 * which created them can reach them. The asynchronous direct I/O
+	 * drops the inode mutex while its pages are in transfer. */
+	if (slice->cpl_page->cp_sync_io != NULL)
+		return -EBUSY;
+
 	locked = !mutex_trylock(&inode->i_mutex);
 	if (!locked)
 		mutex_unlock(&inode->i_mutex);
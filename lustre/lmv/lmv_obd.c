@@ -2159,6 +2159,70 @@ retry:
 	goto retry;
 }
 
+/*
+ * A batch is only sent as a whole, to the MDT of the parent of the creates
+ * and the setattr targets and of the unlinked children; anything which
+ * spreads over several MDTs gets -EOPNOTSUPP and is up to the caller.
+ */
+static int lmv_batch(struct obd_export *exp, struct md_batch_op *ops,
+		     int count)
+{
+	struct obd_device       *obd = exp->exp_obd;
+	struct lmv_obd          *lmv = &obd->u.lmv;
+	struct lmv_tgt_desc     *tgt = NULL;
+	struct lmv_tgt_desc     *tmp;
+	struct md_op_data       *op_data;
+	struct lu_fid           *fid;
+	int                      rc, i;
+	ENTRY;
+
+	rc = lmv_check_connect(obd);
+	if (rc)
+		RETURN(rc);
+
+	for (i = 0; i < count; i++) {
+		op_data = ops[i].mbo_data;
+		fid = &op_data->op_fid1;
+		if (ops[i].mbo_opc == REINT_UNLINK &&
+		    !fid_is_zero(&op_data->op_fid2))
+			fid = &op_data->op_fid2;
+
+		tmp = lmv_locate_mds(lmv, op_data, fid);
+		if (IS_ERR(tmp))
+			RETURN(PTR_ERR(tmp));
+		if (tgt != NULL && tmp != tgt)
+			RETURN(-EOPNOTSUPP);
+		tgt = tmp;
+
+		op_data->op_fsuid = cfs_curproc_fsuid();
+		op_data->op_fsgid = cfs_curproc_fsgid();
+		op_data->op_cap = cfs_curproc_cap_pack();
+
+		switch (ops[i].mbo_opc) {
+		case REINT_CREATE:
+			op_data->op_flags |= MF_MDC_CANCEL_FID1;
+			rc = lmv_fid_alloc(exp, &op_data->op_fid2, op_data);
+			if (rc)
+				RETURN(rc);
+			break;
+		case REINT_UNLINK:
+			op_data->op_flags |= MF_MDC_CANCEL_FID1 |
+					     MF_MDC_CANCEL_FID3;
+			break;
+		default:
+			op_data->op_flags |= MF_MDC_CANCEL_FID1;
+			break;
+		}
+	}
+	if (tgt == NULL)
+		RETURN(0);
+
+	CDEBUG(D_INODE, "batch of %d ops -> mds #%d\n", count, tgt->ltd_idx);
+
+	rc = md_batch(tgt->ltd_exp, ops, count);
+	RETURN(rc);
+}
+
 static int lmv_precleanup(struct obd_device *obd, enum obd_cleanup_stage stage)
 {
         struct lmv_obd *lmv = &obd->u.lmv;
@@ -2735,7 +2799,8 @@ struct md_ops lmv_md_ops = {
         .m_unpack_capa          = lmv_unpack_capa,
         .m_get_remote_perm      = lmv_get_remote_perm,
         .m_intent_getattr_async = lmv_intent_getattr_async,
-        .m_revalidate_lock      = lmv_revalidate_lock
+        .m_revalidate_lock      = lmv_revalidate_lock,
+	.m_batch                = lmv_batch
 };
 
 int __init lmv_init(void)
@@ -437,6 +437,20 @@ static int lov_io_rw_iter_init(const struct lu_env *env,
         LASSERT(io->ci_type == CIT_READ || io->ci_type == CIT_WRITE);
         ENTRY;
 
+	/* direct io to several stripes: one iteration for the whole range,
+	 * the sub-ios are submitted together by lov_io_submit() */
+	if (lio->lis_nr_subios != 1 && io->ci_parallel_dio &&
+	    !cl_io_is_append(io)) {
+		io->ci_continue = 0;
+		io->u.ci_rw.crw_count = lio->lis_io_endpos -
+					io->u.ci_rw.crw_pos;
+		lio->lis_pos    = io->u.ci_rw.crw_pos;
+		lio->lis_endpos = lio->lis_io_endpos;
+		CDEBUG(D_VFSTRACE, "parallel dio: ["LPU64", "LPU64")\n",
+		       lio->lis_pos, lio->lis_endpos);
+		RETURN(lov_io_iter_init(env, ios));
+	}
+
         /* fast path for common case. */
         if (lio->lis_nr_subios != 1 && !cl_io_is_append(io)) {
 
@@ -76,6 +76,42 @@ static int mdc_wr_max_rpcs_in_flight(struct file *file, const char *buffer,
         return count;
 }
 
+static int mdc_rd_batch_stats(char *page, char **start, off_t off,
+			      int count, int *eof, void *data)
+{
+	struct obd_device    *dev = data;
+	struct obd_histogram *hist = &dev->u.cli.cl_batch_ops_hist;
+	unsigned long         tot, cum = 0, n;
+	struct timeval        now;
+	int                   i, rc;
+
+	cfs_gettimeofday(&now);
+	tot = lprocfs_oh_sum(hist);
+
+	*eof = 1;
+	rc = snprintf(page, count,
+		      "snapshot_time:         %lu.%lu (secs.usecs)\n"
+		      "ops per rpc           rpcs   %% cum %%\n",
+		      now.tv_sec, now.tv_usec);
+	for (i = 0; i < OBD_HIST_MAX && cum < tot && rc < count; i++) {
+		n = hist->oh_buckets[i];
+		cum += n;
+		rc += snprintf(page + rc, count - rc,
+			       "%d:\t\t%10lu %3lu %3lu\n", 1 << i, n,
+			       n * 100 / tot, cum * 100 / tot);
+	}
+	return rc;
+}
+
+static int mdc_wr_batch_stats(struct file *file, const char *buffer,
+			      unsigned long count, void *data)
+{
+	struct obd_device *dev = data;
+
+	lprocfs_oh_clear(&dev->u.cli.cl_batch_ops_hist);
+	return count;
+}
+
 /* temporary for testing */
 static int mdc_wr_kuc(struct file *file, const char *buffer,
 		      unsigned long count, void *data)
@@ -165,6 +201,7 @@ static struct lprocfs_vars lprocfs_mdc_obd_vars[] = {
         { "import",          lprocfs_rd_import,      lprocfs_wr_import, 0 },
         { "state",           lprocfs_rd_state,       0, 0 },
 	{ "hsm_nl",          0, mdc_wr_kuc,          0, 0, 0200 },
+	{ "batch_stats",     mdc_rd_batch_stats,     mdc_wr_batch_stats, 0 },
         { "pinger_recov",    lprocfs_rd_pinger_recov,
                              lprocfs_wr_pinger_recov, 0, 0 },
         { 0 }
@@ -72,6 +72,8 @@ void mdc_open_pack(struct ptlrpc_request *req, struct md_op_data *op_data,
                    __u32 mode, __u64 rdev, __u32 flags, const void *data,
                    int datalen);
 void mdc_unlink_pack(struct ptlrpc_request *req, struct md_op_data *op_data);
+void mdc_batch_pack(struct ptlrpc_request *req, struct md_batch_op *ops,
+		    int count);
 void mdc_link_pack(struct ptlrpc_request *req, struct md_op_data *op_data);
 void mdc_rename_pack(struct ptlrpc_request *req, struct md_op_data *op_data,
                      const char *old, int oldlen, const char *new, int newlen);
@@ -113,6 +115,21 @@ int mdc_open(struct obd_export *exp, obd_id ino, int type, int flags,
 
 struct obd_client_handle;
 
+/* First record of the changelog plain llogs read lately, by their slot in
+ * the changelog catalog. This lets a reader starting at a given record skip
+ * the plain llogs before it instead of reading them from the MDT. */
+#define MDC_CHANGELOG_INDEX_SIZE	64
+
+struct mdc_changelog_index {
+	spinlock_t	mci_lock;
+	int		mci_count;
+	/* sorted by catalog slot */
+	struct {
+		int	cat_idx;
+		__u64	first_rec;
+	}		mci_slots[MDC_CHANGELOG_INDEX_SIZE];
+};
+
 int mdc_get_lustre_md(struct obd_export *md_exp, struct ptlrpc_request *req,
                       struct obd_export *dt_exp, struct obd_export *lmv_exp,
                       struct lustre_md *md);
@@ -142,6 +159,7 @@ int mdc_setattr(struct obd_export *exp, struct md_op_data *op_data,
                 struct ptlrpc_request **request, struct md_open_data **mod);
 int mdc_unlink(struct obd_export *exp, struct md_op_data *op_data,
                struct ptlrpc_request **request);
+int mdc_batch(struct obd_export *exp, struct md_batch_op *ops, int count);
 int mdc_cancel_unused(struct obd_export *exp, const struct lu_fid *fid,
                       ldlm_policy_data_t *policy, ldlm_mode_t mode,
                       ldlm_cancel_flags_t flags, void *opaque);
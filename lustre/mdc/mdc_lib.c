@@ -143,17 +143,12 @@ void mdc_readdir_pack(struct ptlrpc_request *req, __u64 pgoff,
 }
 
 /* packing of MDS records */
-void mdc_create_pack(struct ptlrpc_request *req, struct md_op_data *op_data,
-                     const void *data, int datalen, __u32 mode,
-                     __u32 uid, __u32 gid, cfs_cap_t cap_effective, __u64 rdev)
+static void mdc_create_pack_rec(struct mdt_rec_create *rec,
+				struct md_op_data *op_data, __u32 mode,
+				__u32 uid, __u32 gid, cfs_cap_t cap_effective,
+				__u64 rdev)
 {
-	struct mdt_rec_create	*rec;
-	char			*tmp;
-	__u64			 flags;
-
-	CLASSERT(sizeof(struct mdt_rec_reint) == sizeof(struct mdt_rec_create));
-	rec = req_capsule_client_get(&req->rq_pill, &RMF_REC_REINT);
-
+	__u64 flags;
 
 	rec->cr_opcode   = REINT_CREATE;
 	rec->cr_fsuid    = uid;
@@ -172,6 +167,19 @@ void mdc_create_pack(struct ptlrpc_request *req, struct md_op_data *op_data,
 	set_mrc_cr_flags(rec, flags);
 	rec->cr_bias     = op_data->op_bias;
 	rec->cr_umask    = cfs_curproc_umask();
+}
+
+void mdc_create_pack(struct ptlrpc_request *req, struct md_op_data *op_data,
+                     const void *data, int datalen, __u32 mode,
+                     __u32 uid, __u32 gid, cfs_cap_t cap_effective, __u64 rdev)
+{
+	struct mdt_rec_create	*rec;
+	char			*tmp;
+
+	CLASSERT(sizeof(struct mdt_rec_reint) == sizeof(struct mdt_rec_create));
+	rec = req_capsule_client_get(&req->rq_pill, &RMF_REC_REINT);
+
+	mdc_create_pack_rec(rec, op_data, mode, uid, gid, cap_effective, rdev);
 
 	mdc_pack_capa(req, &RMF_CAPA1, op_data->op_capa1);
 
@@ -384,15 +392,9 @@ void mdc_setattr_pack(struct ptlrpc_request *req, struct md_op_data *op_data,
                ea2len);
 }
 
-void mdc_unlink_pack(struct ptlrpc_request *req, struct md_op_data *op_data)
+static void mdc_unlink_pack_rec(struct mdt_rec_unlink *rec,
+				struct md_op_data *op_data)
 {
-	struct mdt_rec_unlink *rec;
-	char *tmp;
-
-	CLASSERT(sizeof(struct mdt_rec_reint) == sizeof(struct mdt_rec_unlink));
-	rec = req_capsule_client_get(&req->rq_pill, &RMF_REC_REINT);
-	LASSERT(rec != NULL);
-
 	rec->ul_opcode  = op_data->op_cli_flags & CLI_RM_ENTRY ?
 					REINT_RMENTRY : REINT_UNLINK;
         rec->ul_fsuid   = op_data->op_fsuid;
@@ -405,6 +407,18 @@ void mdc_unlink_pack(struct ptlrpc_request *req, struct md_op_data *op_data)
         rec->ul_fid2    = op_data->op_fid2;
         rec->ul_time    = op_data->op_mod_time;
         rec->ul_bias    = op_data->op_bias;
+}
+
+void mdc_unlink_pack(struct ptlrpc_request *req, struct md_op_data *op_data)
+{
+	struct mdt_rec_unlink *rec;
+	char *tmp;
+
+	CLASSERT(sizeof(struct mdt_rec_reint) == sizeof(struct mdt_rec_unlink));
+	rec = req_capsule_client_get(&req->rq_pill, &RMF_REC_REINT);
+	LASSERT(rec != NULL);
+
+	mdc_unlink_pack_rec(rec, op_data);
 
         mdc_pack_capa(req, &RMF_CAPA1, op_data->op_capa1);
 
@@ -413,6 +427,61 @@ void mdc_unlink_pack(struct ptlrpc_request *req, struct md_op_data *op_data)
         LOGL0(op_data->op_name, op_data->op_namelen, tmp);
 }
 
+/**
+ * Pack \a count operations into a REINT_BATCH request: one record each in
+ * RMF_BATCH_RECS and, for creates and unlinks, the name in RMF_BATCH_NAMES.
+ */
+void mdc_batch_pack(struct ptlrpc_request *req, struct md_batch_op *ops,
+		    int count)
+{
+	struct mdt_rec_reint	*hdr;
+	struct mdt_rec_reint	*rec;
+	struct md_op_data	*op_data;
+	char			*tmp;
+	int			 i;
+
+	hdr = req_capsule_client_get(&req->rq_pill, &RMF_REC_REINT);
+	LASSERT(hdr != NULL);
+	hdr->rr_opcode = REINT_BATCH;
+	hdr->rr_fsuid  = cfs_curproc_fsuid();
+	hdr->rr_fsgid  = cfs_curproc_fsgid();
+	hdr->rr_cap    = cfs_curproc_cap_pack();
+	hdr->rr_suppgid1 = -1;
+	hdr->rr_suppgid2 = -1;
+
+	rec = req_capsule_client_get(&req->rq_pill, &RMF_BATCH_RECS);
+	LASSERT(rec != NULL);
+	tmp = NULL;
+	if (req_capsule_get_size(&req->rq_pill, &RMF_BATCH_NAMES, RCL_CLIENT))
+		tmp = req_capsule_client_get(&req->rq_pill, &RMF_BATCH_NAMES);
+
+	for (i = 0; i < count; i++, rec++) {
+		op_data = ops[i].mbo_data;
+		switch (ops[i].mbo_opc) {
+		case REINT_SETATTR:
+			mdc_setattr_pack_rec((struct mdt_rec_setattr *)rec,
+					     op_data);
+			continue;
+		case REINT_CREATE:
+			mdc_create_pack_rec((struct mdt_rec_create *)rec,
+					    op_data, op_data->op_mode,
+					    op_data->op_fsuid,
+					    op_data->op_fsgid,
+					    op_data->op_cap, 0);
+			break;
+		case REINT_UNLINK:
+			mdc_unlink_pack_rec((struct mdt_rec_unlink *)rec,
+					    op_data);
+			break;
+		default:
+			LBUG();
+		}
+		LASSERT(tmp != NULL);
+		LOGL0(op_data->op_name, op_data->op_namelen, tmp);
+		tmp += op_data->op_namelen + 1;
+	}
+}
+
 void mdc_link_pack(struct ptlrpc_request *req, struct md_op_data *op_data)
 {
         struct mdt_rec_link *rec;
@@ -378,6 +378,140 @@ int mdc_unlink(struct obd_export *exp, struct md_op_data *op_data,
         RETURN(rc);
 }
 
+static int mdc_batch_send(struct obd_export *exp, struct md_batch_op *ops,
+			  int count, int nameslen)
+{
+	CFS_LIST_HEAD(cancels);
+	struct client_obd     *cli = &exp->exp_obd->u.cli;
+	struct ptlrpc_request *req;
+	struct md_op_data     *op_data;
+	__u32                 *rcs;
+	int                    cancel = 0, rc, i;
+	ENTRY;
+
+	for (i = 0; i < count; i++) {
+		op_data = ops[i].mbo_data;
+		if ((op_data->op_flags & MF_MDC_CANCEL_FID1) &&
+		    fid_is_sane(&op_data->op_fid1))
+			cancel += mdc_resource_get_unused(exp,
+						&op_data->op_fid1, &cancels,
+						LCK_EX, MDS_INODELOCK_UPDATE);
+		if (ops[i].mbo_opc == REINT_UNLINK &&
+		    (op_data->op_flags & MF_MDC_CANCEL_FID3) &&
+		    fid_is_sane(&op_data->op_fid3))
+			cancel += mdc_resource_get_unused(exp,
+						&op_data->op_fid3, &cancels,
+						LCK_EX, MDS_INODELOCK_FULL);
+	}
+
+	req = ptlrpc_request_alloc(class_exp2cliimp(exp),
+				   &RQF_MDS_REINT_BATCH);
+	if (req == NULL) {
+		ldlm_lock_list_put(&cancels, l_bl_ast, cancel);
+		RETURN(-ENOMEM);
+	}
+	req_capsule_set_size(&req->rq_pill, &RMF_BATCH_RECS, RCL_CLIENT,
+			     count * sizeof(struct mdt_rec_reint));
+	req_capsule_set_size(&req->rq_pill, &RMF_BATCH_NAMES, RCL_CLIENT,
+			     nameslen);
+
+	/* whatever does not fit is cancelled by a separate RPC */
+	rc = mdc_prep_elc_req(exp, req, MDS_REINT, &cancels, cancel);
+	if (rc) {
+		ptlrpc_request_free(req);
+		RETURN(rc);
+	}
+
+	mdc_batch_pack(req, ops, count);
+
+	req_capsule_set_size(&req->rq_pill, &RMF_RCS, RCL_SERVER,
+			     count * sizeof(*rcs));
+	ptlrpc_request_set_replen(req);
+
+	rc = mdc_reint(req, cli->cl_rpc_lock, LUSTRE_IMP_FULL);
+	if (rc == 0) {
+		rcs = req_capsule_server_sized_get(&req->rq_pill, &RMF_RCS,
+						   count * sizeof(*rcs));
+		if (rcs == NULL)
+			GOTO(out, rc = -EPROTO);
+		for (i = 0; i < count; i++)
+			ops[i].mbo_rc = (int)rcs[i];
+		lprocfs_oh_tally_log2(&cli->cl_batch_ops_hist, count);
+	}
+	EXIT;
+out:
+	ptlrpc_req_finished(req);
+	return rc;
+}
+
+/**
+ * Send \a count operations to the MDT in REINT_BATCH requests, each holding
+ * up to MDS_BATCH_MAX_OPS records. The result of every operation is stored
+ * in its mbo_rc; an error returned by this function means the RPC of the
+ * operations which are left with -EIO failed as a whole.
+ */
+int mdc_batch(struct obd_export *exp, struct md_batch_op *ops, int count)
+{
+	struct md_op_data *op_data;
+	int                start, n, size, nameslen, i;
+	int                rc = 0;
+	ENTRY;
+
+	if (!exp_connect_md_batch(exp))
+		RETURN(-EOPNOTSUPP);
+
+	for (i = 0; i < count; i++) {
+		op_data = ops[i].mbo_data;
+		switch (ops[i].mbo_opc) {
+		case REINT_SETATTR:
+			break;
+		case REINT_CREATE:
+		case REINT_UNLINK:
+			if (op_data->op_cli_flags & CLI_RM_ENTRY ||
+			    op_data->op_namelen <= 0)
+				RETURN(-EINVAL);
+			break;
+		default:
+			RETURN(-EINVAL);
+		}
+		ops[i].mbo_rc = -EIO;
+	}
+
+	for (start = 0; start < count; start += n) {
+		size = 0;
+		nameslen = 0;
+		for (n = 0; start + n < count && n < MDS_BATCH_MAX_OPS; n++) {
+			op_data = ops[start + n].mbo_data;
+			i = sizeof(struct mdt_rec_reint);
+			if (ops[start + n].mbo_opc != REINT_SETATTR)
+				i += op_data->op_namelen + 1;
+			if (n > 0 && size + i > MDS_BATCH_MAXREQSIZE)
+				break;
+			size += i;
+			if (ops[start + n].mbo_opc != REINT_SETATTR)
+				nameslen += op_data->op_namelen + 1;
+
+			/* For case if upper layer did not alloc fid, do it
+			 * now; 1 means a switch to a new sequence. */
+			if (ops[start + n].mbo_opc == REINT_CREATE &&
+			    !fid_is_sane(&op_data->op_fid2)) {
+				rc = mdc_fid_alloc(exp, &op_data->op_fid2,
+						   op_data);
+				if (rc < 0) {
+					CERROR("Can't alloc new fid, rc %d\n",
+					       rc);
+					RETURN(rc);
+				}
+			}
+		}
+
+		rc = mdc_batch_send(exp, ops + start, n, nameslen);
+		if (rc != 0)
+			break;
+	}
+	RETURN(rc);
+}
+
 int mdc_link(struct obd_export *exp, struct md_op_data *op_data,
              struct ptlrpc_request **request)
 {
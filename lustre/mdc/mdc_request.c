@@ -1092,7 +1092,10 @@ restart_bulk:
         req->rq_request_portal = MDS_READPAGE_PORTAL;
         ptlrpc_at_set_req_timeout(req);
 
-	desc = ptlrpc_prep_bulk_imp(req, op_data->op_npages, 1, BULK_PUT_SINK,
+	/* one bulk per LNET_MAX_IOV pages, see mdt_sendpage() */
+	desc = ptlrpc_prep_bulk_imp(req, op_data->op_npages,
+				    (op_data->op_npages + LNET_MAX_IOV - 1) /
+				    LNET_MAX_IOV, BULK_PUT_SINK,
 				    MDS_BULK_PORTAL);
         if (desc == NULL) {
                 ptlrpc_request_free(req);
@@ -1538,11 +1541,81 @@ static struct kuc_hdr *changelog_kuc_hdr(char *buf, int len, int flags)
 struct changelog_show {
 	__u64		cs_startrec;
 	__u32		cs_flags;
+	__u32		cs_type_mask;
+	struct lu_fid	cs_fid;
+	int		cs_cat_idx;	/* catalog slot of the current llog */
 	struct file	*cs_fp;
 	char		*cs_buf;
 	struct obd_device *cs_obd;
 };
 
+/* remember \a rec is the first record read from catalog slot \a cat_idx */
+static void mdc_changelog_index_add(struct mdc_changelog_index *mci,
+				    int cat_idx, __u64 rec)
+{
+	int i;
+	int j;
+
+	spin_lock(&mci->mci_lock);
+	/* Records only grow with the catalog slot. Forget the slots which
+	 * say otherwise: they were freed and possibly reused since they were
+	 * seen, e.g. when the catalog wrapped, and would make a reader skip
+	 * live llogs. The old entry for \a cat_idx itself is replaced. */
+	for (i = 0, j = 0; i < mci->mci_count; i++) {
+		if (mci->mci_slots[i].cat_idx == cat_idx ||
+		    (mci->mci_slots[i].cat_idx < cat_idx) !=
+		    (mci->mci_slots[i].first_rec < rec))
+			continue;
+		mci->mci_slots[j++] = mci->mci_slots[i];
+	}
+	mci->mci_count = j;
+
+	for (i = 0; i < mci->mci_count; i++)
+		if (mci->mci_slots[i].cat_idx > cat_idx)
+			break;
+
+	if (mci->mci_count == MDC_CHANGELOG_INDEX_SIZE) {
+		/* forget the oldest llog, it will be cleared first */
+		if (i == 0)
+			goto out;
+		memmove(&mci->mci_slots[0], &mci->mci_slots[1],
+			(i - 1) * sizeof(mci->mci_slots[0]));
+		i--;
+	} else {
+		memmove(&mci->mci_slots[i + 1], &mci->mci_slots[i],
+			(mci->mci_count - i) * sizeof(mci->mci_slots[0]));
+		mci->mci_count++;
+	}
+	mci->mci_slots[i].cat_idx = cat_idx;
+	mci->mci_slots[i].first_rec = rec;
+out:
+	spin_unlock(&mci->mci_lock);
+}
+
+/**
+ * Find the catalog slot to start reading the changelog from to get record
+ * \a startrec. Records are appended to plain llogs in catalog order, so
+ * the llogs before the last one starting at or before \a startrec only hold
+ * older records. Only valid as long as the catalog doesn't wrap; the index
+ * is kept growing with the slot by mdc_changelog_index_add().
+ */
+static int mdc_changelog_startcat(struct mdc_changelog_index *mci,
+				  __u64 startrec)
+{
+	int startcat = 0;
+	int i;
+
+	spin_lock(&mci->mci_lock);
+	for (i = 0; i < mci->mci_count; i++) {
+		if (mci->mci_slots[i].first_rec > startrec)
+			break;
+		startcat = mci->mci_slots[i].cat_idx;
+	}
+	spin_unlock(&mci->mci_lock);
+
+	return startcat;
+}
+
 static int changelog_kkuc_cb(const struct lu_env *env, struct llog_handle *llh,
 			     struct llog_rec_hdr *hdr, void *data)
 {
@@ -1560,6 +1633,12 @@ static int changelog_kkuc_cb(const struct lu_env *env, struct llog_handle *llh,
 		RETURN(rc);
 	}
 
+	if (llh->u.phd.phd_cookie.lgc_index != cs->cs_cat_idx) {
+		cs->cs_cat_idx = llh->u.phd.phd_cookie.lgc_index;
+		mdc_changelog_index_add(cs->cs_obd->u.cli.cl_changelog_index,
+					cs->cs_cat_idx, rec->cr.cr_index);
+	}
+
 	if (rec->cr.cr_index < cs->cs_startrec) {
 		/* Skip entries earlier than what we are interested in */
 		CDEBUG(D_CHANGELOG, "rec="LPU64" start="LPU64"\n",
@@ -1567,6 +1646,15 @@ static int changelog_kkuc_cb(const struct lu_env *env, struct llog_handle *llh,
 		RETURN(0);
 	}
 
+	/* filter here rather than in the reader to save the copies */
+	if (cs->cs_type_mask != 0 &&
+	    !(cs->cs_type_mask & (1 << rec->cr.cr_type)))
+		RETURN(0);
+	if (fid_is_sane(&cs->cs_fid) &&
+	    !lu_fid_eq(&cs->cs_fid, &rec->cr.cr_tfid) &&
+	    !lu_fid_eq(&cs->cs_fid, &rec->cr.cr_pfid))
+		RETURN(0);
+
 	CDEBUG(D_CHANGELOG, LPU64" %02d%-5s "LPU64" 0x%x t="DFID" p="DFID
 		" %.*s\n", rec->cr.cr_index, rec->cr.cr_type,
 		changelog_type2str(rec->cr.cr_type), rec->cr.cr_time,
@@ -1592,6 +1680,7 @@ static int mdc_changelog_send_thread(void *csdata)
 	struct llog_ctxt *ctxt = NULL;
 	struct llog_handle *llh = NULL;
 	struct kuc_hdr *kuch;
+	int startcat = 0;
 	int rc;
 
 	CDEBUG(D_CHANGELOG, "changelog to fp=%p start "LPU64"\n",
@@ -1625,7 +1714,16 @@ static int mdc_changelog_send_thread(void *csdata)
 		GOTO(out, rc);
 	}
 
-	rc = llog_cat_process(NULL, llh, changelog_kkuc_cb, cs, 0, 0);
+	/* start from the llog holding startrec if we already know it */
+	if (cs->cs_startrec > 0 &&
+	    llh->lgh_hdr->llh_cat_idx <= llh->lgh_last_idx)
+		startcat = mdc_changelog_startcat(
+				cs->cs_obd->u.cli.cl_changelog_index,
+				cs->cs_startrec);
+	CDEBUG(D_CHANGELOG, "start "LPU64" from catalog slot %d\n",
+	       cs->cs_startrec, startcat);
+
+	rc = llog_cat_process(NULL, llh, changelog_kkuc_cb, cs, startcat, 0);
 
         /* Send EOF no matter what our result */
         if ((kuch = changelog_kuc_hdr(cs->cs_buf, sizeof(*kuch),
@@ -1664,6 +1762,11 @@ static int mdc_ioc_changelog_send(struct obd_device *obd,
 	/* matching fput in mdc_changelog_send_thread */
 	cs->cs_fp = fget(icc->icc_id);
 	cs->cs_flags = icc->icc_flags;
+	if (icc->icc_flags & CHANGELOG_FLAG_FILTER) {
+		cs->cs_type_mask = icc->icc_type_mask;
+		cs->cs_fid = icc->icc_fid;
+	}
+	cs->cs_cat_idx = -1;
 
         /* New thread because we should return to user app before
            writing into our pipe */
@@ -2515,13 +2618,20 @@ static int mdc_setup(struct obd_device *obd, struct lustre_cfg *cfg)
                 GOTO(err_rpc_lock, rc = -ENOMEM);
         mdc_init_rpc_lock(cli->cl_close_lock);
 
+	OBD_ALLOC_PTR(cli->cl_changelog_index);
+	if (cli->cl_changelog_index == NULL)
+		GOTO(err_close_lock, rc = -ENOMEM);
+	spin_lock_init(&cli->cl_changelog_index->mci_lock);
+
         rc = client_obd_setup(obd, cfg);
         if (rc)
-                GOTO(err_close_lock, rc);
+                GOTO(err_changelog_index, rc);
         lprocfs_mdc_init_vars(&lvars);
         lprocfs_obd_setup(obd, lvars.obd_vars);
         sptlrpc_lprocfs_cliobd_attach(obd);
         ptlrpc_lprocfs_register_obd(obd);
+	lprocfs_oh_export(obd->obd_proc_entry, "batch_stats",
+			  &cli->cl_batch_ops_hist, 1);
 
 	ns_register_cancel(obd->obd_namespace, mdc_cancel_weight);
 
@@ -2535,6 +2645,8 @@ static int mdc_setup(struct obd_device *obd, struct lustre_cfg *cfg)
 
         RETURN(rc);
 
+err_changelog_index:
+	OBD_FREE_PTR(cli->cl_changelog_index);
 err_close_lock:
         OBD_FREE(cli->cl_close_lock, sizeof (*cli->cl_close_lock));
 err_rpc_lock:
@@ -2587,6 +2699,7 @@ static int mdc_precleanup(struct obd_device *obd, enum obd_cleanup_stage stage)
                         libcfs_kkuc_group_rem(0, KUC_GRP_HSM);
 
                 obd_cleanup_client_import(obd);
+		lprocfs_oh_unexport(&obd->u.cli.cl_batch_ops_hist);
                 ptlrpc_lprocfs_unregister_obd(obd);
                 lprocfs_obd_cleanup(obd);
 
@@ -2604,6 +2717,7 @@ static int mdc_cleanup(struct obd_device *obd)
 
         OBD_FREE(cli->cl_rpc_lock, sizeof (*cli->cl_rpc_lock));
         OBD_FREE(cli->cl_close_lock, sizeof (*cli->cl_close_lock));
+	OBD_FREE_PTR(cli->cl_changelog_index);
 
         ptlrpcd_decref();
 
@@ -2839,7 +2953,8 @@ struct md_ops mdc_md_ops = {
         .m_unpack_capa      = mdc_unpack_capa,
         .m_get_remote_perm  = mdc_get_remote_perm,
         .m_intent_getattr_async = mdc_intent_getattr_async,
-        .m_revalidate_lock      = mdc_revalidate_lock
+        .m_revalidate_lock      = mdc_revalidate_lock,
+	.m_batch                = mdc_batch
 };
 
 int __init mdc_init(void)
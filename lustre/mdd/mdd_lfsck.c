@@ -231,10 +231,85 @@ static int lfsck_pos_dump(char **buf, int *len, struct lfsck_position *pos,
 	return rc;
 }
 
+static int lfsck_threads_dump(char **buf, int *len, struct md_lfsck *lfsck)
+{
+	cfs_time_t now = cfs_time_current();
+	int	   rc  = 0;
+	int	   i;
+
+	spin_lock(&lfsck->ml_lock);
+	if (lfsck->ml_threads == NULL) {
+		if (lfsck->ml_threads_last == 0)
+			goto unlock;
+
+		rc = snprintf(*buf, *len, "last_threads: %u\n",
+			      lfsck->ml_threads_last);
+		if (rc <= 0)
+			GOTO(unlock, rc = -ENOSPC);
+
+		*buf += rc;
+		*len -= rc;
+		GOTO(unlock, rc = 0);
+	}
+
+	rc = snprintf(*buf, *len, "threads: %u\n", lfsck->ml_thread_count);
+	if (rc <= 0)
+		GOTO(unlock, rc = -ENOSPC);
+
+	*buf += rc;
+	*len -= rc;
+	for (i = 0; i < lfsck->ml_thread_count; i++) {
+		struct lfsck_thread *lt       = &lfsck->ml_threads[i];
+		cfs_duration_t	     duration = now - lt->lt_time_start;
+		__u64		     speed    = lt->lt_items_scanned * CFS_HZ;
+
+		if (duration != 0)
+			do_div(speed, duration);
+		rc = snprintf(*buf, *len, "thread_%d: dirs "LPU64", checked "
+			      LPU64", speed "LPU64" items/sec\n", i,
+			      lt->lt_dirs_scanned, lt->lt_items_scanned, speed);
+		if (rc <= 0)
+			GOTO(unlock, rc = -ENOSPC);
+
+		*buf += rc;
+		*len -= rc;
+	}
+	rc = 0;
+
+unlock:
+	spin_unlock(&lfsck->ml_lock);
+	return rc;
+}
+
+/* The lowest otable-based iteration position of the directories those are
+ * queued or being traversed by the helper threads, 0 if there is none.
+ * Call with ml_lock held. */
+static __u64 mdd_lfsck_dir_inflight(struct md_lfsck *lfsck)
+{
+	struct lfsck_dir_item	*ldi;
+	__u64			 cookie = 0;
+
+	cfs_list_for_each_entry(ldi, &lfsck->ml_dir_active, ldi_link) {
+		if (cookie == 0 || ldi->ldi_cookie < cookie)
+			cookie = ldi->ldi_cookie;
+	}
+
+	/* The queue is in the otable-based iteration order. */
+	if (!cfs_list_empty(&lfsck->ml_dir_queue)) {
+		ldi = cfs_list_entry(lfsck->ml_dir_queue.next,
+				     struct lfsck_dir_item, ldi_link);
+		if (cookie == 0 || ldi->ldi_cookie < cookie)
+			cookie = ldi->ldi_cookie;
+	}
+
+	return cookie;
+}
+
 static void mdd_lfsck_pos_fill(const struct lu_env *env, struct md_lfsck *lfsck,
 			       struct lfsck_position *pos, bool init)
 {
 	const struct dt_it_ops *iops = &lfsck->ml_obj_oit->do_index_ops->dio_it;
+	__u64			cookie;
 
 	spin_lock(&lfsck->ml_lock);
 	if (unlikely(lfsck->ml_di_oit == NULL)) {
@@ -265,6 +340,15 @@ static void mdd_lfsck_pos_fill(const struct lu_env *env, struct md_lfsck *lfsck,
 		fid_zero(&pos->lp_dir_parent);
 		pos->lp_dir_cookie = 0;
 	}
+
+	/* The directories not finished by the helper threads will be
+	 * traversed again from the beginning after restart. */
+	cookie = mdd_lfsck_dir_inflight(lfsck);
+	if (cookie != 0 && cookie <= pos->lp_oit_cookie) {
+		pos->lp_oit_cookie = cookie - 1;
+		fid_zero(&pos->lp_dir_parent);
+		pos->lp_dir_cookie = 0;
+	}
 	spin_unlock(&lfsck->ml_lock);
 }
 
@@ -348,24 +432,36 @@ static void mdd_lfsck_control_speed(struct md_lfsck *lfsck)
 {
 	struct ptlrpc_thread *thread = &lfsck->ml_thread;
 	struct l_wait_info    lwi;
+	cfs_time_t	      now;
 
-	if (lfsck->ml_sleep_jif > 0 &&
-	    lfsck->ml_new_scanned >= lfsck->ml_sleep_rate) {
-		spin_lock(&lfsck->ml_lock);
-		if (likely(lfsck->ml_sleep_jif > 0 &&
-			   lfsck->ml_new_scanned >= lfsck->ml_sleep_rate)) {
-			lwi = LWI_TIMEOUT_INTR(lfsck->ml_sleep_jif, NULL,
-					       LWI_ON_SIGNAL_NOOP, NULL);
-			spin_unlock(&lfsck->ml_lock);
+	if (lfsck->ml_sleep_jif == 0)
+		return;
 
-			l_wait_event(thread->t_ctl_waitq,
-				     !thread_is_running(thread),
-				     &lwi);
+	/* The budget of each time slice is shared by the main thread and
+	 * the helper threads, so the limit applies to the LFSCK as a whole. */
+	spin_lock(&lfsck->ml_lock);
+	while (lfsck->ml_sleep_jif > 0 && thread_is_running(thread)) {
+		now = cfs_time_current();
+		if (cfs_time_aftereq(now, lfsck->ml_speed_window)) {
+			lfsck->ml_speed_window = now + lfsck->ml_sleep_jif;
 			lfsck->ml_new_scanned = 0;
-		} else {
-			spin_unlock(&lfsck->ml_lock);
 		}
+
+		if (lfsck->ml_new_scanned < lfsck->ml_sleep_rate) {
+			lfsck->ml_new_scanned++;
+			break;
+		}
+
+		lwi = LWI_TIMEOUT_INTR(lfsck->ml_speed_window - now, NULL,
+				       LWI_ON_SIGNAL_NOOP, NULL);
+		spin_unlock(&lfsck->ml_lock);
+
+		l_wait_event(thread->t_ctl_waitq,
+			     !thread_is_running(thread),
+			     &lwi);
+		spin_lock(&lfsck->ml_lock);
 	}
+	spin_unlock(&lfsck->ml_lock);
 }
 
 /* lfsck_bookmark file ops */
@@ -783,6 +879,10 @@ static int mdd_lfsck_namespace_update(const struct lu_env *env,
 
 	rc = dt_insert(env, obj, (const struct dt_rec *)&flags,
 		       (const struct dt_key *)key, handle, BYPASS_CAPA, 1);
+	/* Another directory traversal thread has recorded the same
+	 * multiple-linked object, the double scan will check it anyway. */
+	if (rc == -EEXIST && !exist)
+		rc = 0;
 
 	GOTO(out, rc);
 
@@ -1166,11 +1266,10 @@ static int mdd_declare_lfsck_namespace_exec_dir(const struct lu_env *env,
 }
 
 static int mdd_lfsck_namespace_check_exist(const struct lu_env *env,
-					   struct md_lfsck *lfsck,
+					   struct dt_object *dir,
 					   struct mdd_object *obj,
 					   const char *name)
 {
-	struct dt_object *dir = lfsck->ml_obj_dir;
 	struct lu_fid	 *fid = &mdd_env_info(env)->mti_fid;
 	int		  rc;
 	ENTRY;
@@ -1192,8 +1291,12 @@ static int mdd_lfsck_namespace_check_exist(const struct lu_env *env,
 	RETURN(0);
 }
 
+/* It may be called by several directory traversal threads concurrently,
+ * so the lfsck_namespace is only updated under lc_sem at the end, and the
+ * repairing (with its own transaction) does not hold lc_sem. */
 static int mdd_lfsck_namespace_exec_dir(const struct lu_env *env,
 					struct lfsck_component *com,
+					struct dt_object *dir,
 					struct mdd_object *obj,
 					struct lu_dirent *ent)
 {
@@ -1205,26 +1308,25 @@ static int mdd_lfsck_namespace_exec_dir(const struct lu_env *env,
 				(struct lfsck_namespace *)com->lc_file_ram;
 	struct mdd_device	   *mdd      = mdd_lfsck2mdd(lfsck);
 	struct linkea_data	    ldata    = { 0 };
-	const struct lu_fid	   *pfid     =
-				lu_object_fid(&lfsck->ml_obj_dir->do_lu);
+	const struct lu_fid	   *pfid     = lu_object_fid(&dir->do_lu);
 	const struct lu_fid	   *cfid     = mdo2fid(obj);
 	const struct lu_name	   *cname;
 	struct thandle		   *handle   = NULL;
+	__u32			    flags    = 0;
 	bool			    repaired = false;
+	bool			    mlinked  = false;
+	bool			    journal  = false;
 	bool			    locked   = false;
 	int			    count    = 0;
 	int			    rc;
 	ENTRY;
 
 	cname = mdd_name_get_const(env, ent->lde_name, ent->lde_namelen);
-	down_write(&com->lc_sem);
-	com->lc_new_checked++;
-
 	if (ent->lde_attrs & LUDA_UPGRADE) {
-		ns->ln_flags |= LF_UPGRADE;
+		flags |= LF_UPGRADE;
 		repaired = true;
 	} else if (ent->lde_attrs & LUDA_REPAIR) {
-		ns->ln_flags |= LF_INCONSISTENT;
+		flags |= LF_INCONSISTENT;
 		repaired = true;
 	}
 
@@ -1240,6 +1342,7 @@ static int mdd_lfsck_namespace_exec_dir(const struct lu_env *env,
 again:
 		LASSERT(!locked);
 
+		journal = true;
 		com->lc_journal = 1;
 		handle = mdd_trans_create(env, mdd);
 		if (IS_ERR(handle))
@@ -1257,7 +1360,7 @@ again:
 		locked = true;
 	}
 
-	rc = mdd_lfsck_namespace_check_exist(env, lfsck, obj, ent->lde_name);
+	rc = mdd_lfsck_namespace_check_exist(env, dir, obj, ent->lde_name);
 	if (rc != 0)
 		GOTO(stop, rc);
 
@@ -1276,7 +1379,7 @@ again:
 		} else {
 
 unmatch:
-			ns->ln_flags |= LF_INCONSISTENT;
+			flags |= LF_INCONSISTENT;
 			if (bk->lb_param & LPF_DRYRUN) {
 				repaired = true;
 				goto record;
@@ -1284,7 +1387,7 @@ unmatch:
 
 			/*For dir, remove the unmatched linkea entry directly.*/
 			if (S_ISDIR(mdd_object_type(obj))) {
-				if (!com->lc_journal)
+				if (!journal)
 					goto again;
 
 				rc = mdo_xattr_del(env, obj, XATTR_NAME_LINK,
@@ -1298,14 +1401,14 @@ unmatch:
 			}
 		}
 	} else if (unlikely(rc == -EINVAL)) {
-		ns->ln_flags |= LF_INCONSISTENT;
+		flags |= LF_INCONSISTENT;
 		if (bk->lb_param & LPF_DRYRUN) {
 			count = 1;
 			repaired = true;
 			goto record;
 		}
 
-		if (!com->lc_journal)
+		if (!journal)
 			goto again;
 
 		/* The magic crashed, we are not sure whether there are more
@@ -1317,7 +1420,7 @@ unmatch:
 
 		goto nodata;
 	} else if (rc == -ENODATA) {
-		ns->ln_flags |= LF_UPGRADE;
+		flags |= LF_UPGRADE;
 		if (bk->lb_param & LPF_DRYRUN) {
 			count = 1;
 			repaired = true;
@@ -1330,7 +1433,7 @@ nodata:
 			GOTO(stop, rc);
 
 add:
-		if (!com->lc_journal)
+		if (!journal)
 			goto again;
 
 		rc = linkea_add_buf(&ldata, cname, pfid);
@@ -1370,7 +1473,7 @@ record:
 		handle = NULL;
 	}
 
-	ns->ln_mlinked_checked++;
+	mlinked = true;
 	rc = mdd_lfsck_namespace_update(env, com, cfid,
 			count != la->la_nlink ? LLF_UNMATCH_NLINKS : 0, false);
 
@@ -1384,6 +1487,11 @@ stop:
 		mdd_trans_stop(env, mdd, rc, handle);
 
 out:
+	down_write(&com->lc_sem);
+	com->lc_new_checked++;
+	ns->ln_flags |= flags;
+	if (mlinked)
+		ns->ln_mlinked_checked++;
 	if (rc < 0) {
 		ns->ln_items_failed++;
 		if (mdd_lfsck_pos_is_zero(&ns->ln_pos_first_inconsistent))
@@ -1577,6 +1685,10 @@ mdd_lfsck_namespace_dump(const struct lu_env *env, struct lfsck_component *com,
 		rc = lfsck_pos_dump(&buf, &len, &pos, "current_position");
 		if (rc <= 0)
 			goto out;
+
+		rc = lfsck_threads_dump(&buf, &len, lfsck);
+		if (rc < 0)
+			goto out;
 	} else if (ns->ln_status == LS_SCANNING_PHASE2) {
 		cfs_duration_t duration = cfs_time_current() -
 					  lfsck->ml_time_last_checkpoint;
@@ -1682,6 +1794,10 @@ mdd_lfsck_namespace_dump(const struct lu_env *env, struct lfsck_component *com,
 
 		buf += rc;
 		len -= rc;
+
+		rc = lfsck_threads_dump(&buf, &len, lfsck);
+		if (rc < 0)
+			goto out;
 	}
 	ret = save - len;
 
@@ -1769,7 +1885,6 @@ obj_put:
 		mdd_object_put(env, target);
 
 checkpoint:
-		lfsck->ml_new_scanned++;
 		com->lc_new_checked++;
 		ns->ln_fid_latest_scanned_phase2 = fid;
 		if (rc > 0)
@@ -2220,6 +2335,48 @@ out:
 	return rc;
 }
 
+static void mdd_lfsck_dir_item_free(const struct lu_env *env,
+				    struct lfsck_dir_item *ldi)
+{
+	mdd_object_put(env, ldi->ldi_obj);
+	OBD_FREE_PTR(ldi);
+}
+
+/* Hand the directory to the helper threads for traversal. The queue is
+ * bounded, so that the checkpoint does not fall far behind the otable-based
+ * iteration, and the memory usage is limited. */
+static int mdd_lfsck_dir_queue(const struct lu_env *env,
+			       struct md_lfsck *lfsck, struct mdd_object *obj)
+{
+	const struct dt_it_ops	*iops	=
+				&lfsck->ml_obj_oit->do_index_ops->dio_it;
+	struct ptlrpc_thread	*thread = &lfsck->ml_thread;
+	struct lfsck_dir_item	*ldi;
+	struct l_wait_info	 lwi	= { 0 };
+
+	OBD_ALLOC_PTR(ldi);
+	if (ldi == NULL)
+		return -ENOMEM;
+
+	mdd_object_get(obj);
+	ldi->ldi_obj = obj;
+	ldi->ldi_cookie = iops->store(env, lfsck->ml_di_oit);
+
+	l_wait_event(thread->t_ctl_waitq,
+		     lfsck->ml_dir_queued < lfsck->ml_thread_count * 2 ||
+		     !thread_is_running(thread),
+		     &lwi);
+
+	/* Queue it even if the LFSCK is stopping, then the position to be
+	 * recorded will cover it. */
+	spin_lock(&lfsck->ml_lock);
+	cfs_list_add_tail(&ldi->ldi_link, &lfsck->ml_dir_queue);
+	lfsck->ml_dir_queued++;
+	spin_unlock(&lfsck->ml_lock);
+	cfs_waitq_broadcast(&thread->t_ctl_waitq);
+	return 0;
+}
+
 static int mdd_lfsck_exec_oit(const struct lu_env *env, struct md_lfsck *lfsck,
 			      struct mdd_object *obj)
 {
@@ -2249,6 +2406,9 @@ static int mdd_lfsck_exec_oit(const struct lu_env *env, struct md_lfsck *lfsck,
 	if (unlikely(mdd_is_dead_obj(obj)))
 		GOTO(out, rc = 0);
 
+	if (lfsck->ml_threads != NULL)
+		GOTO(out, rc = mdd_lfsck_dir_queue(env, lfsck, obj));
+
 	dt_obj = mdd_object_child(obj);
 	if (unlikely(!dt_try_as_dir(env, dt_obj)))
 		GOTO(out, rc = -ENOTDIR);
@@ -2285,13 +2445,14 @@ out:
 }
 
 static int mdd_lfsck_exec_dir(const struct lu_env *env, struct md_lfsck *lfsck,
-			      struct mdd_object *obj, struct lu_dirent *ent)
+			      struct dt_object *dir, struct mdd_object *obj,
+			      struct lu_dirent *ent)
 {
 	struct lfsck_component *com;
 	int			rc;
 
 	cfs_list_for_each_entry(com, &lfsck->ml_list_scan, lc_link) {
-		rc = com->lc_ops->lfsck_exec_dir(env, com, obj, ent);
+		rc = com->lc_ops->lfsck_exec_dir(env, com, dir, obj, ent);
 		if (rc != 0)
 			return rc;
 	}
@@ -2368,7 +2529,6 @@ static int mdd_lfsck_dir_engine(const struct lu_env *env,
 				     &lwi);
 		}
 
-		lfsck->ml_new_scanned++;
 		rc = iops->rec(env, di, (struct dt_rec *)ent,
 			       lfsck->ml_args_dir);
 		if (rc != 0) {
@@ -2398,7 +2558,8 @@ static int mdd_lfsck_dir_engine(const struct lu_env *env,
 		/* XXX: Currently, skip remote object, the consistency for
 		 *	remote object will be processed in LFSCK phase III. */
 		if (mdd_object_exists(child) && !mdd_object_remote(child))
-			rc = mdd_lfsck_exec_dir(env, lfsck, child, ent);
+			rc = mdd_lfsck_exec_dir(env, lfsck, lfsck->ml_obj_dir,
+						child, ent);
 		mdd_object_put(env, child);
 		if (rc != 0 && bk->lb_param & LPF_FAILOUT)
 			RETURN(rc);
@@ -2470,7 +2631,6 @@ static int mdd_lfsck_oit_engine(const struct lu_env *env,
 			RETURN(0);
 
 		lfsck->ml_current_oit_processed = 1;
-		lfsck->ml_new_scanned++;
 		rc = iops->rec(env, di, (struct dt_rec *)fid, 0);
 		if (rc != 0) {
 			mdd_lfsck_fail(env, lfsck, true);
@@ -2527,6 +2687,316 @@ checkpoint:
 	RETURN(rc);
 }
 
+/* LFSCK helper threads for namespace-based directory traversal */
+
+/**
+ * \retval +ve	the directory has been traversed completely
+ * \retval 0	the LFSCK is stopping
+ * \retval -ve	error cases
+ */
+static int mdd_lfsck_helper_dir(const struct lu_env *env,
+				struct lfsck_thread *lt,
+				struct mdd_object *obj)
+{
+	struct mdd_thread_info	*info	= mdd_env_info(env);
+	struct md_lfsck		*lfsck	= lt->lt_lfsck;
+	struct mdd_device	*mdd	= mdd_lfsck2mdd(lfsck);
+	struct lu_dirent	*ent	= &info->mti_ent;
+	struct lu_fid		*fid	= &info->mti_fid;
+	struct lfsck_bookmark	*bk	= &lfsck->ml_bookmark_ram;
+	struct ptlrpc_thread	*thread = &lfsck->ml_thread;
+	struct dt_object	*dir	= mdd_object_child(obj);
+	const struct dt_it_ops	*iops;
+	struct dt_it		*di;
+	int			 rc;
+
+	if (unlikely(!dt_try_as_dir(env, dir)))
+		GOTO(fail, rc = -ENOTDIR);
+
+	iops = &dir->do_index_ops->dio_it;
+	di = iops->init(env, dir, lfsck->ml_args_dir, BYPASS_CAPA);
+	if (IS_ERR(di))
+		GOTO(fail, rc = PTR_ERR(di));
+
+	rc = iops->load(env, di, 0);
+	if (rc == 0)
+		rc = iops->next(env, di);
+	if (rc < 0) {
+		iops->put(env, di);
+		iops->fini(env, di);
+		GOTO(fail, rc);
+	}
+
+	while (rc == 0) {
+		struct mdd_object *child;
+
+		lt->lt_items_scanned++;
+		rc = iops->rec(env, di, (struct dt_rec *)ent,
+			       lfsck->ml_args_dir);
+		if (rc != 0) {
+			mdd_lfsck_fail(env, lfsck, true);
+			if (bk->lb_param & LPF_FAILOUT)
+				break;
+			else
+				goto next;
+		}
+
+		mdd_lfsck_unpack_ent(ent);
+		if (ent->lde_attrs & LUDA_IGNORE)
+			goto next;
+
+		*fid = ent->lde_fid;
+		child = mdd_object_find(env, mdd, fid);
+		if (child == NULL) {
+			goto next;
+		} else if (IS_ERR(child)) {
+			mdd_lfsck_fail(env, lfsck, true);
+			rc = PTR_ERR(child);
+			if (bk->lb_param & LPF_FAILOUT)
+				break;
+			else
+				goto next;
+		}
+
+		/* XXX: Currently, skip remote object, the consistency for
+		 *	remote object will be processed in LFSCK phase III. */
+		if (mdd_object_exists(child) && !mdd_object_remote(child))
+			rc = mdd_lfsck_exec_dir(env, lfsck, dir, child, ent);
+		mdd_object_put(env, child);
+		if (rc != 0 && bk->lb_param & LPF_FAILOUT)
+			break;
+
+next:
+		/* Rate control. */
+		mdd_lfsck_control_speed(lfsck);
+		if (unlikely(!thread_is_running(thread))) {
+			rc = 0;
+			break;
+		}
+
+		rc = iops->next(env, di);
+	}
+
+	iops->put(env, di);
+	iops->fini(env, di);
+	return rc;
+
+fail:
+	mdd_lfsck_fail(env, lfsck, false);
+	return bk->lb_param & LPF_FAILOUT ? rc : 1;
+}
+
+static int mdd_lfsck_helper(void *args)
+{
+	struct lfsck_thread	*lt	= args;
+	struct md_lfsck		*lfsck	= lt->lt_lfsck;
+	struct ptlrpc_thread	*thread = &lfsck->ml_thread;
+	struct lfsck_dir_item	*ldi;
+	struct l_wait_info	 lwi	= { 0 };
+	struct lu_env		 env;
+	char			 name[16];
+	int			 rc;
+
+	snprintf(name, sizeof(name), "lfsck_%02u", lt->lt_idx);
+	cfs_daemonize(name);
+	rc = lu_env_init(&env, LCT_MD_THREAD | LCT_DT_THREAD);
+	if (rc != 0)
+		GOTO(out, rc);
+
+	while (1) {
+		l_wait_event(thread->t_ctl_waitq,
+			     !cfs_list_empty(&lfsck->ml_dir_queue) ||
+			     !lfsck->ml_dir_producing ||
+			     !thread_is_running(thread),
+			     &lwi);
+		if (unlikely(!thread_is_running(thread)))
+			break;
+
+		spin_lock(&lfsck->ml_lock);
+		if (cfs_list_empty(&lfsck->ml_dir_queue)) {
+			spin_unlock(&lfsck->ml_lock);
+			if (!lfsck->ml_dir_producing)
+				break;
+			continue;
+		}
+
+		ldi = cfs_list_entry(lfsck->ml_dir_queue.next,
+				     struct lfsck_dir_item, ldi_link);
+		cfs_list_move_tail(&ldi->ldi_link, &lfsck->ml_dir_active);
+		lfsck->ml_dir_queued--;
+		spin_unlock(&lfsck->ml_lock);
+		/* Someone may wait for the queue space. */
+		cfs_waitq_broadcast(&thread->t_ctl_waitq);
+
+		rc = mdd_lfsck_helper_dir(&env, lt, ldi->ldi_obj);
+		if (rc <= 0)
+			/* Keep the unfinished directory in ml_dir_active,
+			 * the recorded position will cover it. */
+			break;
+
+		spin_lock(&lfsck->ml_lock);
+		cfs_list_del(&ldi->ldi_link);
+		lt->lt_dirs_scanned++;
+		spin_unlock(&lfsck->ml_lock);
+		mdd_lfsck_dir_item_free(&env, ldi);
+		rc = 0;
+	}
+
+	lu_env_fini(&env);
+
+out:
+	CDEBUG(D_LFSCK, "%s: LFSCK thread %u: stop, dirs = "LPU64", rc = %d\n",
+	       mdd_lfsck2name(lfsck), lt->lt_idx, lt->lt_dirs_scanned, rc);
+
+	spin_lock(&lfsck->ml_lock);
+	lt->lt_result = rc;
+	/* Stop the others, the LFSCK as a whole has failed. */
+	if (rc < 0 && thread_is_running(thread))
+		thread_set_flags(thread, SVC_STOPPING);
+	thread_set_flags(&lt->lt_thread, SVC_STOPPED);
+	cfs_waitq_broadcast(&thread->t_ctl_waitq);
+	spin_unlock(&lfsck->ml_lock);
+	return rc;
+}
+
+static int mdd_lfsck_helpers_stopped(struct md_lfsck *lfsck)
+{
+	int i;
+
+	for (i = 0; i < lfsck->ml_thread_count; i++) {
+		if (!thread_is_stopped(&lfsck->ml_threads[i].lt_thread))
+			return 0;
+	}
+	return 1;
+}
+
+static void mdd_lfsck_threads_start(struct md_lfsck *lfsck)
+{
+	struct lfsck_thread *threads;
+	int		     rc;
+	int		     i;
+
+	lfsck->ml_threads_last = 0;
+	if (lfsck->ml_threads_max == 0 || lfsck->ml_oit_over ||
+	    cfs_list_empty(&lfsck->ml_list_dir))
+		return;
+
+	/* If failed, the main thread will traverse the directories. */
+	OBD_ALLOC(threads, sizeof(*threads) * LFSCK_THREADS_MAX);
+	if (threads == NULL)
+		return;
+
+	lfsck->ml_dir_producing = 1;
+	for (i = 0; i < lfsck->ml_threads_max; i++) {
+		struct lfsck_thread *lt = &threads[i];
+
+		lt->lt_lfsck = lfsck;
+		lt->lt_idx = i;
+		lt->lt_time_start = cfs_time_current();
+		cfs_waitq_init(&lt->lt_thread.t_ctl_waitq);
+		thread_set_flags(&lt->lt_thread, SVC_RUNNING);
+
+		spin_lock(&lfsck->ml_lock);
+		lfsck->ml_threads = threads;
+		lfsck->ml_thread_count = i + 1;
+		spin_unlock(&lfsck->ml_lock);
+
+		rc = cfs_create_thread(mdd_lfsck_helper, lt, 0);
+		if (rc < 0) {
+			CWARN("%s: cannot start LFSCK thread %d, rc = %d\n",
+			      mdd_lfsck2name(lfsck), i, rc);
+			spin_lock(&lfsck->ml_lock);
+			lfsck->ml_thread_count = i;
+			if (i == 0)
+				lfsck->ml_threads = NULL;
+			spin_unlock(&lfsck->ml_lock);
+			break;
+		}
+	}
+
+	if (lfsck->ml_threads == NULL) {
+		lfsck->ml_dir_producing = 0;
+		OBD_FREE(threads, sizeof(*threads) * LFSCK_THREADS_MAX);
+	}
+}
+
+/* Wait for the helper threads to finish the queued directories, then the
+ * final position and the result can be decided. */
+static int mdd_lfsck_threads_stop(const struct lu_env *env,
+				  struct md_lfsck *lfsck, int result)
+{
+	struct ptlrpc_thread	*thread = &lfsck->ml_thread;
+	struct l_wait_info	 lwi;
+	int			 i;
+
+	if (lfsck->ml_threads == NULL)
+		return result;
+
+	spin_lock(&lfsck->ml_lock);
+	lfsck->ml_dir_producing = 0;
+	spin_unlock(&lfsck->ml_lock);
+	cfs_waitq_broadcast(&thread->t_ctl_waitq);
+
+	while (1) {
+		lwi = LWI_TIMEOUT(cfs_time_seconds(LFSCK_CHECKPOINT_INTERVAL),
+				  NULL, NULL);
+		l_wait_event(thread->t_ctl_waitq,
+			     mdd_lfsck_helpers_stopped(lfsck),
+			     &lwi);
+		if (mdd_lfsck_helpers_stopped(lfsck))
+			break;
+
+		mdd_lfsck_checkpoint(env, lfsck);
+	}
+
+	for (i = 0; i < lfsck->ml_thread_count; i++) {
+		int rc = lfsck->ml_threads[i].lt_result;
+
+		if (rc < 0 && result >= 0)
+			result = rc;
+	}
+
+	/* Stopped before all the directories have been traversed. */
+	spin_lock(&lfsck->ml_lock);
+	if (result > 0 && (!cfs_list_empty(&lfsck->ml_dir_queue) ||
+			   !cfs_list_empty(&lfsck->ml_dir_active)))
+		result = 0;
+	spin_unlock(&lfsck->ml_lock);
+
+	return result;
+}
+
+static void mdd_lfsck_threads_fini(const struct lu_env *env,
+				   struct md_lfsck *lfsck)
+{
+	struct lfsck_thread	*threads = lfsck->ml_threads;
+	struct lfsck_dir_item	*ldi;
+
+	cfs_list_splice_init(&lfsck->ml_dir_active, &lfsck->ml_dir_queue);
+	while (!cfs_list_empty(&lfsck->ml_dir_queue)) {
+		ldi = cfs_list_entry(lfsck->ml_dir_queue.next,
+				     struct lfsck_dir_item, ldi_link);
+		cfs_list_del(&ldi->ldi_link);
+		mdd_lfsck_dir_item_free(env, ldi);
+	}
+	lfsck->ml_dir_queued = 0;
+
+	if (threads != NULL) {
+		int i;
+
+		spin_lock(&lfsck->ml_lock);
+		lfsck->ml_threads_last = 0;
+		for (i = 0; i < lfsck->ml_thread_count; i++) {
+			if (threads[i].lt_dirs_scanned > 0)
+				lfsck->ml_threads_last++;
+		}
+		lfsck->ml_threads = NULL;
+		lfsck->ml_thread_count = 0;
+		spin_unlock(&lfsck->ml_lock);
+		OBD_FREE(threads, sizeof(*threads) * LFSCK_THREADS_MAX);
+	}
+}
+
 static int mdd_lfsck_main(void *args)
 {
 	struct lu_env		 env;
@@ -2575,10 +3045,13 @@ static int mdd_lfsck_main(void *args)
 	cfs_waitq_broadcast(&thread->t_ctl_waitq);
 
 	if (!cfs_list_empty(&lfsck->ml_list_scan) ||
-	    cfs_list_empty(&lfsck->ml_list_double_scan))
+	    cfs_list_empty(&lfsck->ml_list_double_scan)) {
+		mdd_lfsck_threads_start(lfsck);
 		rc = mdd_lfsck_oit_engine(&env, lfsck);
-	else
+		rc = mdd_lfsck_threads_stop(&env, lfsck, rc);
+	} else {
 		rc = 1;
+	}
 
 	CDEBUG(D_LFSCK, "LFSCK exit: oit_flags = 0x%x, dir_flags = 0x%x, "
 	       "oit_cookie = "LPU64", dir_cookie = "LPU64", parent = "DFID
@@ -2595,6 +3068,7 @@ static int mdd_lfsck_main(void *args)
 		rc = mdd_lfsck_post(&env, lfsck, rc);
 	if (lfsck->ml_di_dir != NULL)
 		mdd_lfsck_close_dir(&env, lfsck);
+	mdd_lfsck_threads_fini(&env, lfsck);
 
 fini_oit:
 	spin_lock(&lfsck->ml_lock);
@@ -2886,6 +3360,8 @@ int mdd_lfsck_setup(const struct lu_env *env, struct mdd_device *mdd)
 	CFS_INIT_LIST_HEAD(&lfsck->ml_list_dir);
 	CFS_INIT_LIST_HEAD(&lfsck->ml_list_double_scan);
 	CFS_INIT_LIST_HEAD(&lfsck->ml_list_idle);
+	CFS_INIT_LIST_HEAD(&lfsck->ml_dir_queue);
+	CFS_INIT_LIST_HEAD(&lfsck->ml_dir_active);
 	cfs_waitq_init(&lfsck->ml_thread.t_ctl_waitq);
 
 	obj = dt_locate(env, mdd->mdd_bottom, &lfsck_it_fid);
@@ -209,6 +209,7 @@ struct lfsck_operations {
 
 	int (*lfsck_exec_dir)(const struct lu_env *env,
 			      struct lfsck_component *com,
+			      struct dt_object *dir,
 			      struct mdd_object *obj,
 			      struct lu_dirent *ent);
 
@@ -248,6 +249,34 @@ struct lfsck_component {
 	__u16			 lc_type;
 };
 
+/* The max count of the threads for namespace-based directory traversal. */
+#define LFSCK_THREADS_MAX	8
+
+struct lfsck_dir_item {
+	/* into md_lfsck::ml_dir_queue or md_lfsck::ml_dir_active */
+	cfs_list_t		 ldi_link;
+	struct mdd_object	*ldi_obj;
+
+	/* The otable-based iteration position of the directory. */
+	__u64			 ldi_cookie;
+};
+
+struct lfsck_thread {
+	struct ptlrpc_thread	 lt_thread;
+	struct md_lfsck		*lt_lfsck;
+
+	/* How many directories have been traversed by this thread. */
+	__u64			 lt_dirs_scanned;
+
+	/* How many name entries have been checked by this thread. */
+	__u64			 lt_items_scanned;
+
+	/* The time for the thread started, jiffies */
+	cfs_time_t		 lt_time_start;
+	int			 lt_result;
+	__u16			 lt_idx;
+};
+
 struct md_lfsck {
 	struct mutex		 ml_mutex;
 	spinlock_t		 ml_lock;
@@ -303,14 +332,37 @@ struct md_lfsck {
 	/* Sleep N jiffies for each schedule. */
 	__u32			 ml_sleep_jif;
 
-	/* How many objects have been scanned since last sleep. */
+	/* How many objects have been scanned in current time slice. */
 	__u32			 ml_new_scanned;
 
+	/* The end of current time slice, jiffies */
+	cfs_time_t		 ml_speed_window;
+
+	/* The directories found by the otable-based iteration, and to be
+	 * traversed by the helper threads. */
+	cfs_list_t		 ml_dir_queue;
+
+	/* The directories being traversed by the helper threads. */
+	cfs_list_t		 ml_dir_active;
+	__u32			 ml_dir_queued;
+
+	/* The helper threads for directory traversal, NULL if the main
+	 * thread traverses the directories by itself. */
+	struct lfsck_thread	*ml_threads;
+	__u16			 ml_thread_count;
+
+	/* How many helper threads to be started for the next run. */
+	__u16			 ml_threads_max;
+
+	/* How many helper threads traversed directories in the last run. */
+	__u16			 ml_threads_last;
+
 	unsigned int		 ml_paused:1, /* The lfsck is paused. */
 				 ml_oit_over:1, /* oit is finished. */
 				 ml_drop_dryrun:1, /* Ever dryrun, not now. */
 				 ml_initialized:1, /* lfsck_setup is called. */
-				 ml_current_oit_processed:1;
+				 ml_current_oit_processed:1,
+				 ml_dir_producing:1; /* oit may queue dirs. */
 };
 
 enum lfsck_linkea_flags {
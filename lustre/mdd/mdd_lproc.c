@@ -173,6 +173,7 @@ struct cucb_data {
         char *page;
         int count;
         int idx;
+	__u64 cur;
 };
 
 static int lprocfs_changelog_users_cb(const struct lu_env *env,
@@ -186,9 +187,12 @@ static int lprocfs_changelog_users_cb(const struct lu_env *env,
 
         rec = (struct llog_changelog_user_rec *)hdr;
 
-        cucb->idx += snprintf(cucb->page + cucb->idx, cucb->count - cucb->idx,
-                              CHANGELOG_USER_PREFIX"%-3d "LPU64"\n",
-                              rec->cur_id, rec->cur_endrec);
+	/* lag: records this user still has to consume */
+	cucb->idx += snprintf(cucb->page + cucb->idx, cucb->count - cucb->idx,
+			      CHANGELOG_USER_PREFIX"%-3d "LPU64" "LPU64"\n",
+			      rec->cur_id, rec->cur_endrec,
+			      cucb->cur > rec->cur_endrec ?
+			      cucb->cur - rec->cur_endrec : 0);
         if (cucb->idx >= cucb->count)
                 return -ENOSPC;
 
@@ -226,12 +230,13 @@ static int lprocfs_rd_changelog_users(char *page, char **start, off_t off,
         cucb.count = count;
         cucb.page = page;
         cucb.idx = 0;
+	cucb.cur = cur;
 
         cucb.idx += snprintf(cucb.page + cucb.idx, cucb.count - cucb.idx,
                               "current index: "LPU64"\n", cur);
 
         cucb.idx += snprintf(cucb.page + cucb.idx, cucb.count - cucb.idx,
-                              "%-5s %s\n", "ID", "index");
+			      "%-5s %s %s\n", "ID", "index", "lag");
 
 	llog_cat_process(&env, ctxt->loc_handle, lprocfs_changelog_users_cb,
 			 &cucb, 0, 0);
@@ -241,6 +246,25 @@ static int lprocfs_rd_changelog_users(char *page, char **start, off_t off,
 	return cucb.idx;
 }
 
+static int lprocfs_rd_changelog_stats(char *page, char **start, off_t off,
+				      int count, int *eof, void *data)
+{
+	struct mdd_device	*mdd = data;
+	struct llog_ctxt	*ctxt;
+	int			 rc;
+
+	*eof = 1;
+
+	ctxt = llog_get_context(mdd2obd_dev(mdd), LLOG_CHANGELOG_ORIG_CTXT);
+	if (ctxt == NULL)
+		return -ENXIO;
+	LASSERT(ctxt->loc_handle->lgh_hdr->llh_flags & LLOG_F_IS_CAT);
+
+	rc = llog_cat_rd_stats(ctxt->loc_handle, page, count);
+	llog_ctxt_put(ctxt);
+	return rc;
+}
+
 static int lprocfs_rd_sync_perm(char *page, char **start, off_t off,
                                 int count, int *eof, void *data)
 {
@@ -303,6 +327,37 @@ static int lprocfs_wr_lfsck_speed_limit(struct file *file, const char *buffer,
 	return rc != 0 ? rc : count;
 }
 
+static int lprocfs_rd_lfsck_threads(char *page, char **start, off_t off,
+				    int count, int *eof, void *data)
+{
+	struct mdd_device *mdd = data;
+
+	LASSERT(mdd != NULL);
+	*eof = 1;
+	return snprintf(page, count, "%u\n", mdd->mdd_lfsck.ml_threads_max);
+}
+
+static int lprocfs_wr_lfsck_threads(struct file *file, const char *buffer,
+				    unsigned long count, void *data)
+{
+	struct mdd_device *mdd = data;
+	int val;
+	int rc;
+
+	LASSERT(mdd != NULL);
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc != 0)
+		return rc;
+
+	/* 0 means the main LFSCK thread traverses the directories itself.
+	 * The new value takes effect from the next LFSCK run. */
+	if (val < 0 || val > LFSCK_THREADS_MAX)
+		return -ERANGE;
+
+	mdd->mdd_lfsck.ml_threads_max = val;
+	return count;
+}
+
 static int lprocfs_rd_lfsck_namespace(char *page, char **start, off_t off,
 				      int count, int *eof, void *data)
 {
@@ -327,9 +382,12 @@ static struct lprocfs_vars lprocfs_mdd_obd_vars[] = {
         { "changelog_mask",  lprocfs_rd_changelog_mask,
                              lprocfs_wr_changelog_mask, 0 },
         { "changelog_users", lprocfs_rd_changelog_users, 0, 0},
+	{ "changelog_stats", lprocfs_rd_changelog_stats, 0, 0 },
         { "sync_permission", lprocfs_rd_sync_perm, lprocfs_wr_sync_perm, 0 },
 	{ "lfsck_speed_limit", lprocfs_rd_lfsck_speed_limit,
 			       lprocfs_wr_lfsck_speed_limit, 0 },
+	{ "lfsck_threads", lprocfs_rd_lfsck_threads,
+			   lprocfs_wr_lfsck_threads, 0 },
 	{ "lfsck_namespace", lprocfs_rd_lfsck_namespace, 0, 0 },
 	{ 0 }
 };
@@ -1646,6 +1646,7 @@ int mdt_connect(struct mdt_thread_info *info)
 	exp = req->rq_export;
 	spin_lock(&exp->exp_lock);
 	*exp_connect_flags_ptr(exp) = reply->ocd_connect_flags;
+	exp->exp_connect_data.ocd_connect_flags2 = reply->ocd_connect_flags2;
 	exp->exp_mdt_data.med_ibits_known = reply->ocd_ibits_known;
 	exp->exp_connect_data.ocd_brw_size = reply->ocd_brw_size;
 	spin_unlock(&exp->exp_lock);
@@ -1681,8 +1682,13 @@ static int mdt_sendpage(struct mdt_thread_info *info,
         int                      rc;
         ENTRY;
 
-	desc = ptlrpc_prep_bulk_exp(req, rdpg->rp_npages, 1, BULK_PUT_SOURCE,
-				    MDS_BULK_PORTAL);
+	/* A client which negotiated multi-MB readdir posts one bulk per
+	 * LNET_MTU of its buffer and tells us how many via the low bits of
+	 * rq_xid, see ptlrpc_register_bulk(). */
+	desc = ptlrpc_prep_bulk_exp(req, rdpg->rp_npages,
+				    exp_connect_multibulk(exp) ?
+				    PTLRPC_BULK_OPS_COUNT : 1,
+				    BULK_PUT_SOURCE, MDS_BULK_PORTAL);
 	if (desc == NULL)
 		RETURN(-ENOMEM);
 
@@ -1879,13 +1885,16 @@ int mdt_reint(struct mdt_thread_info *info)
 		[REINT_RENAME]   = &RQF_MDS_REINT_RENAME,
 		[REINT_OPEN]     = &RQF_MDS_REINT_OPEN,
 		[REINT_SETXATTR] = &RQF_MDS_REINT_SETXATTR,
-		[REINT_RMENTRY] = &RQF_MDS_REINT_UNLINK
+		[REINT_RMENTRY] = &RQF_MDS_REINT_UNLINK,
+		[REINT_BATCH]    = &RQF_MDS_REINT_BATCH
 	};
 
         ENTRY;
 
         opc = mdt_reint_opcode(info, reint_fmts);
-        if (opc >= 0) {
+	if (opc == REINT_BATCH) {
+		rc = mdt_reint_batch(info);
+	} else if (opc >= 0) {
                 /*
                  * No lock possible here from client to pass it to reint code
                  * path.
@@ -2407,6 +2416,19 @@ int mdt_quota_dqacq(struct mdt_thread_info *info)
 	RETURN(rc);
 }
 
+int mdt_quota_dqacq_batch(struct mdt_thread_info *info)
+{
+	struct lu_device	*qmt = info->mti_mdt->mdt_qmt_dev;
+	int			 rc;
+	ENTRY;
+
+	if (qmt == NULL)
+		RETURN(err_serious(-EOPNOTSUPP));
+
+	rc = qmt_hdls.qmth_dqacq_batch(info->mti_env, qmt, mdt_info_req(info));
+	RETURN(rc);
+}
+
 static struct mdt_object *mdt_obj(struct lu_object *o)
 {
         LASSERT(lu_device_is_mdt(o->lo_dev));
@@ -2645,6 +2667,20 @@ static int mdt_object_lock0(struct mdt_thread_info *info, struct mdt_object *o,
                 }
         }
 
+	/* the records of a batch done so far may hold a conflicting lock,
+	 * it is only released once they are synced. A lock held by anyone
+	 * else syncs the batch early too: waiting for it with the batch
+	 * locks held could deadlock with a thread waiting for those. The
+	 * sync commits the whole device, which is paid once per conflict */
+	if (info->mti_batch_nr_locks > 0 && !nonblock) {
+		rc = mdt_object_lock0(info, o, lh, ibits, true, locality);
+		if (rc != -EIO)
+			RETURN(rc);
+		rc = mdt_batch_sync_unlock(info, 1);
+		if (rc != 0)
+			RETURN(rc);
+	}
+
         memset(policy, 0, sizeof(*policy));
         fid_build_reg_res_name(mdt_object_fid(o), res_id);
 
@@ -2743,6 +2779,16 @@ void mdt_save_lock(struct mdt_thread_info *info, struct lustre_handle *h,
                 if (decref || !info->mti_has_trans ||
                     !(mode & (LCK_PW | LCK_EX))){
                         mdt_fid_unlock(h, mode);
+		} else if (info->mti_batch_locks != NULL) {
+			/* a batch is committed before its reply is sent, the
+			 * locks are held until then, not for the reply ACK */
+			struct mdt_batch_lock *mbl;
+
+			LASSERT(info->mti_batch_nr_locks <
+				info->mti_batch_max_locks);
+			mbl = &info->mti_batch_locks[info->mti_batch_nr_locks++];
+			mbl->mbl_lh = *h;
+			mbl->mbl_mode = mode;
                 } else {
                         struct mdt_device *mdt = info->mti_mdt;
                         struct ldlm_lock *lock = ldlm_handle2lock(h);
@@ -3156,6 +3202,9 @@ static void mdt_thread_info_init(struct ptlrpc_request *req,
         info->mti_dlm_req = NULL;
         info->mti_has_trans = 0;
         info->mti_cross_ref = 0;
+	info->mti_batch_locks = NULL;
+	info->mti_batch_nr_locks = 0;
+	info->mti_batch_max_locks = 0;
         info->mti_opdata = 0;
 	info->mti_big_lmm_used = 0;
 
@@ -3346,6 +3395,7 @@ static int mdt_msg_check_version(struct lustre_msg *msg)
 	case MDS_SWAP_LAYOUTS:
         case QUOTA_DQACQ:
         case QUOTA_DQREL:
+	case QUOTA_DQACQ_BATCH:
         case SEQ_QUERY:
         case FLD_QUERY:
                 rc = lustre_msg_check_version(msg, LUSTRE_MDS_VERSION);
@@ -5266,6 +5316,8 @@ static int mdt_connect_internal(struct obd_export *exp,
 	LASSERT(data != NULL);
 
 	data->ocd_connect_flags &= MDT_CONNECT_SUPPORTED;
+	if (data->ocd_connect_flags & OBD_CONNECT_FLAGS2)
+		data->ocd_connect_flags2 &= MDT_CONNECT_SUPPORTED2;
 	data->ocd_ibits_known &= MDS_INODELOCK_FULL;
 
 	/* If no known bits (which should not happen, probably,
@@ -5284,6 +5336,10 @@ static int mdt_connect_internal(struct obd_export *exp,
 	if (!mdt->mdt_som_conf)
 		data->ocd_connect_flags &= ~OBD_CONNECT_SOM;
 
+	/* batched records carry no capabilities */
+	if (mdt->mdt_opts.mo_mds_capa)
+		data->ocd_connect_flags2 &= ~OBD_CONNECT2_MD_BATCH;
+
 	if (data->ocd_connect_flags & OBD_CONNECT_BRW_SIZE) {
 		data->ocd_brw_size = min(data->ocd_brw_size,
 					 (__u32)MD_MAX_BRW_SIZE);
@@ -5580,6 +5636,10 @@ static int mdt_init_export(struct obd_export *exp)
 	spin_lock_init(&med->med_open_lock);
 	mutex_init(&med->med_idmap_mutex);
 	med->med_idmap = NULL;
+	med->med_batch_xid = 0;
+	med->med_batch_transno = 0;
+	med->med_batch_rcs = NULL;
+	med->med_batch_count = 0;
 	spin_lock(&exp->exp_lock);
 	exp->exp_connecting = 1;
 	spin_unlock(&exp->exp_lock);
@@ -5609,11 +5669,16 @@ err:
 
 static int mdt_destroy_export(struct obd_export *exp)
 {
+	struct mdt_export_data *med = &exp->exp_mdt_data;
         ENTRY;
 
         if (exp_connect_rmtclient(exp))
                 mdt_cleanup_idmap(&exp->exp_mdt_data);
 
+	if (med->med_batch_rcs != NULL)
+		OBD_FREE_LARGE(med->med_batch_rcs,
+			       med->med_batch_count * sizeof(__u32));
+
         target_destroy_export(exp);
         /* destroy can be called from failed obd_setup, so
          * checking uuid is safer than obd_self_export */
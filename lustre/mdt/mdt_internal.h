@@ -245,6 +245,15 @@ struct mdt_lock_handle {
 	ldlm_mode_t	     mlh_rreg_mode;
 };
 
+/* a PW or EX lock taken by a record of a REINT_BATCH */
+struct mdt_batch_lock {
+	struct lustre_handle	mbl_lh;
+	ldlm_mode_t		mbl_mode;
+};
+
+/* Every lock handle of a record may save its regular and its pdo lock */
+#define MDT_BATCH_REC_LOCKS	(MDT_LH_NR * 2)
+
 enum {
         MDT_LH_PARENT, /* parent lockh */
         MDT_LH_CHILD,  /* child lockh */
@@ -397,6 +406,12 @@ struct mdt_thread_info {
         __u32                      mti_has_trans:1, /* has txn already? */
                                    mti_cross_ref:1;
 
+	/* write locks of the REINT_BATCH being handled, released only once
+	 * the batch is synced, see mdt_reint_batch() */
+	struct mdt_batch_lock	  *mti_batch_locks;
+	int			   mti_batch_nr_locks;
+	int			   mti_batch_max_locks;
+
         /* opdata for mdt_reint_open(), has the same as
          * ldlm_reply:lock_policy_res1.  mdt_update_last_rcvd() stores this
          * value onto disk for recovery when mdt_trans_stop_cb() is called.
@@ -678,7 +693,11 @@ int mdt_remote_object_lock(struct mdt_thread_info *mti,
 			   ldlm_mode_t mode, __u64 ibits);
 int mdt_close_unpack(struct mdt_thread_info *info);
 int mdt_reint_unpack(struct mdt_thread_info *info, __u32 op);
+int mdt_batch_unpack(struct mdt_thread_info *info, struct mdt_rec_reint *rec,
+		     const char *name, int namelen);
 int mdt_reint_rec(struct mdt_thread_info *, struct mdt_lock_handle *);
+int mdt_reint_batch(struct mdt_thread_info *info);
+int mdt_batch_sync_unlock(struct mdt_thread_info *info, int sync);
 void mdt_pack_attr2body(struct mdt_thread_info *info, struct mdt_body *b,
                         const struct lu_attr *attr, const struct lu_fid *fid);
 
@@ -803,6 +822,7 @@ extern struct mdt_opc_slice mdt_fld_handlers[];
 int mdt_quotacheck(struct mdt_thread_info *info);
 int mdt_quotactl(struct mdt_thread_info *info);
 int mdt_quota_dqacq(struct mdt_thread_info *info);
+int mdt_quota_dqacq_batch(struct mdt_thread_info *info);
 int mdt_swap_layouts(struct mdt_thread_info *info);
 
 extern struct lprocfs_vars lprocfs_mds_module_vars[];
@@ -760,20 +760,13 @@ static __u64 mdt_attr_valid_xlate(__u64 in, struct mdt_reint_record *rr,
 }
 /* unpacking */
 
-static int mdt_setattr_unpack_rec(struct mdt_thread_info *info)
+static void __mdt_setattr_unpack(struct mdt_thread_info *info,
+				 struct mdt_rec_setattr *rec)
 {
 	struct lu_ucred         *uc  = mdt_ucred(info);
-        struct md_attr          *ma = &info->mti_attr;
-        struct lu_attr          *la = &ma->ma_attr;
-        struct req_capsule      *pill = info->mti_pill;
-        struct mdt_reint_record *rr = &info->mti_rr;
-        struct mdt_rec_setattr  *rec;
-        ENTRY;
-
-        CLASSERT(sizeof(struct mdt_rec_setattr)== sizeof(struct mdt_rec_reint));
-        rec = req_capsule_client_get(pill, &RMF_REC_REINT);
-        if (rec == NULL)
-                RETURN(-EFAULT);
+	struct md_attr          *ma = &info->mti_attr;
+	struct lu_attr          *la = &ma->ma_attr;
+	struct mdt_reint_record *rr = &info->mti_rr;
 
 	/* This prior initialization is needed for old_init_ucred_reint() */
 	uc->uc_fsuid = rec->sa_fsuid;
@@ -813,6 +806,21 @@ static int mdt_setattr_unpack_rec(struct mdt_thread_info *info)
 		ma->ma_attr_flags |= MDS_DATA_MODIFIED;
 	else
 		ma->ma_attr_flags &= ~MDS_DATA_MODIFIED;
+}
+
+static int mdt_setattr_unpack_rec(struct mdt_thread_info *info)
+{
+	struct req_capsule      *pill = info->mti_pill;
+	struct mdt_reint_record *rr = &info->mti_rr;
+	struct mdt_rec_setattr  *rec;
+	ENTRY;
+
+	CLASSERT(sizeof(struct mdt_rec_setattr)== sizeof(struct mdt_rec_reint));
+	rec = req_capsule_client_get(pill, &RMF_REC_REINT);
+	if (rec == NULL)
+		RETURN(-EFAULT);
+
+	__mdt_setattr_unpack(info, rec);
 
         if (req_capsule_get_size(pill, &RMF_CAPA1, RCL_CLIENT))
                 mdt_set_capainfo(info, 0, rr->rr_fid1,
@@ -891,21 +899,13 @@ int mdt_close_unpack(struct mdt_thread_info *info)
 	RETURN(mdt_init_ucred_reint(info));
 }
 
-static int mdt_create_unpack(struct mdt_thread_info *info)
+static void __mdt_create_unpack(struct mdt_thread_info *info,
+				struct mdt_rec_create *rec)
 {
 	struct lu_ucred         *uc  = mdt_ucred(info);
-        struct mdt_rec_create   *rec;
-        struct lu_attr          *attr = &info->mti_attr.ma_attr;
-        struct mdt_reint_record *rr = &info->mti_rr;
-        struct req_capsule      *pill = info->mti_pill;
-        struct md_op_spec       *sp = &info->mti_spec;
-        int rc;
-        ENTRY;
-
-        CLASSERT(sizeof(struct mdt_rec_create) == sizeof(struct mdt_rec_reint));
-        rec = req_capsule_client_get(pill, &RMF_REC_REINT);
-        if (rec == NULL)
-                RETURN(-EFAULT);
+	struct lu_attr          *attr = &info->mti_attr.ma_attr;
+	struct mdt_reint_record *rr = &info->mti_rr;
+	struct md_op_spec       *sp = &info->mti_spec;
 
 	/* This prior initialization is needed for old_init_ucred_reint() */
 	uc->uc_fsuid = rec->cr_fsuid;
@@ -928,6 +928,24 @@ static int mdt_create_unpack(struct mdt_thread_info *info)
 			 LA_CTIME | LA_MTIME | LA_ATIME;
         memset(&sp->u, 0, sizeof(sp->u));
         sp->sp_cr_flags = get_mrc_cr_flags(rec);
+}
+
+static int mdt_create_unpack(struct mdt_thread_info *info)
+{
+	struct mdt_rec_create   *rec;
+	struct lu_attr          *attr = &info->mti_attr.ma_attr;
+	struct mdt_reint_record *rr = &info->mti_rr;
+	struct req_capsule      *pill = info->mti_pill;
+	struct md_op_spec       *sp = &info->mti_spec;
+	int rc;
+	ENTRY;
+
+	CLASSERT(sizeof(struct mdt_rec_create) == sizeof(struct mdt_rec_reint));
+	rec = req_capsule_client_get(pill, &RMF_REC_REINT);
+	if (rec == NULL)
+		RETURN(-EFAULT);
+
+	__mdt_create_unpack(info, rec);
 
         if (req_capsule_get_size(pill, &RMF_CAPA1, RCL_CLIENT))
                 mdt_set_capainfo(info, 0, rr->rr_fid1,
@@ -1005,21 +1023,13 @@ static int mdt_link_unpack(struct mdt_thread_info *info)
         RETURN(rc);
 }
 
-static int mdt_unlink_unpack(struct mdt_thread_info *info)
+static void __mdt_unlink_unpack(struct mdt_thread_info *info,
+				struct mdt_rec_unlink *rec)
 {
 	struct lu_ucred         *uc  = mdt_ucred(info);
-        struct mdt_rec_unlink   *rec;
-        struct md_attr          *ma = &info->mti_attr;
-        struct lu_attr          *attr = &info->mti_attr.ma_attr;
-        struct mdt_reint_record *rr = &info->mti_rr;
-        struct req_capsule      *pill = info->mti_pill;
-        int rc;
-        ENTRY;
-
-        CLASSERT(sizeof(struct mdt_rec_unlink) == sizeof(struct mdt_rec_reint));
-        rec = req_capsule_client_get(pill, &RMF_REC_REINT);
-        if (rec == NULL)
-                RETURN(-EFAULT);
+	struct md_attr          *ma = &info->mti_attr;
+	struct lu_attr          *attr = &info->mti_attr.ma_attr;
+	struct mdt_reint_record *rr = &info->mti_rr;
 
 	/* This prior initialization is needed for old_init_ucred_reint() */
 	uc->uc_fsuid = rec->ul_fsuid;
@@ -1037,6 +1047,27 @@ static int mdt_unlink_unpack(struct mdt_thread_info *info)
         attr->la_mode  = rec->ul_mode;
         attr->la_valid = LA_UID | LA_GID | LA_CTIME | LA_MTIME | LA_MODE;
 
+        if (rec->ul_bias & MDS_VTX_BYPASS)
+                ma->ma_attr_flags |= MDS_VTX_BYPASS;
+        else
+                ma->ma_attr_flags &= ~MDS_VTX_BYPASS;
+}
+
+static int mdt_unlink_unpack(struct mdt_thread_info *info)
+{
+	struct mdt_rec_unlink   *rec;
+	struct mdt_reint_record *rr = &info->mti_rr;
+	struct req_capsule      *pill = info->mti_pill;
+	int rc;
+	ENTRY;
+
+	CLASSERT(sizeof(struct mdt_rec_unlink) == sizeof(struct mdt_rec_reint));
+	rec = req_capsule_client_get(pill, &RMF_REC_REINT);
+	if (rec == NULL)
+		RETURN(-EFAULT);
+
+	__mdt_unlink_unpack(info, rec);
+
         if (req_capsule_get_size(pill, &RMF_CAPA1, RCL_CLIENT))
                 mdt_set_capainfo(info, 0, rr->rr_fid1,
                                  req_capsule_client_get(pill, &RMF_CAPA1));
@@ -1046,11 +1077,6 @@ static int mdt_unlink_unpack(struct mdt_thread_info *info)
 	if (rr->rr_name == NULL || rr->rr_namelen == 0)
 		RETURN(-EFAULT);
 
-        if (rec->ul_bias & MDS_VTX_BYPASS)
-                ma->ma_attr_flags |= MDS_VTX_BYPASS;
-        else
-                ma->ma_attr_flags &= ~MDS_VTX_BYPASS;
-
 	info->mti_spec.no_create = !!req_is_replay(mdt_info_req(info));
 
         rc = mdt_dlmreq_unpack(info);
@@ -1330,3 +1356,62 @@ int mdt_reint_unpack(struct mdt_thread_info *info, __u32 op)
         }
         RETURN(rc);
 }
+
+/**
+ * Unpack one record of a REINT_BATCH request, \a name is the record's name
+ * taken from RMF_BATCH_NAMES or NULL.
+ *
+ * Setattr records may only change attributes, without size, open epoch or
+ * layout, and creates are limited to regular files, directories, fifos and
+ * sockets: everything else needs request fields which are not in a batch.
+ */
+int mdt_batch_unpack(struct mdt_thread_info *info, struct mdt_rec_reint *rec,
+		     const char *name, int namelen)
+{
+	struct md_attr          *ma = &info->mti_attr;
+	struct mdt_reint_record *rr = &info->mti_rr;
+	int rc = 0;
+	ENTRY;
+
+	memset(rr, 0, sizeof(*rr));
+	memset(ma, 0, sizeof(*ma));
+	info->mti_spec.no_create = 0;
+	info->mti_spec.sp_rm_entry = 0;
+	rr->rr_opcode = rec->rr_opcode;
+
+	switch (rec->rr_opcode) {
+	case REINT_SETATTR:
+		__mdt_setattr_unpack(info, (struct mdt_rec_setattr *)rec);
+		if (ma->ma_attr.la_valid == 0 ||
+		    ma->ma_attr.la_valid & (LA_SIZE | LA_BLOCKS) ||
+		    rr->rr_flags & MRF_OPEN_TRUNC)
+			rc = -EOPNOTSUPP;
+		break;
+	case REINT_CREATE:
+		__mdt_create_unpack(info, (struct mdt_rec_create *)rec);
+		mdt_set_capainfo(info, 1, rr->rr_fid2, BYPASS_CAPA);
+		switch (ma->ma_attr.la_mode & S_IFMT) {
+		case S_IFREG:
+		case S_IFDIR:
+		case S_IFIFO:
+		case S_IFSOCK:
+			break;
+		default:
+			rc = -EOPNOTSUPP;
+		}
+		break;
+	case REINT_UNLINK:
+		__mdt_unlink_unpack(info, (struct mdt_rec_unlink *)rec);
+		break;
+	default:
+		rc = -EOPNOTSUPP;
+	}
+
+	if (rc == 0 && rec->rr_opcode != REINT_SETATTR) {
+		if (name == NULL || namelen == 0)
+			RETURN(-EFAULT);
+		rr->rr_name = name;
+		rr->rr_namelen = namelen;
+	}
+	RETURN(rc);
+}
@@ -206,6 +206,7 @@ DEF_SEC_HDL(0,				SEC_CTX_FINI,	  mdt_sec_ctx_handle)
 
 static struct mdt_handler mdt_quota_ops[] = {
 DEF_QUOTA_HDL(HABEO_REFERO,		QUOTA_DQACQ,	  mdt_quota_dqacq),
+DEF_QUOTA_HDL(0,			QUOTA_DQACQ_BATCH, mdt_quota_dqacq_batch),
 };
 
 struct mdt_opc_slice mdt_regular_handlers[] = {
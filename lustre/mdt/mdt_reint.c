@@ -1374,3 +1374,269 @@ int mdt_reint_rec(struct mdt_thread_info *info,
 
         RETURN(rc);
 }
+
+/*
+ * Attribute-only setattr of a REINT_BATCH record. There is no open epoch,
+ * layout or size change here and the reply body is shared by the whole
+ * batch, so the reply handling of mdt_reint_setattr() does not apply.
+ */
+static int mdt_reint_batch_setattr(struct mdt_thread_info *info)
+{
+	struct md_attr          *ma = &info->mti_attr;
+	struct mdt_reint_record *rr = &info->mti_rr;
+	struct mdt_object       *mo;
+	int                      rc;
+	ENTRY;
+
+	DEBUG_REQ(D_INODE, mdt_info_req(info), "batch setattr "DFID" %x",
+		  PFID(rr->rr_fid1), (unsigned int)ma->ma_attr.la_valid);
+
+	mo = mdt_object_find(info->mti_env, info->mti_mdt, rr->rr_fid1);
+	if (IS_ERR(mo))
+		RETURN(PTR_ERR(mo));
+
+	if (mdt_object_remote(mo))
+		GOTO(out_put, rc = -EREMOTE);
+
+	ma->ma_valid = MA_INODE;
+	rc = mdt_attr_set(info, mo, ma, rr->rr_flags);
+	if (rc == 0)
+		mdt_counter_incr(mdt_info_req(info), LPROC_MDT_SETATTR);
+	EXIT;
+out_put:
+	mdt_object_put(info->mti_env, mo);
+	return rc;
+}
+
+static int mdt_reint_batch_one(struct mdt_thread_info *info,
+			       struct mdt_rec_reint *rec, const char *name,
+			       int namelen)
+{
+	int rc;
+	ENTRY;
+
+	/* every record is a transaction of its own */
+	info->mti_has_trans = 0;
+	info->mti_transno = 0;
+	info->mti_mos = NULL;
+	info->mti_dlm_req = NULL;
+
+	rc = mdt_batch_unpack(info, rec, name, namelen);
+	if (rc != 0)
+		RETURN(rc);
+
+	rc = mdt_init_ucred_reint(info);
+	if (rc != 0)
+		RETURN(rc);
+
+	rc = mdt_fix_attr_ucred(info, rec->rr_opcode);
+	if (rc == 0) {
+		if (rec->rr_opcode == REINT_SETATTR)
+			rc = mdt_reint_batch_setattr(info);
+		else
+			rc = mdt_reint_rec(info, NULL);
+	}
+	mdt_exit_ucred(info);
+
+	RETURN(clear_serious(rc));
+}
+
+static inline int mdt_batch_rec_named(const struct mdt_rec_reint *rec)
+{
+	return rec->rr_opcode == REINT_CREATE || rec->rr_opcode == REINT_UNLINK;
+}
+
+/**
+ * Sync the records of the REINT_BATCH being handled done so far if \a sync
+ * is set, and release the write locks they hold. Nobody may see the changes
+ * made under these locks before they are committed, as the client does not
+ * replay a batch.
+ */
+int mdt_batch_sync_unlock(struct mdt_thread_info *info, int sync)
+{
+	struct mdt_batch_lock *mbl;
+	int                    rc = 0;
+	int                    i;
+
+	if (sync)
+		rc = dt_sync(info->mti_env, info->mti_mdt->mdt_bottom);
+
+	for (i = 0; i < info->mti_batch_nr_locks; i++) {
+		mbl = &info->mti_batch_locks[i];
+		mdt_fid_unlock(&mbl->mbl_lh, mbl->mbl_mode);
+	}
+	info->mti_batch_nr_locks = 0;
+
+	return rc;
+}
+
+/* Put the results saved by mdt_batch_save() into the reply of a resent
+ * batch. */
+static int mdt_batch_reconstruct(struct mdt_thread_info *info, __u32 *rcs,
+				 int count)
+{
+	struct ptlrpc_request  *req = mdt_info_req(info);
+	struct obd_export      *exp = req->rq_export;
+	struct mdt_export_data *med = &exp->exp_mdt_data;
+	int                     found = 0;
+
+	spin_lock(&exp->exp_lock);
+	if (med->med_batch_xid == req->rq_xid &&
+	    med->med_batch_count == count) {
+		memcpy(rcs, med->med_batch_rcs, count * sizeof(*rcs));
+		req->rq_transno = med->med_batch_transno;
+		found = 1;
+	}
+	spin_unlock(&exp->exp_lock);
+
+	if (found) {
+		DEBUG_REQ(D_HA, req, "restoring %d batch results, transno "
+			  LPU64, count, req->rq_transno);
+		lustre_msg_set_transno(req->rq_repmsg, req->rq_transno);
+	}
+	return found;
+}
+
+/* Keep the results of a batch for its resend, in place of those of the
+ * previous batch of this client. */
+static void mdt_batch_save(struct mdt_thread_info *info, __u32 *rcs,
+			   int count)
+{
+	struct ptlrpc_request  *req = mdt_info_req(info);
+	struct obd_export      *exp = req->rq_export;
+	struct mdt_export_data *med = &exp->exp_mdt_data;
+	__u32                  *saved;
+	int                     saved_count;
+
+	OBD_ALLOC_LARGE(saved, count * sizeof(*saved));
+	if (saved != NULL)
+		memcpy(saved, rcs, count * sizeof(*saved));
+
+	/* without memory the last results are just dropped, a resend of
+	 * this batch then runs the records again */
+	spin_lock(&exp->exp_lock);
+	swap(med->med_batch_rcs, saved);
+	saved_count = med->med_batch_count;
+	med->med_batch_count = med->med_batch_rcs != NULL ? count : 0;
+	med->med_batch_xid = med->med_batch_rcs != NULL ? req->rq_xid : 0;
+	med->med_batch_transno = req->rq_transno;
+	spin_unlock(&exp->exp_lock);
+
+	if (saved != NULL)
+		OBD_FREE_LARGE(saved, saved_count * sizeof(*saved));
+}
+
+/**
+ * Handle a REINT_BATCH request: run every record as a reint of its own and
+ * return the per-record results in RMF_RCS.
+ *
+ * The device is synced at the end, so the batch is committed before the
+ * reply goes out and the client never has to replay it. The PW and EX locks
+ * of the records are held until then rather than until the reply ACK, see
+ * mdt_save_lock(); a record which has to wait for one of them syncs the
+ * batch early, see mdt_object_lock0(). The sync commits everything pending
+ * on the whole device, not just the batch, and is paid for once per batch.
+ *
+ * The results are kept in the export, so the reply of a resent batch is
+ * rebuilt from them instead of running the records again. They are not
+ * kept over a server restart.
+ */
+int mdt_reint_batch(struct mdt_thread_info *info)
+{
+	struct req_capsule     *pill = info->mti_pill;
+	struct ptlrpc_request  *req = mdt_info_req(info);
+	struct mdt_device      *mdt = info->mti_mdt;
+	struct mdt_rec_reint   *recs;
+	struct ldlm_request    *dlm_req;
+	struct mdt_body        *repbody;
+	struct mdt_batch_lock  *locks;
+	char                   *names, *name, *end = NULL;
+	__u32                  *rcs;
+	int                     count, len, i, rc;
+	ENTRY;
+
+	if (!exp_connect_md_batch(info->mti_exp) || mdt->mdt_opts.mo_mds_capa)
+		RETURN(err_serious(-EOPNOTSUPP));
+
+	recs = req_capsule_client_get(pill, &RMF_BATCH_RECS);
+	count = req_capsule_get_size(pill, &RMF_BATCH_RECS, RCL_CLIENT) /
+		sizeof(*recs);
+	if (recs == NULL || count == 0 || count > MDS_BATCH_MAX_OPS)
+		RETURN(err_serious(-EPROTO));
+
+	/* a batch of setattrs only has no names */
+	len = req_capsule_get_size(pill, &RMF_BATCH_NAMES, RCL_CLIENT);
+	names = len ? req_capsule_client_get(pill, &RMF_BATCH_NAMES) : NULL;
+	if (names != NULL)
+		end = names + len;
+
+	/* every create and unlink takes the next name, make sure they are all
+	 * there before anything is done */
+	for (i = 0, name = names; i < count; i++) {
+		if (!mdt_batch_rec_named(&recs[i]))
+			continue;
+		if (name >= end)
+			RETURN(err_serious(-EPROTO));
+		len = strnlen(name, end - name);
+		if (len == 0 || len == end - name)
+			RETURN(err_serious(-EPROTO));
+		name += len + 1;
+	}
+
+	if (req_capsule_get_size(pill, &RMF_DLM_REQ, RCL_CLIENT)) {
+		dlm_req = req_capsule_client_get(pill, &RMF_DLM_REQ);
+		if (dlm_req == NULL)
+			RETURN(err_serious(-EFAULT));
+		ldlm_request_cancel(req, dlm_req, 0);
+	}
+
+	req_capsule_set_size(pill, &RMF_RCS, RCL_SERVER,
+			     count * sizeof(*rcs));
+	rc = req_capsule_server_pack(pill);
+	if (rc != 0)
+		RETURN(err_serious(rc));
+
+	repbody = req_capsule_server_get(pill, &RMF_MDT_BODY);
+	rcs = req_capsule_server_get(pill, &RMF_RCS);
+	LASSERT(repbody != NULL && rcs != NULL);
+
+	if ((lustre_msg_get_flags(req->rq_reqmsg) & MSG_RESENT) &&
+	    mdt_batch_reconstruct(info, rcs, count))
+		GOTO(out, rc = 0);
+
+	OBD_ALLOC_LARGE(locks, count * MDT_BATCH_REC_LOCKS * sizeof(*locks));
+	if (locks == NULL)
+		RETURN(err_serious(-ENOMEM));
+
+	info->mti_batch_locks = locks;
+	info->mti_batch_nr_locks = 0;
+	info->mti_batch_max_locks = count * MDT_BATCH_REC_LOCKS;
+	for (i = 0, name = names; i < count; i++) {
+		len = 0;
+		if (mdt_batch_rec_named(&recs[i]))
+			len = strlen(name);
+		rcs[i] = mdt_reint_batch_one(info, &recs[i], len ? name : NULL,
+					     len);
+		name += len ? len + 1 : 0;
+	}
+
+	CDEBUG(D_INODE, "%s: batch of %d records, last transno "LPU64"\n",
+	       mdt_obd_name(mdt), count, req->rq_transno);
+
+	rc = mdt_batch_sync_unlock(info, req->rq_transno != 0);
+	info->mti_batch_locks = NULL;
+	info->mti_batch_max_locks = 0;
+	OBD_FREE_LARGE(locks, count * MDT_BATCH_REC_LOCKS * sizeof(*locks));
+
+	if (rc == 0)
+		mdt_batch_save(info, rcs, count);
+	EXIT;
+out:
+	/* the body and capabilities of the single records mean nothing to the
+	 * client */
+	memset(repbody, 0, sizeof(*repbody));
+	req_capsule_shrink(pill, &RMF_CAPA1, 0, RCL_SERVER);
+	req_capsule_shrink(pill, &RMF_CAPA2, 0, RCL_SERVER);
+
+	return rc;
+}
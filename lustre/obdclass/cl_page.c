@@ -273,10 +273,61 @@ int cl_page_gang_lookup(const struct lu_env *env, struct cl_object *obj,
 }
 EXPORT_SYMBOL(cl_page_gang_lookup);
 
+/**
+ * Slab cache for cl_page buffers of a given size.
+ *
+ * A cl_page and the slices of all layers are allocated as a single buffer
+ * whose size depends on the layers of the object stack, see
+ * cl_object_page_init(). There are only a few distinct stacks (e.g. vvp/lov
+ * and lovsub/osc), so a cache is created for every size on first use.
+ */
+struct cl_page_kmem {
+	cfs_list_t		 cpk_linkage;
+	unsigned short		 cpk_size;
+	cfs_mem_cache_t		*cpk_cache;
+	char			 cpk_name[24];
+};
+
+static CFS_LIST_HEAD(cl_page_kmem_list);
+static DEFINE_MUTEX(cl_page_kmem_mutex);
+
+static cfs_mem_cache_t *cl_page_kmem_find(unsigned short size)
+{
+	struct cl_page_kmem *kmem;
+	cfs_mem_cache_t     *cache = NULL;
+
+	mutex_lock(&cl_page_kmem_mutex);
+	cfs_list_for_each_entry(kmem, &cl_page_kmem_list, cpk_linkage) {
+		if (kmem->cpk_size == size) {
+			cache = kmem->cpk_cache;
+			goto out;
+		}
+	}
+
+	OBD_ALLOC_PTR(kmem);
+	if (kmem == NULL)
+		goto out;
+
+	snprintf(kmem->cpk_name, sizeof(kmem->cpk_name), "cl_page_kmem-%u",
+		 size);
+	kmem->cpk_cache = cfs_mem_cache_create(kmem->cpk_name, size, 0, 0);
+	if (kmem->cpk_cache == NULL) {
+		OBD_FREE_PTR(kmem);
+		goto out;
+	}
+	kmem->cpk_size = size;
+	cfs_list_add(&kmem->cpk_linkage, &cl_page_kmem_list);
+	cache = kmem->cpk_cache;
+out:
+	mutex_unlock(&cl_page_kmem_mutex);
+	return cache;
+}
+
 static void cl_page_free(const struct lu_env *env, struct cl_page *page)
 {
         struct cl_object *obj  = page->cp_obj;
-	int pagesize = cl_object_header(obj)->coh_page_bufsize;
+	struct cl_object_header *hdr = cl_object_header(obj);
+	int pagesize = hdr->coh_page_bufsize;
 
         PASSERT(env, page, cfs_list_empty(&page->cp_batch));
         PASSERT(env, page, page->cp_owner == NULL);
@@ -299,7 +350,7 @@ static void cl_page_free(const struct lu_env *env, struct cl_page *page)
         lu_object_ref_del_at(&obj->co_lu, page->cp_obj_ref, "cl_page", page);
         cl_object_put(env, obj);
         lu_ref_fini(&page->cp_reference);
-        OBD_FREE(page, pagesize);
+	OBD_SLAB_FREE(page, hdr->coh_page_kmem, pagesize);
         EXIT;
 }
 
@@ -318,17 +369,23 @@ static struct cl_page *cl_page_alloc(const struct lu_env *env,
 		struct cl_object *o, pgoff_t ind, struct page *vmpage,
 		enum cl_page_type type)
 {
+	struct cl_object_header *hdr = cl_object_header(o);
 	struct cl_page          *page;
 	struct lu_object_header *head;
 
 	ENTRY;
-	OBD_ALLOC_GFP(page, cl_object_header(o)->coh_page_bufsize,
-			CFS_ALLOC_IO);
+	if (unlikely(hdr->coh_page_kmem == NULL)) {
+		hdr->coh_page_kmem = cl_page_kmem_find(hdr->coh_page_bufsize);
+		if (hdr->coh_page_kmem == NULL)
+			RETURN(ERR_PTR(-ENOMEM));
+	}
+
+	OBD_SLAB_ALLOC_GFP(page, hdr->coh_page_kmem, hdr->coh_page_bufsize,
+			   CFS_ALLOC_IO);
 	if (page != NULL) {
 		int result = 0;
-		cfs_atomic_set(&page->cp_ref, 1);
-		if (type == CPT_CACHEABLE) /* for radix tree */
-			cfs_atomic_inc(&page->cp_ref);
+		/* one more reference for radix tree */
+		cfs_atomic_set(&page->cp_ref, type == CPT_CACHEABLE ? 2 : 1);
 		page->cp_obj = o;
 		cl_object_get(o);
 		page->cp_obj_ref = lu_object_ref_add(&o->co_lu, "cl_page",page);
@@ -1628,4 +1685,15 @@ int  cl_page_init(void)
 
 void cl_page_fini(void)
 {
+	struct cl_page_kmem *kmem;
+	int                  rc;
+
+	while (!cfs_list_empty(&cl_page_kmem_list)) {
+		kmem = cfs_list_entry(cl_page_kmem_list.next,
+				      struct cl_page_kmem, cpk_linkage);
+		cfs_list_del(&kmem->cpk_linkage);
+		rc = cfs_mem_cache_destroy(kmem->cpk_cache);
+		LASSERTF(rc == 0, "%s: %d\n", kmem->cpk_name, rc);
+		OBD_FREE_PTR(kmem);
+	}
 }
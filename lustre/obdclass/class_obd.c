@@ -107,6 +107,8 @@ int at_early_margin = 10;
 EXPORT_SYMBOL(at_early_margin);
 int at_extra = 30;
 EXPORT_SYMBOL(at_extra);
+unsigned int at_percentile = 95;
+EXPORT_SYMBOL(at_percentile);
 
 cfs_atomic_t obd_dirty_transit_pages;
 EXPORT_SYMBOL(obd_dirty_transit_pages);
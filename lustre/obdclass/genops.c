@@ -1019,14 +1019,21 @@ EXPORT_SYMBOL(class_import_put);
 
 static void init_imp_at(struct imp_at *at) {
         int i;
-        at_init(&at->iat_net_latency, 0, 0);
+	at_init_qhist(&at->iat_net_latency, 0, AT_FLG_QUANTILE,
+		      &at->iat_net_latency_qhist);
         for (i = 0; i < IMP_AT_MAX_PORTALS; i++) {
                 /* max service estimates are tracked on the server side, so
                    don't use the AT history here, just use the last reported
                    val. (But keep hist for proc histogram, worst_ever) */
-                at_init(&at->iat_service_estimate[i], INITIAL_CONNECT_TIMEOUT,
-                        AT_FLG_NOHIST);
+		at_init_qhist(&at->iat_service_estimate[i],
+			      INITIAL_CONNECT_TIMEOUT, AT_FLG_NOHIST,
+			      &at->iat_service_qhist[i]);
         }
+	/* the service times of single opcodes are only used once enough of
+	 * them are known, see ptlrpc_at_set_req_timeout() */
+	for (i = 0; i < IMP_AT_MAX_OPCODES; i++)
+		at_init_qhist(&at->iat_opc_estimate[i], 0, AT_FLG_QUANTILE,
+			      &at->iat_opc_qhist[i]);
 }
 
 struct obd_import *class_new_import(struct obd_device *obd)
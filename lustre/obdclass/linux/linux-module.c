@@ -430,6 +430,12 @@ int class_procfs_init(void)
                                 &obd_device_list_fops, NULL);
         if (rc)
                 CERROR("error adding /proc/fs/lustre/devices file\n");
+#ifdef LPROCFS
+	rc = lprocfs_seq_create(proc_lustre_root, "stats_export", 0444,
+				&lprocfs_stats_export_fops, NULL);
+	if (rc)
+		CERROR("error adding /proc/fs/lustre/stats_export file\n");
+#endif
 #else
         ENTRY;
 #endif
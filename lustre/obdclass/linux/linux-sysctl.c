@@ -79,6 +79,7 @@ enum {
         OBD_AT_EXTRA,
         OBD_AT_EARLY_MARGIN,
         OBD_AT_HISTORY,
+	OBD_AT_PERCENTILE,
 };
 
 #else
@@ -104,6 +105,7 @@ enum {
 #define OBD_AT_EXTRA            CTL_UNNUMBERED
 #define OBD_AT_EARLY_MARGIN     CTL_UNNUMBERED
 #define OBD_AT_HISTORY          CTL_UNNUMBERED
+#define OBD_AT_PERCENTILE	CTL_UNNUMBERED
 
 #endif
 
@@ -308,6 +310,10 @@ int LL_PROC_PROTO(proc_at_history)
 {
         return ll_proc_dointvec(table, write, filp, buffer, lenp, ppos);
 }
+int LL_PROC_PROTO(proc_at_percentile)
+{
+	return ll_proc_dointvec(table, write, filp, buffer, lenp, ppos);
+}
 
 #ifdef CONFIG_SYSCTL
 static cfs_sysctl_table_t obd_table[] = {
@@ -441,6 +447,14 @@ static cfs_sysctl_table_t obd_table[] = {
                 .mode     = 0644,
                 .proc_handler = &proc_at_history
         },
+	{
+		INIT_CTL_NAME(OBD_AT_PERCENTILE)
+		.procname = "at_percentile",
+		.data     = &at_percentile,
+		.maxlen   = sizeof(int),
+		.mode     = 0644,
+		.proc_handler = &proc_at_percentile
+	},
         {       INIT_CTL_NAME(0)    }
 };
 
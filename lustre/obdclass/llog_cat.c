@@ -334,10 +334,14 @@ int llog_cat_add_rec(const struct lu_env *env, struct llog_handle *cathandle,
 		     void *buf, struct thandle *th)
 {
         struct llog_handle *loghandle;
+	struct timeval start;
+	struct timeval end;
+	long usec;
         int rc;
         ENTRY;
 
         LASSERT(rec->lrh_len <= LLOG_CHUNK_SIZE);
+	cfs_gettimeofday(&start);
 	loghandle = llog_cat_current_log(cathandle, th);
 	LASSERT(!IS_ERR(loghandle));
 
@@ -356,6 +360,10 @@ int llog_cat_add_rec(const struct lu_env *env, struct llog_handle *cathandle,
 			     "llog_write_rec %d: lh=%p\n", rc, loghandle);
 	up_write(&loghandle->lgh_lock);
         if (rc == -ENOSPC) {
+		spin_lock(&cathandle->lgh_hdr_lock);
+		cathandle->u.chd.chd_log_switch++;
+		spin_unlock(&cathandle->lgh_hdr_lock);
+
 		/* try to use next log */
 		loghandle = llog_cat_current_log(cathandle, th);
 		LASSERT(!IS_ERR(loghandle));
@@ -375,6 +383,18 @@ int llog_cat_add_rec(const struct lu_env *env, struct llog_handle *cathandle,
 		up_write(&loghandle->lgh_lock);
 	}
 
+	if (rc >= 0) {
+		cfs_gettimeofday(&end);
+		usec = cfs_timeval_sub(&end, &start, NULL);
+		spin_lock(&cathandle->lgh_hdr_lock);
+		cathandle->u.chd.chd_rec_count++;
+		cathandle->u.chd.chd_rec_bytes += rec->lrh_len;
+		cathandle->u.chd.chd_append_usec += usec;
+		if (usec > cathandle->u.chd.chd_append_max)
+			cathandle->u.chd.chd_append_max = usec;
+		spin_unlock(&cathandle->lgh_hdr_lock);
+	}
+
 	RETURN(rc);
 }
 EXPORT_SYMBOL(llog_cat_add_rec);
@@ -554,6 +574,7 @@ int llog_cat_process_cb(const struct lu_env *env, struct llog_handle *cat_llh,
                 CERROR("invalid record in catalog\n");
                 RETURN(-EINVAL);
         }
+
 	CDEBUG(D_HA, "processing log "DOSTID":%x at index %u of catalog "
 	       DOSTID"\n", POSTID(&lir->lid_id.lgl_oi), lir->lid_id.lgl_ogen,
 	       rec->lrh_index, POSTID(&cat_llh->lgh_id.lgl_oi));
@@ -869,3 +890,31 @@ int llog_cat_init_and_process(const struct lu_env *env,
 }
 EXPORT_SYMBOL(llog_cat_init_and_process);
 
+/**
+ * Print the append statistics of catalog \a cathandle into \a page, for
+ * use by the lprocfs read handlers of catalog owners.
+ */
+int llog_cat_rd_stats(struct llog_handle *cathandle, char *page, int count)
+{
+	struct cat_handle_data	chd;
+	__u64			avg = 0;
+
+	spin_lock(&cathandle->lgh_hdr_lock);
+	chd = cathandle->u.chd;
+	spin_unlock(&cathandle->lgh_hdr_lock);
+
+	if (chd.chd_rec_count != 0) {
+		avg = chd.chd_append_usec;
+		do_div(avg, chd.chd_rec_count);
+	}
+
+	return snprintf(page, count,
+			"records: "LPU64"\n"
+			"bytes: "LPU64"\n"
+			"append_avg_usec: "LPU64"\n"
+			"append_max_usec: "LPU64"\n"
+			"log_switches: "LPU64"\n",
+			chd.chd_rec_count, chd.chd_rec_bytes, avg,
+			chd.chd_append_max, chd.chd_log_switch);
+}
+EXPORT_SYMBOL(llog_cat_rd_stats);
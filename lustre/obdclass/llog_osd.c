@@ -206,6 +206,46 @@ out:
 	RETURN(rc);
 }
 
+/**
+ * Write the parts of an existing llog header changed by setting or clearing
+ * bit \a index: llh_count, the bitmap word holding \a index and the tail.
+ * This avoids rewriting the whole LLOG_CHUNK_SIZE header for each record,
+ * the header is only written in full when the llog is empty.
+ */
+static int llog_osd_write_hdr_update(const struct lu_env *env,
+				     struct dt_object *o,
+				     struct llog_log_hdr *llh, int index,
+				     struct thandle *th)
+{
+	struct llog_thread_info	*lgi = llog_info(env);
+	int			 rc;
+
+	lgi->lgi_off = offsetof(struct llog_log_hdr, llh_count);
+	lgi->lgi_buf.lb_buf = &llh->llh_count;
+	lgi->lgi_buf.lb_len = sizeof(llh->llh_count);
+	rc = dt_record_write(env, o, &lgi->lgi_buf, &lgi->lgi_off, th);
+	if (rc)
+		goto out;
+
+	lgi->lgi_off = offsetof(struct llog_log_hdr, llh_bitmap) +
+		       (index / 32) * sizeof(__u32);
+	lgi->lgi_buf.lb_buf = &llh->llh_bitmap[index / 32];
+	lgi->lgi_buf.lb_len = sizeof(__u32);
+	rc = dt_record_write(env, o, &lgi->lgi_buf, &lgi->lgi_off, th);
+	if (rc)
+		goto out;
+
+	lgi->lgi_off = offsetof(struct llog_log_hdr, llh_tail);
+	lgi->lgi_buf.lb_buf = &llh->llh_tail;
+	lgi->lgi_buf.lb_len = sizeof(llh->llh_tail);
+	rc = dt_record_write(env, o, &lgi->lgi_buf, &lgi->lgi_off, th);
+out:
+	if (rc)
+		CERROR("%s: error updating log header: rc = %d\n",
+		       o->do_lu.lo_dev->ld_obd->obd_name, rc);
+	return rc;
+}
+
 static int llog_osd_read_header(const struct lu_env *env,
 				struct llog_handle *handle)
 {
@@ -332,6 +372,8 @@ static int llog_osd_write_rec(const struct lu_env *env,
 	struct llog_rec_tail	*lrt;
 	struct dt_object	*o;
 	size_t			 left;
+	loff_t			 rec_off;
+	bool			 hdr_written;
 
 	ENTRY;
 
@@ -464,19 +506,21 @@ static int llog_osd_write_rec(const struct lu_env *env,
 	old_tail_idx = llh->llh_tail.lrt_index;
 	llh->llh_tail.lrt_index = index;
 
-	lgi->lgi_off = 0;
-	rc = llog_osd_write_blob(env, o, &llh->llh_hdr, NULL, &lgi->lgi_off,
-				 th);
-	if (rc)
-		GOTO(out, rc);
-
-	rc = dt_attr_get(env, o, &lgi->lgi_attr, NULL);
+	/* the record goes right after the padding, or after the header if
+	 * this is the first one */
+	hdr_written = lgi->lgi_off != 0;
+	rec_off = hdr_written ? lgi->lgi_off : LLOG_CHUNK_SIZE;
+	if (hdr_written) {
+		rc = llog_osd_write_hdr_update(env, o, llh, index, th);
+	} else {
+		lgi->lgi_off = 0;
+		rc = llog_osd_write_blob(env, o, &llh->llh_hdr, NULL,
+					 &lgi->lgi_off, th);
+	}
 	if (rc)
 		GOTO(out, rc);
 
-	LASSERT(lgi->lgi_attr.la_valid & LA_SIZE);
-	lgi->lgi_off = lgi->lgi_attr.la_size;
-
+	lgi->lgi_off = rec_off;
 	rc = llog_osd_write_blob(env, o, rec, buf, &lgi->lgi_off, th);
 
 out:
@@ -490,9 +534,13 @@ out:
 		/* restore the header */
 		loghandle->lgh_last_idx--;
 		llh->llh_tail.lrt_index = old_tail_idx;
-		lgi->lgi_off = 0;
-		llog_osd_write_blob(env, o, &llh->llh_hdr, NULL,
-				    &lgi->lgi_off, th);
+		if (hdr_written) {
+			llog_osd_write_hdr_update(env, o, llh, index, th);
+		} else {
+			lgi->lgi_off = 0;
+			llog_osd_write_blob(env, o, &llh->llh_hdr, NULL,
+					    &lgi->lgi_off, th);
+		}
 	}
 
 	CDEBUG(D_RPCTRACE, "added record "DOSTID": idx: %u, %u\n",
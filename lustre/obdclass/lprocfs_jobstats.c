@@ -77,8 +77,26 @@ struct job_stat {
 	time_t                js_timestamp; /* seconds */
 	struct lprocfs_stats *js_stats;
 	struct obd_job_stats *js_jobstats;
+	/* log2 usec histograms, shared by all CPUs to keep a job small */
+	cfs_atomic_t          js_lat[JOBSTATS_LAT_LAST][JOBSTATS_LAT_BUCKETS];
 };
 
+static const char *job_lat_names[JOBSTATS_LAT_LAST] = {
+	[JOBSTATS_LAT_QUEUE]	= "queue_wait",
+	[JOBSTATS_LAT_HANDLE]	= "handle_time",
+	[JOBSTATS_LAT_BULK]	= "bulk_time",
+};
+
+/* bucket 0 counts 0 usecs, bucket i counts [2^(i-1), 2^i) usecs */
+static inline int job_lat_bucket(long usec)
+{
+	if (usec <= 0)
+		return 0;
+	if (usec >= 1L << (JOBSTATS_LAT_BUCKETS - 2))
+		return JOBSTATS_LAT_BUCKETS - 1;
+	return fls(usec);
+}
+
 static unsigned job_stat_hash(cfs_hash_t *hs, const void *key, unsigned mask)
 {
 	return cfs_hash_djb2_hash(key, strlen(key), mask);
@@ -268,6 +286,39 @@ found:
 }
 EXPORT_SYMBOL(lprocfs_job_stats_log);
 
+/**
+ * Account the latency breakdown \a lat (usecs, indexed by JOBSTATS_LAT_*)
+ * of one request to job \a jobid. Negative entries are not accounted, e.g.
+ * the bulk time of requests without bulk transfer.
+ *
+ * Only jobs which have had an operation logged by lprocfs_job_stats_log()
+ * are tracked, so requests which are not counted in the job stats (pings,
+ * connects, ...) don't create entries of their own.
+ */
+void lprocfs_job_stats_lat(struct obd_device *obd, char *jobid, long *lat)
+{
+	struct obd_job_stats *stats = &obd->u.obt.obt_jobstats;
+	struct job_stat *job;
+	int i;
+
+	if (stats->ojs_hash == NULL || jobid == NULL || jobid[0] == '\0' ||
+	    strnlen(jobid, JOBSTATS_JOBID_SIZE) == JOBSTATS_JOBID_SIZE)
+		return;
+
+	job = cfs_hash_lookup(stats->ojs_hash, jobid);
+	if (job == NULL)
+		return;
+
+	for (i = 0; i < JOBSTATS_LAT_LAST; i++) {
+		if (lat[i] < 0)
+			continue;
+		cfs_atomic_inc(&job->js_lat[i][job_lat_bucket(lat[i])]);
+	}
+
+	job_putref(job);
+}
+EXPORT_SYMBOL(lprocfs_job_stats_lat);
+
 void lprocfs_job_stats_fini(struct obd_device *obd)
 {
 	struct obd_job_stats *stats = &obd->u.obt.obt_jobstats;
@@ -282,33 +333,76 @@ void lprocfs_job_stats_fini(struct obd_device *obd)
 }
 EXPORT_SYMBOL(lprocfs_job_stats_fini);
 
+/*
+ * Reading job_stats restarts the iteration every time the seq_file buffer
+ * fills up, so with many jobs walking ojs_list from the head each time is
+ * quadratic. The job the previous pass stopped at is therefore pinned in
+ * the iterator with its position, and picked up directly if the next pass
+ * starts from there.
+ */
+struct job_stat_iter {
+	struct obd_job_stats	*jsi_stats;
+	/* last job returned by ->start()/->next() and its position */
+	struct job_stat		*jsi_cur;
+	loff_t			 jsi_cur_pos;
+	/* job pinned by ->stop() for the next ->start() */
+	struct job_stat		*jsi_pinned;
+	loff_t			 jsi_pinned_pos;
+};
+
 static void *lprocfs_jobstats_seq_start(struct seq_file *p, loff_t *pos)
 {
-	struct obd_job_stats *stats = p->private;
+	struct job_stat_iter *it = p->private;
+	struct obd_job_stats *stats = it->jsi_stats;
 	loff_t off = *pos;
 	struct job_stat *job;
 
 	read_lock(&stats->ojs_lock);
 	if (off == 0)
 		return SEQ_START_TOKEN;
+
+	/* a pinned job can't be freed, so it is still on ojs_list */
+	if (it->jsi_pinned != NULL && it->jsi_pinned_pos == off) {
+		job = it->jsi_pinned;
+		goto found;
+	}
+
 	off--;
 	cfs_list_for_each_entry(job, &stats->ojs_list, js_list) {
 		if (!off--)
-			return job;
+			goto found;
 	}
 	return NULL;
+found:
+	it->jsi_cur = job;
+	it->jsi_cur_pos = *pos;
+	return job;
 }
 
 static void lprocfs_jobstats_seq_stop(struct seq_file *p, void *v)
 {
-	struct obd_job_stats *stats = p->private;
-
+	struct job_stat_iter *it = p->private;
+	struct obd_job_stats *stats = it->jsi_stats;
+	struct job_stat *old = it->jsi_pinned;
+
+	it->jsi_pinned = NULL;
+	if (v != NULL && v != SEQ_START_TOKEN) {
+		LASSERT(v == it->jsi_cur);
+		cfs_atomic_inc(&it->jsi_cur->js_refcount);
+		it->jsi_pinned = it->jsi_cur;
+		it->jsi_pinned_pos = it->jsi_cur_pos;
+	}
 	read_unlock(&stats->ojs_lock);
+
+	/* job_free() takes ojs_lock, drop the old pin only after unlock */
+	if (old != NULL)
+		job_putref(old);
 }
 
 static void *lprocfs_jobstats_seq_next(struct seq_file *p, void *v, loff_t *pos)
 {
-	struct obd_job_stats *stats = p->private;
+	struct job_stat_iter *it = p->private;
+	struct obd_job_stats *stats = it->jsi_stats;
 	struct job_stat *job;
 	cfs_list_t *next;
 
@@ -320,8 +414,12 @@ static void *lprocfs_jobstats_seq_next(struct seq_file *p, void *v, loff_t *pos)
 		next = job->js_list.next;
 	}
 
-	return next == &stats->ojs_list ? NULL :
-		cfs_list_entry(next, struct job_stat, js_list);
+	if (next == &stats->ojs_list)
+		return NULL;
+
+	it->jsi_cur = cfs_list_entry(next, struct job_stat, js_list);
+	it->jsi_cur_pos = *pos;
+	return it->jsi_cur;
 }
 
 /*
@@ -344,6 +442,9 @@ static void *lprocfs_jobstats_seq_next(struct seq_file *p, void *v, loff_t *pos)
  *   setxattr:      { samples:	       0, unit: reqs }
  *   statfs:        { samples:	       0, unit: reqs }
  *   sync:          { samples:	       0, unit: reqs }
+ *   queue_wait:    { samples:	      14, unit: usecs, p50: 63, p90: 127, p99: 255 }
+ *   handle_time:   { samples:	      14, unit: usecs, p50: 511, p90: 1023, p99: 4095 }
+ *   bulk_time:     { samples:	       0, unit: usecs, p50: 0, p90: 0, p99: 0 }
  *
  * Example of output on OST:
  *
@@ -355,6 +456,12 @@ static void *lprocfs_jobstats_seq_next(struct seq_file *p, void *v, loff_t *pos)
  *   setattr:       { samples:  0, unit: reqs }
  *   punch:         { samples:  0, unit: reqs }
  *   sync:          { samples:  0, unit: reqs }
+ *   queue_wait:    { samples:  1, unit: usecs, p50: 31, p90: 31, p99: 31 }
+ *   handle_time:   { samples:  1, unit: usecs, p50: 255, p90: 255, p99: 255 }
+ *   bulk_time:     { samples:  1, unit: usecs, p50: 127, p90: 127, p99: 127 }
+ *
+ * The latency percentiles are the upper bounds of the log2 buckets they
+ * fall into.
  */
 
 static const char spaces[] = "                    ";
@@ -364,6 +471,47 @@ static int inline width(const char *str, int len)
 	return len - min((int)strlen(str), 15);
 }
 
+/* upper bound of the bucket holding the \a permille / 1000 sample */
+static unsigned long job_lat_percentile(__u32 *buckets, __u64 count,
+					unsigned int permille)
+{
+	__u64 rank = count * permille;
+	__u64 seen = 0;
+	int i;
+
+	do_div(rank, 1000);
+	if (rank == 0)
+		rank = 1;
+
+	for (i = 0; i < JOBSTATS_LAT_BUCKETS; i++) {
+		seen += buckets[i];
+		if (seen >= rank)
+			break;
+	}
+	return i == 0 ? 0 : (1UL << min(i, JOBSTATS_LAT_BUCKETS - 1)) - 1;
+}
+
+static void job_lat_seq_show(struct seq_file *p, struct job_stat *job,
+			     int lat)
+{
+	__u32 buckets[JOBSTATS_LAT_BUCKETS];
+	__u64 count = 0;
+	int i;
+
+	for (i = 0; i < JOBSTATS_LAT_BUCKETS; i++) {
+		buckets[i] = cfs_atomic_read(&job->js_lat[lat][i]);
+		count += buckets[i];
+	}
+
+	seq_printf(p, "  %s:%.*s { samples: %11"LPF64"u, unit: usecs, "
+		   "p50: %lu, p90: %lu, p99: %lu }\n",
+		   job_lat_names[lat], width(job_lat_names[lat], 15), spaces,
+		   count,
+		   count ? job_lat_percentile(buckets, count, 500) : 0,
+		   count ? job_lat_percentile(buckets, count, 900) : 0,
+		   count ? job_lat_percentile(buckets, count, 990) : 0);
+}
+
 static int lprocfs_jobstats_seq_show(struct seq_file *p, void *v)
 {
 	struct job_stat			*job = v;
@@ -409,6 +557,10 @@ static int lprocfs_jobstats_seq_show(struct seq_file *p, void *v)
 		seq_printf(p, " }\n");
 
 	}
+
+	for (i = 0; i < JOBSTATS_LAT_LAST; i++)
+		job_lat_seq_show(p, job, i);
+
 	return 0;
 }
 
@@ -422,27 +574,49 @@ struct seq_operations lprocfs_jobstats_seq_sops = {
 static int lprocfs_jobstats_seq_open(struct inode *inode, struct file *file)
 {
 	struct proc_dir_entry *dp = PDE(inode);
+	struct job_stat_iter *it;
 	struct seq_file *seq;
 	int rc;
 
 	if (LPROCFS_ENTRY_AND_CHECK(dp))
 		return -ENOENT;
 
+	OBD_ALLOC_PTR(it);
+	if (it == NULL) {
+		LPROCFS_EXIT();
+		return -ENOMEM;
+	}
+	it->jsi_stats = dp->data;
+
 	rc = seq_open(file, &lprocfs_jobstats_seq_sops);
 	if (rc) {
+		OBD_FREE_PTR(it);
 		LPROCFS_EXIT();
 		return rc;
 	}
 	seq = file->private_data;
-	seq->private = dp->data;
+	seq->private = it;
 	return 0;
 }
 
+static int lprocfs_jobstats_seq_release(struct inode *inode, struct file *file)
+{
+	struct seq_file *seq = file->private_data;
+	struct job_stat_iter *it = seq->private;
+
+	if (it->jsi_pinned != NULL)
+		job_putref(it->jsi_pinned);
+	OBD_FREE_PTR(it);
+
+	return lprocfs_seq_release(inode, file);
+}
+
 static ssize_t lprocfs_jobstats_seq_write(struct file *file, const char *buf,
 					  size_t len, loff_t *off)
 {
 	struct seq_file *seq = file->private_data;
-	struct obd_job_stats *stats = seq->private;
+	struct job_stat_iter *it = seq->private;
+	struct obd_job_stats *stats = it->jsi_stats;
 	char jobid[JOBSTATS_JOBID_SIZE];
 	int all = 0;
 	struct job_stat *job;
@@ -487,7 +661,7 @@ struct file_operations lprocfs_jobstats_seq_fops = {
 	.read    = seq_read,
 	.write   = lprocfs_jobstats_seq_write,
 	.llseek  = seq_lseek,
-	.release = lprocfs_seq_release,
+	.release = lprocfs_jobstats_seq_release,
 };
 
 int lprocfs_job_stats_init(struct obd_device *obd, int cntr_num,
@@ -866,14 +866,36 @@ static const char *obd_connect_names[] = {
 	"lightweight_conn",
 	"short_io",
 	"pingless",
+	"unknown",	/* 0x8000000000000ULL is not used on this branch */
 	"disp_stripe",
+	"unknown",	/* 0x20000000000000ULL is used on other branches */
+	"unknown",	/* 0x40000000000000ULL is used on other branches */
+	"bl_batch",
 	"unknown",
+	"unknown",
+	"unknown",
+	"unknown",
+	"unknown",
+	"unknown",
+	"unknown",
+	"flags2",
         NULL
 };
 
-int obd_connect_flags2str(char *page, int count, __u64 flags, char *sep)
+/* ocd_connect_flags2 is allocated from the top down on this branch */
+static const struct {
+	__u64		 flag;
+	const char	*name;
+} obd_connect_names2[] = {
+	{ OBD_CONNECT2_MD_BATCH,	"md_batch" },
+	{ 0,				NULL }
+};
+
+int obd_connect_flags2str(char *page, int count, __u64 flags, __u64 flags2,
+			  char *sep)
 {
         __u64 mask = 1;
+	__u64 known2 = 0;
         int i, ret = 0;
 
         for (i = 0; obd_connect_names[i] != NULL; i++, mask <<= 1) {
@@ -885,6 +907,21 @@ int obd_connect_flags2str(char *page, int count, __u64 flags, char *sep)
                 ret += snprintf(page + ret, count - ret,
                                 "%sunknown flags "LPX64,
                                 ret ? sep : "", flags & ~(mask - 1));
+
+	if (!(flags & OBD_CONNECT_FLAGS2))
+		return ret;
+
+	for (i = 0; obd_connect_names2[i].name != NULL; i++) {
+		known2 |= obd_connect_names2[i].flag;
+		if (flags2 & obd_connect_names2[i].flag)
+			ret += snprintf(page + ret, count - ret, "%s%s",
+					ret ? sep : "",
+					obd_connect_names2[i].name);
+	}
+	if (flags2 & ~known2)
+		ret += snprintf(page + ret, count - ret,
+				"%sunknown flags2 "LPX64,
+				ret ? sep : "", flags2 & ~known2);
         return ret;
 }
 EXPORT_SYMBOL(obd_connect_flags2str);
@@ -920,6 +957,7 @@ int lprocfs_rd_import(char *page, char **start, off_t off, int count,
                      imp->imp_connect_data.ocd_instance);
         i += obd_connect_flags2str(page + i, count - i,
                                    imp->imp_connect_data.ocd_connect_flags,
+				   imp->imp_connect_data.ocd_connect_flags2,
                                    ", ");
         i += snprintf(page + i, count - i,
                       "]\n"
@@ -991,10 +1029,14 @@ int lprocfs_rd_import(char *page, char **start, off_t off, int count,
                       "    transactions:\n"
                       "       last_replay: "LPU64"\n"
                       "       peer_committed: "LPU64"\n"
-                      "       last_checked: "LPU64"\n",
+                      "       last_checked: "LPU64"\n"
+		      "       replay_list: %u\n"
+		      "       committed_list: %u\n",
                       imp->imp_last_replay_transno,
                       imp->imp_peer_committed_transno,
-                      imp->imp_last_transno_checked);
+                      imp->imp_last_transno_checked,
+		      imp->imp_replay_count,
+		      imp->imp_committed_count);
 
         /* avg data rates */
         for (rw = 0; rw <= 1; rw++) {
@@ -1073,9 +1115,24 @@ EXPORT_SYMBOL(lprocfs_rd_state);
 int lprocfs_at_hist_helper(char *page, int count, int rc,
                            struct adaptive_timeout *at)
 {
+	unsigned int p50;
+	unsigned int p90;
+	unsigned int p99;
         int i;
+
         for (i = 0; i < AT_BINS; i++)
                 rc += snprintf(page + rc, count - rc, "%3u ", at->at_hist[i]);
+
+	/* percentiles of the distribution of the recent values */
+	if (at->at_qhist != NULL) {
+		spin_lock(&at->at_lock);
+		p50 = at_qhist_percentile(at->at_qhist, 50);
+		p90 = at_qhist_percentile(at->at_qhist, 90);
+		p99 = at_qhist_percentile(at->at_qhist, 99);
+		spin_unlock(&at->at_lock);
+		rc += snprintf(page + rc, count - rc,
+			       " p50 %3u p90 %3u p99 %3u", p50, p90, p99);
+	}
         rc += snprintf(page + rc, count - rc, "\n");
         return rc;
 }
@@ -1130,6 +1187,24 @@ int lprocfs_rd_timeouts(char *page, char **start, off_t off, int count,
                                           &imp->imp_at.iat_service_estimate[i]);
         }
 
+	/* service times measured per opcode, used in place of the portal
+	 * estimate once the percentile is known, see at_percentile */
+	for (i = 0; i < IMP_AT_MAX_OPCODES; i++) {
+		struct adaptive_timeout *at = &imp->imp_at.iat_opc_estimate[i];
+
+		if (imp->imp_at.iat_opc[i] == 0)
+			break;
+		cur = at_get(at);
+		worst = at->at_worst_ever;
+		worstt = at->at_worst_time;
+		s2dhms(&ts, now - worstt);
+		rc += snprintf(page + rc, count - rc,
+			       "opc %-6d : cur %3u  worst %3u (at %ld, "
+			       DHMS_FMT" ago) ", imp->imp_at.iat_opc[i],
+			       cur, worst, worstt, DHMS_VARS(&ts));
+		rc = lprocfs_at_hist_helper(page, count, rc, at);
+	}
+
         LPROCFS_CLIMP_EXIT(obd);
         return rc;
 }
@@ -1140,12 +1215,15 @@ int lprocfs_rd_connect_flags(char *page, char **start, off_t off,
 {
         struct obd_device *obd = data;
         __u64 flags;
+	__u64 flags2;
         int ret = 0;
 
         LPROCFS_CLIMP_CHECK(obd);
         flags = obd->u.cli.cl_import->imp_connect_data.ocd_connect_flags;
+	flags2 = obd->u.cli.cl_import->imp_connect_data.ocd_connect_flags2;
         ret = snprintf(page, count, "flags="LPX64"\n", flags);
-        ret += obd_connect_flags2str(page + ret, count - ret, flags, "\n");
+	ret += obd_connect_flags2str(page + ret, count - ret, flags, flags2,
+				     "\n");
         ret += snprintf(page + ret, count - ret, "\n");
         LPROCFS_CLIMP_EXIT(obd);
         return ret;
@@ -1254,6 +1332,315 @@ void lprocfs_free_per_client_stats(struct obd_device *obd)
 }
 EXPORT_SYMBOL(lprocfs_free_per_client_stats);
 
+/*
+ * Binary stats export.
+ *
+ * Every registered lprocfs_stats and every exported obd_histogram array is
+ * kept on lprocfs_export_list so that /proc/fs/lustre/stats_export can take
+ * a snapshot of all of them in a single pass, without formatting any text.
+ * See struct lstats_export_header for the layout.
+ */
+struct lprocfs_export_entry {
+	cfs_list_t		le_list;
+	enum lstats_export_type	le_type;
+	/* number of counters or histograms at le_data */
+	int			le_count;
+	void			*le_data;
+	char			le_path[LSTATS_PATH_LEN];
+};
+
+static CFS_LIST_HEAD(lprocfs_export_list);
+static DEFINE_MUTEX(lprocfs_export_mutex);
+
+/* build the path of @dir relative to /proc/fs/lustre, with trailing '/' */
+static int lprocfs_export_path(struct proc_dir_entry *dir, char *buf, int len)
+{
+	int pos;
+
+	if (dir == NULL || dir == proc_lustre_root)
+		return 0;
+
+	pos = lprocfs_export_path(dir->parent, buf, len);
+	if (pos < len)
+		pos += snprintf(buf + pos, len - pos, "%s/", dir->name);
+
+	return pos;
+}
+
+static struct lprocfs_export_entry *
+lprocfs_export_add(struct proc_dir_entry *root, const char *name,
+		   enum lstats_export_type type, void *data, int count)
+{
+	struct lprocfs_export_entry *le;
+	int			     pos;
+
+	OBD_ALLOC_PTR(le);
+	if (le == NULL)
+		return NULL;
+
+	le->le_type = type;
+	le->le_count = count;
+	le->le_data = data;
+	pos = lprocfs_export_path(root, le->le_path, sizeof(le->le_path));
+	if (pos < sizeof(le->le_path))
+		strlcpy(le->le_path + pos, name, sizeof(le->le_path) - pos);
+
+	mutex_lock(&lprocfs_export_mutex);
+	cfs_list_add_tail(&le->le_list, &lprocfs_export_list);
+	mutex_unlock(&lprocfs_export_mutex);
+
+	return le;
+}
+
+static void lprocfs_export_del(struct lprocfs_export_entry *le)
+{
+	mutex_lock(&lprocfs_export_mutex);
+	cfs_list_del(&le->le_list);
+	mutex_unlock(&lprocfs_export_mutex);
+
+	OBD_FREE_PTR(le);
+}
+
+/**
+ * Add \a count histograms starting at \a oh to the binary stats export
+ * as \a name under \a root. The caller must call lprocfs_oh_unexport()
+ * before the histograms are freed.
+ */
+int lprocfs_oh_export(struct proc_dir_entry *root, const char *name,
+		      struct obd_histogram *oh, int count)
+{
+	if (lprocfs_export_add(root, name, LSTATS_EXPORT_HIST, oh,
+			       count) == NULL)
+		return -ENOMEM;
+
+	return 0;
+}
+EXPORT_SYMBOL(lprocfs_oh_export);
+
+void lprocfs_oh_unexport(struct obd_histogram *oh)
+{
+	struct lprocfs_export_entry *le;
+	struct lprocfs_export_entry *tmp;
+
+	mutex_lock(&lprocfs_export_mutex);
+	cfs_list_for_each_entry_safe(le, tmp, &lprocfs_export_list, le_list) {
+		if (le->le_type == LSTATS_EXPORT_HIST && le->le_data == oh) {
+			cfs_list_del(&le->le_list);
+			OBD_FREE_PTR(le);
+		}
+	}
+	mutex_unlock(&lprocfs_export_mutex);
+}
+EXPORT_SYMBOL(lprocfs_oh_unexport);
+
+static size_t lprocfs_export_rec_size(struct lprocfs_export_entry *le)
+{
+	size_t size = sizeof(struct lstats_export_record);
+
+	if (le->le_type == LSTATS_EXPORT_STATS)
+		size += le->le_count * sizeof(struct lstats_export_counter);
+	else if (le->le_type == LSTATS_EXPORT_LAT)
+		size += le->le_count * (sizeof(struct lstats_export_lat) +
+					LPROCFS_LAT_BUCKETS * sizeof(__u64));
+	else
+		size += le->le_count * OBD_HIST_MAX * sizeof(__u64);
+
+	return size;
+}
+
+static void lprocfs_export_fill_stats(struct lprocfs_export_entry *le,
+				      struct lstats_export_counter *lec)
+{
+	struct lprocfs_stats		*stats = le->le_data;
+	struct lprocfs_counter_header	*hdr;
+	struct lprocfs_counter		 ctr;
+	int				 i;
+
+	CLASSERT(LSTATS_CNTR_AVGMINMAX == LPROCFS_CNTR_AVGMINMAX);
+	CLASSERT(LSTATS_CNTR_STDDEV == LPROCFS_CNTR_STDDEV);
+
+	for (i = 0; i < le->le_count; i++, lec++) {
+		hdr = &stats->ls_cnt_header[i];
+		lprocfs_stats_collect(stats, i, &ctr);
+
+		lec->lec_count = ctr.lc_count;
+		if (ctr.lc_count > 0) {
+			lec->lec_min = ctr.lc_min;
+			lec->lec_max = ctr.lc_max;
+			lec->lec_sum = ctr.lc_sum;
+			lec->lec_sumsquare = ctr.lc_sumsquare;
+		}
+		lec->lec_config = hdr->lc_config;
+		if (hdr->lc_name != NULL)
+			strlcpy(lec->lec_name, hdr->lc_name,
+				sizeof(lec->lec_name));
+		if (hdr->lc_units != NULL)
+			strlcpy(lec->lec_units, hdr->lc_units,
+				sizeof(lec->lec_units));
+	}
+}
+
+static void lprocfs_export_fill_hist(struct lprocfs_export_entry *le,
+				     __u64 *buckets)
+{
+	struct obd_histogram	*oh = le->le_data;
+	int			 i;
+	int			 j;
+
+	for (i = 0; i < le->le_count; i++, oh++)
+		for (j = 0; j < OBD_HIST_MAX; j++)
+			*buckets++ = oh->oh_buckets[j];
+}
+
+static void lprocfs_export_fill_lat(struct lprocfs_export_entry *le,
+				    struct lstats_export_lat *lel,
+				    struct lprocfs_lat_counter *cntr)
+{
+	struct lprocfs_lat_stats	*stats = le->le_data;
+	struct lprocfs_counter_header	*hdr;
+	__u64				*buckets;
+	int				 i;
+	int				 j;
+
+	for (i = 0; i < le->le_count; i++) {
+		hdr = &stats->lls_cnt_header[i];
+		buckets = (__u64 *)(lel + 1);
+
+		lel->lel_count = lprocfs_lat_collect(stats, i, cntr);
+		lel->lel_max = cntr->llc_max;
+		lel->lel_buckets = LPROCFS_LAT_BUCKETS;
+		lel->lel_sub_bits = LPROCFS_LAT_SUB_BITS;
+		if (hdr->lc_name != NULL)
+			strlcpy(lel->lel_name, hdr->lc_name,
+				sizeof(lel->lel_name));
+		if (hdr->lc_units != NULL)
+			strlcpy(lel->lel_units, hdr->lc_units,
+				sizeof(lel->lel_units));
+		for (j = 0; j < LPROCFS_LAT_BUCKETS; j++)
+			buckets[j] = cntr->llc_buckets[j];
+
+		lel = (struct lstats_export_lat *)(buckets + j);
+	}
+}
+
+struct lprocfs_export_snapshot {
+	void	*les_buf;
+	size_t	 les_size;
+};
+
+/* the snapshot is taken at open time, so one open gives one consistent
+ * view however the file is then read or mapped */
+static int lprocfs_stats_export_open(struct inode *inode, struct file *file)
+{
+	struct lprocfs_export_snapshot	*les;
+	struct lprocfs_export_entry	*le;
+	struct lstats_export_header	*leh;
+	struct lstats_export_record	*ler;
+	struct lprocfs_lat_counter	*cntr;
+	struct timeval			 now;
+	size_t				 size;
+	char				*ptr;
+
+	OBD_ALLOC_PTR(les);
+	if (les == NULL)
+		return -ENOMEM;
+
+	/* merged latency histograms are too big for the stack */
+	OBD_ALLOC_PTR(cntr);
+	if (cntr == NULL) {
+		OBD_FREE_PTR(les);
+		return -ENOMEM;
+	}
+
+	mutex_lock(&lprocfs_export_mutex);
+	size = sizeof(*leh);
+	cfs_list_for_each_entry(le, &lprocfs_export_list, le_list)
+		size += lprocfs_export_rec_size(le);
+
+	/* zeroed and suitable for remap_vmalloc_range() */
+	les->les_buf = vmalloc_user(size);
+	if (les->les_buf == NULL) {
+		mutex_unlock(&lprocfs_export_mutex);
+		OBD_FREE_PTR(cntr);
+		OBD_FREE_PTR(les);
+		return -ENOMEM;
+	}
+	les->les_size = size;
+
+	cfs_gettimeofday(&now);
+	leh = les->les_buf;
+	leh->leh_magic = LSTATS_EXPORT_MAGIC;
+	leh->leh_version = LSTATS_EXPORT_VERSION;
+	leh->leh_hdr_size = sizeof(*leh);
+	leh->leh_rec_size = sizeof(*ler);
+	leh->leh_cntr_size = sizeof(struct lstats_export_counter);
+	leh->leh_size = size;
+	leh->leh_snapshot_sec = now.tv_sec;
+	leh->leh_snapshot_usec = now.tv_usec;
+	leh->leh_hist_max = OBD_HIST_MAX;
+
+	ptr = (char *)(leh + 1);
+	cfs_list_for_each_entry(le, &lprocfs_export_list, le_list) {
+		ler = (struct lstats_export_record *)ptr;
+		ler->ler_type = le->le_type;
+		ler->ler_count = le->le_count;
+		ler->ler_size = lprocfs_export_rec_size(le);
+		memcpy(ler->ler_path, le->le_path, sizeof(ler->ler_path));
+
+		if (le->le_type == LSTATS_EXPORT_STATS)
+			lprocfs_export_fill_stats(le, (void *)(ler + 1));
+		else if (le->le_type == LSTATS_EXPORT_LAT)
+			lprocfs_export_fill_lat(le, (void *)(ler + 1), cntr);
+		else
+			lprocfs_export_fill_hist(le, (void *)(ler + 1));
+
+		ptr += ler->ler_size;
+		leh->leh_count++;
+	}
+	mutex_unlock(&lprocfs_export_mutex);
+	OBD_FREE_PTR(cntr);
+
+	file->private_data = les;
+	return 0;
+}
+
+static ssize_t lprocfs_stats_export_read(struct file *file, char __user *buf,
+					 size_t count, loff_t *ppos)
+{
+	struct lprocfs_export_snapshot *les = file->private_data;
+
+	return simple_read_from_buffer(buf, count, ppos, les->les_buf,
+				       les->les_size);
+}
+
+static int lprocfs_stats_export_mmap(struct file *file,
+				     struct vm_area_struct *vma)
+{
+	struct lprocfs_export_snapshot *les = file->private_data;
+
+	return remap_vmalloc_range(vma, les->les_buf, vma->vm_pgoff);
+}
+
+static int lprocfs_stats_export_release(struct inode *inode,
+					struct file *file)
+{
+	struct lprocfs_export_snapshot *les = file->private_data;
+
+	vfree(les->les_buf);
+	OBD_FREE_PTR(les);
+	return 0;
+}
+
+struct file_operations lprocfs_stats_export_fops = {
+	.owner   = THIS_MODULE,
+	.open    = lprocfs_stats_export_open,
+	.read    = lprocfs_stats_export_read,
+	.llseek  = default_llseek,
+	.mmap    = lprocfs_stats_export_mmap,
+	.release = lprocfs_stats_export_release,
+};
+EXPORT_SYMBOL(lprocfs_stats_export_fops);
+
 struct lprocfs_stats *lprocfs_alloc_stats(unsigned int num,
                                           enum lprocfs_stats_flags flags)
 {
@@ -1321,6 +1708,9 @@ void lprocfs_free_stats(struct lprocfs_stats **statsh)
                 return;
         *statsh = NULL;
 
+	if (stats->ls_export != NULL)
+		lprocfs_export_del(stats->ls_export);
+
 	if (stats->ls_flags & LPROCFS_STATS_FLAG_NOPERCPU)
 		num_entry = 1;
 	else
@@ -1495,6 +1885,13 @@ int lprocfs_register_stats(struct proc_dir_entry *root, const char *name,
         if (entry == NULL)
                 return -ENOMEM;
 
+	/* a stats struct registered under several names is exported once;
+	 * failing to export it is not fatal for the proc entry */
+	if (stats->ls_export == NULL)
+		stats->ls_export = lprocfs_export_add(root, name,
+						      LSTATS_EXPORT_STATS,
+						      stats, stats->ls_num);
+
         return 0;
 }
 EXPORT_SYMBOL(lprocfs_register_stats);
@@ -1535,6 +1932,317 @@ void lprocfs_counter_init(struct lprocfs_stats *stats, int index,
 }
 EXPORT_SYMBOL(lprocfs_counter_init);
 
+struct lprocfs_lat_stats *lprocfs_alloc_lat_stats(unsigned int num)
+{
+	struct lprocfs_lat_stats *stats;
+
+	if (num == 0)
+		return NULL;
+
+	LIBCFS_ALLOC(stats, sizeof(*stats));
+	if (stats == NULL)
+		return NULL;
+
+	stats->lls_num = num;
+	stats->lls_num_cpu = cfs_num_possible_cpus();
+
+	LIBCFS_ALLOC(stats->lls_cnt_header,
+		     num * sizeof(struct lprocfs_counter_header));
+	if (stats->lls_cnt_header == NULL)
+		goto fail;
+
+	LIBCFS_ALLOC(stats->lls_cntr, stats->lls_num_cpu * num *
+				      sizeof(struct lprocfs_lat_counter *));
+	if (stats->lls_cntr == NULL)
+		goto fail;
+
+	return stats;
+fail:
+	lprocfs_free_lat_stats(&stats);
+	return NULL;
+}
+EXPORT_SYMBOL(lprocfs_alloc_lat_stats);
+
+void lprocfs_free_lat_stats(struct lprocfs_lat_stats **statsh)
+{
+	struct lprocfs_lat_stats *stats = *statsh;
+	unsigned int		  i;
+
+	if (stats == NULL)
+		return;
+	*statsh = NULL;
+
+	if (stats->lls_export != NULL)
+		lprocfs_export_del(stats->lls_export);
+
+	if (stats->lls_cntr != NULL) {
+		for (i = 0; i < stats->lls_num_cpu * stats->lls_num; i++)
+			if (stats->lls_cntr[i] != NULL)
+				LIBCFS_FREE(stats->lls_cntr[i],
+					    sizeof(struct lprocfs_lat_counter));
+		LIBCFS_FREE(stats->lls_cntr, stats->lls_num_cpu *
+			    stats->lls_num *
+			    sizeof(struct lprocfs_lat_counter *));
+	}
+	if (stats->lls_cnt_header != NULL)
+		LIBCFS_FREE(stats->lls_cnt_header, stats->lls_num *
+			    sizeof(struct lprocfs_counter_header));
+	LIBCFS_FREE(stats, sizeof(*stats));
+}
+EXPORT_SYMBOL(lprocfs_free_lat_stats);
+
+void lprocfs_clear_lat_stats(struct lprocfs_lat_stats *stats)
+{
+	struct lprocfs_lat_counter *cntr;
+	unsigned int		    i;
+
+	/* racing updates may survive the reset, just like percpu stats */
+	for (i = 0; i < stats->lls_num_cpu * stats->lls_num; i++) {
+		cntr = stats->lls_cntr[i];
+		if (cntr != NULL)
+			memset(cntr, 0, sizeof(*cntr));
+	}
+}
+EXPORT_SYMBOL(lprocfs_clear_lat_stats);
+
+void lprocfs_lat_counter_init(struct lprocfs_lat_stats *stats, int index,
+			      const char *name, const char *units)
+{
+	struct lprocfs_counter_header *header;
+
+	LASSERT(stats != NULL);
+	LASSERT(index < stats->lls_num);
+
+	header = &stats->lls_cnt_header[index];
+	header->lc_config = 0;
+	header->lc_name   = name;
+	header->lc_units  = units;
+}
+EXPORT_SYMBOL(lprocfs_lat_counter_init);
+
+void lprocfs_lat_counter_add(struct lprocfs_lat_stats *stats, int idx,
+			     __u64 value)
+{
+	struct lprocfs_lat_counter **slot;
+	struct lprocfs_lat_counter  *cntr;
+	unsigned int		     cpuid;
+
+	if (stats == NULL)
+		return;
+
+	LASSERT(idx >= 0 && idx < stats->lls_num);
+
+	/* Only the owning CPU ever writes to its slot, and it does so with
+	 * preemption disabled, so no lock or atomic op is needed here. */
+	cpuid = cfs_get_cpu();
+	slot = &stats->lls_cntr[cpuid * stats->lls_num + idx];
+	cntr = *slot;
+	if (unlikely(cntr == NULL)) {
+		LIBCFS_ALLOC_ATOMIC(cntr, sizeof(*cntr));
+		if (cntr == NULL)
+			goto out;
+		/* readers must see a zeroed histogram through the slot */
+		smp_wmb();
+		*slot = cntr;
+	}
+
+	cntr->llc_buckets[lprocfs_lat_bucket(value)]++;
+	if (value > cntr->llc_max)
+		cntr->llc_max = value;
+out:
+	cfs_put_cpu();
+}
+EXPORT_SYMBOL(lprocfs_lat_counter_add);
+
+/**
+ * Sum the per-cpu histograms of counter \a idx into \a cnt.
+ *
+ * \retval number of samples in the merged histogram
+ */
+__u64 lprocfs_lat_collect(struct lprocfs_lat_stats *stats, int idx,
+			  struct lprocfs_lat_counter *cnt)
+{
+	struct lprocfs_lat_counter *percpu_cntr;
+	__u64			    count = 0;
+	unsigned int		    i;
+	unsigned int		    j;
+
+	memset(cnt, 0, sizeof(*cnt));
+	for (i = 0; i < stats->lls_num_cpu; i++) {
+		percpu_cntr = stats->lls_cntr[i * stats->lls_num + idx];
+		if (percpu_cntr == NULL)
+			continue;
+		smp_rmb();
+		for (j = 0; j < LPROCFS_LAT_BUCKETS; j++) {
+			cnt->llc_buckets[j] += percpu_cntr->llc_buckets[j];
+			count += percpu_cntr->llc_buckets[j];
+		}
+		if (percpu_cntr->llc_max > cnt->llc_max)
+			cnt->llc_max = percpu_cntr->llc_max;
+	}
+
+	return count;
+}
+EXPORT_SYMBOL(lprocfs_lat_collect);
+
+/**
+ * Return the value below which \a permille / 1000 of the \a count samples
+ * in the merged histogram \a cnt fall, e.g. 990 for p99, 999 for p99.9.
+ *
+ * The result is the highest value of the bucket the percentile lands in,
+ * but never more than the largest sample seen.
+ */
+__u64 lprocfs_lat_percentile(struct lprocfs_lat_counter *cnt, __u64 count,
+			     unsigned int permille)
+{
+	__u64	     rank;
+	__u64	     seen = 0;
+	unsigned int i;
+
+	if (count == 0)
+		return 0;
+
+	rank = count * permille;
+	do_div(rank, 1000);
+	if (rank == 0)
+		rank = 1;
+
+	for (i = 0; i < LPROCFS_LAT_BUCKETS; i++) {
+		seen += cnt->llc_buckets[i];
+		if (seen >= rank)
+			return min(lprocfs_lat_bucket_max(i), cnt->llc_max);
+	}
+
+	return cnt->llc_max;
+}
+EXPORT_SYMBOL(lprocfs_lat_percentile);
+
+static void *lprocfs_lat_stats_seq_start(struct seq_file *p, loff_t *pos)
+{
+	struct lprocfs_lat_stats *stats = p->private;
+
+	return (*pos < stats->lls_num) ? pos : NULL;
+}
+
+static void lprocfs_lat_stats_seq_stop(struct seq_file *p, void *v)
+{
+}
+
+static void *lprocfs_lat_stats_seq_next(struct seq_file *p, void *v,
+					loff_t *pos)
+{
+	(*pos)++;
+
+	return lprocfs_lat_stats_seq_start(p, pos);
+}
+
+/* seq file export of the percentiles of one latency histogram */
+static int lprocfs_lat_stats_seq_show(struct seq_file *p, void *v)
+{
+	struct lprocfs_lat_stats	*stats	= p->private;
+	struct lprocfs_counter_header	*hdr;
+	struct lprocfs_lat_counter	*cntr;
+	int				 idx	= *(loff_t *)v;
+	__u64				 count;
+	int				 rc	= 0;
+
+	if (idx == 0) {
+		struct timeval now;
+
+		cfs_gettimeofday(&now);
+		rc = seq_printf(p, "%-25s %lu.%lu secs.usecs\n",
+				"snapshot_time", now.tv_sec, now.tv_usec);
+		if (rc < 0)
+			return rc;
+	}
+
+	hdr = &stats->lls_cnt_header[idx];
+	if (hdr->lc_name == NULL)
+		return 0;
+
+	/* too big for the stack of a seq_file reader */
+	OBD_ALLOC_PTR(cntr);
+	if (cntr == NULL)
+		return -ENOMEM;
+
+	count = lprocfs_lat_collect(stats, idx, cntr);
+	if (count == 0)
+		goto out;
+
+	rc = seq_printf(p, "%-25s "LPU64" samples [%s] p50 "LPU64" p90 "LPU64
+			" p99 "LPU64" p99.9 "LPU64" max "LPU64"\n",
+			hdr->lc_name, count, hdr->lc_units,
+			lprocfs_lat_percentile(cntr, count, 500),
+			lprocfs_lat_percentile(cntr, count, 900),
+			lprocfs_lat_percentile(cntr, count, 990),
+			lprocfs_lat_percentile(cntr, count, 999),
+			cntr->llc_max);
+out:
+	OBD_FREE_PTR(cntr);
+	return (rc < 0) ? rc : 0;
+}
+
+static struct seq_operations lprocfs_lat_stats_seq_sops = {
+	.start	= lprocfs_lat_stats_seq_start,
+	.stop	= lprocfs_lat_stats_seq_stop,
+	.next	= lprocfs_lat_stats_seq_next,
+	.show	= lprocfs_lat_stats_seq_show,
+};
+
+static int lprocfs_lat_stats_seq_open(struct inode *inode, struct file *file)
+{
+	struct proc_dir_entry	*dp = PDE(inode);
+	struct seq_file		*seq;
+	int			 rc;
+
+	if (LPROCFS_ENTRY_AND_CHECK(dp))
+		return -ENOENT;
+
+	rc = seq_open(file, &lprocfs_lat_stats_seq_sops);
+	if (rc) {
+		LPROCFS_EXIT();
+		return rc;
+	}
+	seq = file->private_data;
+	seq->private = dp->data;
+	return 0;
+}
+
+static ssize_t lprocfs_lat_stats_seq_write(struct file *file, const char *buf,
+					   size_t len, loff_t *off)
+{
+	struct seq_file		 *seq = file->private_data;
+	struct lprocfs_lat_stats *stats = seq->private;
+
+	lprocfs_clear_lat_stats(stats);
+
+	return len;
+}
+
+static struct file_operations lprocfs_lat_stats_seq_fops = {
+	.owner   = THIS_MODULE,
+	.open    = lprocfs_lat_stats_seq_open,
+	.read    = seq_read,
+	.write   = lprocfs_lat_stats_seq_write,
+	.llseek  = seq_lseek,
+	.release = lprocfs_seq_release,
+};
+
+int lprocfs_register_lat_stats(struct proc_dir_entry *root, const char *name,
+			       struct lprocfs_lat_stats *stats)
+{
+	int rc;
+
+	rc = lprocfs_seq_create(root, name, 0644,
+				&lprocfs_lat_stats_seq_fops, stats);
+	if (rc == 0 && stats->lls_export == NULL)
+		stats->lls_export = lprocfs_export_add(root, name,
+						       LSTATS_EXPORT_LAT,
+						       stats, stats->lls_num);
+	return rc;
+}
+EXPORT_SYMBOL(lprocfs_register_lat_stats);
+
 #define LPROCFS_OBD_OP_INIT(base, stats, op)                               \
 do {                                                                       \
         unsigned int coffset = base + OBD_COUNTER_OFFSET(op);              \
@@ -1701,6 +2409,7 @@ void lprocfs_init_mps_stats(int num_private_stats, struct lprocfs_stats *stats)
         LPROCFS_MD_OP_INIT(num_private_stats, stats, get_remote_perm);
         LPROCFS_MD_OP_INIT(num_private_stats, stats, intent_getattr_async);
         LPROCFS_MD_OP_INIT(num_private_stats, stats, revalidate_lock);
+	LPROCFS_MD_OP_INIT(num_private_stats, stats, batch);
 }
 EXPORT_SYMBOL(lprocfs_init_mps_stats);
 
@@ -2357,6 +3066,41 @@ int lprocfs_obd_rd_hash(char *page, char **start, off_t off,
 }
 EXPORT_SYMBOL(lprocfs_obd_rd_hash);
 
+/* parallel request replay counters, see target_recovery_thread() */
+static int lprocfs_recovery_replay_status(struct obd_device *obd, char **page,
+					  int size, int *len)
+{
+	struct target_recovery_data *trd = &obd->obd_recovery_data;
+	time_t elapsed;
+
+	if (trd->trd_replay_start == 0)
+		return 1;
+
+	elapsed = (trd->trd_replay_end ?: cfs_time_current_sec()) -
+		  trd->trd_replay_start;
+	if (elapsed <= 0)
+		elapsed = 1;
+
+	if (obd->obd_recovering &&
+	    lprocfs_obd_snprintf(page, size, len,
+				 "replay_threads: %d\n"
+				 "replay_inflight: %d\n",
+				 trd->trd_replay_threads,
+				 trd->trd_replay_inflight_count) <= 0)
+		return 0;
+
+	return lprocfs_obd_snprintf(page, size, len,
+				    "replayed_parallel: %d\n"
+				    "replay_waits: %d\n"
+				    "replay_barriers: %d\n"
+				    "replay_rate: %lu reqs/s\n",
+				    trd->trd_replay_parallel,
+				    trd->trd_replay_waits,
+				    trd->trd_replay_barriers,
+				    (unsigned long)obd->obd_replayed_requests /
+				    elapsed);
+}
+
 int lprocfs_obd_rd_recovery_status(char *page, char **start, off_t off,
                                    int count, int *eof, void *data)
 {
@@ -2414,6 +3158,8 @@ int lprocfs_obd_rd_recovery_status(char *page, char **start, off_t off,
                                          "replayed_requests: %d\n",
                                          obd->obd_replayed_requests) <= 0)
                         goto out;
+		if (lprocfs_recovery_replay_status(obd, &page, size, &len) <= 0)
+			goto out;
                 if (lprocfs_obd_snprintf(&page, size, &len,
                                          "last_transno: "LPD64"\n",
                                          obd->obd_next_recovery_transno - 1)<=0)
@@ -2469,6 +3215,8 @@ int lprocfs_obd_rd_recovery_status(char *page, char **start, off_t off,
         if (lprocfs_obd_snprintf(&page, size, &len, "queued_requests: %d\n",
                                  obd->obd_requests_queued_for_recovery) <= 0)
                 goto out;
+	if (lprocfs_recovery_replay_status(obd, &page, size, &len) <= 0)
+		goto out;
 
         if (lprocfs_obd_snprintf(&page, size, &len, "next_transno: "LPD64"\n",
                                  obd->obd_next_recovery_transno) <= 0)
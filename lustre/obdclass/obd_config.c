@@ -954,6 +954,8 @@ static int class_set_global(char *ptr, int val, struct lustre_cfg *lcfg)
 		at_early_margin = val;
 	else if (class_match_param(ptr, PARAM_AT_HISTORY, NULL) == 0)
 		at_history = val;
+	else if (class_match_param(ptr, PARAM_AT_PERCENTILE, NULL) == 0)
+		at_percentile = val;
 	else if (class_match_param(ptr, PARAM_JOBID_VAR, NULL) == 0)
 		strlcpy(obd_jobid_var, lustre_cfg_string(lcfg, 2),
 			JOBSTATS_JOBID_VAR_MAX_LEN + 1);
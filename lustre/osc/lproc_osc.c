@@ -564,6 +564,55 @@ static struct lprocfs_vars lprocfs_osc_module_vars[] = {
 
 #define pct(a,b) (b ? a * 100 / b : 0)
 
+/* read/write RPC round trip percentiles, reset through "latency_stats" */
+static void osc_rpc_lat_seq_show(struct seq_file *seq,
+				 struct lprocfs_lat_stats *stats)
+{
+	static const struct {
+		const char	*name;
+		unsigned int	 permille;
+	} osc_lat_pct[] = {
+		{ "p50",	500 },
+		{ "p90",	900 },
+		{ "p99",	990 },
+		{ "p99.9",	999 },
+	};
+	struct lprocfs_lat_counter *r_cntr;
+	struct lprocfs_lat_counter *w_cntr;
+	__u64			    r_tot;
+	__u64			    w_tot;
+	int			    i;
+
+	OBD_ALLOC_PTR(r_cntr);
+	OBD_ALLOC_PTR(w_cntr);
+	if (r_cntr == NULL || w_cntr == NULL)
+		goto out;
+
+	r_tot = lprocfs_lat_collect(stats, PTLRPC_LAT_LAST +
+				    opcode_offset(OST_READ), r_cntr);
+	w_tot = lprocfs_lat_collect(stats, PTLRPC_LAT_LAST +
+				    opcode_offset(OST_WRITE), w_cntr);
+
+	seq_printf(seq, "\n\t\t\tread\t\t\twrite\n");
+	seq_printf(seq, "rpc latency           usec         |");
+	seq_printf(seq, "       usec\n");
+	seq_printf(seq, "samples:\t"LPU64"\t\t| "LPU64"\n", r_tot, w_tot);
+	for (i = 0; i < ARRAY_SIZE(osc_lat_pct); i++)
+		seq_printf(seq, "%s:\t\t"LPU64"\t\t| "LPU64"\n",
+			   osc_lat_pct[i].name,
+			   lprocfs_lat_percentile(r_cntr, r_tot,
+						  osc_lat_pct[i].permille),
+			   lprocfs_lat_percentile(w_cntr, w_tot,
+						  osc_lat_pct[i].permille));
+	seq_printf(seq, "max:\t\t"LPU64"\t\t| "LPU64"\n",
+		   r_cntr->llc_max, w_cntr->llc_max);
+out:
+	if (r_cntr != NULL)
+		OBD_FREE_PTR(r_cntr);
+	if (w_cntr != NULL)
+		OBD_FREE_PTR(w_cntr);
+}
+
 static int osc_rpc_stats_seq_show(struct seq_file *seq, void *v)
 {
         struct timeval now;
@@ -657,6 +706,9 @@ static int osc_rpc_stats_seq_show(struct seq_file *seq, void *v)
 
         client_obd_list_unlock(&cli->cl_loi_list_lock);
 
+	if (dev->obd_svc_lat_stats != NULL)
+		osc_rpc_lat_seq_show(seq, dev->obd_svc_lat_stats);
+
         return 0;
 }
 #undef pct
@@ -712,9 +764,33 @@ static ssize_t osc_stats_seq_write(struct file *file, const char *buf,
 
 LPROC_SEQ_FOPS(osc_stats);
 
+/* rpc_stats histograms in the binary stats export */
+static struct {
+	size_t		 offset;
+	const char	*name;
+} osc_rpc_hists[] = {
+	{ offsetof(struct client_obd, cl_read_page_hist),
+	  "rpc_stats.read_pages_per_rpc" },
+	{ offsetof(struct client_obd, cl_write_page_hist),
+	  "rpc_stats.write_pages_per_rpc" },
+	{ offsetof(struct client_obd, cl_read_rpc_hist),
+	  "rpc_stats.read_rpcs_in_flight" },
+	{ offsetof(struct client_obd, cl_write_rpc_hist),
+	  "rpc_stats.write_rpcs_in_flight" },
+	{ offsetof(struct client_obd, cl_read_offset_hist),
+	  "rpc_stats.read_offset" },
+	{ offsetof(struct client_obd, cl_write_offset_hist),
+	  "rpc_stats.write_offset" },
+};
+
+#define osc_rpc_hist(cli, i) \
+	((struct obd_histogram *)((char *)(cli) + osc_rpc_hists[i].offset))
+
 int lproc_osc_attach_seqstat(struct obd_device *dev)
 {
-	int rc;
+	struct client_obd *cli = &dev->u.cli;
+	int		   rc;
+	int		   i;
 
 	rc = lprocfs_seq_create(dev->obd_proc_entry, "osc_stats", 0644,
 				&osc_stats_fops, dev);
@@ -722,9 +798,22 @@ int lproc_osc_attach_seqstat(struct obd_device *dev)
 		rc = lprocfs_obd_seq_create(dev, "rpc_stats", 0644,
 					    &osc_rpc_stats_fops, dev);
 
+	for (i = 0; rc == 0 && i < ARRAY_SIZE(osc_rpc_hists); i++)
+		rc = lprocfs_oh_export(dev->obd_proc_entry,
+				       osc_rpc_hists[i].name,
+				       osc_rpc_hist(cli, i), 1);
+
 	return rc;
 }
 
+void lproc_osc_detach_seqstat(struct obd_device *dev)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(osc_rpc_hists); i++)
+		lprocfs_oh_unexport(osc_rpc_hist(&dev->u.cli, i));
+}
+
 void lprocfs_osc_init_vars(struct lprocfs_static_vars *lvars)
 {
         lvars->module_vars = lprocfs_osc_module_vars;
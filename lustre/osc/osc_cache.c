@@ -2294,6 +2294,29 @@ int osc_prep_async_page(struct osc_object *osc, struct osc_page *ops,
 	RETURN(0);
 }
 
+/* Check if the file's owner/group is over quota. */
+static int osc_quota_check(const struct lu_env *env, struct client_obd *cli,
+			   struct osc_object *osc)
+{
+	struct cl_object *obj;
+	struct cl_attr   *attr;
+	unsigned int	  qid[MAXQUOTAS];
+	int		  rc;
+
+	obj = cl_object_top(&osc->oo_cl);
+	attr = &osc_env_info(env)->oti_attr;
+
+	cl_object_attr_lock(obj);
+	rc = cl_object_attr_get(env, obj, attr);
+	cl_object_attr_unlock(obj);
+
+	qid[USRQUOTA] = attr->cat_uid;
+	qid[GRPQUOTA] = attr->cat_gid;
+	if (rc == 0 && osc_quota_chkdq(cli, qid) == NO_QUOTA)
+		rc = -EDQUOT;
+	return rc;
+}
+
 int osc_queue_async_io(const struct lu_env *env, struct cl_io *io,
 		       struct osc_page *ops)
 {
@@ -2307,6 +2330,7 @@ int osc_queue_async_io(const struct lu_env *env, struct cl_io *io,
 	int    brw_flags = OBD_BRW_ASYNC;
 	int    cmd = OBD_BRW_WRITE;
 	int    need_release = 0;
+	int    quota_checked;
 	int    rc = 0;
 	ENTRY;
 
@@ -2328,25 +2352,22 @@ int osc_queue_async_io(const struct lu_env *env, struct cl_io *io,
 		cmd |= OBD_BRW_NOQUOTA;
 	}
 
-	/* check if the file's owner/group is over quota */
-	if (!(cmd & OBD_BRW_NOQUOTA)) {
-		struct cl_object *obj;
-		struct cl_attr   *attr;
-		unsigned int qid[MAXQUOTAS];
-
-		obj = cl_object_top(&osc->oo_cl);
-		attr = &osc_env_info(env)->oti_attr;
-
-		cl_object_attr_lock(obj);
-		rc = cl_object_attr_get(env, obj, attr);
-		cl_object_attr_unlock(obj);
+	index = oap2cl_page(oap)->cp_index;
+	ext = oio->oi_active;
 
-		qid[USRQUOTA] = attr->cat_uid;
-		qid[GRPQUOTA] = attr->cat_gid;
-		if (rc == 0 && osc_quota_chkdq(cli, qid) == NO_QUOTA)
-			rc = -EDQUOT;
+	/* check if the file's owner/group is over quota. Pages of a streaming
+	 * write going into the active extent of this IO were checked when
+	 * the extent was set up, which is at most once per RPC. If the page
+	 * cannot join that extent after all, it is checked below before a
+	 * new extent is set up for it. */
+	quota_checked = (cmd & OBD_BRW_NOQUOTA) ||
+			(ext != NULL && ext->oe_start <= index &&
+			 ext->oe_max_end >= index);
+	if (!quota_checked) {
+		rc = osc_quota_check(env, cli, osc);
 		if (rc)
 			RETURN(rc);
+		quota_checked = 1;
 	}
 
 	if (osc_over_unstable_soft_limit(cli))
@@ -2361,15 +2382,12 @@ int osc_queue_async_io(const struct lu_env *env, struct cl_io *io,
 	OSC_IO_DEBUG(osc, "oap %p page %p added for cmd %d\n",
 		     oap, oap->oap_page, oap->oap_cmd & OBD_BRW_RWMASK);
 
-	index = oap2cl_page(oap)->cp_index;
-
 	/* Add this page into extent by the following steps:
 	 * 1. if there exists an active extent for this IO, mostly this page
 	 *    can be added to the active extent and sometimes we need to
 	 *    expand extent to accomodate this page;
 	 * 2. otherwise, a new extent will be allocated. */
 
-	ext = oio->oi_active;
 	if (ext != NULL && ext->oe_start <= index && ext->oe_max_end >= index) {
 		/* one chunk plus extent overhead must be enough to write this
 		 * page */
@@ -2419,7 +2437,12 @@ int osc_queue_async_io(const struct lu_env *env, struct cl_io *io,
 		LASSERT(ergo(grants > 0, grants >= tmp));
 
 		rc = 0;
-		if (grants == 0) {
+		if (!quota_checked) {
+			rc = osc_quota_check(env, cli, osc);
+			if (rc != 0 && grants > 0)
+				osc_exit_cache(cli, oap);
+		}
+		if (rc == 0 && grants == 0) {
 			/* we haven't allocated grant for this page. */
 			rc = osc_enter_cache(env, cli, oap, tmp);
 			if (rc == 0)
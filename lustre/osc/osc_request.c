@@ -3591,6 +3591,7 @@ static int osc_precleanup(struct obd_device *obd, enum obd_cleanup_stage stage)
                 }
                 obd_cleanup_client_import(obd);
                 ptlrpc_lprocfs_unregister_obd(obd);
+		lproc_osc_detach_seqstat(obd);
                 lprocfs_obd_cleanup(obd);
                 rc = obd_llog_finish(obd, 0);
                 if (rc != 0)
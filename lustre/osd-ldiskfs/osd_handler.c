@@ -403,6 +403,9 @@ iget:
 		inode = osd_iget_verify(info, dev, id, fid);
 	if (IS_ERR(inode)) {
 		result = PTR_ERR(inode);
+		/* The mapping may be stale, re-read it from the OI file. */
+		if (in_oi)
+			osd_oi_cache_delete(dev, fid);
 		if (result == -ENOENT || result == -ESTALE) {
 			if (!in_oi) {
 				fid_zero(&oic->oic_fid);
@@ -3798,6 +3801,9 @@ again:
 	if (rc == 0 && osd_id_eq(id, &oic->oic_lid))
 		RETURN_EXIT;
 
+	if (rc == 0)
+		osd_oi_cache_delete(dev, fid);
+
 	if (thread_is_running(&scrub->os_thread)) {
 		rc = osd_oii_insert(dev, oic, rc == -ENOENT);
 		/* There is race condition between osd_oi_lookup and OI scrub.
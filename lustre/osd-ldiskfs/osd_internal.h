@@ -239,6 +239,8 @@ struct osd_device {
         struct osd_oi           **od_oi_table;
         /* total number of OI containers */
         int                       od_oi_count;
+	/* FID-to-inode cache in front of the OI containers */
+	struct osd_oi_cache	  od_oi_cache;
         /*
          * Fid Capability
          */
@@ -659,6 +661,7 @@ int osd_oii_insert(struct osd_device *dev, struct osd_idmap_cache *oic,
 int osd_oii_lookup(struct osd_device *dev, const struct lu_fid *fid,
 		   struct osd_inode_id *id);
 int osd_scrub_dump(struct osd_device *dev, char *buf, int len);
+void osd_scrub_set_speed(struct osd_device *dev, __u32 limit);
 
 int osd_fld_lookup(const struct lu_env *env, struct osd_device *osd,
 		   const struct lu_fid *fid, struct lu_seq_range *range);
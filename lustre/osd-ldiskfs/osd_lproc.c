@@ -230,6 +230,11 @@ static int osd_stats_init(struct osd_device *osd)
 #endif
 		result = lprocfs_seq_create(osd->od_proc_entry, "brw_stats",
 					    0644, &osd_brw_stats_fops, osd);
+		if (result == 0)
+			result = lprocfs_oh_export(osd->od_proc_entry,
+						   "brw_stats",
+						   osd->od_brw_stats.hist,
+						   BRW_LAST);
         } else
                 result = -ENOMEM;
 
@@ -274,6 +279,8 @@ out:
 
 int osd_procfs_fini(struct osd_device *osd)
 {
+	lprocfs_oh_unexport(osd->od_brw_stats.hist);
+
 	if (osd->od_stats)
 		lprocfs_free_stats(&osd->od_stats);
 
@@ -480,6 +487,126 @@ static int lprocfs_osd_rd_oi_scrub(char *page, char **start, off_t off,
 	return osd_scrub_dump(dev, page, count);
 }
 
+static int lprocfs_osd_rd_oi_scrub_threads(char *page, char **start,
+					   off_t off, int count, int *eof,
+					   void *data)
+{
+	struct osd_device *dev = osd_dt_dev(data);
+
+	LASSERT(dev != NULL);
+	if (unlikely(dev->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	*eof = 1;
+	return snprintf(page, count, "%u\n", dev->od_scrub.os_threads_max);
+}
+
+static int lprocfs_osd_wr_oi_scrub_threads(struct file *file,
+					   const char *buffer,
+					   unsigned long count, void *data)
+{
+	struct osd_device *dev = osd_dt_dev(data);
+	int val, rc;
+
+	LASSERT(dev != NULL);
+	if (unlikely(dev->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val < 1 || val > SCRUB_THREADS_MAX)
+		return -ERANGE;
+
+	/* Takes effect from the next OI scrub run. */
+	dev->od_scrub.os_threads_max = val;
+	return count;
+}
+
+static int lprocfs_osd_rd_oi_scrub_speed_limit(char *page, char **start,
+					       off_t off, int count, int *eof,
+					       void *data)
+{
+	struct osd_device *dev = osd_dt_dev(data);
+
+	LASSERT(dev != NULL);
+	if (unlikely(dev->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	*eof = 1;
+	return snprintf(page, count, "%u\n", dev->od_scrub.os_speed_limit);
+}
+
+static int lprocfs_osd_wr_oi_scrub_speed_limit(struct file *file,
+					       const char *buffer,
+					       unsigned long count, void *data)
+{
+	struct osd_device *dev = osd_dt_dev(data);
+	int val, rc;
+
+	LASSERT(dev != NULL);
+	if (unlikely(dev->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val < 0)
+		return -ERANGE;
+
+	osd_scrub_set_speed(dev, val);
+	return count;
+}
+
+static int lprocfs_osd_rd_oi_cache(char *page, char **start, off_t off,
+				   int count, int *eof, void *data)
+{
+	struct osd_device *dev = osd_dt_dev(data);
+
+	LASSERT(dev != NULL);
+	if (unlikely(dev->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	*eof = 1;
+	return osd_oi_cache_dump(dev, page, count);
+}
+
+static int lprocfs_osd_rd_oi_cache_size(char *page, char **start, off_t off,
+					int count, int *eof, void *data)
+{
+	struct osd_device *dev = osd_dt_dev(data);
+
+	LASSERT(dev != NULL);
+	if (unlikely(dev->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	*eof = 1;
+	return snprintf(page, count, "%u\n", dev->od_oi_cache.oc_size);
+}
+
+static int lprocfs_osd_wr_oi_cache_size(struct file *file, const char *buffer,
+					unsigned long count, void *data)
+{
+	struct osd_device *dev = osd_dt_dev(data);
+	int val, rc;
+
+	LASSERT(dev != NULL);
+	if (unlikely(dev->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	rc = lprocfs_write_helper(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	if (val < 0)
+		return -ERANGE;
+
+	rc = osd_oi_cache_resize(dev, val);
+	return rc != 0 ? rc : count;
+}
+
 int lprocfs_osd_rd_readcache(char *page, char **start, off_t off, int count,
 			     int *eof, void *data)
 {
@@ -528,6 +655,13 @@ struct lprocfs_vars lprocfs_osd_obd_vars[] = {
 	{ "auto_scrub",      lprocfs_osd_rd_auto_scrub,
 			     lprocfs_osd_wr_auto_scrub,  0 },
 	{ "oi_scrub",	     lprocfs_osd_rd_oi_scrub,    0, 0 },
+	{ "oi_scrub_threads",	lprocfs_osd_rd_oi_scrub_threads,
+				lprocfs_osd_wr_oi_scrub_threads, 0 },
+	{ "oi_scrub_speed_limit", lprocfs_osd_rd_oi_scrub_speed_limit,
+				  lprocfs_osd_wr_oi_scrub_speed_limit, 0 },
+	{ "oi_cache",		lprocfs_osd_rd_oi_cache, 0, 0 },
+	{ "oi_cache_size",	lprocfs_osd_rd_oi_cache_size,
+				lprocfs_osd_wr_oi_cache_size, 0 },
 	{ "force_sync",		0, lprocfs_osd_wr_force_sync },
 	{ "read_cache_enable",	lprocfs_osd_rd_cache, lprocfs_osd_wr_cache, 0 },
 	{ "writethrough_cache_enable",	lprocfs_osd_rd_wcache,
@@ -67,6 +67,11 @@ CFS_MODULE_PARM(osd_oi_count, "i", int, 0444,
                 "Number of Object Index containers to be created, "
                 "it's only valid for new filesystem.");
 
+static unsigned int osd_oi_cache_size = OSD_OIC_DEFAULT_SIZE;
+CFS_MODULE_PARM(osd_oi_cache_size, "i", int, 0444,
+		"Max number of FID-to-inode mappings cached per device, "
+		"0 to disable the cache.");
+
 /** to serialize concurrent OI index initialization */
 static struct mutex oi_init_lock;
 
@@ -329,6 +334,273 @@ osd_oi_table_open(struct osd_thread_info *info, struct osd_device *osd,
 	RETURN(count);
 }
 
+/* FID-to-inode cache */
+
+static inline struct osd_oic_shard *
+osd_oi_cache_shard(struct osd_oi_cache *oc, const struct lu_fid *fid,
+		   __u32 *hash)
+{
+	int count = cfs_percpt_number(oc->oc_shards);
+
+	*hash = fid_hash(fid, 32);
+	return oc->oc_shards[*hash % count];
+}
+
+/* Call with ocsh_lock held, the sets may be replaced by resizing. */
+static inline struct osd_oic_set *
+osd_oi_cache_set(struct osd_oi_cache *oc, struct osd_oic_shard *shard,
+		 __u32 hash)
+{
+	if (shard->ocsh_set_count == 0)
+		return NULL;
+
+	hash /= cfs_percpt_number(oc->oc_shards);
+	return &shard->ocsh_sets[hash % shard->ocsh_set_count];
+}
+
+static inline int osd_oi_cache_find(struct osd_oic_set *set,
+				    const struct lu_fid *fid)
+{
+	int i;
+
+	for (i = 0; i < OSD_OIC_WAYS; i++) {
+		if (lu_fid_eq(&set->ocs_slots[i].oic_fid, fid))
+			return i;
+	}
+	return -1;
+}
+
+int osd_oi_cache_lookup(struct osd_device *osd, const struct lu_fid *fid,
+			struct osd_inode_id *id)
+{
+	struct osd_oi_cache	*oc = &osd->od_oi_cache;
+	struct osd_oic_shard	*shard;
+	struct osd_oic_set	*set;
+	__u32			 hash;
+	int			 i;
+
+	if (oc->oc_size == 0)
+		return -ENOENT;
+
+	shard = osd_oi_cache_shard(oc, fid, &hash);
+	spin_lock(&shard->ocsh_lock);
+	set = osd_oi_cache_set(oc, shard, hash);
+	if (unlikely(set == NULL)) {
+		spin_unlock(&shard->ocsh_lock);
+		return -ENOENT;
+	}
+
+	i = osd_oi_cache_find(set, fid);
+	if (i < 0) {
+		shard->ocsh_misses++;
+		spin_unlock(&shard->ocsh_lock);
+		return -ENOENT;
+	}
+
+	*id = set->ocs_slots[i].oic_lid;
+	set->ocs_ref |= 1 << i;
+	shard->ocsh_hits++;
+	spin_unlock(&shard->ocsh_lock);
+	return 0;
+}
+
+void osd_oi_cache_insert(struct osd_device *osd, const struct lu_fid *fid,
+			 const struct osd_inode_id *id)
+{
+	struct osd_oi_cache	*oc = &osd->od_oi_cache;
+	struct osd_oic_shard	*shard;
+	struct osd_oic_set	*set;
+	__u32			 hash;
+	int			 i;
+
+	if (oc->oc_size == 0)
+		return;
+
+	shard = osd_oi_cache_shard(oc, fid, &hash);
+	spin_lock(&shard->ocsh_lock);
+	set = osd_oi_cache_set(oc, shard, hash);
+	if (unlikely(set == NULL))
+		goto unlock;
+
+	i = osd_oi_cache_find(set, fid);
+	if (i >= 0) {
+		set->ocs_slots[i].oic_lid = *id;
+		goto unlock;
+	}
+
+	for (i = 0; i < OSD_OIC_WAYS; i++) {
+		if (fid_is_zero(&set->ocs_slots[i].oic_fid))
+			goto fill;
+	}
+
+	/* The set is full, every slot is checked at most twice. */
+	while (1) {
+		i = set->ocs_hand;
+		set->ocs_hand = (i + 1) % OSD_OIC_WAYS;
+		if (!(set->ocs_ref & (1 << i)))
+			break;
+
+		set->ocs_ref &= ~(1 << i);
+	}
+	shard->ocsh_evictions++;
+
+fill:
+	/* The new mapping has to be hit once before it can survive the
+	 * next round of the hand, then scanning does not flush the cache. */
+	set->ocs_slots[i].oic_fid = *fid;
+	set->ocs_slots[i].oic_lid = *id;
+	set->ocs_ref &= ~(1 << i);
+	shard->ocsh_inserts++;
+
+unlock:
+	spin_unlock(&shard->ocsh_lock);
+}
+
+void osd_oi_cache_delete(struct osd_device *osd, const struct lu_fid *fid)
+{
+	struct osd_oi_cache	*oc = &osd->od_oi_cache;
+	struct osd_oic_shard	*shard;
+	struct osd_oic_set	*set;
+	__u32			 hash;
+	int			 i;
+
+	if (oc->oc_size == 0)
+		return;
+
+	shard = osd_oi_cache_shard(oc, fid, &hash);
+	spin_lock(&shard->ocsh_lock);
+	set = osd_oi_cache_set(oc, shard, hash);
+	if (likely(set != NULL)) {
+		i = osd_oi_cache_find(set, fid);
+		if (i >= 0) {
+			fid_zero(&set->ocs_slots[i].oic_fid);
+			set->ocs_ref &= ~(1 << i);
+			shard->ocsh_invalidations++;
+		}
+	}
+	spin_unlock(&shard->ocsh_lock);
+}
+
+/* Replace the sets of all the shards, the cached mappings are dropped. */
+int osd_oi_cache_resize(struct osd_device *osd, __u32 size)
+{
+	struct osd_oi_cache	*oc = &osd->od_oi_cache;
+	struct osd_oic_shard	*shard;
+	struct osd_oic_set	*sets;
+	__u32			 count;
+	__u32			 old;
+	int			 i;
+
+	if (oc->oc_shards == NULL)
+		return -ENODEV;
+
+	count = DIV_ROUND_UP(size, OSD_OIC_WAYS *
+			     cfs_percpt_number(oc->oc_shards));
+	mutex_lock(&oc->oc_mutex);
+	/* Disable the cache during resizing, the shard count is fixed. */
+	oc->oc_size = 0;
+	cfs_percpt_for_each(shard, i, oc->oc_shards) {
+		sets = NULL;
+		if (count > 0) {
+			OBD_CPT_ALLOC_LARGE(sets, cfs_cpt_table, i,
+					    count * sizeof(*sets));
+			if (sets == NULL) {
+				mutex_unlock(&oc->oc_mutex);
+				return -ENOMEM;
+			}
+		}
+
+		spin_lock(&shard->ocsh_lock);
+		swap(shard->ocsh_sets, sets);
+		old = shard->ocsh_set_count;
+		shard->ocsh_set_count = count;
+		spin_unlock(&shard->ocsh_lock);
+
+		if (sets != NULL)
+			OBD_FREE_LARGE(sets, old * sizeof(*sets));
+	}
+	oc->oc_size = size;
+	mutex_unlock(&oc->oc_mutex);
+	return 0;
+}
+
+int osd_oi_cache_init(struct osd_device *osd)
+{
+	struct osd_oi_cache	*oc = &osd->od_oi_cache;
+	struct osd_oic_shard	*shard;
+	int			 rc;
+	int			 i;
+
+	oc->oc_shards = cfs_percpt_alloc(cfs_cpt_table, sizeof(*shard));
+	if (oc->oc_shards == NULL)
+		return -ENOMEM;
+
+	mutex_init(&oc->oc_mutex);
+	cfs_percpt_for_each(shard, i, oc->oc_shards)
+		spin_lock_init(&shard->ocsh_lock);
+
+	rc = osd_oi_cache_resize(osd, osd_oi_cache_size);
+	if (rc != 0)
+		osd_oi_cache_fini(osd);
+	return rc;
+}
+
+void osd_oi_cache_fini(struct osd_device *osd)
+{
+	struct osd_oi_cache	*oc = &osd->od_oi_cache;
+	struct osd_oic_shard	*shard;
+	int			 i;
+
+	if (oc->oc_shards == NULL)
+		return;
+
+	oc->oc_size = 0;
+	cfs_percpt_for_each(shard, i, oc->oc_shards) {
+		if (shard->ocsh_sets != NULL)
+			OBD_FREE_LARGE(shard->ocsh_sets, shard->ocsh_set_count *
+				       sizeof(*shard->ocsh_sets));
+	}
+	cfs_percpt_free(oc->oc_shards);
+	oc->oc_shards = NULL;
+}
+
+int osd_oi_cache_dump(struct osd_device *osd, char *buf, int len)
+{
+	struct osd_oi_cache	*oc	   = &osd->od_oi_cache;
+	struct osd_oic_shard	*shard;
+	__u64			 hits	   = 0;
+	__u64			 misses	   = 0;
+	__u64			 inserts   = 0;
+	__u64			 evictions = 0;
+	__u64			 invals	   = 0;
+	int			 i;
+
+	if (oc->oc_shards != NULL) {
+		cfs_percpt_for_each(shard, i, oc->oc_shards) {
+			spin_lock(&shard->ocsh_lock);
+			hits += shard->ocsh_hits;
+			misses += shard->ocsh_misses;
+			inserts += shard->ocsh_inserts;
+			evictions += shard->ocsh_evictions;
+			invals += shard->ocsh_invalidations;
+			spin_unlock(&shard->ocsh_lock);
+		}
+	}
+
+	return snprintf(buf, len,
+			"size: %u\n"
+			"shards: %d\n"
+			"hits: "LPU64"\n"
+			"misses: "LPU64"\n"
+			"inserts: "LPU64"\n"
+			"evictions: "LPU64"\n"
+			"invalidations: "LPU64"\n",
+			oc->oc_size,
+			oc->oc_shards != NULL ?
+			cfs_percpt_number(oc->oc_shards) : 0,
+			hits, misses, inserts, evictions, invals);
+}
+
 int osd_oi_init(struct osd_thread_info *info, struct osd_device *osd)
 {
 	struct osd_scrub  *scrub = &osd->od_scrub;
@@ -420,13 +692,17 @@ out:
 		if (sf->sf_oi_count != rc) {
 			sf->sf_oi_count = rc;
 			rc = osd_scrub_file_store(scrub);
-			if (rc < 0) {
-				osd_oi_table_put(info, oi, sf->sf_oi_count);
-				OBD_FREE(oi, sizeof(*oi) * OSD_OI_FID_NR_MAX);
-			}
 		} else {
 			rc = 0;
 		}
+
+		if (rc == 0)
+			rc = osd_oi_cache_init(osd);
+		if (rc < 0) {
+			osd_oi_table_put(info, oi, sf->sf_oi_count);
+			OBD_FREE(oi, sizeof(*oi) * OSD_OI_FID_NR_MAX);
+			osd->od_oi_table = NULL;
+		}
 	}
 
 	mutex_unlock(&oi_init_lock);
@@ -438,6 +714,7 @@ void osd_oi_fini(struct osd_thread_info *info, struct osd_device *osd)
 	if (unlikely(osd->od_oi_table == NULL))
 		return;
 
+	osd_oi_cache_fini(osd);
         osd_oi_table_put(info, osd->od_oi_table, osd->od_oi_count);
 
         OBD_FREE(osd->od_oi_table,
@@ -538,6 +815,8 @@ int osd_oi_lookup(struct osd_thread_info *info, struct osd_device *osd,
 		  const struct lu_fid *fid, struct osd_inode_id *id,
 		  bool check_fld)
 {
+	int rc;
+
 	if (unlikely(fid_is_last_id(fid)))
 		return osd_obj_spec_lookup(info, osd, fid, id);
 
@@ -558,7 +837,13 @@ int osd_oi_lookup(struct osd_thread_info *info, struct osd_device *osd,
 		return 0;
 	}
 
-	return __osd_oi_lookup(info, osd, fid, id);
+	if (osd_oi_cache_lookup(osd, fid, id) == 0)
+		return 0;
+
+	rc = __osd_oi_lookup(info, osd, fid, id);
+	if (rc == 0)
+		osd_oi_cache_insert(osd, fid, id);
+	return rc;
 }
 
 static int osd_oi_iam_refresh(struct osd_thread_info *oti, struct osd_oi *oi,
@@ -665,6 +950,7 @@ update:
 		if (rc != 0)
 			return rc;
 	}
+	osd_oi_cache_insert(osd, fid, id);
 
 	if (unlikely(fid_seq(fid) == FID_SEQ_LOCAL_FILE))
 		rc = osd_obj_spec_insert(info, osd, fid, id, th);
@@ -708,6 +994,7 @@ int osd_oi_delete(struct osd_thread_info *info,
 	/* clear idmap cache */
 	if (lu_fid_eq(fid, &info->oti_cache.oic_fid))
 		fid_zero(&info->oti_cache.oic_fid);
+	osd_oi_cache_delete(osd, fid);
 
 	if (fid_is_last_id(fid))
 		return 0;
@@ -89,6 +89,47 @@ struct osd_idmap_cache {
 	struct osd_inode_id	oic_lid;
 };
 
+/*
+ * FID-to-inode cache in front of the OI files.
+ *
+ * The cache is split into one shard per CPU partition, each shard is an
+ * array of small sets. A FID is hashed to exactly one set in one shard, and
+ * the set is searched linearly. Replacement inside a full set uses CLOCK:
+ * a hit sets the reference bit of the slot, the hand clears the bits until
+ * it finds a slot without one. Hence the memory used is bounded by the
+ * configured size, and no per-entry allocation or list is needed.
+ */
+#define OSD_OIC_WAYS		8
+#define OSD_OIC_DEFAULT_SIZE	(64 * 1024)
+
+struct osd_oic_set {
+	struct osd_idmap_cache	ocs_slots[OSD_OIC_WAYS];
+	/* CLOCK reference bits, one per slot. */
+	__u8			ocs_ref;
+	/* CLOCK hand, the next slot to be checked for replacement. */
+	__u8			ocs_hand;
+};
+
+struct osd_oic_shard {
+	spinlock_t		 ocsh_lock;
+	struct osd_oic_set	*ocsh_sets;
+	__u32			 ocsh_set_count;
+	__u64			 ocsh_hits;
+	__u64			 ocsh_misses;
+	__u64			 ocsh_inserts;
+	__u64			 ocsh_evictions;
+	__u64			 ocsh_invalidations;
+};
+
+struct osd_oi_cache {
+	/* per-CPT array, see cfs_percpt_alloc() */
+	struct osd_oic_shard   **oc_shards;
+	/* serialize resizing */
+	struct mutex		 oc_mutex;
+	/* The max count of cached mappings, 0 means disabled. */
+	__u32			 oc_size;
+};
+
 static inline void osd_id_pack(struct osd_inode_id *tgt,
 			       const struct osd_inode_id *src)
 {
@@ -148,5 +189,15 @@ int  osd_oi_delete(struct osd_thread_info *info,
 
 int fid_is_on_ost(struct osd_thread_info *info, struct osd_device *osd,
 		  const struct lu_fid *fid);
+
+int  osd_oi_cache_init(struct osd_device *osd);
+void osd_oi_cache_fini(struct osd_device *osd);
+int  osd_oi_cache_resize(struct osd_device *osd, __u32 size);
+int  osd_oi_cache_lookup(struct osd_device *osd, const struct lu_fid *fid,
+			 struct osd_inode_id *id);
+void osd_oi_cache_insert(struct osd_device *osd, const struct lu_fid *fid,
+			 const struct osd_inode_id *id);
+void osd_oi_cache_delete(struct osd_device *osd, const struct lu_fid *fid);
+int  osd_oi_cache_dump(struct osd_device *osd, char *buf, int len);
 #endif /* __KERNEL__ */
 #endif /* _OSD_OI_H */
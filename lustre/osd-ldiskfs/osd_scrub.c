@@ -185,6 +185,12 @@ static int osd_scrub_refresh_mapping(struct osd_thread_info *info,
 	}
 	osd_ipd_put(info->oti_env, bag, ipd);
 	ldiskfs_journal_stop(jh);
+
+	/* Keep the FID-to-inode cache coherent with the repaired OI. */
+	if (rc == 0 && ops != DTO_INDEX_DELETE)
+		osd_oi_cache_insert(dev, fid, id);
+	else
+		osd_oi_cache_delete(dev, fid);
 	RETURN(rc);
 }
 
@@ -193,6 +199,8 @@ static int osd_scrub_refresh_mapping(struct osd_thread_info *info,
 static void osd_scrub_file_to_cpu(struct scrub_file *des,
 				  struct scrub_file *src)
 {
+	int i;
+
 	memcpy(des->sf_uuid, src->sf_uuid, 16);
 	des->sf_flags	= le64_to_cpu(src->sf_flags);
 	des->sf_magic	= le32_to_cpu(src->sf_magic);
@@ -221,12 +229,21 @@ static void osd_scrub_file_to_cpu(struct scrub_file *des,
 	des->sf_run_time	= le32_to_cpu(src->sf_run_time);
 	des->sf_success_count   = le32_to_cpu(src->sf_success_count);
 	des->sf_oi_count	= le16_to_cpu(src->sf_oi_count);
+	des->sf_thread_count	= le16_to_cpu(src->sf_thread_count);
+	for (i = 0; i < SCRUB_THREADS_MAX; i++) {
+		des->sf_pos_thread_checkpoint[i] =
+				le32_to_cpu(src->sf_pos_thread_checkpoint[i]);
+		des->sf_pos_thread_end[i] =
+				le32_to_cpu(src->sf_pos_thread_end[i]);
+	}
 	memcpy(des->sf_oi_bitmap, src->sf_oi_bitmap, SCRUB_OI_BITMAP_SIZE);
 }
 
 static void osd_scrub_file_to_le(struct scrub_file *des,
 				 struct scrub_file *src)
 {
+	int i;
+
 	memcpy(des->sf_uuid, src->sf_uuid, 16);
 	des->sf_flags	= cpu_to_le64(src->sf_flags);
 	des->sf_magic	= cpu_to_le32(src->sf_magic);
@@ -255,6 +272,13 @@ static void osd_scrub_file_to_le(struct scrub_file *des,
 	des->sf_run_time	= cpu_to_le32(src->sf_run_time);
 	des->sf_success_count   = cpu_to_le32(src->sf_success_count);
 	des->sf_oi_count	= cpu_to_le16(src->sf_oi_count);
+	des->sf_thread_count	= cpu_to_le16(src->sf_thread_count);
+	for (i = 0; i < SCRUB_THREADS_MAX; i++) {
+		des->sf_pos_thread_checkpoint[i] =
+				cpu_to_le32(src->sf_pos_thread_checkpoint[i]);
+		des->sf_pos_thread_end[i] =
+				cpu_to_le32(src->sf_pos_thread_end[i]);
+	}
 	memcpy(des->sf_oi_bitmap, src->sf_oi_bitmap, SCRUB_OI_BITMAP_SIZE);
 }
 
@@ -288,6 +312,7 @@ void osd_scrub_file_reset(struct osd_scrub *scrub, __u8 *uuid, __u64 flags)
 	sf->sf_items_updated_prior = 0;
 	sf->sf_items_noscrub = 0;
 	sf->sf_items_igif = 0;
+	sf->sf_thread_count = 0;
 }
 
 static int osd_scrub_file_load(struct osd_scrub *scrub)
@@ -360,7 +385,7 @@ int osd_scrub_file_store(struct osd_scrub *scrub)
 
 static int
 osd_scrub_check_update(struct osd_thread_info *info, struct osd_device *dev,
-		       struct osd_idmap_cache *oic, int val)
+		       struct osd_idmap_cache *oic, int val, bool prior)
 {
 	struct osd_scrub	     *scrub  = &dev->od_scrub;
 	struct scrub_file	     *sf     = &scrub->os_file;
@@ -369,17 +394,21 @@ osd_scrub_check_update(struct osd_thread_info *info, struct osd_device *dev,
 	struct osd_inode_id	     *lid2   = &info->oti_id;
 	struct osd_inconsistent_item *oii    = NULL;
 	struct inode		     *inode  = NULL;
+	__u64			      flags  = 0;
 	int			      ops    = DTO_INDEX_UPDATE;
-	int			      idx;
+	int			      idx    = -1;
+	bool			      igif   = false;
+	bool			      updated = false;
 	int			      rc;
 	ENTRY;
 
-	down_write(&scrub->os_rwsem);
-	scrub->os_new_checked++;
+	/* The OI lookup and repair below run without os_rwsem, so that
+	 * several scanning threads can work at the same time, os_rwsem is
+	 * only taken to update the scrub file. */
 	if (val < 0)
 		GOTO(out, rc = val);
 
-	if (scrub->os_in_prior)
+	if (prior)
 		oii = cfs_list_entry(oic, struct osd_inconsistent_item,
 				     oii_cache);
 
@@ -387,7 +416,7 @@ osd_scrub_check_update(struct osd_thread_info *info, struct osd_device *dev,
 		GOTO(out, rc = 0);
 
 	if (fid_is_igif(fid))
-		sf->sf_items_igif++;
+		igif = true;
 
 	if ((val == SCRUB_NEXT_NOLMA) &&
 	    (!dev->od_handle_nolma || OBD_FAIL_CHECK(OBD_FAIL_FID_NOLMA)))
@@ -410,6 +439,7 @@ iget:
 		inode = osd_iget(info, dev, lid);
 		if (IS_ERR(inode)) {
 			rc = PTR_ERR(inode);
+			inode = NULL;
 			/* Someone removed the inode. */
 			if (rc == -ENOENT || rc == -ESTALE)
 				rc = 0;
@@ -419,33 +449,26 @@ iget:
 		/* Check whether the inode to be unlinked during OI scrub. */
 		if (unlikely(inode->i_nlink == 0)) {
 			iput(inode);
+			inode = NULL;
 			GOTO(out, rc = 0);
 		}
 
 		ops = DTO_INDEX_INSERT;
-		idx = osd_oi_fid2idx(dev, fid);
 		if (val == SCRUB_NEXT_NOLMA) {
-			sf->sf_flags |= SF_UPGRADE;
-			scrub->os_full_speed = 1;
+			flags |= SF_UPGRADE;
 			if (!(sf->sf_param & SP_DRYRUN)) {
 				rc = osd_ea_fid_set(info, inode, fid, 0);
 				if (rc != 0)
 					GOTO(out, rc);
 			}
-
-			if (!(sf->sf_flags & SF_INCONSISTENT))
-				dev->od_igif_inoi = 0;
 		} else {
-			sf->sf_flags |= SF_RECREATED;
-			scrub->os_full_speed = 1;
-			if (unlikely(!ldiskfs_test_bit(idx, sf->sf_oi_bitmap)))
-				ldiskfs_set_bit(idx, sf->sf_oi_bitmap);
+			flags |= SF_RECREATED;
+			idx = osd_oi_fid2idx(dev, fid);
 		}
 	} else if (osd_id_eq(lid, lid2)) {
 		GOTO(out, rc = 0);
 	} else {
-		sf->sf_flags |= SF_INCONSISTENT;
-		scrub->os_full_speed = 1;
+		flags |= SF_INCONSISTENT;
 
 		/* XXX: If the device is restored from file-level backup, then
 		 *	some IGIFs may have been already in OI files, and some
@@ -463,33 +486,48 @@ iget:
 	}
 
 	rc = osd_scrub_refresh_mapping(info, dev, fid, lid, ops, false);
-	if (rc == 0) {
-		if (scrub->os_in_prior)
-			sf->sf_items_updated_prior++;
-		else
-			sf->sf_items_updated++;
-	}
+	if (rc == 0)
+		updated = true;
 
 	GOTO(out, rc);
 
 out:
+	if (ops == DTO_INDEX_INSERT && inode != NULL) {
+		/* There may be conflict unlink during the OI scrub,
+		 * if happend, then remove the new added OI mapping. */
+		if (unlikely(inode->i_nlink == 0))
+			osd_scrub_refresh_mapping(info, dev, fid, lid,
+						  DTO_INDEX_DELETE, false);
+		iput(inode);
+	}
+
+	down_write(&scrub->os_rwsem);
+	scrub->os_new_checked++;
+	if (igif)
+		sf->sf_items_igif++;
+	if (flags != 0) {
+		sf->sf_flags |= flags;
+		scrub->os_full_speed = 1;
+		if (flags & SF_UPGRADE && !(sf->sf_flags & SF_INCONSISTENT))
+			dev->od_igif_inoi = 0;
+		if (idx >= 0 && !ldiskfs_test_bit(idx, sf->sf_oi_bitmap))
+			ldiskfs_set_bit(idx, sf->sf_oi_bitmap);
+	}
+
 	if (rc < 0) {
 		sf->sf_items_failed++;
 		if (sf->sf_pos_first_inconsistent == 0 ||
 		    sf->sf_pos_first_inconsistent > lid->oii_ino)
 			sf->sf_pos_first_inconsistent = lid->oii_ino;
 	} else {
+		if (updated) {
+			if (prior)
+				sf->sf_items_updated_prior++;
+			else
+				sf->sf_items_updated++;
+		}
 		rc = 0;
 	}
-
-	if (ops == DTO_INDEX_INSERT) {
-		/* There may be conflict unlink during the OI scrub,
-		 * if happend, then remove the new added OI mapping. */
-		if (unlikely(inode->i_nlink == 0))
-			osd_scrub_refresh_mapping(info, dev, fid, lid,
-						  DTO_INDEX_DELETE, false);
-		iput(inode);
-	}
 	up_write(&scrub->os_rwsem);
 
 	if (oii != NULL) {
@@ -505,6 +543,158 @@ out:
 
 /* OI scrub APIs */
 
+/* Move os_pos_current to the lowest position among the scanning threads,
+ * every object before it has been checked. */
+static void osd_scrub_pos_update(struct osd_scrub *scrub)
+{
+	struct osd_scrub_thread *ost;
+	__u32			 pos = ~0U;
+	int			 i;
+
+	for (i = 0; i < scrub->os_thread_count; i++) {
+		ost = &scrub->os_threads[i];
+		if (ost->ost_pos_current < ost->ost_pos_end &&
+		    ost->ost_pos_current < pos)
+			pos = ost->ost_pos_current;
+	}
+	if (pos == ~0U)
+		pos = scrub->os_threads[scrub->os_thread_count - 1].ost_pos_end;
+	scrub->os_pos_current = pos;
+}
+
+/* Return the position to be recorded as the last checkpoint. For the
+ * parallel scrub, also record each thread's own checkpoint. The caller
+ * holds os_rwsem for write. */
+static __u32 osd_scrub_pos_checkpoint(struct osd_scrub *scrub)
+{
+	struct scrub_file *sf = &scrub->os_file;
+	int		   i;
+
+	if (scrub->os_threads == NULL)
+		return scrub->os_pos_current;
+
+	for (i = 0; i < scrub->os_thread_count; i++)
+		sf->sf_pos_thread_checkpoint[i] =
+			scrub->os_threads[i].ost_pos_current - 1;
+
+	spin_lock(&scrub->os_lock);
+	osd_scrub_pos_update(scrub);
+	spin_unlock(&scrub->os_lock);
+
+	return scrub->os_pos_current - 1;
+}
+
+/* Split the inode table by block groups among the scanning threads. If
+ * the last run used the same number of threads, then each thread resumes
+ * from its own checkpoint, otherwise split from sf_pos_latest_start. */
+static void osd_scrub_split(struct osd_device *dev, bool resume)
+{
+	struct osd_scrub	*scrub = &dev->od_scrub;
+	struct scrub_file	*sf    = &scrub->os_file;
+	struct super_block	*sb    = osd_sb(dev);
+	struct osd_scrub_thread *ost;
+	__u32			 ipg   = LDISKFS_INODES_PER_GROUP(sb);
+	__u32			 limit;
+	__u32			 first;
+	__u32			 groups;
+	__u32			 count = scrub->os_thread_count;
+	int			 i;
+
+	if (resume && sf->sf_thread_count == count) {
+		for (i = 0; i < count; i++) {
+			ost = &scrub->os_threads[i];
+			ost->ost_pos_current =
+				sf->sf_pos_thread_checkpoint[i] + 1;
+			ost->ost_pos_end = sf->sf_pos_thread_end[i];
+		}
+		return;
+	}
+
+	limit = le32_to_cpu(LDISKFS_SB(sb)->s_es->s_inodes_count);
+	first = (sf->sf_pos_latest_start - 1) / ipg;
+	groups = LDISKFS_SB(sb)->s_groups_count - first;
+	if (count > groups)
+		count = groups;
+
+	for (i = 0; i < count; i++) {
+		ost = &scrub->os_threads[i];
+		if (i == 0)
+			ost->ost_pos_current = sf->sf_pos_latest_start;
+		else
+			ost->ost_pos_current =
+				1 + (first + groups * i / count) * ipg;
+
+		if (i == count - 1)
+			ost->ost_pos_end = limit + 1;
+		else
+			ost->ost_pos_end =
+				1 + (first + groups * (i + 1) / count) * ipg;
+
+		sf->sf_pos_thread_checkpoint[i] = ost->ost_pos_current - 1;
+		sf->sf_pos_thread_end[i] = ost->ost_pos_end;
+	}
+	scrub->os_thread_count = count;
+	sf->sf_thread_count = count;
+}
+
+static void osd_scrub_threads_fini(struct osd_scrub *scrub)
+{
+	int i;
+
+	if (scrub->os_threads != NULL) {
+		for (i = 0; i < scrub->os_thread_count; i++) {
+			if (scrub->os_threads[i].ost_items_checked > 0)
+				scrub->os_threads_last++;
+		}
+		OBD_FREE(scrub->os_threads,
+			 sizeof(*scrub->os_threads) * scrub->os_threads_alloc);
+		scrub->os_threads = NULL;
+	}
+	scrub->os_thread_count = 0;
+}
+
+/* Only the full speed scrub runs with several threads, the scrub driven
+ * by the LFSCK otable iterator scans in order inside the window. */
+static void osd_scrub_threads_init(struct osd_device *dev, bool resume)
+{
+	struct osd_scrub *scrub = &dev->od_scrub;
+	struct scrub_file *sf   = &scrub->os_file;
+	__u32		  count = scrub->os_threads_max;
+	int		  i;
+
+	LASSERT(scrub->os_threads == NULL);
+
+	scrub->os_threads_last = 0;
+	if (!scrub->os_full_speed || count <= 1)
+		goto serial;
+
+	OBD_ALLOC(scrub->os_threads, sizeof(*scrub->os_threads) * count);
+	if (scrub->os_threads == NULL)
+		goto serial;
+
+	scrub->os_threads_alloc = count;
+	scrub->os_thread_count = count;
+	osd_scrub_split(dev, resume);
+	if (scrub->os_thread_count <= 1) {
+		osd_scrub_threads_fini(scrub);
+		goto serial;
+	}
+
+	for (i = 0; i < scrub->os_thread_count; i++) {
+		struct osd_scrub_thread *ost = &scrub->os_threads[i];
+
+		cfs_waitq_init(&ost->ost_thread.t_ctl_waitq);
+		ost->ost_dev = dev;
+		ost->ost_idx = i;
+		ost->ost_time_start = cfs_time_current();
+	}
+	osd_scrub_pos_update(scrub);
+	return;
+
+serial:
+	sf->sf_thread_count = 0;
+}
+
 static int osd_scrub_prep(struct osd_device *dev)
 {
 	struct osd_scrub     *scrub  = &dev->od_scrub;
@@ -560,6 +750,8 @@ static int osd_scrub_prep(struct osd_device *dev)
 		sf->sf_pos_latest_start = LDISKFS_FIRST_INO(osd_sb(dev)) + 1;
 
 	scrub->os_pos_current = sf->sf_pos_latest_start;
+	osd_scrub_threads_init(dev, !drop_dryrun &&
+				    sf->sf_pos_last_checkpoint != 0);
 	sf->sf_status = SS_SCANNING;
 	sf->sf_time_latest_start = cfs_time_current_sec();
 	sf->sf_time_last_checkpoint = sf->sf_time_latest_start;
@@ -586,9 +778,16 @@ static int osd_scrub_checkpoint(struct osd_scrub *scrub)
 		return 0;
 
 	down_write(&scrub->os_rwsem);
+	/* Another scanning thread may have just done the checkpoint. */
+	if (unlikely(cfs_time_before(cfs_time_current(),
+				     scrub->os_time_next_checkpoint))) {
+		up_write(&scrub->os_rwsem);
+		return 0;
+	}
+
 	sf->sf_items_checked += scrub->os_new_checked;
 	scrub->os_new_checked = 0;
-	sf->sf_pos_last_checkpoint = scrub->os_pos_current;
+	sf->sf_pos_last_checkpoint = osd_scrub_pos_checkpoint(scrub);
 	sf->sf_time_last_checkpoint = cfs_time_current_sec();
 	sf->sf_run_time += cfs_duration_sec(cfs_time_current() + HALF_SEC -
 					    scrub->os_time_last_checkpoint);
@@ -610,7 +809,7 @@ static void osd_scrub_post(struct osd_scrub *scrub, int result)
 	if (scrub->os_new_checked > 0) {
 		sf->sf_items_checked += scrub->os_new_checked;
 		scrub->os_new_checked = 0;
-		sf->sf_pos_last_checkpoint = scrub->os_pos_current;
+		sf->sf_pos_last_checkpoint = osd_scrub_pos_checkpoint(scrub);
 	}
 	sf->sf_time_last_checkpoint = cfs_time_current_sec();
 	if (result > 0) {
@@ -648,6 +847,96 @@ static void osd_scrub_post(struct osd_scrub *scrub, int result)
 
 /* iteration engine */
 
+static void osd_scrub_control_speed(struct osd_scrub *scrub)
+{
+	struct ptlrpc_thread *thread = &scrub->os_thread;
+	struct l_wait_info    lwi;
+	cfs_time_t	      now;
+
+	if (scrub->os_sleep_jif == 0)
+		return;
+
+	/* The budget of each time slice is shared by all scanning threads,
+	 * so the limit applies to the scrub as a whole. */
+	spin_lock(&scrub->os_lock);
+	while (scrub->os_sleep_jif > 0 && thread_is_running(thread)) {
+		now = cfs_time_current();
+		if (cfs_time_aftereq(now, scrub->os_speed_window)) {
+			scrub->os_speed_window = now + scrub->os_sleep_jif;
+			scrub->os_speed_used = 0;
+		}
+
+		if (scrub->os_speed_used < scrub->os_sleep_rate) {
+			scrub->os_speed_used++;
+			break;
+		}
+
+		lwi = LWI_TIMEOUT_INTR(scrub->os_speed_window - now, NULL,
+				       LWI_ON_SIGNAL_NOOP, NULL);
+		spin_unlock(&scrub->os_lock);
+
+		l_wait_event(thread->t_ctl_waitq,
+			     !thread_is_running(thread),
+			     &lwi);
+		spin_lock(&scrub->os_lock);
+	}
+	spin_unlock(&scrub->os_lock);
+}
+
+void osd_scrub_set_speed(struct osd_device *dev, __u32 limit)
+{
+	struct osd_scrub *scrub = &dev->od_scrub;
+
+	spin_lock(&scrub->os_lock);
+	scrub->os_speed_limit = limit;
+	if (limit != 0) {
+		if (limit > CFS_HZ) {
+			scrub->os_sleep_rate = limit / CFS_HZ;
+			scrub->os_sleep_jif = 1;
+		} else {
+			scrub->os_sleep_rate = 1;
+			scrub->os_sleep_jif = CFS_HZ / limit;
+		}
+	} else {
+		scrub->os_sleep_jif = 0;
+		scrub->os_sleep_rate = 0;
+	}
+	scrub->os_speed_used = 0;
+	spin_unlock(&scrub->os_lock);
+}
+
+/* Start reading the in-use part of the inode table of the group @bg from
+ * @offset, so that the following osd_iget() calls find it in cache. */
+static void osd_scrub_readahead(struct super_block *sb, ldiskfs_group_t bg,
+				__u32 offset)
+{
+	struct ldiskfs_group_desc *gdp;
+	ldiskfs_fsblk_t		   blk;
+	__u32			   ipb  = LDISKFS_INODES_PER_BLOCK(sb);
+	__u32			   used = LDISKFS_INODES_PER_GROUP(sb);
+	__u32			   i;
+
+	gdp = ldiskfs_get_group_desc(sb, bg, NULL);
+	if (gdp == NULL)
+		return;
+
+	if (LDISKFS_HAS_RO_COMPAT_FEATURE(sb,
+					  LDISKFS_FEATURE_RO_COMPAT_GDT_CSUM)) {
+		if (gdp->bg_flags & cpu_to_le16(LDISKFS_BG_INODE_UNINIT))
+			return;
+
+		used -= ldiskfs_itable_unused_count(sb, gdp);
+	}
+
+	blk = le32_to_cpu(gdp->bg_inode_table_lo);
+	if (LDISKFS_DESC_SIZE(sb) >= LDISKFS_MIN_DESC_SIZE_64BIT)
+		blk |= (ldiskfs_fsblk_t)le32_to_cpu(gdp->bg_inode_table_hi)
+									<< 32;
+
+	for (i = offset / ipb; i < (used + ipb - 1) / ipb; i++)
+		sb_breadahead(sb, blk + i);
+}
+
 struct osd_iit_param {
 	struct super_block *sb;
 	struct buffer_head *bitmap;
@@ -863,7 +1152,8 @@ static int osd_scrub_exec(struct osd_thread_info *info, struct osd_device *dev,
 		goto next;
 	}
 
-	rc = osd_scrub_check_update(info, dev, oic, rc);
+	rc = osd_scrub_check_update(info, dev, oic, rc,
+				    scrub->os_in_prior);
 	if (rc != 0)
 		return rc;
 
@@ -882,6 +1172,8 @@ static int osd_scrub_exec(struct osd_thread_info *info, struct osd_device *dev,
 
 next:
 	scrub->os_pos_current = param->gbase + ++(param->offset);
+	if (rc != SCRUB_NEXT_CONTINUE)
+		osd_scrub_control_speed(scrub);
 
 wait:
 	if (it != NULL && it->ooi_waiting &&
@@ -974,6 +1266,9 @@ static int osd_inode_iteration(struct osd_thread_info *info,
 			RETURN(-EIO);
 		}
 
+		if (!preload)
+			osd_scrub_readahead(param.sb, param.bg, param.offset);
+
 		while (param.offset < LDISKFS_INODES_PER_GROUP(param.sb) &&
 		       *count < max) {
 			rc = next(info, dev, &param, &oic, noslot);
@@ -1041,6 +1336,246 @@ static int osd_otable_it_preload(const struct lu_env *env,
 	RETURN(rc < 0 ? rc : ooc->ooc_cached_items);
 }
 
+/* parallel scanning for the full speed OI scrub */
+
+static int osd_scrub_prior(struct osd_thread_info *info, struct osd_device *dev)
+{
+	struct osd_scrub	     *scrub = &dev->od_scrub;
+	struct osd_inconsistent_item *oii;
+
+	spin_lock(&scrub->os_lock);
+	if (cfs_list_empty(&scrub->os_inconsistent_items)) {
+		spin_unlock(&scrub->os_lock);
+		return 0;
+	}
+
+	/* Only the main scrub thread consumes the list. */
+	oii = cfs_list_entry(scrub->os_inconsistent_items.next,
+			     struct osd_inconsistent_item, oii_list);
+	spin_unlock(&scrub->os_lock);
+
+	return osd_scrub_check_update(info, dev, &oii->oii_cache, 0, true);
+}
+
+/**
+ * Scan the range [ost_pos_current, ost_pos_end) of the inode table.
+ *
+ * \retval   1, the whole range has been scanned
+ * \retval   0, the scrub is stopped
+ * \retval -ve, on error
+ */
+static int osd_scrub_range(struct osd_thread_info *info,
+			   struct osd_scrub_thread *ost, bool prior)
+{
+	struct osd_device	*dev    = ost->ost_dev;
+	struct osd_scrub	*scrub  = &dev->od_scrub;
+	struct ptlrpc_thread	*thread = &scrub->os_thread;
+	struct super_block	*sb     = osd_sb(dev);
+	struct osd_idmap_cache	*oic    = &ost->ost_oic;
+	__u32			 ipg    = LDISKFS_INODES_PER_GROUP(sb);
+	struct buffer_head	*bitmap;
+	ldiskfs_group_t		 bg;
+	__u32			 gbase;
+	__u32			 offset;
+	int			 rc;
+
+	while (ost->ost_pos_current < ost->ost_pos_end) {
+		bg = (ost->ost_pos_current - 1) / ipg;
+		offset = (ost->ost_pos_current - 1) % ipg;
+		gbase = 1 + bg * ipg;
+		bitmap = ldiskfs_read_inode_bitmap(sb, bg);
+		if (bitmap == NULL) {
+			CERROR("%.16s: fail to read bitmap for %u, "
+			       "scrub will stop, urgent mode\n",
+			       LDISKFS_SB(sb)->s_es->s_volume_name, (__u32)bg);
+			return -EIO;
+		}
+
+		osd_scrub_readahead(sb, bg, offset);
+		while (1) {
+			if (unlikely(!thread_is_running(thread))) {
+				brelse(bitmap);
+				return 0;
+			}
+
+			if (prior &&
+			    !cfs_list_empty(&scrub->os_inconsistent_items)) {
+				rc = osd_scrub_prior(info, dev);
+				if (rc != 0) {
+					brelse(bitmap);
+					return rc;
+				}
+			}
+
+			offset = ldiskfs_find_next_bit(bitmap->b_data, ipg,
+						       offset);
+			if (offset >= ipg || gbase + offset >= ost->ost_pos_end)
+				break;
+
+			rc = osd_iit_iget(info, dev, &oic->oic_fid,
+					  &oic->oic_lid, gbase + offset, sb,
+					  true);
+			if (rc == SCRUB_NEXT_NOSCRUB) {
+				down_write(&scrub->os_rwsem);
+				scrub->os_new_checked++;
+				scrub->os_file.sf_items_noscrub++;
+				up_write(&scrub->os_rwsem);
+			} else if (rc != SCRUB_NEXT_CONTINUE) {
+				rc = osd_scrub_check_update(info, dev, oic, rc,
+							    false);
+				if (rc != 0) {
+					brelse(bitmap);
+					return rc;
+				}
+			}
+
+			ost->ost_pos_current = gbase + ++offset;
+			if (rc == SCRUB_NEXT_CONTINUE)
+				continue;
+
+			ost->ost_items_checked++;
+			rc = osd_scrub_checkpoint(scrub);
+			if (rc != 0)
+				CERROR("%.16s: fail to checkpoint, pos = %u, "
+				       "rc = %d\n",
+				       LDISKFS_SB(sb)->s_es->s_volume_name,
+				       ost->ost_pos_current, rc);
+			osd_scrub_control_speed(scrub);
+		}
+		brelse(bitmap);
+
+		ost->ost_pos_current = min(gbase + ipg, ost->ost_pos_end);
+		spin_lock(&scrub->os_lock);
+		osd_scrub_pos_update(scrub);
+		spin_unlock(&scrub->os_lock);
+	}
+
+	return 1;
+}
+
+static int osd_scrub_helper(void *args)
+{
+	struct osd_scrub_thread *ost   = args;
+	struct osd_scrub	*scrub = &ost->ost_dev->od_scrub;
+	struct lu_env		 env;
+	char			 name[16];
+	int			 rc;
+
+	snprintf(name, sizeof(name), "OI_scrub_%02u", ost->ost_idx);
+	cfs_daemonize(name);
+	rc = lu_env_init(&env, LCT_DT_THREAD);
+	if (rc == 0) {
+		rc = osd_scrub_range(osd_oti_get(&env), ost, false);
+		lu_env_fini(&env);
+	}
+
+	CDEBUG(D_LFSCK, "OI scrub thread %u: stop, rc = %d, pos = %u/%u\n",
+	       ost->ost_idx, rc, ost->ost_pos_current, ost->ost_pos_end);
+
+	spin_lock(&scrub->os_lock);
+	ost->ost_result = rc;
+	/* Stop the others, the scrub as a whole has failed. */
+	if (rc < 0 && thread_is_running(&scrub->os_thread))
+		thread_set_flags(&scrub->os_thread, SVC_STOPPING);
+	thread_set_flags(&ost->ost_thread, SVC_STOPPED);
+	cfs_waitq_broadcast(&scrub->os_thread.t_ctl_waitq);
+	spin_unlock(&scrub->os_lock);
+	return rc;
+}
+
+static int osd_scrub_helpers_stopped(struct osd_scrub *scrub)
+{
+	int i;
+
+	for (i = 1; i < scrub->os_thread_count; i++) {
+		if (!thread_is_stopped(&scrub->os_threads[i].ost_thread))
+			return 0;
+	}
+	return 1;
+}
+
+static inline int osd_scrub_parallel_wakeup(struct osd_scrub *scrub)
+{
+	return osd_scrub_helpers_stopped(scrub) ||
+	       (thread_is_running(&scrub->os_thread) &&
+		!cfs_list_empty(&scrub->os_inconsistent_items));
+}
+
+static int osd_scrub_parallel(struct osd_thread_info *info,
+			      struct osd_device *dev)
+{
+	struct osd_scrub	*scrub  = &dev->od_scrub;
+	struct ptlrpc_thread	*thread = &scrub->os_thread;
+	struct l_wait_info	 lwi    = { 0 };
+	__u32			 orphan = 0;
+	int			 rc;
+	int			 i;
+
+	for (i = 1; i < scrub->os_thread_count; i++) {
+		struct osd_scrub_thread *ost = &scrub->os_threads[i];
+
+		thread_set_flags(&ost->ost_thread, SVC_RUNNING);
+		rc = cfs_create_thread(osd_scrub_helper, ost, 0);
+		if (rc < 0) {
+			CWARN("%.16s: cannot start OI scrub thread %d, the "
+			      "main thread will scan its range, rc = %d\n",
+			      LDISKFS_SB(osd_sb(dev))->s_es->s_volume_name,
+			      i, rc);
+			thread_set_flags(&ost->ost_thread, SVC_STOPPED);
+			orphan |= 1 << i;
+		}
+	}
+
+	rc = osd_scrub_range(info, &scrub->os_threads[0], true);
+	for (i = 1; rc == 1 && i < scrub->os_thread_count; i++) {
+		if (orphan & (1 << i))
+			rc = osd_scrub_range(info, &scrub->os_threads[i],
+					     true);
+	}
+
+	if (rc < 0) {
+		spin_lock(&scrub->os_lock);
+		if (thread_is_running(thread))
+			thread_set_flags(thread, SVC_STOPPING);
+		spin_unlock(&scrub->os_lock);
+		cfs_waitq_broadcast(&thread->t_ctl_waitq);
+	}
+
+	/* Keep serving the inconsistent items found by RPCs until all the
+	 * other threads finish their ranges. */
+	while (1) {
+		l_wait_event(thread->t_ctl_waitq,
+			     osd_scrub_parallel_wakeup(scrub),
+			     &lwi);
+		if (osd_scrub_helpers_stopped(scrub))
+			break;
+
+		if (osd_scrub_prior(info, dev) < 0) {
+			spin_lock(&scrub->os_lock);
+			if (thread_is_running(thread))
+				thread_set_flags(thread, SVC_STOPPING);
+			spin_unlock(&scrub->os_lock);
+			cfs_waitq_broadcast(&thread->t_ctl_waitq);
+			if (rc >= 0)
+				rc = -EIO;
+		}
+	}
+
+	for (i = 1; i < scrub->os_thread_count; i++) {
+		int result = scrub->os_threads[i].ost_result;
+
+		if (orphan & (1 << i))
+			continue;
+
+		if (result < 0 && rc >= 0)
+			rc = result;
+		else if (result == 0 && rc > 0)
+			rc = 0;
+	}
+
+	return rc;
+}
+
 static int osd_scrub_main(void *args)
 {
 	struct lu_env	      env;
@@ -1083,7 +1618,10 @@ static int osd_scrub_main(void *args)
 	CDEBUG(D_LFSCK, "OI scrub: flags = 0x%x, pos = %u\n",
 	       scrub->os_start_flags, scrub->os_pos_current);
 
-	rc = osd_inode_iteration(osd_oti_get(&env), dev, ~0U, false);
+	if (scrub->os_threads != NULL)
+		rc = osd_scrub_parallel(osd_oti_get(&env), dev);
+	else
+		rc = osd_inode_iteration(osd_oti_get(&env), dev, ~0U, false);
 	if (unlikely(rc == SCRUB_IT_CRASH))
 		GOTO(out, rc = -EINVAL);
 	GOTO(post, rc);
@@ -1094,6 +1632,9 @@ post:
 	       rc, scrub->os_pos_current);
 
 out:
+	down_write(&scrub->os_rwsem);
+	osd_scrub_threads_fini(scrub);
+	up_write(&scrub->os_rwsem);
 	while (!cfs_list_empty(&scrub->os_inconsistent_items)) {
 		struct osd_inconsistent_item *oii;
 
@@ -1755,6 +2296,7 @@ int osd_scrub_setup(const struct lu_env *env, struct osd_device *dev)
 	ENTRY;
 
 	memset(scrub, 0, sizeof(*scrub));
+	scrub->os_threads_max = 1;
 	OBD_SET_CTXT_MAGIC(ctxt);
 	ctxt->pwdmnt = dev->od_mnt;
 	ctxt->pwd = dev->od_mnt->mnt_root;
@@ -2282,6 +2824,39 @@ static int scrub_pos_dump(char **buf, int *len, __u64 pos, const char *prefix)
 	return rc;
 }
 
+static int scrub_threads_dump(char **buf, int *len, struct osd_scrub *scrub)
+{
+	int rc;
+	int i;
+
+	rc = snprintf(*buf, *len, "threads: %u\n", scrub->os_thread_count);
+	if (rc <= 0)
+		return -ENOSPC;
+
+	*buf += rc;
+	*len -= rc;
+	for (i = 0; i < scrub->os_thread_count; i++) {
+		struct osd_scrub_thread *ost = &scrub->os_threads[i];
+		cfs_duration_t duration = cfs_time_current() -
+					  ost->ost_time_start;
+		__u64 speed = ost->ost_items_checked * CFS_HZ;
+
+		if (duration != 0)
+			do_div(speed, duration);
+		rc = snprintf(*buf, *len,
+			      "thread_%d: checked "LPU64", speed "LPU64
+			      " objects/sec, position %u, end %u\n",
+			      i, ost->ost_items_checked, speed,
+			      ost->ost_pos_current, ost->ost_pos_end);
+		if (rc <= 0)
+			return -ENOSPC;
+
+		*buf += rc;
+		*len -= rc;
+	}
+	return 0;
+}
+
 int osd_scrub_dump(struct osd_device *dev, char *buf, int len)
 {
 	struct osd_scrub  *scrub   = &dev->od_scrub;
@@ -2395,6 +2970,18 @@ int osd_scrub_dump(struct osd_device *dev, char *buf, int len)
 
 	buf += rc;
 	len -= rc;
+	if (scrub->os_threads != NULL) {
+		rc = scrub_threads_dump(&buf, &len, scrub);
+		if (rc < 0)
+			goto out;
+	} else if (scrub->os_threads_last > 0) {
+		rc = snprintf(buf, len, "last_threads: %u\n",
+			      scrub->os_threads_last);
+		if (rc <= 0)
+			goto out;
+
+		len -= rc;
+	}
 	ret = save - len;
 
 out:
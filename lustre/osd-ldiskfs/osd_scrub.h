@@ -39,6 +39,7 @@
 #define SCRUB_CHECKPOINT_INTERVAL	60
 #define SCRUB_OI_BITMAP_SIZE		(OSD_OI_FID_NR_MAX >> 3)
 #define SCRUB_WINDOW_SIZE		1024
+#define SCRUB_THREADS_MAX		8
 
 enum scrub_status {
 	/* The scrub file is new created, for new MDT, upgrading from old disk,
@@ -167,15 +168,40 @@ struct scrub_file {
 	/* How many OI files. */
 	__u16   sf_oi_count;
 
+	/* How many threads scanned the inode table, 0 for single thread. */
+	__u16	sf_thread_count;
+
 	/* Update the magic or flags if want to use the reserved fields. */
-	__u16	sf_reserved_0;
 	__u32	sf_reserved_1;
-	__u64	sf_reserved_2[16];
+
+	/* The position for the last checkpoint of each scanning thread. */
+	__u32	sf_pos_thread_checkpoint[SCRUB_THREADS_MAX];
+
+	/* The end position (not included) of each thread's range. */
+	__u32	sf_pos_thread_end[SCRUB_THREADS_MAX];
+
+	__u64	sf_reserved_2[8];
 
 	/* Bitmap for OI files recreated case. */
 	__u8    sf_oi_bitmap[SCRUB_OI_BITMAP_SIZE];
 };
 
+struct osd_scrub_thread {
+	struct ptlrpc_thread	 ost_thread;
+	struct osd_idmap_cache	 ost_oic;
+	struct osd_device	*ost_dev;
+
+	/* The next position to be checked, and the end of the range. */
+	__u32			 ost_pos_current;
+	__u32			 ost_pos_end;
+	__u32			 ost_idx;
+	int			 ost_result;
+
+	/* How many objects this thread checked since the scrub started. */
+	__u64			 ost_items_checked;
+	cfs_time_t		 ost_time_start;
+};
+
 struct osd_scrub {
 	struct lvfs_run_ctxt    os_ctxt;
 	struct ptlrpc_thread    os_thread;
@@ -206,6 +232,25 @@ struct osd_scrub {
 	__u32			os_new_checked;
 	__u32			os_pos_current;
 	__u32			os_start_flags;
+
+	/* Threads scanning the inode table in parallel, os_threads[0] is
+	 * the main scrub thread. NULL when the scrub runs single-threaded. */
+	struct osd_scrub_thread *os_threads;
+	__u32			os_thread_count;
+	__u32			os_threads_alloc;
+
+	/* How many threads to use for a full speed scrub. */
+	__u32			os_threads_max;
+
+	/* How many threads checked objects in the last parallel scrub. */
+	__u32			os_threads_last;
+
+	/* Speed limit shared by all scanning threads, objects/sec. */
+	__u32			os_speed_limit;
+	__u32			os_sleep_rate;
+	cfs_duration_t		os_sleep_jif;
+	__u32			os_speed_used;
+	cfs_time_t		os_speed_window;
 	unsigned int		os_in_prior:1, /* process inconsistent item
 						* found by RPC prior */
 				os_waiting:1, /* Waiting for scan window. */
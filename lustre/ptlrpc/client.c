@@ -246,6 +246,20 @@ void ptlrpc_at_set_req_timeout(struct ptlrpc_request *req)
                 idx = import_at_get_index(req->rq_import,
                                           req->rq_request_portal);
                 serv_est = at_get(&at->iat_service_estimate[idx]);
+
+		/* The portal estimate covers the slowest RPCs handled by the
+		 * service, this opcode may be served much faster. A server
+		 * needing more time sends early replies, but callbacks on
+		 * reverse imports get none and have to be conservative. */
+		if (at_percentile > 0 && !req->rq_import->imp_server_timeout &&
+		    req->rq_import->imp_msghdr_flags & MSGHDR_AT_SUPPORT) {
+			idx = import_at_get_opc_index(req->rq_import,
+					lustre_msg_get_opc(req->rq_reqmsg));
+			if (idx >= 0 &&
+			    at_qhist_ready(&at->iat_opc_estimate[idx]))
+				serv_est = min_t(__u32, serv_est,
+					at_get(&at->iat_opc_estimate[idx]));
+		}
                 req->rq_timeout = at_est2timeout(serv_est);
         }
         /* We could get even fancier here, using history to predict increased
@@ -279,6 +293,20 @@ static void ptlrpc_at_adj_service(struct ptlrpc_request *req,
                        oldse, at_get(&at->iat_service_estimate[idx]));
 }
 
+/* Adjust the service time estimate of the opcode of \a req */
+static void ptlrpc_at_adj_opc(struct ptlrpc_request *req,
+			      unsigned int service_time)
+{
+	struct imp_at *at = &req->rq_import->imp_at;
+	int idx;
+
+	idx = import_at_get_opc_index(req->rq_import,
+				      lustre_msg_get_opc(req->rq_reqmsg));
+	if (idx >= 0)
+		/* +1 for rounding, 0's are not measured */
+		at_measured(&at->iat_opc_estimate[idx], service_time + 1);
+}
+
 /* Expected network latency per remote node (secs) */
 int ptlrpc_at_get_net_latency(struct ptlrpc_request *req)
 {
@@ -590,6 +618,8 @@ static int __ptlrpc_request_bufs_pack(struct ptlrpc_request *request,
         request->rq_request_portal = imp->imp_client->cli_request_portal;
         request->rq_reply_portal = imp->imp_client->cli_reply_portal;
 
+	/* the timeout depends on the opcode */
+	lustre_msg_set_opc(request->rq_reqmsg, opcode);
         ptlrpc_at_set_req_timeout(request);
 
 	spin_lock_init(&request->rq_lock);
@@ -605,8 +635,6 @@ static int __ptlrpc_request_bufs_pack(struct ptlrpc_request *request,
         request->rq_xid = ptlrpc_next_xid();
         cfs_atomic_set(&request->rq_refcount, 1);
 
-        lustre_msg_set_opc(request->rq_reqmsg, opcode);
-
         RETURN(0);
 out_ctx:
         sptlrpc_cli_ctx_put(request->rq_cli_ctx, 1);
@@ -1286,6 +1314,7 @@ static int after_reply(struct ptlrpc_request *req)
         ptlrpc_at_adj_service(req, lustre_msg_get_timeout(req->rq_repmsg));
         ptlrpc_at_adj_net_latency(req,
                                   lustre_msg_get_service_time(req->rq_repmsg));
+	ptlrpc_at_adj_opc(req, lustre_msg_get_service_time(req->rq_repmsg));
 
         rc = ptlrpc_check_status(req);
         imp->imp_connect_error = rc;
@@ -2237,6 +2266,31 @@ int ptlrpc_set_wait(struct ptlrpc_request_set *set)
 }
 EXPORT_SYMBOL(ptlrpc_set_wait);
 
+/**
+ * Take \a req off whichever of the replay lists of \a imp it is on, keeping
+ * the list lengths up to date. Caller holds imp_lock.
+ */
+static void ptlrpc_replay_list_del(struct obd_import *imp,
+				   struct ptlrpc_request *req)
+{
+	LASSERT_SPIN_LOCKED(&imp->imp_lock);
+
+	if (cfs_list_empty(&req->rq_replay_list))
+		return;
+
+	cfs_list_del_init(&req->rq_replay_list);
+	if (req->rq_replay_committed) {
+		LASSERT(imp->imp_committed_count > 0);
+		imp->imp_committed_count--;
+		spin_lock(&req->rq_lock);
+		req->rq_replay_committed = 0;
+		spin_unlock(&req->rq_lock);
+	} else {
+		LASSERT(imp->imp_replay_count > 0);
+		imp->imp_replay_count--;
+	}
+}
+
 /**
  * Helper fuction for request freeing.
  * Called when request count reached zero and request needs to be freed.
@@ -2267,7 +2321,7 @@ static void __ptlrpc_free_req(struct ptlrpc_request *request, int locked)
         if (request->rq_import != NULL) {
 		if (!locked)
 			spin_lock(&request->rq_import->imp_lock);
-		cfs_list_del_init(&request->rq_replay_list);
+		ptlrpc_replay_list_del(request->rq_import, request);
 		if (!locked)
 			spin_unlock(&request->rq_import->imp_lock);
         }
@@ -2458,7 +2512,7 @@ static void ptlrpc_free_request(struct ptlrpc_request *req)
 
 	if (req->rq_commit_cb != NULL)
 		req->rq_commit_cb(req);
-	cfs_list_del_init(&req->rq_replay_list);
+	ptlrpc_replay_list_del(req->rq_import, req);
 
 	__ptlrpc_req_finished(req, 1);
 }
@@ -2545,6 +2599,11 @@ void ptlrpc_free_committed(struct obd_import *imp)
 			DEBUG_REQ(D_RPCTRACE, req, "keeping (FL_REPLAY)");
 			cfs_list_move_tail(&req->rq_replay_list,
 					   &imp->imp_committed_list);
+			spin_lock(&req->rq_lock);
+			req->rq_replay_committed = 1;
+			spin_unlock(&req->rq_lock);
+			imp->imp_replay_count--;
+			imp->imp_committed_count++;
 			continue;
 		}
 
@@ -2682,10 +2741,12 @@ void ptlrpc_retain_replayable_request(struct ptlrpc_request *req,
                 }
 
                 cfs_list_add(&req->rq_replay_list, &iter->rq_replay_list);
+		imp->imp_replay_count++;
                 return;
         }
 
         cfs_list_add(&req->rq_replay_list, &imp->imp_replay_list);
+	imp->imp_replay_count++;
 }
 EXPORT_SYMBOL(ptlrpc_retain_replayable_request);
 
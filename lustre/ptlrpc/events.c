@@ -299,7 +299,7 @@ void request_in_callback(lnet_event_t *ev)
                  ev->type == LNET_EVENT_UNLINK);
         LASSERT ((char *)ev->md.start >= rqbd->rqbd_buffer);
         LASSERT ((char *)ev->md.start + ev->offset + ev->mlength <=
-                 rqbd->rqbd_buffer + service->srv_buf_size);
+                 rqbd->rqbd_buffer + rqbd->rqbd_size);
 
         CDEBUG((ev->status == 0) ? D_NET : D_ERROR,
                "event type %d, status %d, service %s\n",
@@ -355,11 +355,24 @@ void request_in_callback(lnet_event_t *ev)
 
 	ptlrpc_req_add_history(svcpt, req);
 
+	/* moving average of request sizes, to size new request buffers */
+	if (req->rq_reqdata_len != 0)
+		svcpt->scp_req_size_avg += (req->rq_reqdata_len -
+					    svcpt->scp_req_size_avg) / 16;
+
 	if (ev->unlinked) {
 		svcpt->scp_nrqbds_posted--;
 		CDEBUG(D_INFO, "Buffer complete: %d buffers still posted\n",
 		       svcpt->scp_nrqbds_posted);
 
+		if (ev->type != LNET_EVENT_UNLINK) {
+			svcpt->scp_rqbd_used_bytes += ev->offset + ev->mlength;
+			svcpt->scp_rqbd_unlinked_bytes += rqbd->rqbd_size;
+			/* ptlrpc_check_rqbd_pool() posts more buffers */
+			if (svcpt->scp_nrqbds_posted == 0)
+				svcpt->scp_rqbd_starved++;
+		}
+
 		/* Normally, don't complain about 0 buffers posted; LNET won't
 		 * drop incoming reqs since we set the portal lazy */
 		if (test_req_buffer_pressure &&
@@ -521,11 +521,10 @@ static int import_select_connection(struct obd_import *imp)
            trying to reconnect on it.) */
         if (tried_all && (imp->imp_conn_list.next == &imp_conn->oic_item)) {
 		struct adaptive_timeout *at = &imp->imp_at.iat_net_latency;
-		if (at_get(at) < CONNECTION_SWITCH_MAX) {
-			at_measured(at, at_get(at) + CONNECTION_SWITCH_INC);
-			if (at_get(at) > CONNECTION_SWITCH_MAX)
-				at_reset(at, CONNECTION_SWITCH_MAX);
-		}
+		if (at_get(at) < CONNECTION_SWITCH_MAX)
+			at_bump(at, min_t(unsigned int,
+					  at_get(at) + CONNECTION_SWITCH_INC,
+					  CONNECTION_SWITCH_MAX));
 		LASSERT(imp_conn->oic_last_attempt);
 		CDEBUG(D_HA, "%s: tried all connections, increasing latency "
 			"to %ds\n", imp->imp_obd->obd_name, at_get(at));
@@ -664,6 +663,7 @@ int ptlrpc_connect_import(struct obd_import *imp)
         /* Reset connect flags to the originally requested flags, in case
          * the server is updated on-the-fly we will get the new features. */
         imp->imp_connect_data.ocd_connect_flags = imp->imp_connect_flags_orig;
+	imp->imp_connect_data.ocd_connect_flags2 = imp->imp_connect_flags2_orig;
 	/* Reset ocd_version each time so the server knows the exact versions */
 	imp->imp_connect_data.ocd_version = LUSTRE_VERSION_CODE;
         imp->imp_msghdr_flags &= ~MSGHDR_AT_SUPPORT;
@@ -1534,10 +1534,48 @@ EXPORT_SYMBOL(ptlrpc_cleanup_imp);
 /* Adaptive Timeout utils */
 extern unsigned int at_min, at_max, at_history;
 
+/* Bucket of \a val in a struct at_qhist, see at_qhist_bucket_max() */
+static int at_qhist_bucket(unsigned int val)
+{
+	int bits = 0;
+
+	if (val < 4)
+		return val;
+	while ((val >> bits) >= 8)
+		bits++;
+	return min(4 + bits * 4 + (int)((val >> bits) & 3), AT_QBUCKETS - 1);
+}
+
+/* Age the values of \a qhist by \a shift bins */
+static void at_qhist_decay(struct at_qhist *qhist, int shift)
+{
+	int i;
+
+	qhist->atq_count = 0;
+	for (i = 0; i < AT_QBUCKETS; i++) {
+		qhist->atq_buckets[i] = shift < 16 ?
+					qhist->atq_buckets[i] >> shift : 0;
+		qhist->atq_count += qhist->atq_buckets[i];
+	}
+}
+
+static void at_qhist_add(struct at_qhist *qhist, unsigned int val)
+{
+	int i = at_qhist_bucket(val);
+
+	if (qhist->atq_buckets[i] > (__u16)~0 - AT_QWEIGHT)
+		at_qhist_decay(qhist, 1);
+	qhist->atq_buckets[i] += AT_QWEIGHT;
+	qhist->atq_count += AT_QWEIGHT;
+}
+
 /* Bin into timeslices using AT_BINS bins.
    This gives us a max of the last binlimit*AT_BINS secs without the storage,
    but still smoothing out a return to normalcy from a slow response.
-   (E.g. remember the maximum latency in each minute of the last 4 minutes.) */
+   (E.g. remember the maximum latency in each minute of the last 4 minutes.)
+   With AT_FLG_QUANTILE, once enough values are known, the at_percentile of
+   their distribution is used instead of the maximum, so that a few slow
+   events do not hold the timeout up for the whole history. */
 int at_measured(struct adaptive_timeout *at, unsigned int val)
 {
         unsigned int old = at->at_current;
@@ -1563,6 +1601,8 @@ int at_measured(struct adaptive_timeout *at, unsigned int val)
                 at->at_worst_time = now;
                 at->at_hist[0] = val;
                 at->at_binstart = now;
+		if (at->at_qhist != NULL)
+			memset(at->at_qhist, 0, sizeof(*at->at_qhist));
         } else if (now - at->at_binstart < binlimit ) {
                 /* in bin 0 */
                 at->at_hist[0] = max(val, at->at_hist[0]);
@@ -1584,12 +1624,24 @@ int at_measured(struct adaptive_timeout *at, unsigned int val)
                 at->at_hist[0] = val;
                 at->at_current = maxv;
                 at->at_binstart += shift * binlimit;
+		if (at->at_qhist != NULL)
+			at_qhist_decay(at->at_qhist, shift);
         }
 
-        if (at->at_current > at->at_worst_ever) {
-                at->at_worst_ever = at->at_current;
-                at->at_worst_time = now;
-        }
+	if (at->at_qhist != NULL) {
+		at_qhist_add(at->at_qhist, val);
+		if (at->at_flags & AT_FLG_QUANTILE &&
+		    at_percentile > 0 && at_percentile < 100 &&
+		    at_qhist_ready(at))
+			at->at_current = at_qhist_percentile(at->at_qhist,
+							     at_percentile);
+	}
+
+	/* the worst value is kept even if the percentile ignores it */
+	if (max(val, at->at_current) > at->at_worst_ever) {
+		at->at_worst_ever = max(val, at->at_current);
+		at->at_worst_time = now;
+	}
 
         if (at->at_flags & AT_FLG_NOHIST)
                 /* Only keep last reported val; keeping the rest of the history
@@ -1614,6 +1666,31 @@ int at_measured(struct adaptive_timeout *at, unsigned int val)
         return old;
 }
 
+/**
+ * Start the history of \a at over from \a val, so that the estimate is at
+ * least \a val for a while whatever the percentile of the values measured
+ * before.
+ */
+void at_bump(struct adaptive_timeout *at, unsigned int val)
+{
+	time_t now = cfs_time_current_sec();
+
+	spin_lock(&at->at_lock);
+	memset(at->at_hist, 0, sizeof(at->at_hist));
+	at->at_hist[0] = val;
+	at->at_binstart = now;
+	at->at_current = val;
+	if (at->at_qhist != NULL) {
+		memset(at->at_qhist, 0, sizeof(*at->at_qhist));
+		at_qhist_add(at->at_qhist, val);
+	}
+	if (val > at->at_worst_ever) {
+		at->at_worst_ever = val;
+		at->at_worst_time = now;
+	}
+	spin_unlock(&at->at_lock);
+}
+
 /* Find the imp_at index for a given portal; assign if space available */
 int import_at_get_index(struct obd_import *imp, int portal)
 {
@@ -1648,3 +1725,33 @@ out:
 	spin_unlock(&imp->imp_lock);
 	return i;
 }
+
+/* Find the imp_at index for a given opcode; assign if space available,
+ * return -1 if all the slots are taken by other opcodes */
+int import_at_get_opc_index(struct obd_import *imp, int opc)
+{
+	struct imp_at *at = &imp->imp_at;
+	int i;
+
+	for (i = 0; i < IMP_AT_MAX_OPCODES; i++) {
+		if (at->iat_opc[i] == opc)
+			return i;
+		if (at->iat_opc[i] == 0)
+			break;
+	}
+	if (i == IMP_AT_MAX_OPCODES)
+		return -1;
+
+	spin_lock(&imp->imp_lock);
+	for (; i < IMP_AT_MAX_OPCODES; i++) {
+		if (at->iat_opc[i] == opc)
+			break;
+		if (at->iat_opc[i] == 0) {
+			at->iat_opc[i] = opc;
+			break;
+		}
+	}
+	spin_unlock(&imp->imp_lock);
+
+	return i < IMP_AT_MAX_OPCODES ? i : -1;
+}
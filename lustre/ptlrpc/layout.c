@@ -128,6 +128,11 @@ static const struct req_msg_field *quota_body_only[] = {
 	&RMF_QUOTA_BODY
 };
 
+static const struct req_msg_field *quota_bodies_only[] = {
+	&RMF_PTLRPC_BODY,
+	&RMF_QUOTA_BODIES
+};
+
 static const struct req_msg_field *ldlm_intent_quota_client[] = {
 	&RMF_PTLRPC_BODY,
 	&RMF_DLM_REQ,
@@ -286,6 +291,22 @@ static const struct req_msg_field *mds_reint_setattr_client[] = {
         &RMF_DLM_REQ
 };
 
+static const struct req_msg_field *mds_reint_batch_client[] = {
+	&RMF_PTLRPC_BODY,
+	&RMF_REC_REINT,
+	&RMF_BATCH_RECS,
+	&RMF_BATCH_NAMES,
+	&RMF_DLM_REQ
+};
+
+static const struct req_msg_field *mds_reint_batch_server[] = {
+	&RMF_PTLRPC_BODY,
+	&RMF_MDT_BODY,
+	&RMF_RCS,
+	&RMF_CAPA1,
+	&RMF_CAPA2
+};
+
 static const struct req_msg_field *mds_reint_setxattr_client[] = {
         &RMF_PTLRPC_BODY,
         &RMF_REC_REINT,
@@ -355,6 +376,11 @@ static const struct req_msg_field *ldlm_enqueue_lvb_server[] = {
         &RMF_DLM_LVB
 };
 
+static const struct req_msg_field *ldlm_bl_callback_batch_server[] = {
+	&RMF_PTLRPC_BODY,
+	&RMF_DLM_REQ
+};
+
 static const struct req_msg_field *ldlm_cp_callback_client[] = {
         &RMF_PTLRPC_BODY,
         &RMF_DLM_REQ,
@@ -687,6 +713,7 @@ static struct req_format *req_formats[] = {
         &RQF_MDS_REINT_RENAME,
         &RQF_MDS_REINT_SETATTR,
         &RQF_MDS_REINT_SETXATTR,
+	&RQF_MDS_REINT_BATCH,
         &RQF_MDS_QUOTACHECK,
         &RQF_MDS_QUOTACTL,
 	&RQF_MDS_HSM_PROGRESS,
@@ -725,6 +752,7 @@ static struct req_format *req_formats[] = {
         &RQF_LDLM_CALLBACK,
         &RQF_LDLM_CP_CALLBACK,
         &RQF_LDLM_BL_CALLBACK,
+	&RQF_LDLM_BL_CALLBACK_BATCH,
         &RQF_LDLM_GL_CALLBACK,
 	&RQF_LDLM_GL_DESC_CALLBACK,
         &RQF_LDLM_INTENT,
@@ -736,6 +764,7 @@ static struct req_format *req_formats[] = {
         &RQF_LDLM_INTENT_UNLINK,
 	&RQF_LDLM_INTENT_QUOTA,
 	&RQF_QUOTA_DQACQ,
+	&RQF_QUOTA_DQACQ_BATCH,
         &RQF_LOG_CANCEL,
         &RQF_LLOG_ORIGIN_HANDLE_CREATE,
         &RQF_LLOG_ORIGIN_HANDLE_DESTROY,
@@ -878,6 +907,11 @@ struct req_msg_field RMF_QUOTA_BODY =
 		    sizeof(struct quota_body), lustre_swab_quota_body, NULL);
 EXPORT_SYMBOL(RMF_QUOTA_BODY);
 
+struct req_msg_field RMF_QUOTA_BODIES =
+	DEFINE_MSGF("quota_bodies", RMF_F_STRUCT_ARRAY,
+		    sizeof(struct quota_body), lustre_swab_quota_body, NULL);
+EXPORT_SYMBOL(RMF_QUOTA_BODIES);
+
 struct req_msg_field RMF_MDT_EPOCH =
         DEFINE_MSGF("mdt_ioepoch", 0,
                     sizeof(struct mdt_ioepoch), lustre_swab_mdt_ioepoch, NULL);
@@ -997,6 +1031,17 @@ struct req_msg_field RMF_REC_REINT =
                     lustre_swab_mdt_rec_reint, NULL);
 EXPORT_SYMBOL(RMF_REC_REINT);
 
+struct req_msg_field RMF_BATCH_RECS =
+	DEFINE_MSGF("batch_recs", RMF_F_STRUCT_ARRAY,
+		    sizeof(struct mdt_rec_reint), lustre_swab_mdt_rec_reint,
+		    NULL);
+EXPORT_SYMBOL(RMF_BATCH_RECS);
+
+/* names of the batched records, packed back to back with their NULs */
+struct req_msg_field RMF_BATCH_NAMES =
+	DEFINE_MSGF("batch_names", 0, -1, NULL, NULL);
+EXPORT_SYMBOL(RMF_BATCH_NAMES);
+
 /* FIXME: this length should be defined as a macro */
 struct req_msg_field RMF_EADATA = DEFINE_MSGF("eadata", 0, -1,
                                                     NULL, NULL);
@@ -1229,6 +1274,11 @@ struct req_format RQF_QUOTA_DQACQ =
 	DEFINE_REQ_FMT0("QUOTA_DQACQ", quota_body_only, quota_body_only);
 EXPORT_SYMBOL(RQF_QUOTA_DQACQ);
 
+struct req_format RQF_QUOTA_DQACQ_BATCH =
+	DEFINE_REQ_FMT0("QUOTA_DQACQ_BATCH", quota_bodies_only,
+			quota_bodies_only);
+EXPORT_SYMBOL(RQF_QUOTA_DQACQ_BATCH);
+
 struct req_format RQF_LDLM_INTENT_QUOTA =
 	DEFINE_REQ_FMT0("LDLM_INTENT_QUOTA",
 			ldlm_intent_quota_client,
@@ -1315,6 +1365,11 @@ struct req_format RQF_MDS_REINT_SETXATTR =
                         mds_reint_setxattr_client, mdt_body_only);
 EXPORT_SYMBOL(RQF_MDS_REINT_SETXATTR);
 
+struct req_format RQF_MDS_REINT_BATCH =
+	DEFINE_REQ_FMT0("MDS_REINT_BATCH",
+			mds_reint_batch_client, mds_reint_batch_server);
+EXPORT_SYMBOL(RQF_MDS_REINT_BATCH);
+
 struct req_format RQF_MDS_CONNECT =
         DEFINE_REQ_FMT0("MDS_CONNECT",
                         obd_connect_client, obd_connect_server);
@@ -1365,6 +1420,12 @@ struct req_format RQF_LDLM_BL_CALLBACK =
         DEFINE_REQ_FMT0("LDLM_BL_CALLBACK", ldlm_enqueue_client, empty);
 EXPORT_SYMBOL(RQF_LDLM_BL_CALLBACK);
 
+/* the reply returns handles of locks the client does not have any more */
+struct req_format RQF_LDLM_BL_CALLBACK_BATCH =
+	DEFINE_REQ_FMT0("LDLM_BL_CALLBACK", ldlm_enqueue_client,
+			ldlm_bl_callback_batch_server);
+EXPORT_SYMBOL(RQF_LDLM_BL_CALLBACK_BATCH);
+
 struct req_format RQF_LDLM_GL_CALLBACK =
         DEFINE_REQ_FMT0("LDLM_GL_CALLBACK", ldlm_enqueue_client,
                         ldlm_gl_callback_server);
@@ -131,6 +131,7 @@ struct ll_rpc_opcode {
         { LLOG_ORIGIN_HANDLE_DESTROY,    "llog_origin_handle_destroy" },
         { QUOTA_DQACQ,      "quota_acquire" },
         { QUOTA_DQREL,      "quota_release" },
+	{ QUOTA_DQACQ_BATCH, "quota_acquire_batch" },
         { SEQ_QUERY,        "seq_query" },
         { SEC_CTX_INIT,     "sec_ctx_init" },
         { SEC_CTX_INIT_CONT,"sec_ctx_init_cont" },
@@ -256,6 +257,36 @@ void ptlrpc_lprocfs_register(struct proc_dir_entry *root, char *dir,
         }
 }
 
+static void
+ptlrpc_lprocfs_register_lat(struct proc_dir_entry *root,
+			    struct lprocfs_lat_stats **stats_ret)
+{
+	struct lprocfs_lat_stats *lat_stats;
+	int			  i;
+	int			  rc;
+
+	LASSERT(*stats_ret == NULL);
+
+	lat_stats = lprocfs_alloc_lat_stats(PTLRPC_LAT_LAST +
+					    LUSTRE_MAX_OPCODES);
+	if (lat_stats == NULL)
+		return;
+
+	lprocfs_lat_counter_init(lat_stats, PTLRPC_LAT_REQWAIT,
+				 "req_waittime", "usec");
+	for (i = 0; i < LUSTRE_MAX_OPCODES; i++) {
+		__u32 opcode = ll_rpc_opcode_table[i].opcode;
+		lprocfs_lat_counter_init(lat_stats, PTLRPC_LAT_LAST + i,
+					 ll_opcode2str(opcode), "usec");
+	}
+
+	rc = lprocfs_register_lat_stats(root, "latency_stats", lat_stats);
+	if (rc < 0)
+		lprocfs_free_lat_stats(&lat_stats);
+	else
+		*stats_ret = lat_stats;
+}
+
 static int
 ptlrpc_lprocfs_read_req_history_len(char *page, char **start, off_t off,
 				    int count, int *eof, void *data)
@@ -294,9 +325,12 @@ ptlrpc_lprocfs_write_req_history_max(struct file *file, const char *buffer,
                                      unsigned long count, void *data)
 {
 	struct ptlrpc_service	   *svc = data;
+	struct ptlrpc_service_part *svcpt;
+	int			    bufsize = 0;
 	int			    bufpages;
 	int			    val;
 	int			    rc;
+	int			    i;
 
 	rc = lprocfs_write_helper(buffer, count, &val);
         if (rc < 0)
@@ -307,8 +341,11 @@ ptlrpc_lprocfs_write_req_history_max(struct file *file, const char *buffer,
 
         /* This sanity check is more of an insanity check; we can still
          * hose a kernel by allowing the request history to grow too
-         * far. */
-        bufpages = (svc->srv_buf_size + CFS_PAGE_SIZE - 1) >> CFS_PAGE_SHIFT;
+         * far. The partitions may have grown their buffers beyond
+	 * srv_buf_size, so take the largest. */
+	ptlrpc_service_for_each_part(svcpt, i, svc)
+		bufsize = max(bufsize, svcpt->scp_rqbd_size);
+	bufpages = (bufsize + CFS_PAGE_SIZE - 1) >> CFS_PAGE_SHIFT;
         if (val > cfs_num_physpages/(2 * bufpages))
                 return -ERANGE;
 
@@ -1045,7 +1082,7 @@ static int ptlrpc_lprocfs_rd_timeouts(char *page, char **start, off_t off,
 		 * NB: for lustre proc read, the read count must be less
 		 * than PAGE_SIZE, please see details in lprocfs_fops_read.
 		 * It's unlikely that we exceed PAGE_SIZE at here because
-		 * it means the service has more than 50 partitions.
+		 * it means the service has more than 35 partitions.
 		 */
 		if (count <= 0) {
 			CWARN("Can't fit AT information of %s in one page, "
@@ -1058,6 +1095,90 @@ static int ptlrpc_lprocfs_rd_timeouts(char *page, char **start, off_t off,
 	return rc;
 }
 
+/*
+ * request buffers of each partition: buffer size and number posted, total
+ * and wanted, average request size, fill ratio of unlinked buffers, # times
+ * no buffer was posted and # requests copied out of a buffer they pinned
+ */
+static int ptlrpc_lprocfs_rd_req_buffers(char *page, char **start, off_t off,
+					 int count, int *eof, void *data)
+{
+	struct ptlrpc_service		*svc = data;
+	struct ptlrpc_service_part	*svcpt;
+	__u64				used;
+	__u64				unlinked;
+	int				rc = 0;
+	int				i;
+
+	*eof = 1;
+	ptlrpc_service_for_each_part(svcpt, i, svc) {
+		spin_lock(&svcpt->scp_lock);
+		used = svcpt->scp_rqbd_used_bytes;
+		unlinked = svcpt->scp_rqbd_unlinked_bytes;
+		/* do_div() only takes a 32-bit divisor */
+		while ((unlinked >> 32) != 0) {
+			used >>= 1;
+			unlinked >>= 1;
+		}
+		used *= 100;
+		if (unlinked != 0)
+			do_div(used, (__u32)unlinked);
+
+		rc += snprintf(page + rc, count - rc,
+			       "cpt %-3d: size %d posted %d total %d target %d "
+			       "req_avg %d util %d%% starved "LPU64
+			       " copied "LPU64"\n", svcpt->scp_cpt,
+			       svcpt->scp_rqbd_size, svcpt->scp_nrqbds_posted,
+			       svcpt->scp_nrqbds_total,
+			       svcpt->scp_nrqbds_target,
+			       svcpt->scp_req_size_avg, (int)used,
+			       svcpt->scp_rqbd_starved,
+			       svcpt->scp_rqbd_copied);
+		spin_unlock(&svcpt->scp_lock);
+		if (rc >= count) {
+			rc = count;
+			break;
+		}
+	}
+	return rc;
+}
+
+/* reply state pool hits, misses and cached reply states per size class */
+static int ptlrpc_lprocfs_rd_reply_pool(char *page, char **start, off_t off,
+					int count, int *eof, void *data)
+{
+	struct ptlrpc_service		*svc = data;
+	struct ptlrpc_service_part	*svcpt;
+	__u64				hits;
+	__u64				misses;
+	int				cached[PTLRPC_RS_POOL_CLASSES];
+	int				rc = 0;
+	int				i;
+	int				j;
+
+	*eof = 1;
+	ptlrpc_service_for_each_part(svcpt, i, svc) {
+		spin_lock(&svcpt->scp_rs_pool_lock);
+		hits   = svcpt->scp_rs_pool_hits;
+		misses = svcpt->scp_rs_pool_misses;
+		memcpy(cached, svcpt->scp_rs_pool_count, sizeof(cached));
+		spin_unlock(&svcpt->scp_rs_pool_lock);
+
+		rc += snprintf(page + rc, count - rc,
+			       "cpt %-3d: hits "LPU64" misses "LPU64" cached",
+			       svcpt->scp_cpt, hits, misses);
+		for (j = 0; j < PTLRPC_RS_POOL_CLASSES && rc < count; j++)
+			rc += snprintf(page + rc, count - rc, " %d", cached[j]);
+		if (rc < count)
+			rc += snprintf(page + rc, count - rc, "\n");
+		if (rc >= count) {
+			rc = count;
+			break;
+		}
+	}
+	return rc;
+}
+
 static int ptlrpc_lprocfs_rd_hp_ratio(char *page, char **start, off_t off,
                                       int count, int *eof, void *data)
 {
@@ -1116,6 +1237,12 @@ void ptlrpc_lprocfs_register_service(struct proc_dir_entry *entry,
                 {.name       = "timeouts",
                  .read_fptr  = ptlrpc_lprocfs_rd_timeouts,
                  .data       = svc},
+		{.name	     = "req_buffers",
+		 .read_fptr  = ptlrpc_lprocfs_rd_req_buffers,
+		 .data	     = svc},
+		{.name	     = "reply_pool",
+		 .read_fptr  = ptlrpc_lprocfs_rd_reply_pool,
+		 .data	     = svc},
                 {.name       = "nrs_policies",
 		 .read_fptr  = ptlrpc_lprocfs_rd_nrs,
 		 .write_fptr = ptlrpc_lprocfs_wr_nrs,
@@ -1141,6 +1268,8 @@ void ptlrpc_lprocfs_register_service(struct proc_dir_entry *entry,
 
         lprocfs_add_vars(svc->srv_procroot, lproc_vars, NULL);
 
+	ptlrpc_lprocfs_register_lat(svc->srv_procroot, &svc->srv_lat_stats);
+
         rc = lprocfs_seq_create(svc->srv_procroot, "req_history",
                                 0400, &req_history_fops, svc);
         if (rc)
@@ -1152,15 +1281,27 @@ void ptlrpc_lprocfs_register_obd(struct obd_device *obddev)
         ptlrpc_lprocfs_register(obddev->obd_proc_entry, NULL, "stats",
                                 &obddev->obd_svc_procroot,
                                 &obddev->obd_svc_stats);
+	if (obddev->obd_svc_stats != NULL)
+		ptlrpc_lprocfs_register_lat(obddev->obd_proc_entry,
+					    &obddev->obd_svc_lat_stats);
 }
 EXPORT_SYMBOL(ptlrpc_lprocfs_register_obd);
 
 void ptlrpc_lprocfs_rpc_sent(struct ptlrpc_request *req, long amount)
 {
+	struct lprocfs_lat_stats *lat_stats;
         struct lprocfs_stats *svc_stats;
         __u32 op = lustre_msg_get_opc(req->rq_reqmsg);
         int opc = opcode_offset(op);
 
+	lat_stats = req->rq_import->imp_obd->obd_svc_lat_stats;
+	if (lat_stats != NULL) {
+		lprocfs_lat_counter_add(lat_stats, PTLRPC_LAT_REQWAIT, amount);
+		if (opc >= 0)
+			lprocfs_lat_counter_add(lat_stats,
+						PTLRPC_LAT_LAST + opc, amount);
+	}
+
         svc_stats = req->rq_import->imp_obd->obd_svc_stats;
         if (svc_stats == NULL || opc <= 0)
                 return;
@@ -1204,6 +1345,9 @@ void ptlrpc_lprocfs_unregister_service(struct ptlrpc_service *svc)
 
         if (svc->srv_stats)
                 lprocfs_free_stats(&svc->srv_stats);
+
+	if (svc->srv_lat_stats != NULL)
+		lprocfs_free_lat_stats(&svc->srv_lat_stats);
 }
 
 void ptlrpc_lprocfs_unregister_obd(struct obd_device *obd)
@@ -1213,6 +1357,13 @@ void ptlrpc_lprocfs_unregister_obd(struct obd_device *obd)
 
         if (obd->obd_svc_stats)
                 lprocfs_free_stats(&obd->obd_svc_stats);
+
+	if (obd->obd_svc_lat_stats != NULL) {
+		if (obd->obd_proc_entry != NULL)
+			lprocfs_remove_proc_entry("latency_stats",
+						  obd->obd_proc_entry);
+		lprocfs_free_lat_stats(&obd->obd_svc_lat_stats);
+	}
 }
 EXPORT_SYMBOL(ptlrpc_lprocfs_unregister_obd);
 
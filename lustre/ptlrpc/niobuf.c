@@ -888,7 +888,7 @@ int ptlrpc_register_rqbd(struct ptlrpc_request_buffer_desc *rqbd)
         rqbd->rqbd_refcount = 1;
 
         md.start     = rqbd->rqbd_buffer;
-        md.length    = service->srv_buf_size;
+	md.length    = rqbd->rqbd_size;
         md.max_size  = service->srv_max_req_size;
         md.threshold = LNET_MD_THRESH_INF;
         md.options   = PTLRPC_MD_OPTIONS | LNET_MD_OP_PUT | LNET_MD_MAX_SIZE;
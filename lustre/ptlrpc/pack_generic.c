@@ -327,6 +327,114 @@ void lustre_put_emerg_rs(struct ptlrpc_reply_state *rs)
 	cfs_waitq_signal(&svcpt->scp_rep_waitq);
 }
 
+/* Size class of a reply state of \a size bytes, -1 if too large */
+static int ptlrpc_rs_pool_class(int size)
+{
+	int i;
+
+	for (i = 0; i < PTLRPC_RS_POOL_CLASSES; i++) {
+		if (size <= 1 << (PTLRPC_RS_POOL_MIN_SHIFT + i))
+			return i;
+	}
+	return -1;
+}
+
+/**
+ * Get a reply state of at least \a size bytes from the pool of \a svcpt,
+ * zeroed up to \a size. If the pool is empty, a reply state as large as the
+ * size class of \a size is allocated, so that it can be reused by any reply
+ * of that class once freed.
+ *
+ * \retval NULL if \a size is beyond the largest class or out of memory
+ */
+struct ptlrpc_reply_state *
+ptlrpc_rs_pool_get(struct ptlrpc_service_part *svcpt, int size)
+{
+	struct ptlrpc_reply_state *rs = NULL;
+	int			   class = ptlrpc_rs_pool_class(size);
+
+	if (class < 0)
+		return NULL;
+
+	spin_lock(&svcpt->scp_rs_pool_lock);
+	if (!cfs_list_empty(&svcpt->scp_rs_pool[class])) {
+		rs = cfs_list_entry(svcpt->scp_rs_pool[class].next,
+				    struct ptlrpc_reply_state, rs_list);
+		cfs_list_del(&rs->rs_list);
+		svcpt->scp_rs_pool_count[class]--;
+		svcpt->scp_rs_pool_hits++;
+	} else {
+		svcpt->scp_rs_pool_misses++;
+	}
+	spin_unlock(&svcpt->scp_rs_pool_lock);
+
+	if (rs != NULL) {
+		memset(rs, 0, size);
+	} else {
+		OBD_CPT_ALLOC_LARGE(rs, svcpt->scp_service->srv_cptable,
+				    svcpt->scp_cpt,
+				    1 << (PTLRPC_RS_POOL_MIN_SHIFT + class));
+		if (rs == NULL)
+			return NULL;
+	}
+
+	rs->rs_size = 1 << (PTLRPC_RS_POOL_MIN_SHIFT + class);
+	rs->rs_svcpt = svcpt;
+	rs->rs_pooled = 1;
+	return rs;
+}
+
+/* Give \a rs back to the pool of its service partition, or free it */
+void ptlrpc_rs_pool_put(struct ptlrpc_reply_state *rs)
+{
+	struct ptlrpc_service_part *svcpt = rs->rs_svcpt;
+	int			    class = ptlrpc_rs_pool_class(rs->rs_size);
+
+	LASSERT(rs->rs_pooled);
+	LASSERT(class >= 0);
+
+	spin_lock(&svcpt->scp_rs_pool_lock);
+	if (svcpt->scp_rs_pool_count[class] <
+	    PTLRPC_RS_POOL_BYTES >> (PTLRPC_RS_POOL_MIN_SHIFT + class)) {
+		cfs_list_add(&rs->rs_list, &svcpt->scp_rs_pool[class]);
+		svcpt->scp_rs_pool_count[class]++;
+		rs = NULL;
+	}
+	spin_unlock(&svcpt->scp_rs_pool_lock);
+
+	if (rs != NULL)
+		OBD_FREE_LARGE(rs, rs->rs_size);
+}
+
+void ptlrpc_rs_pool_init(struct ptlrpc_service_part *svcpt)
+{
+	int i;
+
+	spin_lock_init(&svcpt->scp_rs_pool_lock);
+	for (i = 0; i < PTLRPC_RS_POOL_CLASSES; i++) {
+		CFS_INIT_LIST_HEAD(&svcpt->scp_rs_pool[i]);
+		svcpt->scp_rs_pool_count[i] = 0;
+	}
+}
+
+/* Free the reply states cached by \a svcpt, all the replies are gone */
+void ptlrpc_rs_pool_fini(struct ptlrpc_service_part *svcpt)
+{
+	struct ptlrpc_reply_state *rs;
+	int			   i;
+
+	for (i = 0; i < PTLRPC_RS_POOL_CLASSES; i++) {
+		while (!cfs_list_empty(&svcpt->scp_rs_pool[i])) {
+			rs = cfs_list_entry(svcpt->scp_rs_pool[i].next,
+					    struct ptlrpc_reply_state,
+					    rs_list);
+			cfs_list_del(&rs->rs_list);
+			OBD_FREE_LARGE(rs, rs->rs_size);
+		}
+		svcpt->scp_rs_pool_count[i] = 0;
+	}
+}
+
 int lustre_pack_reply_v2(struct ptlrpc_request *req, int count,
                          __u32 *lens, char **bufs, int flags)
 {
@@ -1709,7 +1817,8 @@ void lustre_swab_connect(struct obd_connect_data *ocd)
                 __swab32s(&ocd->ocd_max_easize);
         if (ocd->ocd_connect_flags & OBD_CONNECT_MAXBYTES)
                 __swab64s(&ocd->ocd_maxbytes);
-        CLASSERT(offsetof(typeof(*ocd), padding1) != 0);
+	if (ocd->ocd_connect_flags & OBD_CONNECT_FLAGS2)
+		__swab64s(&ocd->ocd_connect_flags2);
         CLASSERT(offsetof(typeof(*ocd), padding2) != 0);
         CLASSERT(offsetof(typeof(*ocd), padding3) != 0);
         CLASSERT(offsetof(typeof(*ocd), padding4) != 0);
@@ -2294,6 +2403,7 @@ void lustre_swab_quota_body(struct quota_body *b)
 	lustre_swab_lu_fid(&b->qb_fid);
 	lustre_swab_lu_fid((struct lu_fid *)&b->qb_id);
 	__swab32s(&b->qb_flags);
+	__swab32s(&b->qb_rc);
 	__swab64s(&b->qb_count);
 	__swab64s(&b->qb_usage);
 	__swab64s(&b->qb_slv_ver);
@@ -239,6 +239,11 @@ void ptlrpc_add_bulk_page(struct ptlrpc_bulk_desc *desc, cfs_page_t *page,
 struct ptlrpc_reply_state *
 lustre_get_emerg_rs(struct ptlrpc_service_part *svcpt);
 void lustre_put_emerg_rs(struct ptlrpc_reply_state *rs);
+struct ptlrpc_reply_state *
+ptlrpc_rs_pool_get(struct ptlrpc_service_part *svcpt, int size);
+void ptlrpc_rs_pool_put(struct ptlrpc_reply_state *rs);
+void ptlrpc_rs_pool_init(struct ptlrpc_service_part *svcpt);
+void ptlrpc_rs_pool_fini(struct ptlrpc_service_part *svcpt);
 
 /* pinger.c */
 int ptlrpc_start_pinger(void);
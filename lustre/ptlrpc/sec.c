@@ -2105,7 +2105,21 @@ int sptlrpc_svc_alloc_rs(struct ptlrpc_request *req, int msglen)
         policy = req->rq_svc_ctx->sc_policy;
         LASSERT(policy->sp_sops->alloc_rs);
 
+	/* the null flavor needs no more than the message and the state, so
+	 * a reply state of that size can be recycled by the service */
+	if (policy->sp_policy == SPTLRPC_POLICY_NULL &&
+	    req->rq_reply_state == NULL) {
+		rs = ptlrpc_rs_pool_get(req->rq_rqbd->rqbd_svcpt,
+					sizeof(*rs) + msglen);
+		req->rq_reply_state = rs;
+	}
+
         rc = policy->sp_sops->alloc_rs(req, msglen);
+        if (unlikely(rc != 0 && req->rq_reply_state != NULL &&
+		     req->rq_reply_state->rs_pooled)) {
+		ptlrpc_rs_pool_put(req->rq_reply_state);
+		req->rq_reply_state = NULL;
+	}
         if (unlikely(rc == -ENOMEM)) {
                 /* failed alloc, try emergency pool */
 		rs = lustre_get_emerg_rs(req->rq_rqbd->rqbd_svcpt);
@@ -2157,6 +2171,7 @@ void sptlrpc_svc_free_rs(struct ptlrpc_reply_state *rs)
 {
         struct ptlrpc_sec_policy *policy;
         unsigned int prealloc;
+	unsigned int pooled;
         ENTRY;
 
         LASSERT(rs->rs_svc_ctx);
@@ -2166,10 +2181,13 @@ void sptlrpc_svc_free_rs(struct ptlrpc_reply_state *rs)
         LASSERT(policy->sp_sops->free_rs);
 
         prealloc = rs->rs_prealloc;
+	pooled = rs->rs_pooled;
         policy->sp_sops->free_rs(rs);
 
         if (prealloc)
                 lustre_put_emerg_rs(rs);
+	else if (pooled)
+		ptlrpc_rs_pool_put(rs);
         EXIT;
 }
 
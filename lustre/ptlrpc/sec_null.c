@@ -341,7 +341,7 @@ void null_free_rs(struct ptlrpc_reply_state *rs)
         LASSERT_ATOMIC_GT(&rs->rs_svc_ctx->sc_refcount, 1);
         cfs_atomic_dec(&rs->rs_svc_ctx->sc_refcount);
 
-        if (!rs->rs_prealloc)
+	if (!rs->rs_prealloc && !rs->rs_pooled)
                 OBD_FREE_LARGE(rs, rs->rs_size);
 }
 
@@ -60,6 +60,9 @@ CFS_MODULE_PARM(at_early_margin, "i", int, 0644,
                 "How soon before an RPC deadline to send an early reply");
 CFS_MODULE_PARM(at_extra, "i", int, 0644,
                 "How much extra time to give with each early reply");
+CFS_MODULE_PARM(at_percentile, "i", int, 0644,
+		"Percentile of the measured times some adaptive timeouts are "
+		"based on, instead of the slowest one (0 to disable)");
 
 
 /* forward ref */
@@ -67,6 +70,22 @@ static int ptlrpc_server_post_idle_rqbds(struct ptlrpc_service_part *svcpt);
 static void ptlrpc_server_hpreq_fini(struct ptlrpc_request *req);
 static void ptlrpc_at_remove_timed(struct ptlrpc_request *req);
 
+/**
+ * Request buffers of a partition are kept posted up to scp_nrqbds_target,
+ * which is doubled up to RQBD_TARGET_MAX_FACTOR times srv_nbuf_per_group
+ * whenever requests arrived with no buffer posted, and shrinks back by a
+ * quarter each RQBD_ADJUST_INTERVAL seconds without that happening.
+ */
+#define RQBD_TARGET_MAX_FACTOR	4
+#define RQBD_ADJUST_INTERVAL	60
+/**
+ * New request buffers are made up to 1 << RQBD_SIZE_SHIFT_MAX times larger
+ * than srv_buf_size, so that RQBD_NREQS_MIN requests of the average size
+ * fit in one before it is unlinked for not having srv_max_req_size left.
+ */
+#define RQBD_SIZE_SHIFT_MAX	2
+#define RQBD_NREQS_MIN		32
+
 /** Holds a list of all PTLRPC services */
 CFS_LIST_HEAD(ptlrpc_all_services);
 /** Used to protect the \e ptlrpc_all_services list */
@@ -87,8 +106,9 @@ ptlrpc_alloc_rqbd(struct ptlrpc_service_part *svcpt)
 	rqbd->rqbd_cbid.cbid_fn = request_in_callback;
 	rqbd->rqbd_cbid.cbid_arg = rqbd;
 	CFS_INIT_LIST_HEAD(&rqbd->rqbd_reqs);
+	rqbd->rqbd_size = svcpt->scp_rqbd_size;
 	OBD_CPT_ALLOC_LARGE(rqbd->rqbd_buffer, svc->srv_cptable,
-			    svcpt->scp_cpt, svc->srv_buf_size);
+			    svcpt->scp_cpt, rqbd->rqbd_size);
 	if (rqbd->rqbd_buffer == NULL) {
 		OBD_FREE_PTR(rqbd);
 		return NULL;
@@ -115,10 +135,34 @@ ptlrpc_free_rqbd(struct ptlrpc_request_buffer_desc *rqbd)
 	svcpt->scp_nrqbds_total--;
 	spin_unlock(&svcpt->scp_lock);
 
-	OBD_FREE_LARGE(rqbd->rqbd_buffer, svcpt->scp_service->srv_buf_size);
+	OBD_FREE_LARGE(rqbd->rqbd_buffer, rqbd->rqbd_size);
 	OBD_FREE_PTR(rqbd);
 }
 
+/**
+ * Pick the size of new request buffers of \a svcpt, the smallest multiple
+ * of srv_buf_size by a power of two which fits RQBD_NREQS_MIN requests of
+ * the average size seen so far before it has to be unlinked.
+ */
+static void
+ptlrpc_rqbd_size_update(struct ptlrpc_service_part *svcpt)
+{
+	struct ptlrpc_service	*svc = svcpt->scp_service;
+	int			avg = svcpt->scp_req_size_avg;
+	int			size = svc->srv_buf_size;
+	int			i;
+
+	if (avg == 0 || test_req_buffer_pressure)
+		return;
+
+	for (i = 0; i < RQBD_SIZE_SHIFT_MAX; i++) {
+		if (size - svc->srv_max_req_size >= RQBD_NREQS_MIN * avg)
+			break;
+		size <<= 1;
+	}
+	svcpt->scp_rqbd_size = size;
+}
+
 int
 ptlrpc_grow_req_bufs(struct ptlrpc_service_part *svcpt, int post)
 {
@@ -142,11 +186,12 @@ ptlrpc_grow_req_bufs(struct ptlrpc_service_part *svcpt, int post)
 	svcpt->scp_rqbd_allocating++;
 	spin_unlock(&svcpt->scp_lock);
 
+	ptlrpc_rqbd_size_update(svcpt);
 
-        for (i = 0; i < svc->srv_nbuf_per_group; i++) {
+	for (i = 0; i < svcpt->scp_nrqbds_target; i++) {
                 /* NB: another thread might have recycled enough rqbds, we
 		 * need to make sure it wouldn't over-allocate, see LU-1212. */
-		if (svcpt->scp_nrqbds_posted >= svc->srv_nbuf_per_group)
+		if (svcpt->scp_nrqbds_posted >= svcpt->scp_nrqbds_target)
 			break;
 
 		rqbd = ptlrpc_alloc_rqbd(svcpt);
@@ -168,7 +213,7 @@ ptlrpc_grow_req_bufs(struct ptlrpc_service_part *svcpt, int post)
 
 	CDEBUG(D_RPCTRACE,
 	       "%s: allocate %d new %d-byte reqbufs (%d/%d left), rc = %d\n",
-	       svc->srv_name, i, svc->srv_buf_size, svcpt->scp_nrqbds_posted,
+	       svc->srv_name, i, svcpt->scp_rqbd_size, svcpt->scp_nrqbds_posted,
 	       svcpt->scp_nrqbds_total, rc);
 
  try_post:
@@ -469,6 +514,21 @@ ptlrpc_server_post_idle_rqbds(struct ptlrpc_service_part *svcpt)
 				      rqbd_list);
 		cfs_list_del(&rqbd->rqbd_list);
 
+		/* enough buffers are posted already and this one is either of
+		 * an outdated size or more than the target asks for, free it
+		 * instead of keeping it around */
+		if (svcpt->scp_nrqbds_posted >= svcpt->scp_nrqbds_target / 2 &&
+		    (rqbd->rqbd_size != svcpt->scp_rqbd_size ||
+		     svcpt->scp_nrqbds_total > 2 * svcpt->scp_nrqbds_target +
+		     svcpt->scp_service->srv_hist_nrqbds_cpt_max)) {
+			svcpt->scp_nrqbds_total--;
+			spin_unlock(&svcpt->scp_lock);
+
+			OBD_FREE_LARGE(rqbd->rqbd_buffer, rqbd->rqbd_size);
+			OBD_FREE_PTR(rqbd);
+			continue;
+		}
+
 		/* assume we will post successfully */
 		svcpt->scp_nrqbds_posted++;
 		cfs_list_add(&rqbd->rqbd_list, &svcpt->scp_rqbd_posted);
@@ -631,6 +691,9 @@ ptlrpc_service_part_init(struct ptlrpc_service *svc,
 	CFS_INIT_LIST_HEAD(&svcpt->scp_rqbd_idle);
 	CFS_INIT_LIST_HEAD(&svcpt->scp_rqbd_posted);
 	CFS_INIT_LIST_HEAD(&svcpt->scp_req_incoming);
+	svcpt->scp_nrqbds_target = svc->srv_nbuf_per_group;
+	svcpt->scp_rqbd_size = svc->srv_buf_size;
+	svcpt->scp_rqbd_adjust_time = cfs_time_current_sec();
 	cfs_waitq_init(&svcpt->scp_waitq);
 	/* history request & rqbd list */
 	CFS_INIT_LIST_HEAD(&svcpt->scp_hist_reqs);
@@ -648,6 +711,7 @@ ptlrpc_service_part_init(struct ptlrpc_service *svc,
 	CFS_INIT_LIST_HEAD(&svcpt->scp_rep_idle);
 	cfs_waitq_init(&svcpt->scp_rep_waitq);
 	cfs_atomic_set(&svcpt->scp_nreps_difficult, 0);
+	ptlrpc_rs_pool_init(svcpt);
 
 	/* adaptive timeout */
 	spin_lock_init(&svcpt->scp_at_lock);
@@ -674,8 +738,10 @@ ptlrpc_service_part_init(struct ptlrpc_service *svc,
 
 	cfs_timer_init(&svcpt->scp_at_timer, ptlrpc_at_timer, svcpt);
 	/* At SOW, service time should be quick; 10s seems generous. If client
-	 * timeout is less than this, we'll be sending an early reply. */
-	at_init(&svcpt->scp_at_estimate, 10, 0);
+	 * timeout is less than this, we'll be sending an early reply.
+	 * Early replies rely on the estimate growing with the slowest
+	 * requests, so its distribution is only reported, not used. */
+	at_init_qhist(&svcpt->scp_at_estimate, 10, 0, &svcpt->scp_at_qhist);
 
 	/* assign this before call ptlrpc_grow_req_bufs */
 	svcpt->scp_service = svc;
@@ -955,6 +1021,16 @@ void ptlrpc_server_drop_request(struct ptlrpc_request *req)
                                 ptlrpc_server_free_request(req);
                         }
 
+			/* the buffer only held a copied request */
+			if (rqbd->rqbd_copy) {
+				OBD_FREE_LARGE(rqbd->rqbd_buffer,
+					       rqbd->rqbd_size);
+				OBD_FREE_PTR(rqbd);
+				spin_lock(&svcpt->scp_lock);
+				svcpt->scp_nrqbds_total--;
+				continue;
+			}
+
 			spin_lock(&svcpt->scp_lock);
 			/*
 			 * now all reqs including the embedded req has been
@@ -1825,6 +1901,141 @@ got_request:
 	RETURN(req);
 }
 
+/**
+ * Account the queue wait \a queued and the handling time \a handled (both
+ * in usecs) of \a req to the job stats of its target, if any.
+ */
+static void ptlrpc_server_job_stats(struct ptlrpc_request *req, long queued,
+				    long handled)
+{
+	struct obd_export *exp = req->rq_export;
+	struct obd_device *obd;
+	long		   lat[JOBSTATS_LAT_LAST];
+
+	if (exp == NULL || req->rq_reqmsg == NULL ||
+	    !(exp_connect_flags(exp) & OBD_CONNECT_JOBSTATS))
+		return;
+
+	/* only MDT/OST targets keep job stats, the obd union means nothing
+	 * for other devices */
+	obd = exp->exp_obd;
+	if (obd == NULL || obd->obd_type == NULL ||
+	    (strcmp(obd->obd_type->typ_name, LUSTRE_MDT_NAME) != 0 &&
+	     strcmp(obd->obd_type->typ_name, LUSTRE_OST_NAME) != 0))
+		return;
+
+	if (obd->u.obt.obt_magic != OBT_MAGIC ||
+	    obd->u.obt.obt_jobstats.ojs_hash == NULL)
+		return;
+
+	lat[JOBSTATS_LAT_QUEUE] = queued;
+	lat[JOBSTATS_LAT_HANDLE] = max(handled - req->rq_bulk_usec, 0L);
+	lat[JOBSTATS_LAT_BULK] = req->rq_bulk_usec > 0 ? req->rq_bulk_usec : -1;
+
+	lprocfs_job_stats_lat(obd, lustre_msg_get_jobid(req->rq_reqmsg), lat);
+}
+
+/**
+ * A request buffer is only reposted once all the requests received in it
+ * have been released, so a single slow request can keep a large buffer out
+ * of use.  If \a req is about to be handled and it is the only request left
+ * in its buffer, which is no longer posted, copy the request out and give
+ * the buffer to a new descriptor to be reposted; the old descriptor stays
+ * with \a req and is freed once \a req is released.
+ *
+ * Only requests of the null flavor are copied, as their message is the
+ * received buffer itself, and not those on the export's high priority list,
+ * whose messages may be looked at by other threads.
+ */
+static void
+ptlrpc_server_copy_straggler(struct ptlrpc_service_part *svcpt,
+			     struct ptlrpc_request *req)
+{
+	struct ptlrpc_service		  *svc = svcpt->scp_service;
+	struct ptlrpc_request_buffer_desc *rqbd = req->rq_rqbd;
+	struct ptlrpc_request_buffer_desc *nrqbd;
+	struct ptlrpc_request		  *tmp;
+	CFS_LIST_HEAD			  (culled);
+	char				  *buf;
+	int				  len = req->rq_reqdata_len;
+
+	/* NB I'm not locking; just looking, checked again below */
+	if (rqbd->rqbd_refcount != 1 || rqbd->rqbd_copy ||
+	    len == 0 || len > rqbd->rqbd_size / 4 || req->rq_ops != NULL ||
+	    req->rq_svc_ctx == NULL ||
+	    req->rq_svc_ctx->sc_policy->sp_policy != SPTLRPC_POLICY_NULL ||
+	    (char *)req->rq_reqmsg != (char *)req->rq_reqbuf)
+		return;
+
+	OBD_CPT_ALLOC_PTR(nrqbd, svc->srv_cptable, svcpt->scp_cpt);
+	if (nrqbd == NULL)
+		return;
+
+	OBD_CPT_ALLOC_LARGE(buf, svc->srv_cptable, svcpt->scp_cpt, len);
+	if (buf == NULL) {
+		OBD_FREE_PTR(nrqbd);
+		return;
+	}
+	memcpy(buf, req->rq_reqbuf, len);
+
+	spin_lock(&svcpt->scp_lock);
+	/* req holds a reference on rqbd, and no more requests can arrive in
+	 * it once it was unlinked, so nobody else uses rqbd */
+	if (rqbd->rqbd_refcount != 1)
+		goto out_unlock;
+
+	/* nobody else may look at the message while it is swapped, early
+	 * replies take a reference on req under scp_at_lock */
+	spin_lock(&svcpt->scp_at_lock);
+	if (cfs_atomic_read(&req->rq_refcount) != 1) {
+		spin_unlock(&svcpt->scp_at_lock);
+		goto out_unlock;
+	}
+	req->rq_reqbuf = (struct lustre_msg *)buf;
+	req->rq_reqmsg = req->rq_reqbuf;
+	spin_unlock(&svcpt->scp_at_lock);
+
+	/* requests released already are in the history and still point to
+	 * the buffer, cull them now */
+	cfs_list_for_each_entry(tmp, &rqbd->rqbd_reqs, rq_list) {
+		if (tmp->rq_history_seq > svcpt->scp_hist_seq_culled)
+			svcpt->scp_hist_seq_culled = tmp->rq_history_seq;
+		cfs_list_del(&tmp->rq_history_list);
+	}
+	cfs_list_splice_init(&rqbd->rqbd_reqs, &culled);
+
+	nrqbd->rqbd_svcpt = svcpt;
+	nrqbd->rqbd_refcount = 0;
+	nrqbd->rqbd_cbid.cbid_fn = request_in_callback;
+	nrqbd->rqbd_cbid.cbid_arg = nrqbd;
+	CFS_INIT_LIST_HEAD(&nrqbd->rqbd_reqs);
+	nrqbd->rqbd_buffer = rqbd->rqbd_buffer;
+	nrqbd->rqbd_size = rqbd->rqbd_size;
+	cfs_list_add_tail(&nrqbd->rqbd_list, &svcpt->scp_rqbd_idle);
+	svcpt->scp_nrqbds_total++;
+
+	rqbd->rqbd_buffer = buf;
+	rqbd->rqbd_size = len;
+	rqbd->rqbd_copy = 1;
+	svcpt->scp_rqbd_copied++;
+	spin_unlock(&svcpt->scp_lock);
+
+	DEBUG_REQ(D_RPCTRACE, req, "copied out of its request buffer");
+
+	while (!cfs_list_empty(&culled)) {
+		tmp = cfs_list_entry(culled.next, struct ptlrpc_request,
+				     rq_list);
+		cfs_list_del(&tmp->rq_list);
+		ptlrpc_server_free_request(tmp);
+	}
+	return;
+
+out_unlock:
+	spin_unlock(&svcpt->scp_lock);
+	OBD_FREE_LARGE(buf, len);
+	OBD_FREE_PTR(nrqbd);
+}
+
 /**
  * Handle freshly incoming reqs, add to timed early reply list,
  * pass on to regular request queue.
@@ -1984,6 +2195,7 @@ ptlrpc_server_handle_request(struct ptlrpc_service_part *svcpt,
         struct timeval         work_start;
         struct timeval         work_end;
         long                   timediff;
+	long		       queued;
         int                    rc;
         int                    fail_opc = 0;
         ENTRY;
@@ -1992,6 +2204,8 @@ ptlrpc_server_handle_request(struct ptlrpc_service_part *svcpt,
 	if (request == NULL)
 		RETURN(0);
 
+	ptlrpc_server_copy_straggler(svcpt, request);
+
         if (OBD_FAIL_CHECK(OBD_FAIL_PTLRPC_HPREQ_NOTIMEOUT))
                 fail_opc = OBD_FAIL_PTLRPC_HPREQ_NOTIMEOUT;
         else if (OBD_FAIL_CHECK(OBD_FAIL_PTLRPC_HPREQ_TIMEOUT))
@@ -2009,6 +2223,7 @@ ptlrpc_server_handle_request(struct ptlrpc_service_part *svcpt,
 
         cfs_gettimeofday(&work_start);
         timediff = cfs_timeval_sub(&work_start, &request->rq_arrival_time,NULL);
+	queued = timediff;
         if (likely(svc->srv_stats != NULL)) {
                 lprocfs_counter_add(svc->srv_stats, PTLRPC_REQWAIT_CNTR,
                                     timediff);
@@ -2019,6 +2234,8 @@ ptlrpc_server_handle_request(struct ptlrpc_service_part *svcpt,
 		lprocfs_counter_add(svc->srv_stats, PTLRPC_TIMEOUT,
 				    at_get(&svcpt->scp_at_estimate));
         }
+	lprocfs_lat_counter_add(svc->srv_lat_stats, PTLRPC_LAT_REQWAIT,
+				timediff);
 
 	rc = lu_context_init(&request->rq_session, LCT_SERVER_SESSION |
 						   LCT_NOREF);
@@ -2117,7 +2334,12 @@ put_conn:
                                             opc + EXTRA_MAX_OPCODES,
                                             timediff);
                 }
+		if (opc >= 0)
+			lprocfs_lat_counter_add(svc->srv_lat_stats,
+						PTLRPC_LAT_LAST + opc,
+						timediff);
         }
+	ptlrpc_server_job_stats(request, queued, timediff);
         if (unlikely(request->rq_early_count)) {
                 DEBUG_REQ(D_ADAPTTO, request,
                           "sent %d early replies before finishing in "
@@ -2152,10 +2374,15 @@ ptlrpc_handle_rs(struct ptlrpc_reply_state *rs)
         LASSERT (rs->rs_scheduled);
         LASSERT (cfs_list_empty(&rs->rs_list));
 
-	spin_lock(&exp->exp_lock);
-	/* Noop if removed already */
-	cfs_list_del_init (&rs->rs_exp_list);
-	spin_unlock(&exp->exp_lock);
+	/* Replies are never put back on exp_outstanding_replies, so if the
+	 * reply handling thread already unlinked this one along with other
+	 * replies of the export, there is no need for exp_lock */
+	if (!cfs_list_empty(&rs->rs_exp_list)) {
+		spin_lock(&exp->exp_lock);
+		/* Noop if removed already */
+		cfs_list_del_init(&rs->rs_exp_list);
+		spin_unlock(&exp->exp_lock);
+	}
 
         /* The disk commit callback holds exp_uncommitted_replies_lock while it
          * iterates over newly committed replies, removing them from
@@ -2314,12 +2541,45 @@ liblustre_check_services (void *arg)
 
 #else /* __KERNEL__ */
 
+/**
+ * Grow the number of request buffers \a svcpt keeps posted if requests had
+ * to wait for a buffer since last time, shrink it slowly otherwise.
+ */
+static void
+ptlrpc_rqbd_adjust_target(struct ptlrpc_service_part *svcpt)
+{
+	int	nbufs = svcpt->scp_service->srv_nbuf_per_group;
+	time_t	now = cfs_time_current_sec();
+
+	if (test_req_buffer_pressure)
+		return;
+
+	/* scp_rqbd_starved is updated by request_in_callback() */
+	spin_lock(&svcpt->scp_lock);
+	if (svcpt->scp_rqbd_starved != svcpt->scp_rqbd_starved_seen) {
+		svcpt->scp_rqbd_starved_seen = svcpt->scp_rqbd_starved;
+		svcpt->scp_nrqbds_target = min(2 * svcpt->scp_nrqbds_target,
+					       RQBD_TARGET_MAX_FACTOR * nbufs);
+		svcpt->scp_rqbd_adjust_time = now;
+	} else if (svcpt->scp_nrqbds_target > nbufs &&
+		   now > svcpt->scp_rqbd_adjust_time + RQBD_ADJUST_INTERVAL) {
+		svcpt->scp_nrqbds_target = max(svcpt->scp_nrqbds_target -
+					       svcpt->scp_nrqbds_target / 4,
+					       nbufs);
+		svcpt->scp_rqbd_adjust_time = now;
+	}
+	spin_unlock(&svcpt->scp_lock);
+}
+
 static void
 ptlrpc_check_rqbd_pool(struct ptlrpc_service_part *svcpt)
 {
 	int avail = svcpt->scp_nrqbds_posted;
-	int low_water = test_req_buffer_pressure ? 0 :
-			svcpt->scp_service->srv_nbuf_per_group / 2;
+	int low_water;
+
+	ptlrpc_rqbd_adjust_target(svcpt);
+	low_water = test_req_buffer_pressure ? 0 :
+		    svcpt->scp_nrqbds_target / 2;
 
         /* NB I'm not locking; just looking. */
 
@@ -2640,6 +2900,35 @@ static int hrt_dont_sleep(struct ptlrpc_hr_thread *hrt,
 	return result;
 }
 
+/** Maximum number of replies of one export released under one exp_lock */
+#define PTLRPC_HR_BATCH	32
+
+/**
+ * Unlink a run of up to PTLRPC_HR_BATCH replies of the same export from the
+ * tail of \a replies from the export under a single exp_lock, so that
+ * committed replies of a busy client do not bounce exp_lock for each of them.
+ */
+static void ptlrpc_hr_unlink_batch(cfs_list_t *replies)
+{
+	struct ptlrpc_reply_state *rs;
+	struct obd_export	  *exp;
+	cfs_list_t		  *pos;
+	int			   n = 0;
+
+	rs = cfs_list_entry(replies->prev, struct ptlrpc_reply_state, rs_list);
+	exp = rs->rs_export;
+
+	spin_lock(&exp->exp_lock);
+	for (pos = replies->prev; pos != replies && n < PTLRPC_HR_BATCH;
+	     pos = pos->prev, n++) {
+		rs = cfs_list_entry(pos, struct ptlrpc_reply_state, rs_list);
+		if (rs->rs_export != exp)
+			break;
+		cfs_list_del_init(&rs->rs_exp_list);
+	}
+	spin_unlock(&exp->exp_lock);
+}
+
 /**
  * Main body of "handle reply" function.
  * It processes acked reply states
@@ -2668,15 +2957,19 @@ static int ptlrpc_hr_main(void *arg)
 	while (!ptlrpc_hr.hr_stopping) {
 		l_wait_condition(hrt->hrt_waitq, hrt_dont_sleep(hrt, &replies));
 
-                while (!cfs_list_empty(&replies)) {
-                        struct ptlrpc_reply_state *rs;
+		while (!cfs_list_empty(&replies)) {
+			struct ptlrpc_reply_state *rs;
 
-                        rs = cfs_list_entry(replies.prev,
-                                            struct ptlrpc_reply_state,
-                                            rs_list);
-                        cfs_list_del_init(&rs->rs_list);
-                        ptlrpc_handle_rs(rs);
-                }
+			rs = cfs_list_entry(replies.prev,
+					    struct ptlrpc_reply_state,
+					    rs_list);
+			/* replies of one export are batched by
+			 * rs_batch_add(), unlink them all at once */
+			if (!cfs_list_empty(&rs->rs_exp_list))
+				ptlrpc_hr_unlink_batch(&replies);
+			cfs_list_del_init(&rs->rs_list);
+			ptlrpc_handle_rs(rs);
+		}
         }
 
 	cfs_atomic_inc(&hrp->hrp_nstopped);
@@ -3168,6 +3461,7 @@ ptlrpc_service_purge_all(struct ptlrpc_service *svc)
 			cfs_list_del(&rs->rs_list);
 			OBD_FREE_LARGE(rs, svc->srv_max_reply_size);
 		}
+		ptlrpc_rs_pool_fini(svcpt);
 	}
 }
 
@@ -325,4 +325,85 @@ struct file_operations lprocfs_quota_seq_fops = {
 	.llseek		= seq_lseek,
 	.release	= lprocfs_quota_seq_release,
 };
+
+static int lprocfs_quota_cache_cb(cfs_hash_t *hs, cfs_hash_bd_t *bd,
+				  cfs_hlist_node_t *hnode, void *data)
+{
+	struct seq_file		*p = data;
+	struct lquota_entry	*lqe;
+	__u64			 hits, misses, rate = 0;
+
+	lqe = cfs_hlist_entry(hnode, struct lquota_entry, lqe_hash);
+	if (!lqe->lqe_enforced)
+		return 0;
+
+	lqe_read_lock(lqe);
+	hits = lqe->lqe_hits;
+	misses = lqe->lqe_misses;
+	if (hits + misses != 0) {
+		rate = hits * 100;
+		do_div(rate, (__u32)(hits + misses));
+	}
+	seq_printf(p, "- %-8s %llu\n", "id:", lqe->lqe_id.qid_uid);
+	seq_printf(p, "  %-8s { hits: %20"LPF64"u, misses: %20"LPF64"u, "
+		   "hit_rate: %3u%% }\n", "local:", hits, misses,
+		   (unsigned int)rate);
+	seq_printf(p, "  %-8s { granted: %20"LPF64"u, usage: %20"LPF64"u, "
+		   "reserve: %20"LPF64"u }\n", "space:", lqe->lqe_granted,
+		   lqe->lqe_usage, lqe->lqe_reserve);
+	lqe_read_unlock(lqe);
+	return 0;
+}
+
+/*
+ * Dump the quota IDs cached by a quota slave along with how often operations
+ * could be served from local quota space.
+ *
+ * Output example:
+ *
+ * id_cache_user:
+ * - id:      500
+ *   local:   { hits:                  982, misses:                   18, hit_rate:  98% }
+ *   space:   { granted:             40960, usage:               30208, reserve:               8192 }
+ */
+static int lprocfs_quota_cache_seq_show(struct seq_file *p, void *v)
+{
+	struct lquota_site	*site = p->private;
+
+	LASSERT(site != NULL && !site->lqs_is_mst);
+
+	seq_printf(p, "id_cache_%s:\n",
+		   site->lqs_qtype == USRQUOTA ? "user" : "group");
+	cfs_hash_for_each(site->lqs_hash, lprocfs_quota_cache_cb, p);
+	return 0;
+}
+
+static int lprocfs_quota_cache_seq_open(struct inode *inode, struct file *file)
+{
+	struct proc_dir_entry	*dp = PDE(inode);
+	int			 rc;
+
+	if (LPROCFS_ENTRY_AND_CHECK(dp))
+		return -ENOENT;
+
+	rc = single_open(file, lprocfs_quota_cache_seq_show, dp->data);
+	if (rc)
+		LPROCFS_EXIT();
+	return rc;
+}
+
+static int lprocfs_quota_cache_seq_release(struct inode *inode,
+					   struct file *file)
+{
+	LPROCFS_EXIT();
+	return single_release(inode, file);
+}
+
+struct file_operations lprocfs_quota_cache_fops = {
+	.owner		= THIS_MODULE,
+	.open		= lprocfs_quota_cache_seq_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= lprocfs_quota_cache_seq_release,
+};
 #endif  /* LPROCFS */
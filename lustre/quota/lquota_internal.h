@@ -129,6 +129,17 @@ struct lquota_slv_entry {
 
 	/* when latest acquire RPC completed */
 	__u64			lse_acq_time;
+
+	/* adaptive amount of spare quota space kept on top of the usage for
+	 * IDs consuming space quickly, in inodes or kbytes */
+	__u64			lse_reserve;
+
+	/* when the reservation was last grown, i.e. latest local miss */
+	__u64			lse_reserve_time;
+
+	/* number of operations served from/not from local quota space */
+	__u64			lse_hits;
+	__u64			lse_misses;
 };
 
 /* In-memory entry for each enforced quota id
@@ -208,6 +219,10 @@ struct lquota_site {
 #define lqe_lockh		u.se.lse_lockh
 #define lqe_acq_rc		u.se.lse_acq_rc
 #define lqe_acq_time		u.se.lse_acq_time
+#define lqe_reserve		u.se.lse_reserve
+#define lqe_reserve_time	u.se.lse_reserve_time
+#define lqe_hits		u.se.lse_hits
+#define lqe_misses		u.se.lse_misses
 
 #define LQUOTA_BUMP_VER 0x1
 #define LQUOTA_SET_VER  0x2
@@ -412,6 +427,7 @@ void qmt_glb_fini(void);
 
 /* lproc_quota.c */
 extern struct file_operations lprocfs_quota_seq_fops;
+extern struct file_operations lprocfs_quota_cache_fops;
 
 /* qsd_lib.c */
 int qsd_glb_init(void);
@@ -582,17 +582,19 @@ out:
 }
 
 /*
- * Handle quota request from slave.
+ * Validate and process one quota_body sent by a slave, either on its own in a
+ * QUOTA_DQACQ request or as part of a QUOTA_DQACQ_BATCH.
  *
- * \param env  - is the environment passed by the caller
- * \param ld   - is the lu device associated with the qmt
- * \param req  - is the quota acquire request
+ * \param env     - is the environment passed by the caller
+ * \param qmt     - is the master device
+ * \param req     - is the quota request the body was extracted from
+ * \param qbody   - is the quota_body packed by the slave
+ * \param repbody - is the quota_body to be filled in the reply
  */
-static int qmt_dqacq(const struct lu_env *env, struct lu_device *ld,
-		     struct ptlrpc_request *req)
+static int qmt_dqacq_body(const struct lu_env *env, struct qmt_device *qmt,
+			  struct ptlrpc_request *req, struct quota_body *qbody,
+			  struct quota_body *repbody)
 {
-	struct qmt_device	*qmt = lu2qmt_dev(ld);
-	struct quota_body	*qbody, *repbody;
 	struct obd_uuid		*uuid;
 	struct ldlm_lock	*lock;
 	struct lquota_entry	*lqe;
@@ -600,14 +602,6 @@ static int qmt_dqacq(const struct lu_env *env, struct lu_device *ld,
 	int			 rc;
 	ENTRY;
 
-	qbody = req_capsule_client_get(&req->rq_pill, &RMF_QUOTA_BODY);
-	if (qbody == NULL)
-		RETURN(err_serious(-EPROTO));
-
-	repbody = req_capsule_server_get(&req->rq_pill, &RMF_QUOTA_BODY);
-	if (repbody == NULL)
-		RETURN(err_serious(-EFAULT));
-
 	/* verify if global lock is stale */
 	if (!lustre_handle_is_used(&qbody->qb_glb_lockh))
 		RETURN(-ENOLCK);
@@ -686,12 +680,90 @@ static int qmt_dqacq(const struct lu_env *env, struct lu_device *ld,
 	RETURN(rc);
 }
 
+/*
+ * Handle quota request from slave.
+ *
+ * \param env  - is the environment passed by the caller
+ * \param ld   - is the lu device associated with the qmt
+ * \param req  - is the quota acquire request
+ */
+static int qmt_dqacq(const struct lu_env *env, struct lu_device *ld,
+		     struct ptlrpc_request *req)
+{
+	struct qmt_device	*qmt = lu2qmt_dev(ld);
+	struct quota_body	*qbody, *repbody;
+	ENTRY;
+
+	qbody = req_capsule_client_get(&req->rq_pill, &RMF_QUOTA_BODY);
+	if (qbody == NULL)
+		RETURN(err_serious(-EPROTO));
+
+	repbody = req_capsule_server_get(&req->rq_pill, &RMF_QUOTA_BODY);
+	if (repbody == NULL)
+		RETURN(err_serious(-EFAULT));
+
+	RETURN(qmt_dqacq_body(env, qmt, req, qbody, repbody));
+}
+
+/*
+ * Handle a batch of quota requests from slave. Each quota_body is processed
+ * independently and its result is returned in qb_rc of the matching reply
+ * body, the RPC itself only fails if the request is malformed.
+ *
+ * \param env  - is the environment passed by the caller
+ * \param ld   - is the lu device associated with the qmt
+ * \param req  - is the batched quota acquire request
+ */
+static int qmt_dqacq_batch(const struct lu_env *env, struct lu_device *ld,
+			   struct ptlrpc_request *req)
+{
+	struct qmt_device	*qmt = lu2qmt_dev(ld);
+	struct req_capsule	*pill = &req->rq_pill;
+	struct quota_body	*qbodies, *repbodies;
+	int			 count, i, rc;
+	ENTRY;
+
+	qbodies = req_capsule_client_get(pill, &RMF_QUOTA_BODIES);
+	if (qbodies == NULL)
+		RETURN(err_serious(-EPROTO));
+
+	count = req_capsule_get_size(pill, &RMF_QUOTA_BODIES, RCL_CLIENT) /
+		sizeof(struct quota_body);
+	if (count == 0 || count > QUOTA_DQACQ_BATCH_MAX) {
+		CERROR("%s: invalid number of quota bodies in batch: %d\n",
+		       qmt->qmt_svname, count);
+		RETURN(err_serious(-EPROTO));
+	}
+
+	req_capsule_set_size(pill, &RMF_QUOTA_BODIES, RCL_SERVER,
+			     count * sizeof(struct quota_body));
+	rc = req_capsule_server_pack(pill);
+	if (rc)
+		RETURN(err_serious(rc));
+
+	repbodies = req_capsule_server_get(pill, &RMF_QUOTA_BODIES);
+	if (repbodies == NULL)
+		RETURN(err_serious(-EFAULT));
+
+	for (i = 0; i < count; i++) {
+		memset(&repbodies[i], 0, sizeof(repbodies[i]));
+		memcpy(&repbodies[i].qb_id, &qbodies[i].qb_id,
+		       sizeof(repbodies[i].qb_id));
+
+		rc = qmt_dqacq_body(env, qmt, req, &qbodies[i], &repbodies[i]);
+		repbodies[i].qb_rc = rc;
+	}
+
+	RETURN(0);
+}
+
 /* Vector of quota request handlers. This vector is used by the MDT to forward
  * requests to the quota master. */
 struct qmt_handlers qmt_hdls = {
 	/* quota request handlers */
 	.qmth_quotactl		= qmt_quotactl,
 	.qmth_dqacq		= qmt_dqacq,
+	.qmth_dqacq_batch	= qmt_dqacq_batch,
 
 	/* ldlm handlers */
 	.qmth_intent_policy	= qmt_intent_policy,
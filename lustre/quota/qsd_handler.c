@@ -162,12 +162,13 @@ static int qsd_ready(struct lquota_entry *lqe, struct lustre_handle *lockh)
  */
 static bool qsd_calc_adjust(struct lquota_entry *lqe, struct quota_body *qbody)
 {
-	__u64	usage, granted;
+	__u64	usage, granted, reserve;
 	ENTRY;
 
 	usage   = lqe->lqe_usage;
 	usage  += lqe->lqe_pending_write + lqe->lqe_waiting_write;
 	granted = lqe->lqe_granted;
+	reserve = qsd_reserve(lqe);
 
 	if (qbody != NULL)
 		qbody->qb_flags = 0;
@@ -237,8 +238,9 @@ static bool qsd_calc_adjust(struct lquota_entry *lqe, struct quota_body *qbody)
 	/* valid per-ID lock
 	 * Apply good old quota qunit adjustment logic which has been around
 	 * since lustre 1.4:
-	 * 1. release spare quota space? */
-	if (granted > usage + lqe->lqe_qunit) {
+	 * 1. release spare quota space? IDs with a reservation keep it on
+	 *    top of the usual qunit */
+	if (granted > usage + lqe->lqe_qunit + reserve) {
 		/* pre-release quota space */
 		if (qbody == NULL)
 			RETURN(true);
@@ -246,7 +248,7 @@ static bool qsd_calc_adjust(struct lquota_entry *lqe, struct quota_body *qbody)
 		/* if usage == 0, release all granted space */
 		if (usage) {
 			/* try to keep one qunit of quota space */
-			qbody->qb_count -= lqe->lqe_qunit;
+			qbody->qb_count -= lqe->lqe_qunit + reserve;
 			/* but don't release less than qtune to avoid releasing
 			 * space too often */
 			if (qbody->qb_count < lqe->lqe_qtune)
@@ -267,7 +269,19 @@ static bool qsd_calc_adjust(struct lquota_entry *lqe, struct quota_body *qbody)
 		qbody->qb_flags = QUOTA_DQACQ_FL_REPORT;
 	}
 
-	/* 3. Time to pre-acquire? */
+	/* 3. Hot ID whose reservation is running low? Acquire enough space
+	 * to refill it ahead of the writers. This requires the per-ID lock we
+	 * already own. */
+	if (reserve != 0 && !lqe->lqe_nopreacq && usage > 0 &&
+	    granted < usage + reserve / 2) {
+		if (qbody == NULL)
+			RETURN(true);
+		qbody->qb_count  = usage + reserve - granted;
+		qbody->qb_flags |= QUOTA_DQACQ_FL_ACQ;
+		RETURN(true);
+	}
+
+	/* 4. Time to pre-acquire? */
 	if (!lqe->lqe_edquot && !lqe->lqe_nopreacq && usage > 0 &&
 	    lqe->lqe_qunit != 0 && granted < usage + lqe->lqe_qtune) {
 		/* To pre-acquire quota space, we report how much spare quota
@@ -405,6 +419,12 @@ static void qsd_req_completion(const struct lu_env *env,
 	 * on again as soon as qunit is modified */
 	if (req_is_preacq(reqbody->qb_flags) && ret == -EDQUOT)
 		lqe->lqe_nopreacq = true;
+
+	/* master has no more space to spare for this ID, stop trying to keep
+	 * a reservation until new misses show up */
+	if (req_is_acq(reqbody->qb_flags) && reqbody->qb_count != 0 &&
+	    (ret != 0 || repbody == NULL || repbody->qb_count == 0))
+		lqe->lqe_reserve = 0;
 out:
 	adjust = qsd_adjust_needed(lqe);
 	if (reqbody && req_is_acq(reqbody->qb_flags) && ret != -EDQUOT) {
@@ -477,8 +497,8 @@ static int qsd_acquire_local(struct lquota_entry *lqe, __u64 space)
 
 /**
  * Compute how much quota space should be acquire from the master based
- * on how much is currently granted to this slave and pending/waiting
- * operations.
+ * on how much is currently granted to this slave, pending/waiting
+ * operations and the reservation of this ID.
  *
  * \param lqe - is the lquota entry for which we would like to adjust quota
  *              space.
@@ -506,9 +526,10 @@ static inline bool qsd_calc_acquire(struct lquota_entry *lqe,
 		granted = lqe->lqe_usage;
 	}
 
-	/* acquire as much as needed, but not more */
+	/* acquire as much as needed, plus the reservation of hot IDs so that
+	 * the next writers don't have to wait for the master */
 	if (usage > granted) {
-		qbody->qb_count  = usage - granted;
+		qbody->qb_count  = usage - granted + qsd_reserve(lqe);
 		qbody->qb_flags |= QUOTA_DQACQ_FL_ACQ;
 	}
 
@@ -620,16 +641,17 @@ static int qsd_acquire_remote(const struct lu_env *env,
  * Try to consume local quota space first and send acquire request to quota
  * master if required.
  *
- * \param env   - the environment passed by the caller
- * \param lqe   - is the qid entry to be processed
- * \param space - is the amount of quota required for the operation
- * \param ret   - is the return code (-EDQUOT, -EINPROGRESS, ...)
+ * \param env    - the environment passed by the caller
+ * \param lqe    - is the qid entry to be processed
+ * \param space  - is the amount of quota required for the operation
+ * \param ret    - is the return code (-EDQUOT, -EINPROGRESS, ...)
+ * \param missed - set to true if local quota space wasn't sufficient
  *
  * \retval true  - exit from l_wait_event and real return value in \a ret
  * \retval false - continue waiting
  */
 static bool qsd_acquire(const struct lu_env *env, struct lquota_entry *lqe,
-			long long space, int *ret)
+			long long space, int *ret, bool *missed)
 {
 	int rc = 0, count;
 	ENTRY;
@@ -655,6 +677,7 @@ static bool qsd_acquire(const struct lu_env *env, struct lquota_entry *lqe,
 			 break;
 
 		/* need to acquire more quota space from master */
+		*missed = true;
 		rc = qsd_acquire_remote(env, lqe);
 	}
 
@@ -665,6 +688,47 @@ static bool qsd_acquire(const struct lu_env *env, struct lquota_entry *lqe,
 	RETURN(true); /* exit from l_wait_event */
 }
 
+/**
+ * Account an operation which could/couldn't be served from local quota space
+ * and grow the reservation of IDs missing repeatedly.
+ * Called with the lqe write lock held.
+ */
+static void qsd_account_local(struct qsd_qtype_info *qqi,
+			      struct lquota_entry *lqe, bool missed)
+{
+	__u64	max;
+
+	if (!missed) {
+		lqe->lqe_hits++;
+		qsd_stat_add(qqi->qqi_qsd, QSD_STAT_LOCAL_HIT, 1);
+		return;
+	}
+
+	lqe->lqe_misses++;
+	qsd_stat_add(qqi->qqi_qsd, QSD_STAT_LOCAL_MISS, 1);
+
+	if (lqe->lqe_qunit == 0 || lqe->lqe_edquot)
+		return;
+
+	/* missing again shortly after the previous miss, the ID is consuming
+	 * space faster than the current reservation can absorb */
+	if (lqe->lqe_reserve_time != 0 &&
+	    cfs_time_before_64(cfs_time_shift_64(-QSD_RESERVE_WINDOW),
+			       lqe->lqe_reserve_time)) {
+		max = lqe->lqe_qunit * QSD_RESERVE_MAX_QUNITS;
+		if (lqe->lqe_reserve == 0)
+			lqe->lqe_reserve = lqe->lqe_qunit;
+		else
+			lqe->lqe_reserve = min(lqe->lqe_reserve * 2, max);
+		LQUOTA_DEBUG(lqe, "reservation grown to "LPU64,
+			     lqe->lqe_reserve);
+	} else {
+		/* fold the decay in before restarting the clock */
+		lqe->lqe_reserve = qsd_reserve(lqe);
+	}
+	lqe->lqe_reserve_time = cfs_time_current_64();
+}
+
 /**
  * Quota enforcement handler. If local quota can satisfy this operation,
  * return success, otherwise, acquire more quota from master.
@@ -690,6 +754,7 @@ static int qsd_op_begin0(const struct lu_env *env, struct qsd_qtype_info *qqi,
 {
 	struct lquota_entry	*lqe;
 	int			 rc, ret = -EINPROGRESS;
+	bool			 missed = false;
 	struct l_wait_info	 lwi;
 	ENTRY;
 
@@ -733,11 +798,14 @@ static int qsd_op_begin0(const struct lu_env *env, struct qsd_qtype_info *qqi,
 	 * prevent a service thread from being stuck for too long */
 	lwi = LWI_TIMEOUT(cfs_time_seconds(qsd_wait_timeout(qqi->qqi_qsd)),
 			  NULL, NULL);
-	rc = l_wait_event(lqe->lqe_waiters, qsd_acquire(env, lqe, space, &ret),
-			  &lwi);
+	rc = l_wait_event(lqe->lqe_waiters,
+			  qsd_acquire(env, lqe, space, &ret, &missed), &lwi);
 
 	if (rc == 0 && ret == 0) {
 		qid->lqi_space += space;
+		lqe_write_lock(lqe);
+		qsd_account_local(qqi, lqe, missed);
+		lqe_write_unlock(lqe);
 	} else {
 		if (rc == 0)
 			rc = ret;
@@ -889,27 +957,29 @@ int qsd_op_begin(const struct lu_env *env, struct qsd_instance *qsd,
 EXPORT_SYMBOL(qsd_op_begin);
 
 /**
- * Adjust quota space (by acquiring or releasing) hold by the quota slave.
- * This function is called after each quota request completion and during
- * reintegration in order to report usage or re-acquire quota locks.
- * Space adjustment is aborted if there is already a quota request in flight
- * for this ID.
+ * Prepare a quota space adjustment (acquire/release/report) for a given ID.
+ * On success, \a qbody and \a lockh are filled, a request slot is taken for
+ * the ID and a reference is held on \a lqe until qsd_req_completion() runs.
  *
  * \param env    - the environment passed by the caller
  * \param lqe    - is the qid entry to be processed
+ * \param qbody  - is the quota body to fill
+ * \param lockh  - is the per-ID lock handle to use, if any
+ * \param intent - set to true if a per-ID lock has to be enqueued
  *
- * \retval 0 on success, appropriate errors on failure
+ * \retval 1 if the request has to be sent, 0 if no adjustment is needed or
+ *         appropriate error otherwise. The completion callback was already
+ *         called if an error is returned after taking the request slot.
  */
-int qsd_adjust(const struct lu_env *env, struct lquota_entry *lqe)
+static int qsd_adjust_prep(const struct lu_env *env, struct lquota_entry *lqe,
+			   struct quota_body *qbody,
+			   struct lustre_handle *lockh, bool *intent)
 {
-	struct qsd_thread_info	*qti = qsd_info(env);
-	struct quota_body	*qbody = &qti->qti_body;
-	struct qsd_instance	*qsd;
 	struct qsd_qtype_info	*qqi;
 	int			 rc;
-	bool			 intent = false;
 	ENTRY;
 
+	*intent = false;
 	memset(qbody, 0, sizeof(*qbody));
 	rc = qsd_ready(lqe, &qbody->qb_glb_lockh);
 	if (rc) {
@@ -921,7 +991,6 @@ int qsd_adjust(const struct lu_env *env, struct lquota_entry *lqe)
 	}
 
 	qqi = lqe2qqi(lqe);
-	qsd = qqi->qqi_qsd;
 
 	lqe_write_lock(lqe);
 
@@ -943,7 +1012,7 @@ int qsd_adjust(const struct lu_env *env, struct lquota_entry *lqe)
 
 	if (req_is_rel(qbody->qb_flags))
 		lqe->lqe_pending_rel = qbody->qb_count;
-	lustre_handle_copy(&qti->qti_lockh, &lqe->lqe_lockh);
+	lustre_handle_copy(lockh, &lqe->lqe_lockh);
 	lqe_write_unlock(lqe);
 
 	/* hold a refcount until completion */
@@ -955,9 +1024,9 @@ int qsd_adjust(const struct lu_env *env, struct lquota_entry *lqe)
 
 	if (req_is_acq(qbody->qb_flags) || req_is_preacq(qbody->qb_flags)) {
 		/* check whether we own a valid lock for this ID */
-		rc = qsd_id_lock_match(&qti->qti_lockh, &qbody->qb_lockh);
+		rc = qsd_id_lock_match(lockh, &qbody->qb_lockh);
 		if (rc) {
-			memset(&qti->qti_lockh, 0, sizeof(qti->qti_lockh));
+			memset(lockh, 0, sizeof(*lockh));
 			if (req_is_preacq(qbody->qb_flags)) {
 				if (req_has_rep(qbody->qb_flags))
 					/* still want to report usage */
@@ -967,7 +1036,7 @@ int qsd_adjust(const struct lu_env *env, struct lquota_entry *lqe)
 					GOTO(out, rc = -ENOLCK);
 			} else {
 				/* no lock found, should use intent */
-				intent = true;
+				*intent = true;
 			}
 		} else if (req_is_acq(qbody->qb_flags) &&
 			   qbody->qb_count == 0) {
@@ -976,31 +1045,143 @@ int qsd_adjust(const struct lu_env *env, struct lquota_entry *lqe)
 		}
 	} else {
 		/* release and report don't need a per-ID lock */
-		memset(&qti->qti_lockh, 0, sizeof(qti->qti_lockh));
+		memset(lockh, 0, sizeof(*lockh));
 	}
 
-	if (!intent) {
-		rc = qsd_send_dqacq(env, qsd->qsd_exp, qbody, false,
-				    qsd_req_completion, qqi, &qti->qti_lockh,
-				    lqe);
-	} else {
-		struct lquota_lvb *lvb;
+	/* acquiring space from the adjust path is only done to refill the
+	 * reservation of a hot ID */
+	if (req_is_acq(qbody->qb_flags) && qbody->qb_count != 0)
+		qsd_stat_add(qqi->qqi_qsd, QSD_STAT_PREFETCH, 1);
+	RETURN(1);
+out:
+	qsd_req_completion(env, qqi, qbody, NULL, lockh, NULL, lqe, rc);
+	return rc;
+}
 
-		OBD_ALLOC_PTR(lvb);
-		if (lvb == NULL)
-			GOTO(out, rc = -ENOMEM);
+/**
+ * Send a single-ID space adjustment prepared by qsd_adjust_prep().
+ */
+static int qsd_adjust_send(const struct lu_env *env, struct lquota_entry *lqe,
+			   struct quota_body *qbody,
+			   struct lustre_handle *lockh, bool intent)
+{
+	struct qsd_qtype_info	*qqi = lqe2qqi(lqe);
+	struct qsd_instance	*qsd = qqi->qqi_qsd;
+	struct lquota_lvb	*lvb;
+	int			 rc;
 
-		rc = qsd_intent_lock(env, qsd->qsd_exp, qbody, false,
-				     IT_QUOTA_DQACQ, qsd_req_completion,
-				     qqi, lvb, (void *)lqe);
+	if (!intent)
+		return qsd_send_dqacq(env, qsd->qsd_exp, qbody, false,
+				      qsd_req_completion, qqi, lockh, lqe);
+
+	OBD_ALLOC_PTR(lvb);
+	if (lvb == NULL) {
+		rc = -ENOMEM;
+		qsd_req_completion(env, qqi, qbody, NULL, lockh, NULL, lqe,
+				   rc);
+		return rc;
 	}
+
+	return qsd_intent_lock(env, qsd->qsd_exp, qbody, false, IT_QUOTA_DQACQ,
+			       qsd_req_completion, qqi, lvb, (void *)lqe);
+}
+
+/**
+ * Adjust quota space (by acquiring or releasing) hold by the quota slave.
+ * This function is called after each quota request completion and during
+ * reintegration in order to report usage or re-acquire quota locks.
+ * Space adjustment is aborted if there is already a quota request in flight
+ * for this ID.
+ *
+ * \param env    - the environment passed by the caller
+ * \param lqe    - is the qid entry to be processed
+ *
+ * \retval 0 on success, appropriate errors on failure
+ */
+int qsd_adjust(const struct lu_env *env, struct lquota_entry *lqe)
+{
+	struct qsd_thread_info	*qti = qsd_info(env);
+	bool			 intent;
+	int			 rc;
+	ENTRY;
+
+	rc = qsd_adjust_prep(env, lqe, &qti->qti_body, &qti->qti_lockh,
+			     &intent);
+	if (rc <= 0)
+		RETURN(rc);
+
 	/* the completion function will be called by qsd_send_dqacq or
 	 * qsd_intent_lock */
+	rc = qsd_adjust_send(env, lqe, &qti->qti_body, &qti->qti_lockh,
+			     intent);
 	RETURN(rc);
-out:
-	qsd_req_completion(env, qqi, qbody, NULL, &qti->qti_lockh, NULL, lqe,
-			   rc);
-	return rc;
+}
+
+/**
+ * Adjust quota space for several IDs at once. Adjustments relying on a per-ID
+ * lock we already own are packed in a single QUOTA_DQACQ_BATCH request, the
+ * other ones (per-ID lock enqueue) are sent individually. Fall back to
+ * qsd_adjust() for each ID if the master doesn't support batched requests.
+ *
+ * \param env   - the environment passed by the caller
+ * \param lqes  - is the array of qid entries to be processed, the caller
+ *                keeps its references
+ * \param count - is the number of entries in \a lqes
+ */
+void qsd_adjust_batch(const struct lu_env *env, struct lquota_entry **lqes,
+		      int count)
+{
+	struct qsd_instance	*qsd;
+	struct qsd_dqacq_batch	*batch = NULL;
+	bool			 no_batch, intent;
+	int			 i, n, rc;
+	ENTRY;
+
+	LASSERT(count > 0 && count <= QSD_BATCH_MAX);
+	qsd = lqe2qqi(lqes[0])->qqi_qsd;
+
+	read_lock(&qsd->qsd_lock);
+	no_batch = qsd->qsd_no_batch;
+	read_unlock(&qsd->qsd_lock);
+
+	if (!no_batch && count > 1)
+		OBD_ALLOC_PTR(batch);
+
+	if (batch == NULL) {
+		for (i = 0; i < count; i++)
+			qsd_adjust(env, lqes[i]);
+		RETURN_EXIT;
+	}
+
+	for (i = 0, n = 0; i < count; i++) {
+		struct quota_body	*qbody = &batch->qdb_bodies[n];
+		struct lustre_handle	*lockh = &batch->qdb_lockh[n];
+
+		rc = qsd_adjust_prep(env, lqes[i], qbody, lockh, &intent);
+		if (rc <= 0)
+			continue;
+
+		if (intent) {
+			/* lock enqueue can't be batched */
+			qsd_adjust_send(env, lqes[i], qbody, lockh, true);
+			continue;
+		}
+		batch->qdb_lqes[n++] = lqes[i];
+	}
+
+	if (n == 0) {
+		OBD_FREE_PTR(batch);
+	} else if (n == 1) {
+		qsd_adjust_send(env, batch->qdb_lqes[0], &batch->qdb_bodies[0],
+				&batch->qdb_lockh[0], false);
+		OBD_FREE_PTR(batch);
+	} else {
+		batch->qdb_count = n;
+		/* batch is released once the request completes */
+		qsd_send_dqacq_batch(env, qsd->qsd_exp, batch,
+				     qsd_req_completion);
+	}
+	EXIT;
 }
 
 /**
@@ -1021,7 +1202,7 @@ static void qsd_op_end0(const struct lu_env *env, struct qsd_qtype_info *qqi,
 			struct lquota_id_info *qid)
 {
 	struct lquota_entry	*lqe;
-	bool			 adjust;
+	bool			 adjust, hot = false;
 	ENTRY;
 
 	lqe = qid->lqi_qentry;
@@ -1040,15 +1221,18 @@ static void qsd_op_end0(const struct lu_env *env, struct qsd_qtype_info *qqi,
 		adjust = qsd_adjust_needed(lqe);
 	else
 		adjust = true;
+	hot = qsd_reserve(lqe) != 0;
 	lqe_write_unlock(lqe);
 
 	if (adjust) {
 		/* pre-acquire/release quota space is needed */
-		if (env != NULL)
+		if (env != NULL && !hot)
 			qsd_adjust(env, lqe);
 		else
 			/* no suitable environment, handle adjustment in
-			 * separate thread context */
+			 * separate thread context. Hot IDs are also refilled
+			 * there, so that their adjustments are batched and
+			 * the service thread doesn't send any RPC */
 			qsd_adjust_schedule(lqe, false, false);
 	}
 	lqe_putref(lqe);
@@ -107,16 +107,38 @@ struct qsd_instance {
 	 * enforced here (via procfs) */
 	int			 qsd_timeout;
 
+	/* statistics on quota requests sent by this slave, see QSD_STAT_* */
+	struct lprocfs_stats	*qsd_stats;
+
 	unsigned long		 qsd_is_md:1,    /* managing quota for mdt */
 				 qsd_started:1,  /* instance is now started */
 				 qsd_prepared:1, /* qsd_prepare() successfully
 						  * called */
 				 qsd_exp_valid:1,/* qsd_exp is now valid */
 				 qsd_stopping:1, /* qsd_instance is stopping */
-				 qsd_acct_failed:1; /* failed to set up acct
+				 qsd_acct_failed:1, /* failed to set up acct
 						     * for one quota type */
+				 qsd_no_batch:1; /* master doesn't support
+						  * QUOTA_DQACQ_BATCH */
+};
+
+/* counters registered in qsd_stats */
+enum {
+	QSD_STAT_LOCAL_HIT = 0,	/* operation served from local quota space */
+	QSD_STAT_LOCAL_MISS,	/* operation had to wait for the master */
+	QSD_STAT_DQACQ,		/* single-ID acquire/release RPCs */
+	QSD_STAT_DQACQ_BATCH,	/* QUOTA_DQACQ_BATCH RPCs */
+	QSD_STAT_BATCH_IDS,	/* IDs packed in QUOTA_DQACQ_BATCH RPCs */
+	QSD_STAT_PREFETCH,	/* asynchronous acquire for hot IDs */
+	QSD_STAT_LAST,
 };
 
+static inline void qsd_stat_add(struct qsd_instance *qsd, int idx, long amt)
+{
+	if (qsd->qsd_stats != NULL)
+		lprocfs_counter_add(qsd->qsd_stats, idx, amt);
+}
+
 /*
  * Per-type quota information.
  * Quota slave instance for a specific quota type. The qsd instance has one such
@@ -315,8 +337,50 @@ static inline void qsd_set_qunit(struct lquota_entry *lqe, __u64 qunit)
 
 	/* turn on pre-acquire when qunit is modified */
 	lqe->lqe_nopreacq = false;
+
+	/* the reservation is expressed in qunits, start over */
+	lqe->lqe_reserve = 0;
+}
+
+/* Adaptive reservation: each local miss happening less than
+ * QSD_RESERVE_WINDOW seconds after the previous one doubles the amount of
+ * spare quota space (starting at one qunit) the slave tries to keep for this
+ * ID, up to QSD_RESERVE_MAX_QUNITS qunits. The reservation is halved for
+ * every QSD_RESERVE_DECAY seconds without miss. */
+#define QSD_RESERVE_WINDOW	1
+#define QSD_RESERVE_DECAY	10
+#define QSD_RESERVE_MAX_QUNITS	8
+
+/* helper function returning the current reservation of a quota ID */
+static inline __u64 qsd_reserve(struct lquota_entry *lqe)
+{
+	cfs_duration_t	idle;
+	int		shift;
+
+	if (lqe->lqe_reserve == 0 || lqe->lqe_edquot || lqe->lqe_qunit == 0)
+		return 0;
+
+	idle = (cfs_duration_t)(cfs_time_current_64() - lqe->lqe_reserve_time);
+	shift = cfs_duration_sec(idle) / QSD_RESERVE_DECAY;
+	if (shift >= 64)
+		return 0;
+	return lqe->lqe_reserve >> shift;
 }
 
+/* maximum number of quota IDs adjusted with a single QUOTA_DQACQ_BATCH, must
+ * not exceed QUOTA_DQACQ_BATCH_MAX */
+#define QSD_BATCH_MAX	32
+
+/* space adjustments for several IDs packed in a single QUOTA_DQACQ_BATCH
+ * request. Allocated by qsd_adjust_batch() and freed once the reply has been
+ * processed. */
+struct qsd_dqacq_batch {
+	int			 qdb_count;
+	struct lquota_entry	*qdb_lqes[QSD_BATCH_MAX];
+	struct lustre_handle	 qdb_lockh[QSD_BATCH_MAX];
+	struct quota_body	 qdb_bodies[QSD_BATCH_MAX];
+};
+
 #define QSD_WB_INTERVAL	60 /* 60 seconds */
 
 /* helper function calculating how long a service thread should be waiting for
@@ -358,6 +422,8 @@ int qsd_send_dqacq(const struct lu_env *, struct obd_export *,
 		   struct quota_body *, bool, qsd_req_completion_t,
 		   struct qsd_qtype_info *, struct lustre_handle *,
 		   struct lquota_entry *);
+int qsd_send_dqacq_batch(const struct lu_env *, struct obd_export *,
+			 struct qsd_dqacq_batch *, qsd_req_completion_t);
 int qsd_intent_lock(const struct lu_env *, struct obd_export *,
 		    struct quota_body *, bool, int, qsd_req_completion_t,
 		    struct qsd_qtype_info *, struct lquota_lvb *, void *);
@@ -375,6 +441,7 @@ int qsd_process_config(struct lustre_cfg *);
 
 /* qsd_handler.c */
 int qsd_adjust(const struct lu_env *, struct lquota_entry *);
+void qsd_adjust_batch(const struct lu_env *, struct lquota_entry **, int);
 
 /* qsd_writeback.c */
 void qsd_upd_schedule(struct qsd_qtype_info *, struct lquota_entry *,
@@ -242,6 +242,8 @@ static int qsd_conn_callback(void *data)
 	write_lock(&qsd->qsd_lock);
 	/* notify that qsd_exp is now valid */
 	qsd->qsd_exp_valid = true;
+	/* master might have been upgraded, try batched requests again */
+	qsd->qsd_no_batch = false;
 	write_unlock(&qsd->qsd_lock);
 
 	/* Now that the connection to master is setup, we can initiate the
@@ -454,6 +456,17 @@ static int qsd_qtype_init(const struct lu_env *env, struct qsd_instance *qsd,
 		       qsd->qsd_svname, rc);
 		GOTO(out, rc);
 	}
+
+	rc = lprocfs_seq_create(qsd->qsd_proc,
+				qtype == USRQUOTA ? "id_cache_user" :
+						    "id_cache_group",
+				0444, &lprocfs_quota_cache_fops,
+				qqi->qqi_site);
+	if (rc) {
+		CERROR("%s: can't add procfs entry for quota ID cache %d\n",
+		       qsd->qsd_svname, rc);
+		GOTO(out, rc);
+	}
 	EXIT;
 out:
 	if (rc)
@@ -509,6 +522,9 @@ void qsd_fini(const struct lu_env *env, struct qsd_instance *qsd)
 	for (qtype = USRQUOTA; qtype < MAXQUOTAS; qtype++)
 		qsd_qtype_fini(env, qsd, qtype);
 
+	if (qsd->qsd_stats != NULL)
+		lprocfs_free_stats(&qsd->qsd_stats);
+
 	/* deregister connection to the quota master */
 	qsd->qsd_exp_valid = false;
 	lustre_deregister_lwp_item(&qsd->qsd_exp);
@@ -629,6 +645,29 @@ struct qsd_instance *qsd_init(const struct lu_env *env, char *svname,
 		       svname, rc);
 		GOTO(out, rc);
         }
+
+	/* statistics on quota requests, see QSD_STAT_* */
+	qsd->qsd_stats = lprocfs_alloc_stats(QSD_STAT_LAST, 0);
+	if (qsd->qsd_stats == NULL)
+		GOTO(out, rc = -ENOMEM);
+	lprocfs_counter_init(qsd->qsd_stats, QSD_STAT_LOCAL_HIT, 0,
+			     "local_hit", "reqs");
+	lprocfs_counter_init(qsd->qsd_stats, QSD_STAT_LOCAL_MISS, 0,
+			     "local_miss", "reqs");
+	lprocfs_counter_init(qsd->qsd_stats, QSD_STAT_DQACQ, 0,
+			     "dqacq", "reqs");
+	lprocfs_counter_init(qsd->qsd_stats, QSD_STAT_DQACQ_BATCH, 0,
+			     "dqacq_batch", "reqs");
+	lprocfs_counter_init(qsd->qsd_stats, QSD_STAT_BATCH_IDS, 0,
+			     "batch_ids", "ids");
+	lprocfs_counter_init(qsd->qsd_stats, QSD_STAT_PREFETCH, 0,
+			     "prefetch", "reqs");
+	rc = lprocfs_register_stats(qsd->qsd_proc, "stats", qsd->qsd_stats);
+	if (rc) {
+		CERROR("%s: fail to register quota slave stats (%d)\n",
+		       svname, rc);
+		GOTO(out, rc);
+	}
 	EXIT;
 out:
 	if (rc) {
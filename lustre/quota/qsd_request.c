@@ -130,6 +130,8 @@ int qsd_send_dqacq(const struct lu_env *env, struct obd_export *exp,
 	aa->aa_completion = completion;
 	lustre_handle_copy(&aa->aa_lockh, lockh);
 
+	qsd_stat_add(qqi->qqi_qsd, QSD_STAT_DQACQ, 1);
+
 	if (sync) {
 		rc = ptlrpc_queue_wait(req);
 		rc = qsd_dqacq_interpret(env, req, aa, rc);
@@ -145,6 +147,156 @@ out:
 	return rc;
 }
 
+/*
+ * batched quota request interpret callback. The completion callback is run
+ * for each quota ID packed in the batch with the per-ID return code sent back
+ * by the master.
+ *
+ * \param env    - the environment passed by the caller
+ * \param req    - the QUOTA_DQACQ_BATCH request
+ * \param arg    - qsd_async_args
+ * \param rc     - request status
+ *
+ * \retval 0     - success
+ * \retval -ve   - appropriate errors
+ */
+static int qsd_dqacq_batch_interpret(const struct lu_env *env,
+				     struct ptlrpc_request *req, void *arg,
+				     int rc)
+{
+	struct qsd_async_args	*aa = (struct qsd_async_args *)arg;
+	struct qsd_dqacq_batch	*batch = (struct qsd_dqacq_batch *)aa->aa_arg;
+	struct quota_body	*rep_qbodies = NULL;
+	int			 i;
+	ENTRY;
+
+	if (rc == 0) {
+		rep_qbodies = req_capsule_server_get(&req->rq_pill,
+						     &RMF_QUOTA_BODIES);
+		if (rep_qbodies == NULL ||
+		    req_capsule_get_size(&req->rq_pill, &RMF_QUOTA_BODIES,
+					 RCL_SERVER) !=
+		    batch->qdb_count * sizeof(struct quota_body))
+			rc = -EPROTO;
+	}
+
+	if (rc == -EOPNOTSUPP || rc == -ENOTSUPP || rc == -EPROTO) {
+		struct qsd_instance *qsd = lqe2qqi(batch->qdb_lqes[0])->qqi_qsd;
+
+		/* master doesn't know about batched quota requests, fall back
+		 * to one request per ID from now on. Each lqe is still
+		 * holding its request slot and reference, both are handed
+		 * over to the new request */
+		CDEBUG(D_QUOTA, "%s: batched quota request failed with %d, "
+		       "falling back to single requests\n", qsd->qsd_svname,
+		       rc);
+		write_lock(&qsd->qsd_lock);
+		qsd->qsd_no_batch = true;
+		write_unlock(&qsd->qsd_lock);
+
+		for (i = 0; i < batch->qdb_count; i++) {
+			struct lquota_entry *lqe = batch->qdb_lqes[i];
+
+			qsd_send_dqacq(env, aa->aa_exp, &batch->qdb_bodies[i],
+				       false, aa->aa_completion, lqe2qqi(lqe),
+				       &batch->qdb_lockh[i], lqe);
+		}
+		GOTO(out, rc);
+	}
+
+	for (i = 0; i < batch->qdb_count; i++) {
+		struct lquota_entry	*lqe = batch->qdb_lqes[i];
+		struct quota_body	*rep_qbody = NULL;
+		int			 ret = rc;
+
+		if (ret == 0)
+			ret = (int)rep_qbodies[i].qb_rc;
+		if (rep_qbodies != NULL &&
+		    (ret == 0 || ret == -EDQUOT || ret == -EINPROGRESS))
+			rep_qbody = &rep_qbodies[i];
+
+		aa->aa_completion(env, lqe2qqi(lqe), &batch->qdb_bodies[i],
+				  rep_qbody, &batch->qdb_lockh[i], NULL, lqe,
+				  ret);
+	}
+out:
+	OBD_FREE_PTR(batch);
+	RETURN(rc);
+}
+
+/*
+ * Send space adjustments for several quota IDs to master in a single
+ * QUOTA_DQACQ_BATCH request. The request is always sent asynchronously.
+ *
+ * \param env    - the environment passed by the caller
+ * \param exp    - is the export to use to send the acquire RPC
+ * \param batch  - quota bodies, lock handles and qid entries to process,
+ *                 owned by the request and freed on completion
+ * \param completion - completion callback run for each qid entry
+ *
+ * \retval 0     - success
+ * \retval -ve   - appropriate errors
+ */
+int qsd_send_dqacq_batch(const struct lu_env *env, struct obd_export *exp,
+			 struct qsd_dqacq_batch *batch,
+			 qsd_req_completion_t completion)
+{
+	struct qsd_instance	*qsd = lqe2qqi(batch->qdb_lqes[0])->qqi_qsd;
+	struct ptlrpc_request	*req;
+	struct quota_body	*req_qbodies;
+	struct qsd_async_args	*aa;
+	int			 i, rc;
+	ENTRY;
+
+	LASSERT(exp);
+	LASSERT(batch->qdb_count > 0 && batch->qdb_count <= QSD_BATCH_MAX);
+	CLASSERT(QSD_BATCH_MAX <= QUOTA_DQACQ_BATCH_MAX);
+
+	req = ptlrpc_request_alloc(class_exp2cliimp(exp),
+				   &RQF_QUOTA_DQACQ_BATCH);
+	if (req == NULL)
+		GOTO(out, rc = -ENOMEM);
+
+	req->rq_no_resend = req->rq_no_delay = 1;
+	req->rq_no_retry_einprogress = 1;
+	req_capsule_set_size(&req->rq_pill, &RMF_QUOTA_BODIES, RCL_CLIENT,
+			     batch->qdb_count * sizeof(struct quota_body));
+	rc = ptlrpc_request_pack(req, LUSTRE_MDS_VERSION, QUOTA_DQACQ_BATCH);
+	if (rc) {
+		ptlrpc_request_free(req);
+		GOTO(out, rc);
+	}
+
+	req_qbodies = req_capsule_client_get(&req->rq_pill, &RMF_QUOTA_BODIES);
+	memcpy(req_qbodies, batch->qdb_bodies,
+	       batch->qdb_count * sizeof(struct quota_body));
+
+	req_capsule_set_size(&req->rq_pill, &RMF_QUOTA_BODIES, RCL_SERVER,
+			     batch->qdb_count * sizeof(struct quota_body));
+	ptlrpc_request_set_replen(req);
+
+	CLASSERT(sizeof(*aa) <= sizeof(req->rq_async_args));
+	aa = ptlrpc_req_async_args(req);
+	aa->aa_exp = exp;
+	aa->aa_qqi = NULL;
+	aa->aa_arg = (void *)batch;
+	aa->aa_completion = completion;
+
+	qsd_stat_add(qsd, QSD_STAT_DQACQ_BATCH, 1);
+	qsd_stat_add(qsd, QSD_STAT_BATCH_IDS, batch->qdb_count);
+
+	req->rq_interpret_reply = qsd_dqacq_batch_interpret;
+	ptlrpcd_add_req(req, PDL_POLICY_LOCAL, -1);
+	RETURN(0);
+out:
+	for (i = 0; i < batch->qdb_count; i++)
+		completion(env, lqe2qqi(batch->qdb_lqes[i]),
+			   &batch->qdb_bodies[i], NULL, &batch->qdb_lockh[i],
+			   NULL, batch->qdb_lqes[i], rc);
+	OBD_FREE_PTR(batch);
+	return rc;
+}
+
 /*
  * intent quota request interpret callback.
  *
@@ -413,6 +413,22 @@ static bool qsd_job_pending(struct qsd_instance *qsd, cfs_list_t *upd,
 	return job_pending;
 }
 
+/* send the space adjustments collected by the writeback thread and drop the
+ * references transferred from the adjust list */
+static void qsd_adjust_flush(const struct lu_env *env,
+			     struct lquota_entry **lqes, int *count)
+{
+	int	i;
+
+	if (*count == 0)
+		return;
+
+	qsd_adjust_batch(env, lqes, *count);
+	for (i = 0; i < *count; i++)
+		lqe_putref(lqes[i]);
+	*count = 0;
+}
+
 static int qsd_upd_thread(void *arg)
 {
 	struct qsd_instance	*qsd = (struct qsd_instance *)arg;
@@ -425,6 +441,8 @@ static int qsd_upd_thread(void *arg)
 	int			 qtype, rc = 0;
 	bool			 uptodate;
 	struct lquota_entry	*lqe, *tmp;
+	struct lquota_entry	*adjust[QSD_BATCH_MAX];
+	int			 nr_adjust = 0;
 	__u64			 cur_time;
 	ENTRY;
 
@@ -472,16 +490,25 @@ static int qsd_upd_thread(void *arg)
 
 			if (thread_is_running(thread) && uptodate) {
 				qsd_refresh_usage(env, lqe);
-				if (lqe->lqe_adjust_time == 0)
-					qsd_id_lock_cancel(env, lqe);
-				else
-					qsd_adjust(env, lqe);
+				if (lqe->lqe_adjust_time != 0) {
+					/* collect adjustments to be sent in
+					 * batch, lqe reference is released
+					 * by qsd_adjust_flush() */
+					adjust[nr_adjust++] = lqe;
+					if (nr_adjust == QSD_BATCH_MAX)
+						qsd_adjust_flush(env, adjust,
+								 &nr_adjust);
+					spin_lock(&qsd->qsd_adjust_lock);
+					continue;
+				}
+				qsd_id_lock_cancel(env, lqe);
 			}
 
 			lqe_putref(lqe);
 			spin_lock(&qsd->qsd_adjust_lock);
 		}
 		spin_unlock(&qsd->qsd_adjust_lock);
+		qsd_adjust_flush(env, adjust, &nr_adjust);
 
 		if (!thread_is_running(thread))
 			break;
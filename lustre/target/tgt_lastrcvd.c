@@ -403,6 +403,7 @@ void tgt_cb_last_committed(struct lu_env *env, struct thandle *th,
 			   struct dt_txn_commit_cb *cb, int err)
 {
 	struct tgt_last_committed_callback *ccb;
+	__u64				    committed;
 
 	ccb = container_of0(cb, struct tgt_last_committed_callback, llcc_cb);
 
@@ -410,8 +411,11 @@ void tgt_cb_last_committed(struct lu_env *env, struct thandle *th,
 	LASSERT(ccb->llcc_exp->exp_obd == ccb->llcc_tgt->lut_obd);
 
 	spin_lock(&ccb->llcc_tgt->lut_translock);
-	if (ccb->llcc_transno > ccb->llcc_tgt->lut_obd->obd_last_committed)
-		ccb->llcc_tgt->lut_obd->obd_last_committed = ccb->llcc_transno;
+	/* replays done in parallel may commit out of transno order */
+	committed = target_replay_committed(ccb->llcc_tgt->lut_obd,
+					    ccb->llcc_transno);
+	if (committed > ccb->llcc_tgt->lut_obd->obd_last_committed)
+		ccb->llcc_tgt->lut_obd->obd_last_committed = committed;
 
 	LASSERT(ccb->llcc_exp);
 	if (ccb->llcc_transno > ccb->llcc_exp->exp_last_committed) {
@@ -0,0 +1,256 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.sun.com/software/products/lustre/docs/GPLv2.pdf
+ *
+ * GPL HEADER END
+ */
+/*
+ * This file is part of Lustre, http://www.lustre.org/
+ * Lustre is a trademark of Sun Microsystems, Inc.
+ *
+ * lustre/tests/aiobench.c
+ *
+ * Write or read a file with O_DIRECT through Linux native AIO, keeping up to
+ * a given number of requests in flight, and report the throughput. Written
+ * data is a pattern derived from the file offset, which -r verifies.
+ * The AIO system calls are used directly so that libaio is not needed.
+ */
+
+#ifndef _GNU_SOURCE
+#define  _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <sys/time.h>
+#include <sys/syscall.h>
+#include <linux/aio_abi.h>
+
+static int io_setup(unsigned nr, aio_context_t *ctx)
+{
+	return syscall(__NR_io_setup, nr, ctx);
+}
+
+static int io_destroy(aio_context_t ctx)
+{
+	return syscall(__NR_io_destroy, ctx);
+}
+
+static int io_submit(aio_context_t ctx, long nr, struct iocb **iocbs)
+{
+	return syscall(__NR_io_submit, ctx, nr, iocbs);
+}
+
+static int io_getevents(aio_context_t ctx, long min_nr, long nr,
+			struct io_event *events, struct timespec *timeout)
+{
+	return syscall(__NR_io_getevents, ctx, min_nr, nr, events, timeout);
+}
+
+static void usage(const char *prog)
+{
+	fprintf(stderr,
+		"usage: %s {-w|-r} [-q depth] [-b bsize] [-s size] <file>\n"
+		"\t-w          write the file\n"
+		"\t-r          read and verify the file\n"
+		"\t-q depth    requests in flight (default: 1)\n"
+		"\t-b bsize    request size (default: 1MB)\n"
+		"\t-s size     file size (default: 256MB)\n", prog);
+	exit(EINVAL);
+}
+
+static void fill(uint64_t *buf, size_t len, off_t off)
+{
+	size_t i;
+
+	for (i = 0; i < len / sizeof(*buf); i++)
+		buf[i] = off + i * sizeof(*buf);
+}
+
+static int verify(const uint64_t *buf, size_t len, off_t off)
+{
+	size_t i;
+
+	for (i = 0; i < len / sizeof(*buf); i++) {
+		if (buf[i] != off + i * sizeof(*buf)) {
+			fprintf(stderr, "mismatch at %llu: %#llx\n",
+				(unsigned long long)(off + i * sizeof(*buf)),
+				(unsigned long long)buf[i]);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static unsigned long long strtosize(const char *str)
+{
+	char			*end;
+	unsigned long long	 val = strtoull(str, &end, 0);
+
+	switch (*end) {
+	case 'G': case 'g':
+		val <<= 10;
+	case 'M': case 'm':
+		val <<= 10;
+	case 'K': case 'k':
+		val <<= 10;
+	}
+	return val;
+}
+
+int main(int argc, char **argv)
+{
+	aio_context_t		 ctx = 0;
+	struct iocb		*iocbs;
+	struct iocb		**free_iocbs;
+	struct io_event		*events;
+	struct timeval		 start;
+	struct timeval		 end;
+	unsigned long long	 size = 256ULL << 20;
+	unsigned long long	 done = 0;
+	off_t			 off = 0;
+	size_t			 bsize = 1 << 20;
+	double			 secs;
+	int			 depth = 1;
+	int			 nfree;
+	int			 write = -1;
+	int			 fd;
+	int			 rc;
+	int			 c;
+	int			 i;
+
+	while ((c = getopt(argc, argv, "b:q:rs:w")) != -1) {
+		switch (c) {
+		case 'b':
+			bsize = strtosize(optarg);
+			break;
+		case 'q':
+			depth = atoi(optarg);
+			break;
+		case 'r':
+			write = 0;
+			break;
+		case 's':
+			size = strtosize(optarg);
+			break;
+		case 'w':
+			write = 1;
+			break;
+		default:
+			usage(argv[0]);
+		}
+	}
+	if (write < 0 || optind != argc - 1 || depth < 1 || bsize == 0 ||
+	    bsize % 4096 != 0 || size % bsize != 0)
+		usage(argv[0]);
+
+	fd = open(argv[optind],
+		  O_DIRECT | (write ? O_WRONLY | O_CREAT : O_RDONLY), 0644);
+	if (fd < 0) {
+		fprintf(stderr, "cannot open '%s': %s\n", argv[optind],
+			strerror(errno));
+		return errno;
+	}
+
+	iocbs = calloc(depth, sizeof(*iocbs));
+	free_iocbs = calloc(depth, sizeof(*free_iocbs));
+	events = calloc(depth, sizeof(*events));
+	if (iocbs == NULL || free_iocbs == NULL || events == NULL)
+		return ENOMEM;
+
+	for (i = 0; i < depth; i++) {
+		void *buf;
+
+		if (posix_memalign(&buf, 4096, bsize) != 0)
+			return ENOMEM;
+		iocbs[i].aio_fildes = fd;
+		iocbs[i].aio_buf = (uintptr_t)buf;
+		iocbs[i].aio_nbytes = bsize;
+		iocbs[i].aio_lio_opcode = write ? IOCB_CMD_PWRITE :
+						  IOCB_CMD_PREAD;
+		free_iocbs[i] = &iocbs[i];
+	}
+	nfree = depth;
+
+	if (io_setup(depth, &ctx) < 0) {
+		fprintf(stderr, "io_setup: %s\n", strerror(errno));
+		return errno;
+	}
+
+	gettimeofday(&start, NULL);
+	while (done < size) {
+		/* keep the queue full */
+		while (nfree > 0 && off < size) {
+			struct iocb *cb = free_iocbs[--nfree];
+
+			cb->aio_offset = off;
+			if (write)
+				fill((uint64_t *)(uintptr_t)cb->aio_buf,
+				     bsize, off);
+			rc = io_submit(ctx, 1, &cb);
+			if (rc != 1) {
+				fprintf(stderr, "io_submit at %llu: %s\n",
+					(unsigned long long)off,
+					strerror(rc < 0 ? errno : EAGAIN));
+				return rc < 0 ? errno : EAGAIN;
+			}
+			off += bsize;
+		}
+
+		rc = io_getevents(ctx, 1, depth, events, NULL);
+		if (rc < 0) {
+			if (errno == EINTR)
+				continue;
+			fprintf(stderr, "io_getevents: %s\n", strerror(errno));
+			return errno;
+		}
+		for (i = 0; i < rc; i++) {
+			struct iocb *cb = (struct iocb *)(uintptr_t)
+					  events[i].obj;
+
+			if (events[i].res != (__s64)bsize) {
+				fprintf(stderr, "%s at %llu: %lld\n",
+					write ? "write" : "read",
+					(unsigned long long)cb->aio_offset,
+					(long long)events[i].res);
+				return EIO;
+			}
+			if (!write &&
+			    verify((uint64_t *)(uintptr_t)cb->aio_buf, bsize,
+				   cb->aio_offset) < 0)
+				return EIO;
+			done += bsize;
+			free_iocbs[nfree++] = cb;
+		}
+	}
+	gettimeofday(&end, NULL);
+
+	io_destroy(ctx);
+	close(fd);
+
+	secs = (end.tv_sec - start.tv_sec) +
+	       (end.tv_usec - start.tv_usec) / 1000000.0;
+	printf("%s %llu bytes, depth %d, bsize %zu: %.3f secs, %.2f MB/s\n",
+	       write ? "wrote" : "read", done, depth, bsize, secs,
+	       secs > 0 ? done / secs / (1 << 20) : 0);
+	return 0;
+}
@@ -1811,6 +1811,53 @@ test_112a() {
 }
 run_test 112a "bulk resend while orignal request is in progress"
 
+# time of the last eviction seen by the OST0000 import of mount point $1
+ost1_last_eviction() {
+	local name=$($LFS getname $1 | awk '{ print $1 }')
+
+	do_facet client $LCTL get_param \
+		osc.$FSNAME-OST0000-osc-${name#$FSNAME-}.state |
+		awk -F"[ [,]" '/EVICTED]$/ { if (mx<$4) {mx=$4;} }
+			      END { print mx + 0 }'
+}
+
+test_113() {
+	local BEFORE=$(date +%s)
+	local before
+	local after
+
+	do_facet ost1 $LCTL get_param -n ldlm.waiting_locks ||
+		{ skip "no ldlm.waiting_locks on ost1"; return 0; }
+	before=$(get_param_field ost1 ldlm.waiting_locks timeouts | calc_sum)
+
+	mount_client $DIR2 || error "failed to mount $DIR2: $?"
+	$SETSTRIPE -i 0 -c 1 $DIR/$tfile || error "setstripe failed"
+	# cancel cached locks from MDT to avoid eviction from it
+	cancel_lru_locks mdc
+
+	# the lock taken through $DIR is never cancelled, its callback timer
+	# must expire and evict that client, not the one waiting on $DIR2
+	do_facet client $MULTIOP $DIR/$tfile Ow ||
+		error "failed to run multiop: $?"
+	drop_ldlm_cancel $MULTIOP $DIR2/$tfile Ow ||
+		error "failed to ldlm_cancel: $?"
+
+	[ $(ost1_last_eviction $DIR2) -lt $BEFORE ] ||
+		error "client waiting for the lock was evicted"
+	umount_client $DIR2 || error "failed to unmount $DIR2: $?"
+	client_reconnect
+
+	[ $(ost1_last_eviction $DIR) -ge $BEFORE ] ||
+		error "client holding the lock was not evicted"
+
+	do_facet ost1 $LCTL get_param -n ldlm.waiting_locks
+	after=$(get_param_field ost1 ldlm.waiting_locks timeouts | calc_sum)
+	[ $after -gt $before ] ||
+		error "lock timeouts on ost1 did not increase: $before/$after"
+	rm -f $DIR/$tfile
+}
+run_test 113 "lock callback timeouts are counted per CPT"
+
 complete $SECONDS
 check_and_cleanup_lustre
 exit_status
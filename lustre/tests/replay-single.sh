@@ -1741,6 +1741,44 @@ test_66b() #bug 3055
 }
 run_test 66b "AT: verify net latency adjusts"
 
+test_66c()
+{
+	remote_mds_nodsh && skip "remote MDS with nodsh" && return 0
+
+	at_start || return 0
+	local pct=$($LCTL get_param -n at_percentile 2>/dev/null)
+	[ -n "$pct" ] && [ $pct -gt 0 ] && [ $pct -lt 100 ] ||
+		{ skip "at_percentile is not in use" && return 0; }
+	local at_min=$($LCTL get_param -n at_min)
+
+	test_mkdir -p $DIR/$tdir
+	createmany -m $DIR/$tdir/f 50 > /dev/null
+	# one slow reint, slower than at_min
+	do_facet $SINGLEMDS "$LCTL set_param fail_val=$(((at_min + 5) * 1000))"
+#define OBD_FAIL_PTLRPC_PAUSE_REQ        0x50a
+	do_facet $SINGLEMDS "$LCTL set_param fail_loc=0x8000050a"
+	mknod $DIR/$tdir/slow p || error "mknod failed"
+	do_facet $SINGLEMDS "$LCTL set_param fail_loc=0"
+	createmany -m $DIR/$tdir/g 50 > /dev/null
+
+	local opc=$(lctl get_param -n mdc.${FSNAME}-MDT0000-mdc-*.timeouts |
+		    grep "^opc")
+	echo "$opc"
+	[ -n "$opc" ] || error "no per-opcode service estimates"
+	echo "$opc" | grep -q p99 || error "no percentiles"
+
+	# MDS_REINT
+	local cur=$(echo "$opc" | awk '$2 == 36 {print $5}')
+	local worst=$(echo "$opc" | awk '$2 == 36 {print $7}')
+	[ -n "$cur" ] || error "no estimate for MDS_REINT"
+	echo "MDS_REINT service estimate $cur, worst $worst"
+	[ $worst -gt $at_min ] || error "slow reint not measured, worst $worst"
+	[ $cur -lt $worst ] ||
+		error "Current $cur should be less than worst $worst"
+	rm -rf $DIR/$tdir
+}
+run_test 66c "AT: verify per-opcode service time ignores one slow RPC"
+
 test_67a() #bug 3055
 {
     remote_ost_nodsh && skip "remote OST with nodsh" && return 0
@@ -2793,6 +2831,113 @@ test_90() { # bug 19494
 }
 run_test 90 "lfs find identifies the missing striped file segments"
 
+test_91() {
+	local param=mdt.${FSNAME}-MDT0000.recovery_status
+	local status
+	local parallel
+
+	# two clients, so that replays can go to different workers
+	mount_client $MOUNT2 || error "mount $MOUNT2 failed"
+	mkdir -p $DIR/$tdir-1 $MOUNT2/$tdir-2
+	replay_barrier $SINGLEMDS
+	createmany -o $DIR/$tdir-1/$tfile- 100 &
+	local pid=$!
+	createmany -o $MOUNT2/$tdir-2/$tfile- 100 ||
+		error "createmany on $MOUNT2 failed"
+	wait $pid || error "createmany on $MOUNT failed"
+	unlinkmany $DIR/$tdir-1/$tfile- 50 || error "unlinkmany failed"
+	unlinkmany $MOUNT2/$tdir-2/$tfile- 50 || error "unlinkmany failed"
+	fail $SINGLEMDS
+
+	status=$(do_facet $SINGLEMDS $LCTL get_param -n $param)
+	echo "$status"
+	for field in replayed_parallel replay_waits replay_barriers \
+		     replay_rate; do
+		echo "$status" | grep -q "^$field:" ||
+			error "$field missing from recovery_status"
+	done
+	parallel=$(echo "$status" | awk '/^replayed_parallel:/ { print $2 }')
+	[ ${parallel:-0} -gt 0 ] || error "nothing was replayed in parallel"
+
+	# fail again before the replayed transactions are synced: clients must
+	# not have dropped any replay the MDS had not committed
+	replay_barrier_nosync $SINGLEMDS
+	fail $SINGLEMDS
+
+	unlinkmany $DIR/$tdir-1/$tfile- 50 50 ||
+		error "files lost on $MOUNT after parallel replay"
+	unlinkmany $MOUNT2/$tdir-2/$tfile- 50 50 ||
+		error "files lost on $MOUNT2 after parallel replay"
+	umount_client $MOUNT2
+}
+run_test 91 "parallel replay of two clients survives a second failure"
+
+committed_opens() {
+	$LCTL get_param -n mdc.${FSNAME}-MDT0000-mdc-*.import |
+		awk '/committed_list:/ { print $2 }'
+}
+
+test_92() {
+	local nfiles=200
+	local before
+	local cnt
+	local pid
+
+	mkdir -p $DIR/$tdir
+	createmany -o $DIR/$tdir/$tfile- $nfiles || error "createmany failed"
+	before=$(committed_opens)
+
+	# keep all the files open from one process
+	(
+		for i in $(seq 0 $((nfiles - 1))); do
+			eval "exec $((i + 10))<$DIR/$tdir/$tfile-$i"
+		done
+		exec sleep 600
+	) &
+	pid=$!
+	sleep 2
+	do_facet $SINGLEMDS "sync; sleep 5; sync"
+	$LFS df $DIR > /dev/null	# get last_committed from the MDS
+
+	cnt=$(committed_opens)
+	echo "committed opens: $before before, $cnt with files open"
+	[ $((cnt - before)) -ge $nfiles ] ||
+		error "expect >= $nfiles more committed opens, got $cnt"
+
+	fail $SINGLEMDS
+	cnt=$(committed_opens)
+	[ $((cnt - before)) -ge $nfiles ] ||
+		error "expect >= $nfiles committed opens after replay, got $cnt"
+
+	kill -9 $pid
+	wait $pid
+	cnt=$(committed_opens)
+	[ $cnt -le $before ] ||
+		error "$cnt committed opens left after close, expect $before"
+	unlinkmany $DIR/$tdir/$tfile- $nfiles || error "unlinkmany failed"
+}
+run_test 92 "import counts retained open requests"
+
+test_93() {
+	local count=20
+
+	$LCTL get_param -n mdc.*.connect_flags | grep -q md_batch ||
+		{ skip "MDS does not support batched reint" && return 0; }
+
+	mkdir -p $DIR/$tdir
+	createmany -o $DIR/$tdir/f $count || error "createmany failed"
+
+	# the resent batch gets the results of the first attempt, the
+	# unlinks done by it do not fail with -ENOENT the second time
+#define OBD_FAIL_MDS_REINT_NET_REP       0x119
+	do_facet $SINGLEMDS "lctl set_param fail_loc=0x80000119"
+	unlinkmany -b $DIR/$tdir/f $count || error "resent bulk unlink failed"
+	do_facet $SINGLEMDS "lctl set_param fail_loc=0"
+	[ -z "$(ls -A $DIR/$tdir)" ] || error "$DIR/$tdir not empty"
+	rm -rf $DIR/$tdir
+}
+run_test 93 "resent batched unlink is reconstructed"
+
 complete $SECONDS
 check_and_cleanup_lustre
 exit_status
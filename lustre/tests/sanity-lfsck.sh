@@ -956,6 +956,48 @@ test_10()
 }
 run_test 10 "System is available during LFSCK scanning"
 
+test_11()
+{
+	lfsck_prep 10 10
+	echo "start $SINGLEMDS"
+	start $SINGLEMDS $MDT_DEVNAME $MOUNT_OPTS_SCRUB > /dev/null ||
+		error "(1) Fail to start MDS!"
+
+	mount_client $MOUNT || error "(2) Fail to start client!"
+
+	#define OBD_FAIL_LFSCK_LINKEA_CRASH	0x1603
+	do_facet $SINGLEMDS $LCTL set_param fail_loc=0x1603
+	for ((i=0; i<20; i++)); do
+		mkdir -p $DIR/$tdir/c${i}
+		touch $DIR/$tdir/c${i}/f0
+	done
+
+	do_facet $SINGLEMDS $LCTL set_param fail_loc=0
+	umount_client $MOUNT
+
+	do_facet $SINGLEMDS $LCTL set_param -n mdd.${MDT_DEV}.lfsck_threads 4
+	$START_NAMESPACE || error "(3) Fail to start LFSCK for namespace!"
+
+	sleep 5
+	local STATUS=$($SHOW_NAMESPACE | awk '/^status/ { print $2 }')
+	do_facet $SINGLEMDS $LCTL set_param -n mdd.${MDT_DEV}.lfsck_threads 0
+	[ "$STATUS" == "completed" ] ||
+		error "(4) Expect 'completed', but got '$STATUS'"
+
+	local repaired=$($SHOW_NAMESPACE |
+			 awk '/^updated_phase1/ { print $2 }')
+	[ $repaired -eq 40 ] ||
+		error "(5) Fail to repair crashed linkEA: $repaired"
+
+	local failed=$($SHOW_NAMESPACE | awk '/^failed_phase1/ { print $2 }')
+	[ $failed -eq 0 ] || error "(6) Expect 0 failed, but got '$failed'"
+
+	local threads=$($SHOW_NAMESPACE | awk '/^last_threads/ { print $2 }')
+	[ -n "$threads" ] && [ $threads -ge 2 ] ||
+		error "(7) Expect at least 2 helper threads, got '$threads'"
+}
+run_test 11 "LFSCK traverses directories with multiple threads"
+
 $LCTL set_param debug=-lfsck > /dev/null || true
 
 # restore MDS/OST size
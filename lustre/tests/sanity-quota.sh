@@ -2330,6 +2330,47 @@ test_36() {
 }
 run_test 36 "Migrate old admin files into new global indexes"
 
+# quota slave acquire statistics and per-ID local cache
+test_37() {
+	local LIMIT=100 # 100MB
+	local TESTFILE="$DIR/$tdir/$tfile"
+	local osd=osd-$(facet_fstype ost1).$(facet_svc ost1)
+	local stats
+	local reqs
+
+	setup_quota_test
+	trap cleanup_quota_test EXIT
+
+	set_ost_qtype "u" || error "enable ost quota failed"
+
+	$LFS setquota -u $TSTUSR -b 0 -B ${LIMIT}M -i 0 -I 0 $DIR ||
+		error "set quota failed"
+
+	$LFS setstripe $TESTFILE -i 0 -c 1 || error "setstripe $TESTFILE failed"
+	chown $TSTUSR.$TSTUSR $TESTFILE
+
+	do_facet ost1 $LCTL set_param -n $osd.quota_slave.stats=clear
+	$RUNAS $DD of=$TESTFILE count=$((LIMIT / 2)) || error "write failed"
+	cancel_lru_locks osc
+	sync_all_data || true
+
+	stats=$(do_facet ost1 $LCTL get_param -n $osd.quota_slave.stats)
+	echo "$stats"
+	reqs=$(echo "$stats" |
+		awk '/^(dqacq|dqacq_batch) / { sum += $2 } END { print sum + 0 }')
+	[ $reqs -gt 0 ] || error "no acquire request accounted"
+	echo "$stats" | grep -q "^local_hit " ||
+		error "no operation served from local quota space"
+
+	do_facet ost1 $LCTL get_param -n $osd.quota_slave.id_cache_user |
+		grep -A2 "id:.*$TSTID\b" | grep -q "hit_rate:" ||
+		error "$TSTUSR missing from quota ID cache"
+
+	cleanup_quota_test
+	resetquota -u $TSTUSR
+}
+run_test 37 "Quota slave acquire statistics and ID cache"
+
 quota_fini()
 {
         do_nodes $(comma_list $(nodes_list)) "lctl set_param debug=-quota"
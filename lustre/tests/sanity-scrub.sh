@@ -898,6 +898,88 @@ test_15() {
 }
 run_test 15 "Dryrun mode OI scrub"
 
+test_16() {
+	scrub_prep 100
+	mds_backup_restore || error "(1) Fail to backup/restore!"
+
+	echo "starting MDTs with OI scrub disabled"
+	start $SINGLEMDS $MDT_DEVNAME $MOUNT_OPTS_NOSCRUB > /dev/null ||
+		error "(2) Fail to start MDS!"
+
+	local FLAGS=$($SHOW_SCRUB | awk '/^flags/ { print $2 }')
+	[ "$FLAGS" == "inconsistent" ] ||
+		error "(3) Expect 'inconsistent', but got '$FLAGS'"
+
+	do_facet $SINGLEMDS \
+		$LCTL set_param -n osd-ldiskfs.${MDT_DEV}.oi_scrub_threads 4
+	$START_SCRUB || error "(4) Fail to start OI scrub!"
+	sleep 5
+
+	local STATUS=$($SHOW_SCRUB | awk '/^status/ { print $2 }')
+	do_facet $SINGLEMDS \
+		$LCTL set_param -n osd-ldiskfs.${MDT_DEV}.oi_scrub_threads 1
+	[ "$STATUS" == "completed" ] ||
+		error "(5) Expect 'completed', but got '$STATUS'"
+
+	FLAGS=$($SHOW_SCRUB | awk '/^flags/ { print $2 }')
+	[ -z "$FLAGS" ] || error "(6) Expect empty flags, but got '$FLAGS'"
+
+	local REPAIRED=$($SHOW_SCRUB | awk '/^updated/ { print $2 }')
+	[ $REPAIRED -lt 100 ] &&
+		error "(7) Expect at least 100 updated, but got '$REPAIRED'"
+
+	local THREADS=$($SHOW_SCRUB | awk '/^last_threads/ { print $2 }')
+	[ -n "$THREADS" ] && [ $THREADS -ge 2 ] ||
+		error "(8) Expect at least 2 threads checked, got '$THREADS'"
+
+	mount_client $MOUNT || error "(9) Fail to start client!"
+	local i
+	for ((i=0; i<100; i++)); do
+		stat $DIR/$tdir/$tfile$i > /dev/null ||
+			error "(10) Fail to stat $tfile$i!"
+	done
+	umount_client $MOUNT
+}
+run_test 16 "OI scrub with multiple threads"
+
+test_17() {
+	scrub_prep 100
+	echo "start $SINGLEMDS"
+	start $SINGLEMDS $MDT_DEVNAME $MOUNT_OPTS_SCRUB > /dev/null ||
+		error "(1) Fail to start MDS!"
+
+	local OI_CACHE="do_facet $SINGLEMDS \
+		$LCTL get_param -n osd-ldiskfs.${MDT_DEV}.oi_cache"
+	local SIZE=$($OI_CACHE | awk '/^size/ { print $2 }')
+	[ $SIZE -gt 0 ] || error "(2) Expect enabled OI cache, but got '$SIZE'"
+
+	local HITS1=$($OI_CACHE | awk '/^hits/ { print $2 }')
+	local i
+	for ((i=0; i<2; i++)); do
+		mount_client $MOUNT || error "(3) Fail to start client!"
+		ls -l $DIR/$tdir > /dev/null || error "(4) Fail to ls!"
+		umount_client $MOUNT
+	done
+
+	local HITS2=$($OI_CACHE | awk '/^hits/ { print $2 }')
+	[ $HITS2 -gt $HITS1 ] ||
+		error "(5) Expect more than $HITS1 hits, but got '$HITS2'"
+
+	do_facet $SINGLEMDS \
+		$LCTL set_param -n osd-ldiskfs.${MDT_DEV}.oi_cache_size 0
+	mount_client $MOUNT || error "(6) Fail to start client!"
+	ls -l $DIR/$tdir > /dev/null || error "(7) Fail to ls!"
+	rm -f $DIR/$tdir/${tfile}1 || error "(8) Fail to unlink!"
+	umount_client $MOUNT
+
+	local HITS3=$($OI_CACHE | awk '/^hits/ { print $2 }')
+	do_facet $SINGLEMDS \
+		$LCTL set_param -n osd-ldiskfs.${MDT_DEV}.oi_cache_size $SIZE
+	[ $HITS3 -eq $HITS2 ] ||
+		error "(9) Expect $HITS2 hits when disabled, but got '$HITS3'"
+}
+run_test 17 "FID-to-inode cache for OI lookup"
+
 # restore MDS/OST size
 MDSSIZE=${SAVED_MDSSIZE}
 OSTSIZE=${SAVED_OSTSIZE}
@@ -7724,6 +7724,41 @@ test_124b() {
 }
 run_test 124b "lru resize (performance test) ======================="
 
+test_124c() {
+	$LCTL get_param -n ldlm.bl_pools > /dev/null 2>&1 ||
+		{ skip "no ldlm.bl_pools" && return 0; }
+	local pools=$(get_param_field client ldlm.bl_pools total | wc -l)
+	[ $pools -gt 1 ] ||
+		{ skip "only one blocking callback pool" && return 0; }
+
+	test_mkdir -p $DIR/$tdir
+	createmany -o $DIR/$tdir/f 100 || error "createmany failed"
+	cancel_lru_locks mdc
+	ls -l $DIR/$tdir > /dev/null || error "ls -l $DIR/$tdir failed"
+
+	# without early lock cancel each chmod makes the MDS call back the
+	# lock taken by ls on that file, one callback per resource
+	$LCTL set_param ldlm.namespaces.*mdc*.early_lock_cancel=0
+	local before=($(get_param_field client ldlm.bl_pools total))
+	chmod 0600 $DIR/$tdir/f*
+	local rc=$?
+	local after=($(get_param_field client ldlm.bl_pools total))
+	$LCTL set_param ldlm.namespaces.*mdc*.early_lock_cancel=1
+	$LCTL get_param ldlm.bl_pools
+	[ $rc -eq 0 ] || error "chmod failed"
+
+	local used=0
+	local i
+
+	for ((i = 0; i < ${#after[@]}; i++)); do
+		[ ${after[i]} -gt ${before[i]} ] && used=$((used + 1))
+	done
+	[ $used -gt 1 ] ||
+		error "callbacks on 100 resources went to $used of $pools pools"
+	unlinkmany $DIR/$tdir/f 100
+}
+run_test 124c "blocking callbacks are spread over the CPT pools"
+
 test_125() { # 13358
 	[ -z "$(lctl get_param -n llite.*.client_type | grep local)" ] && skip "must run as local client" && return
 	[ -z "$(lctl get_param -n mdc.*-mdc-*.connect_flags | grep acl)" ] && skip "must have acl enabled" && return
@@ -7826,6 +7861,64 @@ test_127b() { # bug LU-333
 }
 run_test 127b "verify the llite client stats are sane"
 
+test_127c() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	local lat_param=$($LCTL list_param osc.*0000-osc-*.latency_stats \
+			  2>/dev/null | head -1)
+	[ -z "$lat_param" ] && skip "no osc latency_stats" && return
+
+	$SETSTRIPE -i 0 -c 1 $DIR/$tfile || error "setstripe failed"
+	$LCTL set_param $lat_param=0
+	dd if=/dev/zero of=$DIR/$tfile bs=1M count=4 oflag=sync ||
+		error "dd write failed"
+	cancel_lru_locks osc
+	dd if=$DIR/$tfile of=/dev/null bs=1M || error "dd read failed"
+
+	$LCTL get_param -n $lat_param | grep samples > $TMP/${tfile}.tmp
+	while read NAME COUNT SAMP UNIT P50N P50 P90N P90 P99N P99 P999N P999 \
+		   MAXN MAX; do
+		echo "got $COUNT $NAME p50 $P50 p99 $P99 p99.9 $P999 max $MAX"
+		eval $NAME=$COUNT || error "Wrong proc format"
+		[ $P50 -le $P90 ] || error "$NAME p50 $P50 > p90 $P90"
+		[ $P90 -le $P99 ] || error "$NAME p90 $P90 > p99 $P99"
+		[ $P99 -le $P999 ] || error "$NAME p99 $P99 > p99.9 $P999"
+		[ $P999 -le $MAX ] || error "$NAME p99.9 $P999 > max $MAX"
+	done < $TMP/${tfile}.tmp
+	rm -f $TMP/${tfile}.tmp
+
+	[ "$ost_read" ] || error "Missing ost_read latency"
+	[ "$ost_write" ] || error "Missing ost_write latency"
+	$LCTL get_param osc.*0000-osc-*.rpc_stats | grep -q "^p99.9:" ||
+		error "Missing latency percentiles in rpc_stats"
+}
+run_test 127c "verify the client latency histograms are sane"
+
+test_127d() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	[ -r /proc/fs/lustre/stats_export ] ||
+		{ skip "no binary stats export" && return; }
+	which $LSTATS_DECODE > /dev/null 2>&1 ||
+		{ skip "no $LSTATS_DECODE" && return; }
+
+	$LCTL set_param -n llite.*.stats=0
+	dd if=/dev/zero of=$DIR/$tfile bs=64k count=4 || error "dd failed"
+
+	local text=$($LCTL get_param -n llite.*.stats |
+		     awk '/^write_bytes/ { print $2 }' | head -1)
+	local bin=$($LSTATS_DECODE 'llite/*/stats' |
+		    awk '/^write_bytes/ { print $2 }' | head -1)
+	echo "write_bytes: text $text binary $bin"
+	[ -n "$bin" ] || error "no write_bytes in binary export"
+	[ "$text" == "$bin" ] ||
+		error "binary export $bin differs from text stats $text"
+
+	$LSTATS_DECODE 'osc/*/rpc_stats.write_pages_per_rpc' | grep -q '\[0\]' ||
+		error "rpc_stats histograms missing from binary export"
+	$LSTATS_DECODE 'mdc/*/latency_stats' | grep -q ' p99 ' ||
+		error "mdc latency histograms missing from binary export"
+}
+run_test 127d "verify the binary stats export matches the text stats"
+
 test_128() { # bug 15212
 	touch $DIR/$tfile
 	$LFS 2>&1 <<-EOF | tee $TMP/$tfile.log
@@ -8628,6 +8721,93 @@ test_133f() {
 }
 run_test 133f "Check for LBUGs/Oopses/unreadable files in /proc"
 
+test_133g() {
+	local param=mds.MDS.mdt.reply_pool
+
+	do_facet $SINGLEMDS $LCTL get_param -n $param > /dev/null 2>&1 ||
+		{ skip "no mdt reply_pool" && return 0; }
+
+	test_mkdir -p $DIR/$tdir
+	createmany -o $DIR/$tdir/f 100 || error "createmany failed"
+
+	# getattr replies are released once sent, unlike replies to changes
+	# which wait for their commit. With statahead off they are sent one
+	# at a time, so no pass needs more than the first one left cached.
+	local sa_max=$($LCTL get_param -n llite.*.statahead_max | head -n 1)
+	$LCTL set_param -n llite.*.statahead_max=0
+	cancel_lru_locks mdc
+	ls -l $DIR/$tdir > /dev/null || error "ls -l $DIR/$tdir failed"
+
+	local hits1=$(get_param_field $SINGLEMDS $param hits | calc_sum)
+	local misses1=$(get_param_field $SINGLEMDS $param misses | calc_sum)
+	local i
+
+	for i in 1 2 3; do
+		cancel_lru_locks mdc
+		ls -l $DIR/$tdir > /dev/null || error "ls -l $DIR/$tdir failed"
+	done
+	local hits2=$(get_param_field $SINGLEMDS $param hits | calc_sum)
+	local misses2=$(get_param_field $SINGLEMDS $param misses | calc_sum)
+	$LCTL set_param -n llite.*.statahead_max=$sa_max
+	do_facet $SINGLEMDS $LCTL get_param $param
+
+	[ $((hits2 - hits1)) -ge 300 ] ||
+		error "reply states not reused: hits $hits1 -> $hits2"
+	# leave room for a ping or two
+	[ $((misses2 - misses1)) -le 2 ] ||
+		error "reply states allocated: misses $misses1 -> $misses2"
+	unlinkmany $DIR/$tdir/f 100
+}
+run_test 133g "MDT reply states are reused without new allocations"
+
+test_133h() {
+	local param=mds.MDS.mdt
+
+	do_facet $SINGLEMDS $LCTL get_param -n $param.req_buffers \
+		> /dev/null 2>&1 ||
+		{ skip "no mdt req_buffers" && return 0; }
+
+	local ncpts=$(get_param_field $SINGLEMDS $param.req_buffers size |
+		      wc -l)
+	[ $ncpts -gt 0 ] || error "req_buffers has no partition lines"
+	local hist_max=$(do_facet $SINGLEMDS $LCTL get_param -n \
+			 $param.req_history_max)
+	local hist=$TMP/$tfile.history
+
+	# keep only a few buffers of history per partition, so that the
+	# requests below send the buffers through the history and back to
+	# LNet many times over
+	do_facet $SINGLEMDS $LCTL set_param -n \
+		$param.req_history_max=$((ncpts * 4))
+	test_mkdir -p $DIR/$tdir
+	createmany -m $DIR/$tdir/f 4000 || error "createmany failed"
+	unlinkmany $DIR/$tdir/f 4000 || error "unlinkmany failed"
+	do_facet $SINGLEMDS $LCTL get_param -n $param.req_history > $hist
+	do_facet $SINGLEMDS $LCTL set_param -n \
+		$param.req_history_max=$hist_max
+	do_facet $SINGLEMDS $LCTL get_param $param.req_buffers
+
+	local nreq=$(wc -l < $hist)
+	[ $nreq -gt 0 -a $nreq -lt 8000 ] ||
+		error "$nreq requests in history, buffers not recycled"
+	[ $(cut -d: -f1 $hist | sort -u | wc -l) -eq $nreq ] ||
+		error "requests listed twice in history"
+	# the history still shows the messages received, not whatever a
+	# recycled buffer holds now
+	local bad=$(awk '$(NF - 1) == "opc" {
+			o = $NF
+			if (!((o >= 33 && o <= 61) || (o >= 101 && o <= 107) ||
+			      o == 400 || (o >= 501 && o <= 509) ||
+			      (o >= 601 && o <= 603) || o == 700 || o == 900))
+				print
+		}' $hist)
+	[ -z "$bad" ] || error "bad opcodes in history: $bad"
+	# MDS_REINT, the unlinks last handled
+	grep -q "opc 36$" $hist || error "unlinks missing from history"
+	rm -f $hist
+}
+run_test 133h "MDT request history survives buffer recycling"
+
 test_140() { #bug-17379
 	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
         test_mkdir -p $DIR/$tdir || error "Creating dir $DIR/$tdir"
@@ -9450,6 +9630,98 @@ test_160b() { # LU-3587
 }
 run_test 160b "Verify that very long rename doesn't crash in changelog"
 
+test_160c() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	remote_mds_nodsh && skip "remote MDS with nodsh" && return
+
+	local CL_STATS="mdd.$MDT0.changelog_stats"
+	local before
+	local after
+
+	USER=$(do_facet $SINGLEMDS $LCTL --device $MDT0 changelog_register -n)
+	echo "Registered as changelog user $USER"
+
+	before=$(do_facet $SINGLEMDS $LCTL get_param -n $CL_STATS |
+		 awk '/^records:/ { print $2 }')
+	test_mkdir -p $DIR/$tdir
+	createmany -o $DIR/$tdir/f 100 || error "createmany failed"
+	unlinkmany $DIR/$tdir/f 100 || error "unlinkmany failed"
+	do_facet $SINGLEMDS $LCTL get_param $CL_STATS
+	after=$(do_facet $SINGLEMDS $LCTL get_param -n $CL_STATS |
+		awk '/^records:/ { print $2 }')
+
+	do_facet $SINGLEMDS $LCTL --device $MDT0 changelog_deregister $USER
+
+	[ $((after - before)) -ge 200 ] ||
+		error "only $((after - before)) records counted, expected 200"
+}
+run_test 160c "changelog catalog append statistics"
+
+test_160d() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	remote_mds_nodsh && skip "remote MDS with nodsh" && return
+
+	local CL_USERS="mdd.$MDT0.changelog_users"
+	local fid
+	local lag
+
+	USER=$(do_facet $SINGLEMDS $LCTL --device $MDT0 changelog_register -n)
+	echo "Registered as changelog user $USER"
+
+	test_mkdir -p $DIR/$tdir
+	touch $DIR/$tdir/f1 $DIR/$tdir/f2
+	mkdir $DIR/$tdir/d1
+	rm $DIR/$tdir/f2
+	fid=$($LFS path2fid $DIR/$tdir)
+
+	$LFS changelog --type MKDIR $MDT0 | grep -v "MKDIR" &&
+		error "--type MKDIR showed other records"
+	$LFS changelog --type MKDIR $MDT0 | grep -q "d1" ||
+		error "--type MKDIR did not show d1"
+	[ $($LFS changelog --type CREAT,UNLNK --fid $fid $MDT0 | wc -l) \
+		-eq 3 ] || error "--type CREAT,UNLNK --fid $fid: wrong count"
+
+	lag=$(do_facet $SINGLEMDS $LCTL get_param -n $CL_USERS |
+	      awk "/^$USER / { print \$3 }")
+	echo "user $USER lag $lag"
+	[ -n "$lag" ] && [ $lag -ge 4 ] || error "wrong lag '$lag' for $USER"
+
+	do_facet $SINGLEMDS $LCTL --device $MDT0 changelog_deregister $USER
+}
+run_test 160d "changelog filtering and per-user lag"
+
+test_160e() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
+	remote_mds_nodsh && skip "remote MDS with nodsh" && return
+
+	local first
+	local last
+	local mid
+	local recs
+
+	USER=$(do_facet $SINGLEMDS $LCTL --device $MDT0 changelog_register -n)
+	echo "Registered as changelog user $USER"
+
+	test_mkdir -p $DIR/$tdir
+	createmany -o $DIR/$tdir/f 100 || error "createmany failed"
+
+	# a full read fills in the mdc start position index
+	first=$($LFS changelog $MDT0 | head -1 | awk '{ print $1 }')
+	last=$($LFS changelog $MDT0 | tail -1 | awk '{ print $1 }')
+	mid=$(((first + last) / 2))
+	echo "records $first-$last, reading from $mid"
+
+	recs=$($LFS changelog $MDT0 $mid | awk '{ print $1 }')
+	[ "$(echo "$recs" | head -1)" == "$mid" ] ||
+		error "read from $mid started at $(echo "$recs" | head -1)"
+	[ $(echo "$recs" | wc -l) -eq $((last - mid + 1)) ] ||
+		error "read from $mid missed records"
+
+	do_facet $SINGLEMDS $LCTL --device $MDT0 changelog_deregister $USER
+	rm -rf $DIR/$tdir
+}
+run_test 160e "changelog read from a start record"
+
 test_161a() {
 	[ $PARALLEL == "yes" ] && skip "skip parallel run" && return
     test_mkdir -p $DIR/$tdir
@@ -10665,6 +10937,10 @@ test_205() { # Job stats
 	# write
 	cmd="dd if=/dev/zero of=$DIR/$tfile bs=1M count=1 oflag=sync"
 	verify_jobstats "$cmd" "ost"
+	do_facet ost1 lctl get_param -n obdfilter.*.job_stats |
+		grep -A 20 "job_id:.*$JOBVAL" |
+		grep -q "bulk_time:.*samples: *[1-9]" ||
+		error "No bulk time accounted on OST for $JOBVAL"
 	# read
 	cmd="dd if=$DIR/$tfile of=/dev/null bs=1M count=1 iflag=direct"
 	verify_jobstats "$cmd" "ost"
@@ -11558,6 +11834,204 @@ test_233() {
 }
 run_test 233 "checking that OBF of the FS root succeeds"
 
+test_234() {
+	local nfiles=20000
+	local name=$(printf "%0200d" 0)
+	local ra=$($LCTL get_param -n llite.*.dir_readahead | head -1)
+	local before
+	local after
+	local cnt
+
+	mkdir -p $DIR/$tdir
+	createmany -m $DIR/$tdir/$name $nfiles ||
+		error "createmany $nfiles failed"
+
+	$LCTL set_param -n llite.*.dir_readahead=0
+	cancel_lru_locks mdc
+	ls -f $DIR/$tdir | sort > $TMP/$tfile.nora
+	$LCTL set_param -n llite.*.dir_readahead=1
+	cancel_lru_locks mdc
+	before=$($LCTL get_param -n llite.*.statahead_stats |
+		 awk '/dir readahead total:/ { sum += $4 } END { print sum }')
+	ls -f $DIR/$tdir | sort > $TMP/$tfile.ra
+	after=$($LCTL get_param -n llite.*.statahead_stats |
+		awk '/dir readahead total:/ { sum += $4 } END { print sum }')
+	$LCTL set_param -n llite.*.dir_readahead=$ra
+
+	cnt=$(grep -c $name $TMP/$tfile.ra)
+	[ $cnt -eq $nfiles ] || error "found $cnt entries, expect $nfiles"
+	diff $TMP/$tfile.nora $TMP/$tfile.ra ||
+		error "listing differs with dir_readahead"
+	echo "dir readahead started $((after - before)) times"
+	[ $after -gt $before ] || error "dir readahead was never started"
+	rm -f $TMP/$tfile.nora $TMP/$tfile.ra
+	unlinkmany $DIR/$tdir/$name $nfiles || error "unlinkmany failed"
+}
+run_test 234 "readdir-ahead lists a large directory correctly"
+
+test_235() {
+	[ -z "$(which aiobench 2>/dev/null)" ] &&
+		skip_env "could not find aiobench" && return
+
+	local size=256M
+	local depth
+	local before
+	local after
+	local sum
+	local sum1
+
+	before=$($LCTL get_param -n llite.*.dio_aio_stats |
+		 awk '/^total:/ { sum += $2 } END { print sum }')
+	for depth in 1 32; do
+		# a new file each time, so the data read back at depth 32 is
+		# the data written at depth 32
+		rm -f $DIR/$tfile
+		$SETSTRIPE -c -1 $DIR/$tfile ||
+			error "setstripe $DIR/$tfile failed"
+		cancel_lru_locks osc
+		aiobench -w -q $depth -s $size $DIR/$tfile ||
+			error "async direct write at depth $depth failed"
+		cancel_lru_locks osc
+		aiobench -r -q 1 -s $size $DIR/$tfile ||
+			error "data written at depth $depth is wrong"
+		cancel_lru_locks osc
+		aiobench -r -q $depth -s $size $DIR/$tfile ||
+			error "async direct read at depth $depth failed"
+
+		# and through the page cache as well
+		cancel_lru_locks osc
+		sum=$(md5sum < $DIR/$tfile)
+		[ $depth -eq 1 ] && sum1=$sum
+		[ "$sum" == "$sum1" ] ||
+			error "checksum at depth $depth differs from depth 1"
+	done
+	$LCTL get_param llite.*.dio_aio_stats
+	after=$($LCTL get_param -n llite.*.dio_aio_stats |
+		awk '/^total:/ { sum += $2 } END { print sum }')
+	[ $after -gt $before ] ||
+		error "no async direct I/O was queued: $before -> $after"
+	rm -f $DIR/$tfile
+}
+run_test 235 "async direct I/O with queue depth 1 and 32"
+
+test_236() {
+	[ $OSTCOUNT -lt 2 ] && skip "needs >= 2 OSTs" && return
+
+	local pdio=$($LCTL get_param -n llite.*.parallel_dio | head -1)
+	local size=$((OSTCOUNT * 4))
+	local val
+
+	dd if=/dev/urandom of=$TMP/$tfile bs=1M count=$size ||
+		error "dd to $TMP/$tfile failed"
+	$SETSTRIPE -c -1 -S 1M $DIR/$tfile || error "setstripe failed"
+
+	for val in 0 1; do
+		$LCTL set_param -n llite.*.parallel_dio=$val
+		cancel_lru_locks osc
+		dd if=$TMP/$tfile of=$DIR/$tfile bs=${size}M count=1 \
+			oflag=direct conv=notrunc 2>&1 | tail -1
+		[ ${PIPESTATUS[0]} -eq 0 ] ||
+			error "direct write with parallel_dio=$val failed"
+		cancel_lru_locks osc
+		cmp $TMP/$tfile $DIR/$tfile ||
+			error "data differs after parallel_dio=$val write"
+		dd if=$DIR/$tfile of=$TMP/$tfile.2 bs=${size}M count=1 \
+			iflag=direct 2>&1 | tail -1
+		[ ${PIPESTATUS[0]} -eq 0 ] ||
+			error "direct read with parallel_dio=$val failed"
+		cmp $TMP/$tfile $TMP/$tfile.2 ||
+			error "data differs after parallel_dio=$val read"
+	done
+	$LCTL set_param -n llite.*.parallel_dio=$pdio
+	rm -f $DIR/$tfile $TMP/$tfile $TMP/$tfile.2
+}
+run_test 236 "direct I/O across all stripes at once"
+
+test_237() {
+	local count=1000
+	local batch=false
+
+	$LCTL get_param -n mdc.*.connect_flags | grep -q md_batch &&
+		batch=true
+	$batch && $LCTL set_param -n mdc.*.batch_stats=0
+
+	test_mkdir -p $DIR/$tdir
+	createmany -o $DIR/$tdir/f $count || error "createmany failed"
+	unlinkmany -b $DIR/$tdir/f $count || error "bulk unlink failed"
+	[ -z "$(ls -A $DIR/$tdir)" ] || error "$DIR/$tdir not empty"
+
+	# names which are not there any more just fail
+	touch $DIR/$tdir/f0
+	unlinkmany -b $DIR/$tdir/f 2 && error "unlink of missing f1 succeeded"
+	[ -e $DIR/$tdir/f0 ] && error "$DIR/$tdir/f0 still exists"
+
+	if $batch; then
+		$LCTL get_param mdc.*.batch_stats
+		local rpcs=$($LCTL get_param -n mdc.*.batch_stats |
+			     awk '/^[0-9]+:/ { sum += $2 } END { print sum + 0 }')
+		[ $rpcs -gt 0 ] || error "no batched unlink RPC was sent"
+		[ $rpcs -lt $count ] || error "$rpcs RPCs for $count unlinks"
+	fi
+	rm -rf $DIR/$tdir
+}
+run_test 237 "bulk unlink of many files in a directory"
+
+mdc_close_count() {
+	$LCTL get_param -n mdc.*.stats |
+		awk '/^mds_close/ { sum += $2 } END { print sum + 0 }'
+}
+
+test_238() {
+	local age=$($LCTL get_param -n llite.*.open_cache_age | head -1)
+	local count=10
+
+	$LCTL set_param -n llite.*.open_cache_age=30
+	dd if=/dev/zero of=$DIR/$tfile bs=4k count=1 ||
+		error "cannot write $DIR/$tfile"
+	cancel_lru_locks mdc
+
+	local closes=$(mdc_close_count)
+	for i in $(seq $count); do
+		cat $DIR/$tfile > /dev/null || error "cannot read $DIR/$tfile"
+	done
+	$LCTL get_param llite.*.open_cache_stats
+	local hits=$($LCTL get_param -n llite.*.open_cache_stats |
+		     awk '/^hits:/ { sum += $2 } END { print sum + 0 }')
+	[ $hits -ge $((count - 1)) ] ||
+		error "$hits open cache hits for $count opens"
+	[ $(mdc_close_count) -eq $closes ] ||
+		error "open handle closed while it was cached"
+
+	# exec handles are not kept, writers would get ETXTBSY
+	cp /bin/true $DIR/$tfile.exe || error "cannot copy /bin/true"
+	$DIR/$tfile.exe || error "cannot run $DIR/$tfile.exe"
+	cat /bin/true > $DIR/$tfile.exe ||
+		error "cannot write $DIR/$tfile.exe after it exited"
+	rm -f $DIR/$tfile.exe
+
+	# disabling the cache releases all handles it has
+	$LCTL set_param -n llite.*.open_cache_age=0
+	sleep 3
+	local cached=$($LCTL get_param -n llite.*.open_cache_stats |
+		       awk '/^cached:/ { sum += $2 } END { print sum + 0 }')
+	[ $cached -eq 0 ] || error "$cached handles still cached"
+	[ $(mdc_close_count) -gt $closes ] || error "cached handle not closed"
+
+	# the first handle cached in an empty cache is released once it is
+	# old enough, the close thread must not sleep through it
+	$LCTL set_param -n llite.*.open_cache_age=2
+	closes=$(mdc_close_count)
+	cat $DIR/$tfile > /dev/null || error "cannot read $DIR/$tfile"
+	sleep 5
+	cached=$($LCTL get_param -n llite.*.open_cache_stats |
+		 awk '/^cached:/ { sum += $2 } END { print sum + 0 }')
+	$LCTL set_param -n llite.*.open_cache_age=$age
+	[ $cached -eq 0 ] || error "$cached handles cached after they expired"
+	[ $(mdc_close_count) -gt $closes ] || error "expired handle not closed"
+	rm -f $DIR/$tfile
+}
+run_test 238 "repeated opens reuse the cached open handle"
+
 #
 # tests that do cleanup/setup should be run at the end
 #
@@ -2470,6 +2470,41 @@ test_71() {
 }
 run_test 71 "correct file map just after write operation is finished"
 
+test_72() { # batched blocking ASTs
+	$LCTL get_param -n mdc.$FSNAME-MDT0000-mdc-*.connect_flags |
+		grep -q bl_batch ||
+		{ skip "MDS does not send batched blocking ASTs"; return 0; }
+
+	mkdir -p $DIR1/$tdir
+	for i in $(seq 10); do
+		echo data > $DIR1/$tdir/f$i || error "create f$i failed"
+	done
+	cancel_lru_locks mdc
+
+	do_facet $SINGLEMDS $LCTL set_param ldlm.bl_batch_stats=clear
+	$LCTL set_param ldlm.bl_batch_stats=clear
+
+	# get the layout lock apart from the getattr lock, so that the first
+	# mount holds several locks on each file
+#define OBD_FAIL_MDS_NO_LL_GETATTR	 0x170
+	do_facet $SINGLEMDS $LCTL set_param fail_loc=0x170
+	stat $DIR1/$tdir/f* > /dev/null || error "stat failed"
+	cat $DIR1/$tdir/f* > /dev/null || error "read failed"
+	do_facet $SINGLEMDS $LCTL set_param fail_loc=0
+
+	rm -rf $DIR2/$tdir || error "rm failed"
+	ls $DIR1/$tdir 2> /dev/null && error "$tdir is still on $MOUNT1"
+
+	do_facet $SINGLEMDS $LCTL get_param ldlm.bl_batch_stats
+	$LCTL get_param ldlm.bl_batch_stats
+
+	local batched=$(do_facet $SINGLEMDS \
+		$LCTL get_param -n ldlm.bl_batch_stats |
+		awk '/^[0-9]+:/ && $1 != "1:" { n += $2 } END { print n + 0 }')
+	[ $batched -gt 0 ] || error "no blocking AST carried several locks"
+}
+run_test 72 "blocking ASTs to one client are batched"
+
 log "cleanup: ======================================================"
 
 [ "$(mount | grep $MOUNT2)" ] && umount $MOUNT2
@@ -240,6 +240,8 @@ init_test_env() {
     fi
     export LL_DECODE_FILTER_FID=${LL_DECODE_FILTER_FID:-"$LUSTRE/utils/ll_decode_filter_fid"}
     [ ! -f "$LL_DECODE_FILTER_FID" ] && export LL_DECODE_FILTER_FID="ll_decode_filter_fid"
+    export LSTATS_DECODE=${LSTATS_DECODE:-"$LUSTRE/utils/lstats_decode"}
+    [ ! -f "$LSTATS_DECODE" ] && export LSTATS_DECODE="lstats_decode"
     export MKFS=${MKFS:-"$LUSTRE/utils/mkfs.lustre"}
     [ ! -f "$MKFS" ] && export MKFS="mkfs.lustre"
     export TUNEFS=${TUNEFS:-"$LUSTRE/utils/tunefs.lustre"}
@@ -5161,6 +5163,18 @@ calc_sum () {
         awk 'BEGIN {s = 0}; {s += $1}; END {print s}'
 }
 
+# print the value following the word $3 on each line of parameter $2 on
+# facet $1, i.e. one value per partition of the "cpt N: ..." stats files
+get_param_field() {
+	local facet=$1
+	local param=$2
+	local key=$3
+
+	do_facet $facet $LCTL get_param -n $param |
+		awk -v key=$key '{ for (i = 1; i < NF; i++)
+					if ($i == key) { print $(i + 1); break } }'
+}
+
 calc_osc_kbytes () {
         df $MOUNT > /dev/null
         $LCTL get_param -n osc.*[oO][sS][cC][-_][0-9a-f]*.$1 | calc_sum
@@ -41,16 +41,68 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <stdlib.h>
+#include <libgen.h>
+#include <lustre/lustreapi.h>
 
 void usage(char *prog)
 {
-	printf("usage: %s filenamefmt count\n", prog);
-	printf("       %s filenamefmt start count\n", prog);
+	printf("usage: %s [-d|-b] filenamefmt count\n", prog);
+	printf("       %s [-d|-b] filenamefmt start count\n", prog);
+	printf("\t-d: rmdir instead of unlink\n");
+	printf("\t-b: unlink in bulk, all files must be in one directory\n");
+}
+
+/* unlink all names at once with llapi_bulk_unlink() */
+static int unlink_bulk(const char *fmt, long begin, long count)
+{
+	char filename[4096], dir[4096];
+	char **names;
+	int *rcs;
+	long i;
+	int rc;
+
+	names = calloc(count, sizeof(*names));
+	rcs = calloc(count, sizeof(*rcs));
+	if (names == NULL || rcs == NULL) {
+		printf("cannot allocate %ld names\n", count);
+		return ENOMEM;
+	}
+
+	for (i = 0; i < count; i++) {
+		sprintf(filename, fmt, begin + i);
+		if (i == 0) {
+			strcpy(dir, filename);
+			strcpy(dir, dirname(dir));
+		}
+		names[i] = strdup(basename(filename));
+		if (names[i] == NULL) {
+			printf("cannot allocate %ld names\n", count);
+			return ENOMEM;
+		}
+	}
+
+	rc = llapi_bulk_unlink(dir, names, count, rcs);
+	if (rc < 0) {
+		printf("bulk unlink in %s error: %s\n", dir, strerror(-rc));
+		return -rc;
+	}
+
+	for (i = 0; i < count; i++) {
+		if (rcs[i] != 0) {
+			printf("unlink(%s/%s) error: %s\n", dir, names[i],
+			       strerror(-rcs[i]));
+			return -rcs[i];
+		}
+		free(names[i]);
+	}
+	free(names);
+	free(rcs);
+	return 0;
 }
 
 int main(int argc, char ** argv)
 {
-        int i, rc = 0, do_rmdir = 0;
+        int i, rc = 0, do_rmdir = 0, do_bulk = 0;
         char format[4096], *fmt;
         char filename[4096];
         long start, last;
@@ -65,6 +117,10 @@ int main(int argc, char ** argv)
 		do_rmdir = 1;
 		argv++;
 		argc--;
+	} else if (strcmp(argv[1], "-b") == 0) {
+		do_bulk = 1;
+		argv++;
+		argc--;
 	}
 
         if (strlen(argv[1]) > 4080) {
@@ -91,6 +147,14 @@ int main(int argc, char ** argv)
 		sprintf(format, "%s%%d", argv[1]);
 		fmt = format;
 	}
+	if (do_bulk) {
+		rc = unlink_bulk(fmt, begin, count);
+		if (rc == 0)
+			printf("total: %ld bulk unlinks in %ld seconds\n",
+			       count, time(0) - start);
+		return rc;
+	}
+
         for (i = 0; i < count; i++, begin++) {
                 sprintf(filename, fmt, begin);
 		if (do_rmdir)
@@ -263,7 +263,10 @@ command_t cmdlist[] = {
          "usage: ls [OPTION]... [FILE]..."},
         {"changelog", lfs_changelog, 0,
          "Show the metadata changes on an MDT."
-         "\nusage: changelog <mdtname> [startrec [endrec]]"},
+         "\nusage: changelog [--type TYPE[,TYPE...]] [--fid FID] <mdtname> "
+         "[startrec [endrec]]\n"
+         "\t--type: only show records of these types (e.g. CREAT,UNLNK)\n"
+         "\t--fid: only show records about this FID or its entries"},
         {"changelog_clear", lfs_changelog_clear, 0,
          "Indicate that old changelog records up to <endrec> are no longer of "
          "interest to consumer <id>, allowing the system to free up space.\n"
@@ -2884,10 +2887,17 @@ static int lfs_changelog(int argc, char **argv)
         long long startrec = 0, endrec = 0;
         char *mdd;
         struct option long_opts[] = {
+		{"fid", required_argument, 0, 'F'},
                 {"follow", no_argument, 0, 'f'},
+		{"type", required_argument, 0, 't'},
                 {0, 0, 0, 0}
         };
-        char short_opts[] = "f";
+	char short_opts[] = "fF:t:";
+	lustre_fid fid = { 0 };
+	__u32 type_mask = 0;
+	char *type;
+	char *fidstr;
+	int i;
         int rc, follow = 0;
 
         optind = 0;
@@ -2897,6 +2907,32 @@ static int lfs_changelog(int argc, char **argv)
                 case 'f':
                         follow++;
                         break;
+		case 'F':
+			fidstr = optarg;
+			while (*fidstr == '[')
+				fidstr++;
+			if (sscanf(fidstr, SFID, RFID(&fid)) != 3 ||
+			    !fid_is_sane(&fid)) {
+				fprintf(stderr, "error: %s: bad FID '%s'\n",
+					argv[0], optarg);
+				return CMD_HELP;
+			}
+			break;
+		case 't':
+			while ((type = strsep(&optarg, ",")) != NULL) {
+				for (i = 0; i < CL_LAST; i++)
+					if (strcasecmp(type,
+						changelog_type2str(i)) == 0)
+						break;
+				if (i == CL_LAST) {
+					fprintf(stderr, "error: %s: unknown "
+						"record type '%s'\n",
+						argv[0], type);
+					return CMD_HELP;
+				}
+				type_mask |= 1 << i;
+			}
+			break;
                 case '?':
                         return CMD_HELP;
                 default:
@@ -2914,10 +2950,11 @@ static int lfs_changelog(int argc, char **argv)
         if (argc > optind)
                 endrec = strtoll(argv[optind++], NULL, 10);
 
-        rc = llapi_changelog_start(&changelog_priv,
-                                   CHANGELOG_FLAG_BLOCK |
-                                   (follow ? CHANGELOG_FLAG_FOLLOW : 0),
-                                   mdd, startrec);
+	rc = llapi_changelog_start_filter(&changelog_priv,
+					  CHANGELOG_FLAG_BLOCK |
+					  (follow ? CHANGELOG_FLAG_FOLLOW : 0),
+					  mdd, startrec, type_mask,
+					  fid_is_sane(&fid) ? &fid : NULL);
         if (rc < 0) {
                 fprintf(stderr, "Can't start changelog: %s\n",
                         strerror(errno = -rc));
@@ -0,0 +1,317 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.sun.com/software/products/lustre/docs/GPLv2.pdf
+ *
+ * GPL HEADER END
+ */
+/*
+ * This file is part of Lustre, http://www.lustre.org/
+ * Lustre is a trademark of Sun Microsystems, Inc.
+ *
+ * lustre/utils/lhsmtool_posix.c
+ *
+ * HSM copytool moving data between Lustre and an archive stored in a POSIX
+ * filesystem, built on the liblustreapi copytool engine. Each file is
+ * archived as <hsm_root>/<last 16 bits of its OID>/<FID>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <limits.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <libcfs/libcfs.h>
+#include <lustre/lustreapi.h>
+
+#define MAX_ARCHIVES	HSM_CT_MAX_ARCHIVE
+
+static struct hsm_ct_engine	*ct_engine;
+static char			*ct_hsm_root;
+
+static void usage(const char *prog)
+{
+	fprintf(stderr,
+		"usage: %s [options] --hsm-root <dir> <lustre_mount>\n"
+		"\t-A, --archive <n>          serve archive <n> (default: all)\n"
+		"\t-b, --bandwidth <n>:<MB/s> limit the rate to archive <n>\n"
+		"\t-c, --chunk-size <bytes>   I/O size (default: 1MB)\n"
+		"\t-d, --direct               use O_DIRECT on Lustre files\n"
+		"\t-i, --progress <secs>      progress report interval\n"
+		"\t-p, --hsm-root <dir>       root of the archive\n"
+		"\t-s, --stripes <n>          parallel streams per file\n"
+		"\t-t, --threads <n>          concurrent actions\n",
+		prog);
+}
+
+static int ct_path(const struct hsm_action_item *hai, char *path, size_t len)
+{
+	lustre_fid fid = hai->hai_fid;
+
+	if (snprintf(path, len, "%s/%04x/"DFID_NOBRACE, ct_hsm_root,
+		     fid.f_oid & 0xffff, PFID(&fid)) >= len)
+		return -ENAMETOOLONG;
+	return 0;
+}
+
+static int ct_mkdir(const struct hsm_action_item *hai)
+{
+	lustre_fid	fid = hai->hai_fid;
+	char		dir[PATH_MAX];
+
+	if (snprintf(dir, sizeof(dir), "%s/%04x", ct_hsm_root,
+		     fid.f_oid & 0xffff) >= sizeof(dir))
+		return -ENAMETOOLONG;
+	if (mkdir(dir, 0700) < 0 && errno != EEXIST)
+		return -errno;
+	return 0;
+}
+
+static int ct_archive(struct hsm_ct_action *act, void *data)
+{
+	const struct hsm_action_item	*hai = llapi_hsm_ct_action_item(act);
+	char				 path[PATH_MAX];
+	char				 tmp[PATH_MAX];
+	int				 src;
+	int				 dst;
+	int				 rc;
+
+	rc = ct_mkdir(hai);
+	if (rc < 0)
+		return rc;
+
+	src = llapi_hsm_ct_action_open(act, O_RDONLY);
+	if (src < 0)
+		return src;
+
+	rc = ct_path(hai, path, sizeof(path));
+	if (rc < 0)
+		return rc;
+	if (snprintf(tmp, sizeof(tmp), "%s.tmp", path) >= sizeof(tmp))
+		return -ENAMETOOLONG;
+	dst = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+	if (dst < 0) {
+		rc = -errno;
+		fprintf(stderr, "cannot create '%s': %s\n", tmp, strerror(-rc));
+		return rc;
+	}
+
+	rc = llapi_hsm_ct_action_copy(act, src, dst, hai->hai_extent.offset,
+				      hai->hai_extent.length);
+	if (close(dst) < 0 && rc == 0)
+		rc = -errno;
+	/* only replace a previous copy once this one is complete */
+	if (rc == 0 && rename(tmp, path) < 0)
+		rc = -errno;
+	if (rc < 0) {
+		fprintf(stderr, "archive of '%s' failed: %s\n", path,
+			strerror(-rc));
+		unlink(tmp);
+	}
+	return rc;
+}
+
+static int ct_restore(struct hsm_ct_action *act, void *data)
+{
+	const struct hsm_action_item	*hai = llapi_hsm_ct_action_item(act);
+	char				 path[PATH_MAX];
+	int				 src;
+	int				 dst;
+	int				 rc;
+
+	rc = ct_path(hai, path, sizeof(path));
+	if (rc < 0)
+		return rc;
+	src = open(path, O_RDONLY);
+	if (src < 0) {
+		rc = -errno;
+		fprintf(stderr, "cannot open '%s': %s\n", path, strerror(-rc));
+		return rc;
+	}
+
+	dst = llapi_hsm_ct_action_open(act, O_WRONLY);
+	if (dst < 0) {
+		close(src);
+		return dst;
+	}
+
+	rc = llapi_hsm_ct_action_copy(act, src, dst, hai->hai_extent.offset,
+				      hai->hai_extent.length);
+	if (rc < 0)
+		fprintf(stderr, "restore from '%s' failed: %s\n", path,
+			strerror(-rc));
+	close(src);
+	return rc;
+}
+
+static int ct_remove(struct hsm_ct_action *act, void *data)
+{
+	char path[PATH_MAX];
+	int  rc;
+
+	rc = ct_path(llapi_hsm_ct_action_item(act), path, sizeof(path));
+	if (rc < 0)
+		return rc;
+	if (unlink(path) < 0 && errno != ENOENT)
+		return -errno;
+	return 0;
+}
+
+static void ct_print_stats(struct hsm_ct_engine *engine)
+{
+	struct hsm_ct_stats	st;
+	double			rate = 0;
+
+	llapi_hsm_ct_engine_stats(engine, &st);
+	if (st.cts_copy_usec != 0)
+		rate = (double)st.cts_bytes / st.cts_copy_usec;
+
+	printf("archived: %llu\n"
+	       "restored: %llu\n"
+	       "removed: %llu\n"
+	       "failed: %llu\n"
+	       "bytes: %llu\n"
+	       "copy_time: %llu usecs\n"
+	       "throttled: %llu usecs\n"
+	       "throughput: %.2f MB/s\n",
+	       st.cts_archived, st.cts_restored, st.cts_removed,
+	       st.cts_failed, st.cts_bytes, st.cts_copy_usec,
+	       st.cts_throttle_usec, rate);
+}
+
+static void ct_stop(int signal)
+{
+	if (ct_engine != NULL)
+		llapi_hsm_ct_engine_stop(ct_engine);
+}
+
+int main(int argc, char **argv)
+{
+	struct option long_opts[] = {
+		{"archive",	required_argument, 0, 'A'},
+		{"bandwidth",	required_argument, 0, 'b'},
+		{"chunk-size",	required_argument, 0, 'c'},
+		{"direct",	no_argument,	   0, 'd'},
+		{"help",	no_argument,	   0, 'h'},
+		{"progress",	required_argument, 0, 'i'},
+		{"hsm-root",	required_argument, 0, 'p'},
+		{"stripes",	required_argument, 0, 's'},
+		{"threads",	required_argument, 0, 't'},
+		{0, 0, 0, 0}
+	};
+	struct hsm_ct_mover		mover = {
+		.ctm_archive	= ct_archive,
+		.ctm_restore	= ct_restore,
+		.ctm_remove	= ct_remove,
+	};
+	struct hsm_ct_engine_param	param;
+	struct sigaction		sa;
+	int				archives[MAX_ARCHIVES];
+	int				archive_count = 0;
+	unsigned long			mbps;
+	char				*end;
+	int				archive;
+	int				rc;
+	int				c;
+
+	llapi_hsm_ct_engine_param_init(&param);
+
+	while ((c = getopt_long(argc, argv, "A:b:c:dhi:p:s:t:", long_opts,
+				NULL)) != -1) {
+		switch (c) {
+		case 'A':
+			if (archive_count == MAX_ARCHIVES) {
+				fprintf(stderr, "%s: too many archives\n",
+					argv[0]);
+				return EINVAL;
+			}
+			archives[archive_count++] = atoi(optarg);
+			break;
+		case 'b':
+			archive = strtol(optarg, &end, 0);
+			if (*end != ':' || archive < 1 ||
+			    archive > HSM_CT_MAX_ARCHIVE) {
+				fprintf(stderr, "%s: bad bandwidth '%s'\n",
+					argv[0], optarg);
+				return EINVAL;
+			}
+			mbps = strtoul(end + 1, NULL, 0);
+			param.cep_bandwidth[archive - 1] =
+				(unsigned long long)mbps << 20;
+			break;
+		case 'c':
+			param.cep_chunk_size = strtoul(optarg, NULL, 0);
+			break;
+		case 'd':
+			param.cep_direct_io = 1;
+			break;
+		case 'i':
+			param.cep_progress_interval = atoi(optarg);
+			break;
+		case 'p':
+			ct_hsm_root = optarg;
+			break;
+		case 's':
+			param.cep_stripes = atoi(optarg);
+			break;
+		case 't':
+			param.cep_threads = atoi(optarg);
+			break;
+		case 'h':
+			usage(argv[0]);
+			return 0;
+		default:
+			usage(argv[0]);
+			return EINVAL;
+		}
+	}
+
+	if (optind != argc - 1 || ct_hsm_root == NULL) {
+		usage(argv[0]);
+		return EINVAL;
+	}
+
+	rc = llapi_hsm_ct_engine_init(&ct_engine, argv[optind], archive_count,
+				      archives, &param, &mover);
+	if (rc < 0) {
+		fprintf(stderr, "%s: cannot start copytool on '%s': %s\n",
+			argv[0], argv[optind], strerror(-rc));
+		return -rc;
+	}
+
+	/* no SA_RESTART, so that a signal interrupts the wait for actions */
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = ct_stop;
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+
+	printf("%s: waiting for actions on %s (pid=%d)\n", argv[0],
+	       argv[optind], getpid());
+	rc = llapi_hsm_ct_engine_run(ct_engine);
+
+	ct_print_stats(ct_engine);
+	llapi_hsm_ct_engine_fini(&ct_engine);
+
+	return -rc;
+}
@@ -3811,11 +3811,19 @@ int root_ioctl(const char *mdtname, int opc, void *data, int *mdtidxp,
 /****** Changelog API ********/
 
 static int changelog_ioctl(const char *mdtname, int opc, int id,
-                           long long recno, int flags)
+			   long long recno, int flags, __u32 type_mask,
+			   const lustre_fid *fid)
 {
         struct ioc_changelog data;
         int *idx;
 
+	memset(&data, 0, sizeof(data));
+	if (type_mask != 0 || fid != NULL) {
+		flags |= CHANGELOG_FLAG_FILTER;
+		data.icc_type_mask = type_mask;
+		if (fid != NULL)
+			data.icc_fid = *fid;
+	}
         data.icc_id = id;
         data.icc_recno = recno;
         data.icc_flags = flags;
@@ -3831,15 +3839,18 @@ struct changelog_private {
         lustre_kernelcomm kuc;
 };
 
-/** Start reading from a changelog
+/** Start reading a filtered changelog
  * @param priv Opaque private control structure
  * @param flags Start flags (e.g. CHANGELOG_FLAG_BLOCK)
  * @param device Report changes recorded on this MDT
  * @param startrec Report changes beginning with this record number
+ * @param type_mask Only report these record types (1 << CL_*), 0 for all
+ * @param fid Only report changes to this FID or its entries, or NULL
  * (just call llapi_changelog_fini when done; don't need an endrec)
  */
-int llapi_changelog_start(void **priv, int flags, const char *device,
-                          long long startrec)
+int llapi_changelog_start_filter(void **priv, int flags, const char *device,
+				 long long startrec, __u32 type_mask,
+				 const lustre_fid *fid)
 {
         struct changelog_private *cp;
         int rc;
@@ -3860,8 +3871,8 @@ int llapi_changelog_start(void **priv, int flags, const char *device,
         *priv = cp;
 
         /* Tell the kernel to start sending */
-        rc = changelog_ioctl(device, OBD_IOC_CHANGELOG_SEND, cp->kuc.lk_wfd,
-                             startrec, flags);
+	rc = changelog_ioctl(device, OBD_IOC_CHANGELOG_SEND, cp->kuc.lk_wfd,
+			     startrec, flags, type_mask, fid);
         /* Only the kernel reference keeps the write side open */
         close(cp->kuc.lk_wfd);
         cp->kuc.lk_wfd = 0;
@@ -3878,6 +3889,20 @@ out_free:
         return rc;
 }
 
+/** Start reading from a changelog
+ * @param priv Opaque private control structure
+ * @param flags Start flags (e.g. CHANGELOG_FLAG_BLOCK)
+ * @param device Report changes recorded on this MDT
+ * @param startrec Report changes beginning with this record number
+ * (just call llapi_changelog_fini when done; don't need an endrec)
+ */
+int llapi_changelog_start(void **priv, int flags, const char *device,
+			  long long startrec)
+{
+	return llapi_changelog_start_filter(priv, flags, device, startrec,
+					    0, NULL);
+}
+
 /** Finish reading from a changelog */
 int llapi_changelog_fini(void **priv)
 {
@@ -4008,7 +4033,8 @@ int llapi_changelog_clear(const char *mdtname, const char *idstr,
                 return -EINVAL;
         }
 
-        return changelog_ioctl(mdtname, OBD_IOC_CHANGELOG_CLEAR, id, endrec, 0);
+	return changelog_ioctl(mdtname, OBD_IOC_CHANGELOG_CLEAR, id, endrec, 0,
+			       0, NULL);
 }
 
 int llapi_fid2path(const char *device, const char *fidstr, char *buf,
@@ -4124,6 +4150,76 @@ int llapi_get_connect_flags(const char *mnt, __u64 *flags)
         return rc;
 }
 
+/**
+ * Unlink \a count entries of directory \a dir, which are not directories
+ * themselves. The result of each unlink, 0 or a negative errno, is stored in
+ * \a rcs. The unlinks are sent to the MDT in batches where the client and
+ * server support it, and one by one otherwise.
+ *
+ * \retval 0 on success, or a negative errno if \a dir could not be used
+ */
+int llapi_bulk_unlink(const char *dir, char **names, int count, int *rcs)
+{
+	struct ll_bulk_unlink *lbu;
+	char *buf;
+	int fd, start, n, size, len, i, rc = 0;
+
+	fd = open(dir, O_RDONLY | O_DIRECTORY);
+	if (fd < 0) {
+		rc = -errno;
+		llapi_error(LLAPI_MSG_ERROR, rc, "cannot open '%s'", dir);
+		return rc;
+	}
+
+	lbu = malloc(sizeof(*lbu) + LL_BULK_UNLINK_BUFLEN);
+	if (lbu == NULL) {
+		rc = -ENOMEM;
+		goto out;
+	}
+
+	for (start = 0; start < count; start += n) {
+		size = 0;
+		for (n = 0; start + n < count && n < LL_BULK_UNLINK_MAX; n++) {
+			len = sizeof(__s32) + strlen(names[start + n]) + 1;
+			if (size + len > LL_BULK_UNLINK_BUFLEN)
+				break;
+			size += len;
+		}
+
+		if (n > 0) {
+			lbu->lbu_count = n;
+			lbu->lbu_buflen = size;
+			buf = lbu->lbu_buf + n * sizeof(__s32);
+			for (i = 0; i < n; i++)
+				buf = stpcpy(buf, names[start + i]) + 1;
+
+			rc = ioctl(fd, LL_IOC_BULK_UNLINK, lbu);
+			if (rc == 0) {
+				memcpy(&rcs[start], lbu->lbu_buf,
+				       n * sizeof(__s32));
+				continue;
+			}
+			rc = -errno;
+			if (rc != -ENOTTY && rc != -EOPNOTSUPP) {
+				llapi_error(LLAPI_MSG_ERROR, rc,
+					    "bulk unlink in '%s' failed", dir);
+				goto out;
+			}
+		}
+
+		/* no bulk unlink, or a name too long for it */
+		if (n == 0)
+			n = 1;
+		for (i = start; i < start + n; i++)
+			rcs[i] = unlinkat(fd, names[i], 0) < 0 ? -errno : 0;
+		rc = 0;
+	}
+out:
+	free(lbu);
+	close(fd);
+	return rc;
+}
+
 int llapi_get_version(char *buffer, int buffer_size,
                       char **version)
 {
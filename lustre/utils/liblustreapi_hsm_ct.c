@@ -0,0 +1,796 @@
+/*
+ * LGPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the GNU Lesser General Public License
+ * (LGPL) version 2.1 or (at your discretion) any later version.
+ * (LGPL) version 2.1 accompanies this distribution, and is available at
+ * http://www.gnu.org/licenses/lgpl-2.1.html
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * LGPL HEADER END
+ */
+/*
+ * lustre/utils/liblustreapi_hsm_ct.c
+ *
+ * lustreapi library for HSM copytools: an engine running the actions
+ * received by a copytool in a pool of worker threads.
+ *
+ * Actions are queued in the order they are received and picked up by the
+ * first idle worker, which starts the copy, calls the mover for the action
+ * type and ends the copy with the mover result. Movers copy file data with
+ * llapi_hsm_ct_action_copy(), which splits the file into chunks copied by
+ * several streams in parallel, throttled per archive, while the engine
+ * reports the progress of running copies to the coordinator.
+ */
+
+/* for O_DIRECT */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/types.h>
+
+#include <liblustre.h>
+#include <lustre/lustreapi.h>
+#include "lustreapi_internal.h"
+
+#define CT_DEFAULT_THREADS		4
+#define CT_DEFAULT_STRIPES		1
+#define CT_DEFAULT_CHUNK_SIZE		(1 << 20)
+#define CT_DEFAULT_PROGRESS_INTERVAL	5
+#define CT_IO_ALIGN			4096
+
+struct hsm_ct_action {
+	struct hsm_ct_action	*act_next;	/* ce_queue or ce_active */
+	struct hsm_ct_engine	*act_engine;
+	int			 act_archive;
+	int			 act_fd;	/* Lustre file, if opened */
+	unsigned long long	 act_bytes;	/* copied, under ce_lock */
+	unsigned long long	 act_reported;	/* sent with a progress */
+	struct hsm_copy		 act_copy;
+	struct hsm_action_item	*act_hai;	/* with its data */
+};
+
+struct hsm_ct_engine {
+	char				 ce_mnt[PATH_MAX];
+	char				 ce_fsname[PATH_MAX];
+	struct hsm_copytool_private	*ce_ct;
+	struct hsm_ct_engine_param	 ce_param;
+	struct hsm_ct_mover		 ce_mover;
+
+	pthread_mutex_t			 ce_lock;
+	pthread_cond_t			 ce_cond;	/* queue changes */
+	pthread_cond_t			 ce_progress_cond;
+	struct hsm_ct_action		*ce_queue;
+	struct hsm_ct_action		*ce_queue_tail;
+	struct hsm_ct_action		*ce_active;
+	int				 ce_exiting;
+	volatile int			 ce_stopping;
+
+	pthread_t			*ce_workers;
+	int				 ce_nworkers;
+	pthread_t			 ce_progress;
+	int				 ce_progress_running;
+
+	/* time at which the bytes already allowed will have gone through,
+	 * for each archive, in usec */
+	unsigned long long		 ce_bw_next[HSM_CT_MAX_ARCHIVE];
+	struct hsm_ct_stats		 ce_stats;
+};
+
+static unsigned long long ct_now_usec(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return (unsigned long long)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+/** Fill \a param with the default engine parameters. */
+void llapi_hsm_ct_engine_param_init(struct hsm_ct_engine_param *param)
+{
+	memset(param, 0, sizeof(*param));
+	param->cep_threads = CT_DEFAULT_THREADS;
+	param->cep_stripes = CT_DEFAULT_STRIPES;
+	param->cep_chunk_size = CT_DEFAULT_CHUNK_SIZE;
+	param->cep_progress_interval = CT_DEFAULT_PROGRESS_INTERVAL;
+}
+
+/** The action item being run, including its data. */
+const struct hsm_action_item *
+llapi_hsm_ct_action_item(const struct hsm_ct_action *act)
+{
+	return act->act_hai;
+}
+
+/** The archive number the action was sent for. */
+int llapi_hsm_ct_action_archive(const struct hsm_ct_action *act)
+{
+	return act->act_archive;
+}
+
+/**
+ * Open the Lustre file the action moves data from or to, by FID. The file
+ * is opened with O_DIRECT if the engine was set up so, and is closed by the
+ * engine once the mover returns.
+ *
+ * \param flags open flags, e.g. O_RDONLY to archive or O_WRONLY to restore
+ *
+ * \return the file descriptor or a negative errno
+ */
+int llapi_hsm_ct_action_open(struct hsm_ct_action *act, int flags)
+{
+	struct hsm_ct_engine	*ce = act->act_engine;
+	lustre_fid		 fid = act->act_hai->hai_dfid;
+	char			 path[PATH_MAX];
+	__u64			 dv;
+	int			 fd;
+	int			 rc;
+
+	if (act->act_fd >= 0)
+		return act->act_fd;
+
+	if (!fid_is_sane(&fid))
+		fid = act->act_hai->hai_fid;
+
+	if (snprintf(path, sizeof(path), "%s/%s/fid/"DFID, ce->ce_mnt,
+		     dot_lustre_name, PFID(&fid)) >= sizeof(path))
+		return -ENAMETOOLONG;
+	if (ce->ce_param.cep_direct_io)
+		flags |= O_DIRECT;
+
+	fd = open(path, flags);
+	if (fd < 0) {
+		rc = -errno;
+		llapi_error(LLAPI_MSG_ERROR, rc, "cannot open '%s'", path);
+		return rc;
+	}
+
+	/* tell the coordinator which version of the data gets archived,
+	 * unless the kernel did already in llapi_hsm_copy_start() */
+	if (act->act_hai->hai_action == HSMA_ARCHIVE &&
+	    act->act_copy.hc_data_version == 0) {
+		rc = llapi_get_data_version(fd, &dv, 0);
+		if (rc < 0) {
+			llapi_error(LLAPI_MSG_ERROR, rc,
+				    "cannot get data version of '%s'", path);
+			close(fd);
+			return rc;
+		}
+		act->act_copy.hc_data_version = dv;
+	}
+
+	act->act_fd = fd;
+	return fd;
+}
+
+/* wait until \a bytes can go to the archive of \a act */
+static void ct_throttle(struct hsm_ct_action *act, unsigned long long bytes)
+{
+	struct hsm_ct_engine	*ce = act->act_engine;
+	unsigned long long	 bw = 0;
+	unsigned long long	 now;
+	unsigned long long	 start;
+	int			 idx = act->act_archive - 1;
+
+	if (idx >= 0 && idx < HSM_CT_MAX_ARCHIVE)
+		bw = ce->ce_param.cep_bandwidth[idx];
+	if (bw == 0)
+		return;
+
+	now = ct_now_usec();
+	pthread_mutex_lock(&ce->ce_lock);
+	start = ce->ce_bw_next[idx] > now ? ce->ce_bw_next[idx] : now;
+	ce->ce_bw_next[idx] = start + bytes * 1000000 / bw;
+	if (start > now)
+		ce->ce_stats.cts_throttle_usec += start - now;
+	pthread_mutex_unlock(&ce->ce_lock);
+
+	if (start > now)
+		usleep(start - now);
+}
+
+/* O_DIRECT needs aligned sizes, write the unaligned end of a file through
+ * a buffered descriptor */
+static ssize_t ct_pwrite(int fd, const void *buf, size_t len, off_t pos)
+{
+	char	path[PATH_MAX];
+	ssize_t	rc;
+	int	fd2;
+
+	rc = pwrite(fd, buf, len, pos);
+	if (rc >= 0 || errno != EINVAL || !(fcntl(fd, F_GETFL) & O_DIRECT))
+		return rc;
+
+	snprintf(path, sizeof(path), "/proc/self/fd/%d", fd);
+	fd2 = open(path, O_WRONLY);
+	if (fd2 < 0)
+		return -1;
+	rc = pwrite(fd2, buf, len, pos);
+	close(fd2);
+	return rc;
+}
+
+struct ct_stream {
+	struct hsm_ct_action	*cs_act;
+	pthread_t		 cs_thread;
+	int			 cs_src;
+	int			 cs_dst;
+	unsigned long long	 cs_offset;
+	unsigned long long	 cs_end;
+	int			 cs_index;
+	int			 cs_count;
+	int			 cs_rc;
+};
+
+/* copy every cs_count-th chunk of the range, starting with cs_index */
+static void *ct_stream_copy(void *arg)
+{
+	struct ct_stream	*cs = arg;
+	struct hsm_ct_engine	*ce = cs->cs_act->act_engine;
+	unsigned int		 chunk = ce->ce_param.cep_chunk_size;
+	unsigned long long	 pos;
+	size_t			 len;
+	ssize_t			 rc;
+	void			*buf;
+
+	cs->cs_rc = posix_memalign(&buf, CT_IO_ALIGN, chunk);
+	if (cs->cs_rc != 0) {
+		cs->cs_rc = -cs->cs_rc;
+		return NULL;
+	}
+
+	for (pos = cs->cs_offset + (unsigned long long)cs->cs_index * chunk;
+	     pos < cs->cs_end; pos += (unsigned long long)cs->cs_count * chunk) {
+		len = chunk;
+		if (len > cs->cs_end - pos)
+			len = cs->cs_end - pos;
+
+		ct_throttle(cs->cs_act, len);
+
+		/* full chunk for O_DIRECT, a short read tells the end */
+		rc = pread(cs->cs_src, buf, chunk, pos);
+		if (rc < 0) {
+			cs->cs_rc = -errno;
+			llapi_error(LLAPI_MSG_ERROR, cs->cs_rc,
+				    "read error at "LPU64, (__u64)pos);
+			break;
+		}
+		if (rc < len)
+			len = rc;
+		if (len == 0)
+			break;
+
+		rc = ct_pwrite(cs->cs_dst, buf, len, pos);
+		if (rc < 0 || rc != len) {
+			cs->cs_rc = rc < 0 ? -errno : -EIO;
+			llapi_error(LLAPI_MSG_ERROR, cs->cs_rc,
+				    "write error at "LPU64, (__u64)pos);
+			break;
+		}
+
+		pthread_mutex_lock(&ce->ce_lock);
+		cs->cs_act->act_bytes += len;
+		ce->ce_stats.cts_bytes += len;
+		pthread_mutex_unlock(&ce->ce_lock);
+	}
+
+	free(buf);
+	return NULL;
+}
+
+/**
+ * Copy \a length bytes at \a offset from \a src_fd to the same offset of
+ * \a dst_fd, in chunks of the engine chunk size, using as many parallel
+ * streams as configured. A length of -1 copies up to the end of \a src_fd.
+ * The bytes copied are reported to the coordinator as progress.
+ *
+ * \return 0 or a negative errno
+ */
+int llapi_hsm_ct_action_copy(struct hsm_ct_action *act, int src_fd,
+			     int dst_fd, unsigned long long offset,
+			     unsigned long long length)
+{
+	struct hsm_ct_engine	*ce = act->act_engine;
+	unsigned int		 chunk = ce->ce_param.cep_chunk_size;
+	unsigned long long	 start = ct_now_usec();
+	unsigned long long	 nchunks;
+	struct ct_stream	*streams;
+	struct stat		 st;
+	int			 count;
+	int			 started;
+	int			 rc = 0;
+	int			 i;
+
+	if (length == (unsigned long long)-1) {
+		if (fstat(src_fd, &st) < 0)
+			return -errno;
+		length = st.st_size > offset ? st.st_size - offset : 0;
+	}
+	if (length == 0)
+		return 0;
+
+	nchunks = (length + chunk - 1) / chunk;
+	count = ce->ce_param.cep_stripes;
+	if (count > nchunks)
+		count = nchunks;
+
+	streams = calloc(count, sizeof(*streams));
+	if (streams == NULL)
+		return -ENOMEM;
+
+	for (i = 0; i < count; i++) {
+		streams[i].cs_act = act;
+		streams[i].cs_src = src_fd;
+		streams[i].cs_dst = dst_fd;
+		streams[i].cs_offset = offset;
+		streams[i].cs_end = offset + length;
+		streams[i].cs_index = i;
+		streams[i].cs_count = count;
+	}
+
+	/* the calling worker runs the first stream itself, and those which
+	 * couldn't get a thread once it is done */
+	for (started = 1; started < count; started++) {
+		rc = pthread_create(&streams[started].cs_thread, NULL,
+				    ct_stream_copy, &streams[started]);
+		if (rc != 0) {
+			llapi_error(LLAPI_MSG_WARN, -rc,
+				    "only %d copy streams started", started);
+			break;
+		}
+	}
+	rc = 0;
+
+	ct_stream_copy(&streams[0]);
+	for (i = started; i < count; i++)
+		ct_stream_copy(&streams[i]);
+	for (i = 1; i < started; i++)
+		pthread_join(streams[i].cs_thread, NULL);
+
+	for (i = 0; i < count; i++)
+		if (streams[i].cs_rc != 0 && rc == 0)
+			rc = streams[i].cs_rc;
+	free(streams);
+
+	pthread_mutex_lock(&ce->ce_lock);
+	ce->ce_stats.cts_copy_usec += ct_now_usec() - start;
+	pthread_mutex_unlock(&ce->ce_lock);
+
+	if (rc == 0 && fsync(dst_fd) < 0)
+		rc = -errno;
+	return rc;
+}
+
+static void ct_progress_fill(struct hsm_progress *hp,
+			     const struct hsm_ct_action *act, int errval)
+{
+	memset(hp, 0, sizeof(*hp));
+	hp->hp_fid = act->act_hai->hai_fid;
+	hp->hp_cookie = act->act_hai->hai_cookie;
+	hp->hp_extent.offset = act->act_hai->hai_extent.offset;
+	hp->hp_extent.length = act->act_bytes;
+	hp->hp_errval = errval;
+}
+
+static void ct_action_run(struct hsm_ct_engine *ce, struct hsm_ct_action *act)
+{
+	struct hsm_ct_mover	*mover = &ce->ce_mover;
+	struct hsm_progress	 hp;
+	int			 rc;
+
+	rc = llapi_hsm_copy_start(ce->ce_mnt, &act->act_copy, act->act_hai);
+	if (rc < 0) {
+		llapi_error(LLAPI_MSG_ERROR, rc, "copy start failed for "DFID,
+			    PFID(&act->act_hai->hai_fid));
+		ct_progress_fill(&hp, act, -rc);
+		llapi_hsm_copy_end(ce->ce_mnt, NULL, &hp);
+		return;
+	}
+
+	switch (act->act_hai->hai_action) {
+	case HSMA_ARCHIVE:
+		rc = mover->ctm_archive ?
+		     mover->ctm_archive(act, mover->ctm_data) : -ENOTSUP;
+		break;
+	case HSMA_RESTORE:
+		rc = mover->ctm_restore ?
+		     mover->ctm_restore(act, mover->ctm_data) : -ENOTSUP;
+		break;
+	case HSMA_REMOVE:
+		rc = mover->ctm_remove ?
+		     mover->ctm_remove(act, mover->ctm_data) : -ENOTSUP;
+		break;
+	default:
+		rc = -ENOTSUP;
+		break;
+	}
+
+	if (act->act_fd >= 0) {
+		close(act->act_fd);
+		act->act_fd = -1;
+	}
+
+	pthread_mutex_lock(&ce->ce_lock);
+	ct_progress_fill(&hp, act, rc < 0 ? -rc : 0);
+	hp.hp_flags = HP_FLAG_COMPLETED;
+	pthread_mutex_unlock(&ce->ce_lock);
+
+	if (llapi_hsm_copy_end(ce->ce_mnt, &act->act_copy, &hp) < 0 && rc == 0)
+		rc = -EIO;
+
+	pthread_mutex_lock(&ce->ce_lock);
+	if (rc < 0) {
+		ce->ce_stats.cts_failed++;
+	} else {
+		switch (act->act_hai->hai_action) {
+		case HSMA_ARCHIVE:
+			ce->ce_stats.cts_archived++;
+			break;
+		case HSMA_RESTORE:
+			ce->ce_stats.cts_restored++;
+			break;
+		case HSMA_REMOVE:
+			ce->ce_stats.cts_removed++;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&ce->ce_lock);
+}
+
+static void *ct_worker(void *arg)
+{
+	struct hsm_ct_engine	*ce = arg;
+	struct hsm_ct_action	*act;
+	struct hsm_ct_action	**prev;
+
+	pthread_mutex_lock(&ce->ce_lock);
+	while (1) {
+		while (ce->ce_queue == NULL && !ce->ce_exiting)
+			pthread_cond_wait(&ce->ce_cond, &ce->ce_lock);
+		if (ce->ce_queue == NULL)
+			break;
+
+		act = ce->ce_queue;
+		ce->ce_queue = act->act_next;
+		if (ce->ce_queue == NULL)
+			ce->ce_queue_tail = NULL;
+		act->act_next = ce->ce_active;
+		ce->ce_active = act;
+		ce->ce_stats.cts_running++;
+		pthread_mutex_unlock(&ce->ce_lock);
+
+		ct_action_run(ce, act);
+
+		pthread_mutex_lock(&ce->ce_lock);
+		for (prev = &ce->ce_active; *prev != act;
+		     prev = &(*prev)->act_next)
+			;
+		*prev = act->act_next;
+		ce->ce_stats.cts_running--;
+		free(act);
+	}
+	pthread_mutex_unlock(&ce->ce_lock);
+	return NULL;
+}
+
+/* report the bytes copied by running actions every cep_progress_interval */
+static void *ct_progress(void *arg)
+{
+	struct hsm_ct_engine	*ce = arg;
+	struct hsm_ct_action	*act;
+	struct hsm_progress	*hps;
+	struct timespec		 ts;
+	struct timeval		 tv;
+	int			 count;
+	int			 i;
+
+	hps = calloc(ce->ce_nworkers, sizeof(*hps));
+	if (hps == NULL)
+		return NULL;
+
+	pthread_mutex_lock(&ce->ce_lock);
+	while (!ce->ce_exiting) {
+		gettimeofday(&tv, NULL);
+		ts.tv_sec = tv.tv_sec + ce->ce_param.cep_progress_interval;
+		ts.tv_nsec = tv.tv_usec * 1000;
+		pthread_cond_timedwait(&ce->ce_progress_cond, &ce->ce_lock,
+				       &ts);
+		if (ce->ce_exiting)
+			break;
+
+		count = 0;
+		for (act = ce->ce_active; act != NULL && count < ce->ce_nworkers;
+		     act = act->act_next) {
+			if (act->act_bytes == act->act_reported)
+				continue;
+			ct_progress_fill(&hps[count++], act, 0);
+			act->act_reported = act->act_bytes;
+		}
+		pthread_mutex_unlock(&ce->ce_lock);
+
+		for (i = 0; i < count; i++)
+			llapi_hsm_progress(ce->ce_mnt, &hps[i]);
+
+		pthread_mutex_lock(&ce->ce_lock);
+	}
+	pthread_mutex_unlock(&ce->ce_lock);
+
+	free(hps);
+	return NULL;
+}
+
+/**
+ * Register a copytool on the filesystem mounted at \a mnt and start the
+ * workers running its actions.
+ *
+ * \param[out] engine	Opaque engine structure
+ * \param mnt		Lustre mount point
+ * \param archive_count, archives  archive numbers served, see
+ *			llapi_hsm_copytool_start()
+ * \param param		engine parameters, or NULL for the defaults
+ * \param mover		callbacks moving the data for each action type
+ */
+int llapi_hsm_ct_engine_init(struct hsm_ct_engine **engine, const char *mnt,
+			     int archive_count, int *archives,
+			     const struct hsm_ct_engine_param *param,
+			     const struct hsm_ct_mover *mover)
+{
+	struct hsm_ct_engine	*ce;
+	int			 rc;
+	int			 i;
+
+	if (mover == NULL)
+		return -EINVAL;
+
+	ce = calloc(1, sizeof(*ce));
+	if (ce == NULL)
+		return -ENOMEM;
+
+	if (param != NULL)
+		ce->ce_param = *param;
+	else
+		llapi_hsm_ct_engine_param_init(&ce->ce_param);
+	ce->ce_mover = *mover;
+
+	if (ce->ce_param.cep_threads <= 0)
+		ce->ce_param.cep_threads = CT_DEFAULT_THREADS;
+	if (ce->ce_param.cep_stripes <= 0)
+		ce->ce_param.cep_stripes = CT_DEFAULT_STRIPES;
+	if (ce->ce_param.cep_progress_interval <= 0)
+		ce->ce_param.cep_progress_interval =
+			CT_DEFAULT_PROGRESS_INTERVAL;
+	if (ce->ce_param.cep_chunk_size == 0 ||
+	    ce->ce_param.cep_chunk_size % CT_IO_ALIGN != 0) {
+		llapi_err_noerrno(LLAPI_MSG_ERROR,
+				  "chunk size %u is not a multiple of %d",
+				  ce->ce_param.cep_chunk_size, CT_IO_ALIGN);
+		free(ce);
+		return -EINVAL;
+	}
+
+	strncpy(ce->ce_mnt, mnt, sizeof(ce->ce_mnt) - 1);
+	rc = get_root_path(WANT_FSNAME, ce->ce_fsname, NULL, ce->ce_mnt, -1);
+	if (rc < 0) {
+		llapi_error(LLAPI_MSG_ERROR, rc, "'%s' is not a Lustre mount",
+			    mnt);
+		free(ce);
+		return rc;
+	}
+
+	pthread_mutex_init(&ce->ce_lock, NULL);
+	pthread_cond_init(&ce->ce_cond, NULL);
+	pthread_cond_init(&ce->ce_progress_cond, NULL);
+
+	rc = llapi_hsm_copytool_start(&ce->ce_ct, ce->ce_fsname, 0,
+				      archive_count, archives);
+	if (rc < 0)
+		goto out_free;
+
+	ce->ce_workers = calloc(ce->ce_param.cep_threads,
+				sizeof(*ce->ce_workers));
+	if (ce->ce_workers == NULL) {
+		rc = -ENOMEM;
+		goto out_fini;
+	}
+
+	for (i = 0; i < ce->ce_param.cep_threads; i++) {
+		rc = pthread_create(&ce->ce_workers[i], NULL, ct_worker, ce);
+		if (rc != 0) {
+			rc = -rc;
+			llapi_error(LLAPI_MSG_ERROR, rc,
+				    "cannot start copytool worker");
+			break;
+		}
+		ce->ce_nworkers++;
+	}
+
+	if (ce->ce_nworkers > 0) {
+		rc = pthread_create(&ce->ce_progress, NULL, ct_progress, ce);
+		if (rc != 0)
+			rc = -rc;
+		else
+			ce->ce_progress_running = 1;
+	}
+
+	if (rc < 0) {
+		llapi_hsm_ct_engine_fini(&ce);
+		return rc;
+	}
+
+	*engine = ce;
+	return 0;
+
+out_fini:
+	llapi_hsm_copytool_fini(&ce->ce_ct);
+out_free:
+	pthread_cond_destroy(&ce->ce_progress_cond);
+	pthread_cond_destroy(&ce->ce_cond);
+	pthread_mutex_destroy(&ce->ce_lock);
+	free(ce);
+	return rc;
+}
+
+static struct hsm_ct_action *ct_action_alloc(struct hsm_ct_engine *ce,
+					     const struct hsm_action_list *hal,
+					     const struct hsm_action_item *hai)
+{
+	struct hsm_ct_action *act;
+
+	act = calloc(1, sizeof(*act) + hai->hai_len);
+	if (act == NULL)
+		return NULL;
+
+	act->act_engine = ce;
+	act->act_archive = hal->hal_archive_id;
+	act->act_fd = -1;
+	act->act_hai = (struct hsm_action_item *)(act + 1);
+	memcpy(act->act_hai, hai, hai->hai_len);
+	return act;
+}
+
+/**
+ * Receive the actions sent to the copytool and queue them for the workers,
+ * until the coordinator shuts the copytool down, an error happens or
+ * llapi_hsm_ct_engine_stop() is called.
+ *
+ * \return 0 on shutdown or stop, a negative errno otherwise
+ */
+int llapi_hsm_ct_engine_run(struct hsm_ct_engine *ce)
+{
+	struct hsm_action_list	*hal;
+	struct hsm_action_item	*hai;
+	struct hsm_ct_action	*act;
+	struct hsm_progress	 hp;
+	int			 msgsize;
+	int			 rc = 0;
+	int			 i;
+
+	while (!ce->ce_stopping) {
+		rc = llapi_hsm_copytool_recv(ce->ce_ct, &hal, &msgsize);
+		if (rc == -ESHUTDOWN) {
+			rc = 0;
+			break;
+		}
+		/* not for our archives, or interrupted to check ce_stopping */
+		if (rc == -EAGAIN || rc == -EINTR)
+			continue;
+		if (rc < 0) {
+			llapi_error(LLAPI_MSG_ERROR, rc,
+				    "cannot receive action list");
+			break;
+		}
+		if (msgsize == 0)
+			continue;
+
+		hai = hai_zero(hal);
+		for (i = 0; i < hal->hal_count; i++, hai = hai_next(hai)) {
+			act = ct_action_alloc(ce, hal, hai);
+			if (act == NULL) {
+				memset(&hp, 0, sizeof(hp));
+				hp.hp_fid = hai->hai_fid;
+				hp.hp_cookie = hai->hai_cookie;
+				hp.hp_errval = ENOMEM;
+				llapi_hsm_copy_end(ce->ce_mnt, NULL, &hp);
+				continue;
+			}
+
+			pthread_mutex_lock(&ce->ce_lock);
+			if (ce->ce_queue_tail != NULL)
+				ce->ce_queue_tail->act_next = act;
+			else
+				ce->ce_queue = act;
+			ce->ce_queue_tail = act;
+			pthread_cond_signal(&ce->ce_cond);
+			pthread_mutex_unlock(&ce->ce_lock);
+		}
+
+		llapi_hsm_copytool_free(&hal);
+	}
+
+	return rc;
+}
+
+/**
+ * Make llapi_hsm_ct_engine_run() return after the current message. Safe to
+ * call from a signal handler.
+ */
+void llapi_hsm_ct_engine_stop(struct hsm_ct_engine *ce)
+{
+	ce->ce_stopping = 1;
+}
+
+/**
+ * Wait for the running actions to complete, fail the queued ones so that
+ * the coordinator can send them again, and deregister the copytool.
+ */
+int llapi_hsm_ct_engine_fini(struct hsm_ct_engine **engine)
+{
+	struct hsm_ct_engine	*ce = *engine;
+	struct hsm_ct_action	*act;
+	struct hsm_progress	 hp;
+	int			 rc;
+	int			 i;
+
+	if (ce == NULL)
+		return -EINVAL;
+
+	pthread_mutex_lock(&ce->ce_lock);
+	ce->ce_exiting = 1;
+	act = ce->ce_queue;
+	ce->ce_queue = ce->ce_queue_tail = NULL;
+	pthread_cond_broadcast(&ce->ce_cond);
+	pthread_cond_broadcast(&ce->ce_progress_cond);
+	pthread_mutex_unlock(&ce->ce_lock);
+
+	while (act != NULL) {
+		struct hsm_ct_action *next = act->act_next;
+
+		ct_progress_fill(&hp, act, ECANCELED);
+		llapi_hsm_copy_end(ce->ce_mnt, NULL, &hp);
+		free(act);
+		act = next;
+	}
+
+	for (i = 0; i < ce->ce_nworkers; i++)
+		pthread_join(ce->ce_workers[i], NULL);
+	if (ce->ce_progress_running)
+		pthread_join(ce->ce_progress, NULL);
+
+	rc = llapi_hsm_copytool_fini(&ce->ce_ct);
+
+	pthread_cond_destroy(&ce->ce_progress_cond);
+	pthread_cond_destroy(&ce->ce_cond);
+	pthread_mutex_destroy(&ce->ce_lock);
+	free(ce->ce_workers);
+	free(ce);
+	*engine = NULL;
+	return rc;
+}
+
+/** Get a snapshot of the engine counters. */
+void llapi_hsm_ct_engine_stats(struct hsm_ct_engine *ce,
+			       struct hsm_ct_stats *stats)
+{
+	pthread_mutex_lock(&ce->ce_lock);
+	*stats = ce->ce_stats;
+	pthread_mutex_unlock(&ce->ce_lock);
+}
@@ -0,0 +1,282 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.sun.com/software/products/lustre/docs/GPLv2.pdf
+ *
+ * GPL HEADER END
+ */
+/*
+ * This file is part of Lustre, http://www.lustre.org/
+ * Lustre is a trademark of Sun Microsystems, Inc.
+ *
+ * lustre/utils/lstats_decode.c
+ *
+ * Decode a binary statistics snapshot taken from
+ * /proc/fs/lustre/stats_export (or saved from it to a file) and print
+ * it in the same form as the text "stats" files.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <fnmatch.h>
+#include <getopt.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <liblustre.h>
+#include <lustre/lustre_user.h>
+
+#define LSTATS_EXPORT_FILE	"/proc/fs/lustre/stats_export"
+
+static void usage(const char *prog)
+{
+	fprintf(stderr, "usage: %s [-a] [-f snapshot] [pattern ...]\n"
+		"\t-a: also print counters and histograms with no samples\n"
+		"\t-f: decode this file instead of %s\n"
+		"\tpattern: only print paths matching one of these globs\n",
+		prog, LSTATS_EXPORT_FILE);
+}
+
+static int path_match(const char *path, char **patterns, int npatterns)
+{
+	int i;
+
+	if (npatterns == 0)
+		return 1;
+
+	for (i = 0; i < npatterns; i++)
+		if (fnmatch(patterns[i], path, 0) == 0)
+			return 1;
+
+	return 0;
+}
+
+static void print_stats(const struct lstats_export_header *leh,
+			const struct lstats_export_record *ler, int all)
+{
+	const char *ptr = (const char *)ler + leh->leh_rec_size;
+	int	    i;
+
+	printf("%s\n", ler->ler_path);
+	printf("%-25s "LPU64".%06u secs.usecs\n", "snapshot_time",
+	       leh->leh_snapshot_sec, leh->leh_snapshot_usec);
+
+	for (i = 0; i < ler->ler_count; i++, ptr += leh->leh_cntr_size) {
+		const struct lstats_export_counter *lec = (const void *)ptr;
+
+		if (lec->lec_count == 0 && !all)
+			continue;
+
+		printf("%-25.*s "LPU64" samples [%.*s]",
+		       LSTATS_NAME_LEN, lec->lec_name, lec->lec_count,
+		       LSTATS_UNITS_LEN, lec->lec_units);
+		if (lec->lec_config & LSTATS_CNTR_AVGMINMAX) {
+			printf(" "LPU64" "LPU64" "LPU64, lec->lec_min,
+			       lec->lec_max, lec->lec_sum);
+			if (lec->lec_config & LSTATS_CNTR_STDDEV)
+				printf(" "LPU64, lec->lec_sumsquare);
+		}
+		printf("\n");
+	}
+}
+
+static void print_hist(const struct lstats_export_header *leh,
+		       const struct lstats_export_record *ler, int all)
+{
+	const __u64 *buckets = (const void *)((const char *)ler +
+					      leh->leh_rec_size);
+	int	     i;
+	int	     j;
+
+	printf("%s\n", ler->ler_path);
+	for (i = 0; i < ler->ler_count; i++, buckets += leh->leh_hist_max) {
+		printf("  [%d]", i);
+		for (j = 0; j < leh->leh_hist_max; j++)
+			if (buckets[j] != 0 || all)
+				printf(" %d:"LPU64, j, buckets[j]);
+		printf("\n");
+	}
+}
+
+/* highest value counted into latency bucket \a idx, see lustre_user.h */
+static __u64 lat_bucket_max(const struct lstats_export_lat *lel,
+			    unsigned int idx)
+{
+	unsigned int sub = 1 << lel->lel_sub_bits;
+
+	if (idx < sub)
+		return idx;
+
+	return ((__u64)(sub + idx % sub + 1) << (idx / sub - 1)) - 1;
+}
+
+static __u64 lat_percentile(const struct lstats_export_lat *lel,
+			    const __u64 *buckets, unsigned int permille)
+{
+	__u64	     rank = lel->lel_count * permille / 1000;
+	__u64	     seen = 0;
+	__u64	     max;
+	unsigned int i;
+
+	if (rank == 0)
+		rank = 1;
+
+	for (i = 0; i < lel->lel_buckets; i++) {
+		seen += buckets[i];
+		if (seen >= rank) {
+			max = lat_bucket_max(lel, i);
+			return max < lel->lel_max ? max : lel->lel_max;
+		}
+	}
+
+	return lel->lel_max;
+}
+
+static void print_lat(const struct lstats_export_header *leh,
+		      const struct lstats_export_record *ler, int all)
+{
+	const char *ptr = (const char *)ler + leh->leh_rec_size;
+	const char *end = (const char *)ler + ler->ler_size;
+	int	    i;
+
+	printf("%s\n", ler->ler_path);
+	printf("%-25s "LPU64".%06u secs.usecs\n", "snapshot_time",
+	       leh->leh_snapshot_sec, leh->leh_snapshot_usec);
+
+	for (i = 0; i < ler->ler_count; i++) {
+		const struct lstats_export_lat *lel = (const void *)ptr;
+		const __u64 *buckets = (const void *)(lel + 1);
+
+		if (ptr + sizeof(*lel) > end ||
+		    (const char *)(buckets + lel->lel_buckets) > end)
+			break;
+		ptr = (const char *)(buckets + lel->lel_buckets);
+
+		if (lel->lel_count == 0) {
+			if (all)
+				printf("%-25.*s 0 samples [%.*s]\n",
+				       LSTATS_NAME_LEN, lel->lel_name,
+				       LSTATS_UNITS_LEN, lel->lel_units);
+			continue;
+		}
+
+		printf("%-25.*s "LPU64" samples [%.*s] p50 "LPU64" p90 "LPU64
+		       " p99 "LPU64" p99.9 "LPU64" max "LPU64"\n",
+		       LSTATS_NAME_LEN, lel->lel_name, lel->lel_count,
+		       LSTATS_UNITS_LEN, lel->lel_units,
+		       lat_percentile(lel, buckets, 500),
+		       lat_percentile(lel, buckets, 900),
+		       lat_percentile(lel, buckets, 990),
+		       lat_percentile(lel, buckets, 999), lel->lel_max);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	const char			*file = LSTATS_EXPORT_FILE;
+	struct lstats_export_header	 leh;
+	const struct lstats_export_record *ler;
+	char				*buf;
+	__u64				 offset;
+	int				 all = 0;
+	int				 fd;
+	int				 rc;
+	int				 c;
+	int				 i;
+
+	while ((c = getopt(argc, argv, "af:h")) != -1) {
+		switch (c) {
+		case 'a':
+			all = 1;
+			break;
+		case 'f':
+			file = optarg;
+			break;
+		default:
+			usage(argv[0]);
+			return c == 'h' ? 0 : 1;
+		}
+	}
+
+	/* every open is a new snapshot, so size and map it through the
+	 * same descriptor */
+	fd = open(file, O_RDONLY);
+	if (fd < 0) {
+		fprintf(stderr, "%s: cannot open %s: %s\n", argv[0], file,
+			strerror(errno));
+		return 1;
+	}
+
+	rc = pread(fd, &leh, sizeof(leh), 0);
+	if (rc != sizeof(leh)) {
+		fprintf(stderr, "%s: %s: short header\n", argv[0], file);
+		close(fd);
+		return 1;
+	}
+	if (leh.leh_magic != LSTATS_EXPORT_MAGIC ||
+	    leh.leh_version != LSTATS_EXPORT_VERSION ||
+	    leh.leh_hdr_size < sizeof(leh) ||
+	    leh.leh_rec_size < sizeof(*ler) ||
+	    leh.leh_cntr_size < sizeof(struct lstats_export_counter)) {
+		fprintf(stderr, "%s: %s: bad magic %#x or version %u\n",
+			argv[0], file, leh.leh_magic, leh.leh_version);
+		close(fd);
+		return 1;
+	}
+
+	buf = mmap(NULL, leh.leh_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (buf == MAP_FAILED) {
+		fprintf(stderr, "%s: cannot map %s: %s\n", argv[0], file,
+			strerror(errno));
+		close(fd);
+		return 1;
+	}
+
+	offset = leh.leh_hdr_size;
+	for (i = 0; i < leh.leh_count; i++) {
+		if (offset + leh.leh_rec_size > leh.leh_size)
+			break;
+		ler = (const void *)(buf + offset);
+		if (ler->ler_size < leh.leh_rec_size ||
+		    offset + ler->ler_size > leh.leh_size)
+			break;
+		offset += ler->ler_size;
+
+		if (!path_match(ler->ler_path, argv + optind, argc - optind))
+			continue;
+
+		if (ler->ler_type == LSTATS_EXPORT_STATS)
+			print_stats(&leh, ler, all);
+		else if (ler->ler_type == LSTATS_EXPORT_HIST)
+			print_hist(&leh, ler, all);
+		else if (ler->ler_type == LSTATS_EXPORT_LAT)
+			print_lat(&leh, ler, all);
+	}
+
+	rc = 0;
+	if (i < leh.leh_count) {
+		fprintf(stderr, "%s: %s: truncated at record %d of %u\n",
+			argv[0], file, i, leh.leh_count);
+		rc = 1;
+	}
+
+	munmap(buf, leh.leh_size);
+	close(fd);
+	return rc;
+}
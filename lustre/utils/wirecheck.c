@@ -453,7 +453,7 @@ check_obd_connect_data(void)
 	CHECK_MEMBER(obd_connect_data, ocd_max_easize);
 	CHECK_MEMBER(obd_connect_data, ocd_instance);
 	CHECK_MEMBER(obd_connect_data, ocd_maxbytes);
-	CHECK_MEMBER(obd_connect_data, padding1);
+	CHECK_MEMBER(obd_connect_data, ocd_connect_flags2);
 	CHECK_MEMBER(obd_connect_data, padding2);
 	CHECK_MEMBER(obd_connect_data, padding3);
 	CHECK_MEMBER(obd_connect_data, padding4);
@@ -520,6 +520,9 @@ check_obd_connect_data(void)
 	CHECK_DEFINE_64X(OBD_CONNECT_LIGHTWEIGHT);
 	CHECK_DEFINE_64X(OBD_CONNECT_SHORTIO);
 	CHECK_DEFINE_64X(OBD_CONNECT_PINGLESS);
+	CHECK_DEFINE_64X(OBD_CONNECT_BL_BATCH);
+	CHECK_DEFINE_64X(OBD_CONNECT_FLAGS2);
+	CHECK_DEFINE_64X(OBD_CONNECT2_MD_BATCH);
 
 	CHECK_VALUE_X(OBD_CKSUM_CRC32);
 	CHECK_VALUE_X(OBD_CKSUM_ADLER);
@@ -2171,6 +2174,7 @@ main(int argc, char **argv)
 	CHECK_VALUE(REINT_OPEN);
 	CHECK_VALUE(REINT_SETXATTR);
 	CHECK_VALUE(REINT_RMENTRY);
+	CHECK_VALUE(REINT_BATCH);
 	CHECK_VALUE(REINT_MAX);
 
 	CHECK_VALUE_X(DISP_IT_EXECD);
@@ -2278,6 +2282,7 @@ main(int argc, char **argv)
 
 	CHECK_VALUE(QUOTA_DQACQ);
 	CHECK_VALUE(QUOTA_DQREL);
+	CHECK_VALUE(QUOTA_DQACQ_BATCH);
 	CHECK_VALUE(QUOTA_LAST_OPC);
 
 	CHECK_VALUE(MGS_CONNECT);